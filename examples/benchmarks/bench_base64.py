@@ -0,0 +1,38 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+"""Micro-benchmark of the base64 encoding/decoding of constant payloads (host side),
+comparing the AVX2 and scalar (chromium) implementations, and Python `base64` module.
+
+Usage:
+    python bench_base64.py
+"""
+import base64
+import timeit
+
+import numpy as np
+
+from jax_ipu_experimental_addons.tile.tile_common_utils import base64_avx2_supported, base64_decode, base64_encode
+
+sizes_list = [1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024]
+num_repeats = 10
+
+
+def bench_time_ms(fn, data) -> float:
+    """Best time (in ms) of a function call."""
+    return 1000 * min(timeit.repeat(lambda: fn(data), number=1, repeat=num_repeats))
+
+
+if __name__ == "__main__":
+    print(f"AVX2 supported: {base64_avx2_supported()}")
+    for size in sizes_list:
+        data = np.random.randint(0, 256, size=size, dtype=np.uint8).tobytes()
+        encoded = base64.b64encode(data)
+        timings = {
+            "encode | avx2": bench_time_ms(lambda v: base64_encode(v, use_avx2=True), data),
+            "encode | scalar": bench_time_ms(lambda v: base64_encode(v, use_avx2=False), data),
+            "encode | python": bench_time_ms(base64.b64encode, data),
+            "decode | avx2": bench_time_ms(lambda v: base64_decode(v, use_avx2=True), encoded),
+            "decode | scalar": bench_time_ms(lambda v: base64_decode(v, use_avx2=False), encoded),
+            "decode | python": bench_time_ms(base64.b64decode, encoded),
+        }
+        for name, ms in timings.items():
+            print(f"base64 {name} | size: {size} | {ms:.3f} ms | {size / (ms * 1e3):.1f} MB/s")
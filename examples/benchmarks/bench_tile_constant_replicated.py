@@ -0,0 +1,39 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+"""Benchmark of the Poplar graph construction/compilation time of replicated tile constants.
+
+Usage:
+    python bench_tile_constant_replicated.py
+"""
+import time
+from functools import partial
+
+import jax
+import numpy as np
+
+from jax_ipu_experimental_addons.tile import ipu_tile_constant_pool_clear, tile_constant_replicated
+
+num_tiles_list = [1, 64, 1472]
+dtypes = [np.float32, np.float16, np.int32]
+data = np.arange(128, dtype=np.float32)
+
+
+def bench_compile_time(num_tiles: int, dtype) -> float:
+    tiles = tuple(range(num_tiles))
+    cst = data.astype(dtype)
+
+    # Note: make sure it is not a constant function, so it does not get simplified away.
+    @partial(jax.jit, backend="ipu")
+    def compute_fn(v):
+        return v, tile_constant_replicated(cst, tiles)
+
+    ipu_tile_constant_pool_clear()
+    start = time.perf_counter()
+    compute_fn.lower(data).compile()
+    return time.perf_counter() - start
+
+
+if __name__ == "__main__":
+    for dtype in dtypes:
+        for num_tiles in num_tiles_list:
+            elapsed = bench_compile_time(num_tiles, dtype)
+            print(f"tile_constant_replicated | dtype: {np.dtype(dtype).name} | tiles: {num_tiles} | {elapsed:.3f}s")
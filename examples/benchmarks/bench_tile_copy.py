@@ -0,0 +1,48 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+"""Benchmark of the IPU cycle count of `tile_copy` (multi-worker `TileMemcpyVertex`),
+compared to a Poplar on-tile `Copy` program.
+
+Usage:
+    python bench_tile_copy.py
+"""
+from functools import partial
+
+import jax
+import numpy as np
+
+from jax_ipu_experimental_addons.tile import ipu_cycle_count, tile_copy, tile_gather, tile_put_replicated
+
+tiles = (0,)
+sizes_list = [64, 128, 512, 2048, 8192]
+dtypes_list = [np.uint8, np.float16, np.float32]
+
+
+def bench_copy_cycles(size: int, dtype, use_tile_copy: bool) -> int:
+    data = np.random.rand(size).astype(dtype)
+
+    @partial(jax.jit, backend="ipu")
+    def compute_fn(data):
+        arr = tile_put_replicated(data, tiles)
+        arr, start = ipu_cycle_count(arr)
+        if use_tile_copy:
+            arr = tile_copy(arr)
+        else:
+            # Identity gather with copy => Poplar `Copy` program.
+            arr = tile_gather(arr, list(range(len(tiles))), tiles, copy=True)
+        arr, end = ipu_cycle_count(arr)
+        return arr, start, end
+
+    _, start, end = compute_fn(data)
+    start, end = np.asarray(start), np.asarray(end)
+    return int(np.max(end[:, 0].astype(np.int64) - start[:, 0].astype(np.int64)))
+
+
+if __name__ == "__main__":
+    for dtype in dtypes_list:
+        for size in sizes_list:
+            tile_cycles = bench_copy_cycles(size, dtype, use_tile_copy=True)
+            poplar_cycles = bench_copy_cycles(size, dtype, use_tile_copy=False)
+            print(
+                f"tile_copy | dtype: {np.dtype(dtype).name} | size: {size} | "
+                f"tile_copy: {tile_cycles} cycles | Poplar Copy: {poplar_cycles} cycles"
+            )
@@ -0,0 +1,41 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+"""Benchmark of the IPU cycle count of `tile_gather` (batched into a single exchange step).
+
+Usage:
+    python bench_tile_gather.py
+"""
+from functools import partial
+
+import jax
+import numpy as np
+
+from jax_ipu_experimental_addons.tile import ipu_cycle_count, tile_gather, tile_put_sharded
+
+num_tiles_list = [16, 64, 736]
+item_size = 64
+
+
+def bench_gather_cycles(num_tiles: int, shift: int, copy: bool) -> int:
+    tiles = tuple(range(num_tiles))
+    # Rotation pattern, similar to Jacobi eigh columns rotation.
+    indices = tuple([(idx + shift) % num_tiles for idx in range(num_tiles)])
+    data = np.random.rand(num_tiles, item_size).astype(np.float32)
+
+    @partial(jax.jit, backend="ipu")
+    def compute_fn(data):
+        arr = tile_put_sharded(data, tiles)
+        arr, start = ipu_cycle_count(arr, sync=True)
+        arr = tile_gather(arr, indices, tiles, copy=copy)
+        arr, end = ipu_cycle_count(arr, sync=True)
+        return arr, start, end
+
+    _, start, end = compute_fn(data)
+    start, end = np.asarray(start), np.asarray(end)
+    return int(np.max(end[:, 0].astype(np.int64) - start[:, 0].astype(np.int64)))
+
+
+if __name__ == "__main__":
+    for num_tiles in num_tiles_list:
+        for shift, copy in [(0, False), (0, True), (1, False), (num_tiles // 2, False)]:
+            cycles = bench_gather_cycles(num_tiles, shift, copy)
+            print(f"tile_gather | tiles: {num_tiles} | shift: {shift} | copy: {copy} | {cycles} cycles")
@@ -0,0 +1,217 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+"""Benchmark suite of the custom IPU vertices, sweeping over sizes and dtypes.
+
+Every benchmark is running a single `tile_map_primitive` call on one tile, measured using
+`ipu_cycle_count`. Results are reported as cycles/element and FLOPs/cycle (vs tile peak),
+and can be saved as JSON, and compared to a baseline JSON file to detect performance regressions.
+
+Usage:
+    python bench_vertices.py --output bench.json
+    python bench_vertices.py --baseline bench.json --tolerance 0.05
+"""
+import argparse
+import json
+import sys
+from functools import partial
+from typing import Any, Callable, Dict, List, Tuple
+
+import jax
+import numpy as np
+
+from jax_ipu_experimental_addons.tile import (
+    IpuConvVertexType,
+    ipu_cycle_count,
+    ipu_cycle_count_overhead,
+    tile_map_primitive,
+    tile_put_replicated,
+)
+from jax_ipu_experimental_addons.tile.tile_interpreter_linalg_jacobi import jacobi_update_first_step_p
+from jax_ipu_experimental_addons.tile.tile_interpreter_linalg_qr import dot_product1d_p, qr_householder_row_update_p
+
+tiles = (0,)
+default_sizes = [64, 128, 256, 512, 1024, 2048]
+
+# IPU Mk2 tile peak FLOPs/cycle: AMP unit (matmul/conv vertices) and vector unit (other vertices).
+peak_flops_amp = {"float16": 128, "float32": 32}
+peak_flops_vector = {"float16": 8, "float32": 4}
+
+BenchmarkSetup = Callable[[int, Any], Tuple[Callable[..., Any], List[np.ndarray], int, int]]
+"""Benchmark setup: (size, dtype) => (tile function, inputs, number of elements, number of FLOPs).
+"""
+
+
+def measure_tile_cycles(tile_fn: Callable[..., Any], inputs: List[np.ndarray]) -> int:
+    """Measure the cycle count of a tile function (on a single tile).
+
+    Args:
+        tile_fn: Tile function, taking tile sharded arrays inputs.
+        inputs: NumPy inputs, replicated on the benchmark tile.
+    Returns:
+        Cycle count, excluding `ipu_cycle_count` overhead.
+    """
+
+    @partial(jax.jit, backend="ipu")
+    def bench_fn(*args):
+        args = [tile_put_replicated(v, tiles) for v in args]
+        # Force all inputs on tile before starting the cycle count.
+        *args, start = ipu_cycle_count(*args)
+        outputs = tile_fn(*args)
+        outputs = outputs if isinstance(outputs, tuple) else (outputs,)
+        _, end = ipu_cycle_count(outputs[0])
+        return start, end
+
+    start, end = bench_fn(*inputs)
+    start, end = np.asarray(start)[0], np.asarray(end)[0]
+    cycles = (int(end[1]) << 32 | int(end[0])) - (int(start[1]) << 32 | int(start[0]))
+    return cycles - ipu_cycle_count_overhead()
+
+
+def setup_jacobi_update_first_step(N: int, dtype: Any):
+    pq = np.array([3, N // 2], dtype=np.uint32)
+    pcol = np.random.randn(N).astype(dtype)
+    qcol = np.random.randn(N).astype(dtype)
+    tile_fn = partial(tile_map_primitive, jacobi_update_first_step_p, N=N)
+    # Two columns rotation: 6 FLOPs per element.
+    return tile_fn, [pq, pcol, qcol], N, 6 * N
+
+
+def setup_dot_product1d(N: int, dtype: Any):
+    x = np.random.randn(N).astype(dtype)
+    y = np.random.randn(N).astype(dtype)
+    return partial(tile_map_primitive, dot_product1d_p), [x, y], N, 2 * N
+
+
+def setup_qr_householder_row_update(N: int, dtype: Any):
+    x = np.random.randn(N).astype(dtype)
+    v = np.random.randn(N).astype(dtype)
+    # FP32 scaling factors, independently of x and v storage dtype.
+    w = np.random.randn(1).astype(np.float32)
+    tile_fn = partial(tile_map_primitive, qr_householder_row_update_p, start_idx=0)
+    return lambda x, v, w: tile_fn(x, v, w, w), [x, v, w], N, 2 * N
+
+
+def setup_dot_conv_partial1x1(N: int, dtype: Any):
+    # Basic AMP matmul: [N, K] x [K, K], with K=8 in FP32 and K=16 in FP16.
+    K = 16 if np.dtype(dtype) == np.float16 else 8
+    lhs = np.random.randn(N, K).astype(dtype)
+    rhs = np.random.randn(K, K).astype(dtype)
+    tile_fn = partial(
+        tile_map_primitive,
+        jax.lax.dot_general_p,
+        dimension_numbers=(([1], [1]), ([], [])),
+        precision=jax.lax.Precision.DEFAULT,
+        preferred_element_type=dtype,
+        ipu_vertex_type=IpuConvVertexType.ConvPartial1x1,
+    )
+    return tile_fn, [lhs, rhs], N * K, 2 * N * K * K
+
+
+def setup_dot_conv_partial_hmac(N: int, dtype: Any):
+    lhs = np.random.randn(N).astype(dtype)
+    rhs = np.random.randn(N).astype(dtype)
+    tile_fn = partial(
+        tile_map_primitive,
+        jax.lax.dot_general_p,
+        dimension_numbers=(([0], [0]), ([], [])),
+        precision=jax.lax.Precision.DEFAULT,
+        preferred_element_type=dtype,
+        ipu_vertex_type=IpuConvVertexType.ConvPartialHMAC,
+    )
+    return tile_fn, [lhs, rhs], N, 2 * N
+
+
+# Benchmarks registry: name => (setup, dtypes, peak FLOPs/cycle table).
+benchmarks: Dict[str, Tuple[BenchmarkSetup, List[Any], Dict[str, int]]] = {
+    "JacobiUpdateFirstStep": (setup_jacobi_update_first_step, [np.float16, np.float32], peak_flops_vector),
+    "DotProduct1dVertex": (setup_dot_product1d, [np.float16, np.float32], peak_flops_vector),
+    "QRHouseholderRowUpdateVertex": (setup_qr_householder_row_update, [np.float16, np.float32], peak_flops_vector),
+    "ConvPartial1x1": (setup_dot_conv_partial1x1, [np.float16, np.float32], peak_flops_amp),
+    "ConvPartialHMAC": (setup_dot_conv_partial_hmac, [np.float32], peak_flops_vector),
+}
+
+
+def run_benchmarks(names: List[str], sizes: List[int]) -> List[Dict[str, Any]]:
+    """Run the collection of benchmarks, sweeping over sizes and dtypes."""
+    results = []
+    for name in names:
+        setup_fn, dtypes, peak_flops = benchmarks[name]
+        for dtype in dtypes:
+            dtype_name = np.dtype(dtype).name
+            for size in sizes:
+                result: Dict[str, Any] = {"name": name, "dtype": dtype_name, "size": size}
+                try:
+                    tile_fn, inputs, num_elements, num_flops = setup_fn(size, dtype)
+                    cycles = measure_tile_cycles(tile_fn, inputs)
+                except Exception as e:
+                    # Unsupported configuration: keep track of it in the report.
+                    result["error"] = str(e).splitlines()[0] if str(e) else type(e).__name__
+                    results.append(result)
+                    print(f"{name} | {dtype_name} | N: {size} | ERROR: {result['error']}")
+                    continue
+                flops_per_cycle = num_flops / max(cycles, 1)
+                result.update(
+                    {
+                        "cycles": cycles,
+                        "cycles_per_element": cycles / num_elements,
+                        "flops": num_flops,
+                        "flops_per_cycle": flops_per_cycle,
+                        "peak_flops_per_cycle": peak_flops[dtype_name],
+                        "peak_ratio": flops_per_cycle / peak_flops[dtype_name],
+                    }
+                )
+                results.append(result)
+                print(
+                    f"{name} | {dtype_name} | N: {size} | {cycles} cycles | "
+                    f"{result['cycles_per_element']:.3f} cycles/elt | "
+                    f"{flops_per_cycle:.2f} FLOPs/cycle ({100 * result['peak_ratio']:.1f}% of peak)"
+                )
+    return results
+
+
+def check_regressions(results: List[Dict[str, Any]], baseline: List[Dict[str, Any]], tolerance: float) -> List[str]:
+    """Compare benchmark results to a baseline, returning the list of cycle count regressions."""
+
+    def make_key(r: Dict[str, Any]) -> Tuple[str, str, int]:
+        return (r["name"], r["dtype"], r["size"])
+
+    baseline_cycles = {make_key(r): r["cycles"] for r in baseline if "cycles" in r}
+    regressions = []
+    for r in results:
+        ref_cycles = baseline_cycles.get(make_key(r))
+        if ref_cycles is None or "cycles" not in r:
+            continue
+        if r["cycles"] > ref_cycles * (1 + tolerance):
+            regressions.append(f"{r['name']} | {r['dtype']} | N: {r['size']} | {ref_cycles} => {r['cycles']} cycles")
+    return regressions
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="IPU custom vertices benchmark suite.")
+    parser.add_argument("--benchmarks", nargs="+", default=list(benchmarks.keys()), choices=list(benchmarks.keys()))
+    parser.add_argument("--sizes", nargs="+", type=int, default=default_sizes)
+    parser.add_argument("--output", type=str, default=None, help="JSON output filename.")
+    parser.add_argument("--baseline", type=str, default=None, help="JSON baseline filename, to check regressions.")
+    parser.add_argument("--tolerance", type=float, default=0.05, help="Relative cycle count regression tolerance.")
+    args = parser.parse_args()
+
+    device = jax.devices("ipu")[0]
+    if device.is_ipu_model:
+        print("WARNING: running on IPU model, cycle counts are not representative of IPU hardware.")
+
+    np.random.seed(42)
+    results = run_benchmarks(args.benchmarks, args.sizes)
+    if args.output:
+        report = {
+            "device": {"num_tiles": device.num_tiles, "is_ipu_model": device.is_ipu_model},
+            "results": results,
+        }
+        with open(args.output, "w") as f:
+            json.dump(report, f, indent=2)
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)["results"]
+        regressions = check_regressions(results, baseline, args.tolerance)
+        for msg in regressions:
+            print(f"REGRESSION: {msg}")
+        if len(regressions) > 0:
+            sys.exit(1)
@@ -3,6 +3,12 @@
 #include <x86intrin.h>
 #include <stdbool.h>
 
+/**
+* AVX2 code path compiled independently of global compilation flags: callers
+* must check AVX2 support of the host CPU at runtime.
+*/
+#define AVX2_TARGET __attribute__((target("avx2")))
+
 /**
 * This code borrows from Wojciech Mula's library at
 * https://github.com/WojciechMula/base64simd (published under BSD)
@@ -18,7 +24,7 @@
 */
 
 
-static inline __m256i enc_reshuffle(const __m256i input) {
+AVX2_TARGET static inline __m256i enc_reshuffle(const __m256i input) {
 
     // translation from SSE into AVX2 of procedure
     // https://github.com/WojciechMula/base64simd/blob/master/encode/unpack_bigendian.cpp
@@ -43,7 +49,7 @@ static inline __m256i enc_reshuffle(const __m256i input) {
     return _mm256_or_si256(t1, t3);
 }
 
-static inline __m256i enc_translate(const __m256i in) {
+AVX2_TARGET static inline __m256i enc_translate(const __m256i in) {
   const __m256i lut = _mm256_setr_epi8(
       65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0, 65, 71,
       -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
@@ -54,7 +60,7 @@ static inline __m256i enc_translate(const __m256i in) {
   return out;
 }
 
-static inline __m256i dec_reshuffle(__m256i in) {
+AVX2_TARGET static inline __m256i dec_reshuffle(__m256i in) {
 
   // inlined procedure pack_madd from https://github.com/WojciechMula/base64simd/blob/master/decode/pack.avx2.cpp
   // The only difference is that elements are reversed,
@@ -75,7 +81,7 @@ static inline __m256i dec_reshuffle(__m256i in) {
 }
 
 
-size_t fast_avx2_base64_encode(char* dest, const char* str, size_t len) {
+AVX2_TARGET size_t fast_avx2_base64_encode(char* dest, const char* str, size_t len) {
       const char* const dest_orig = dest;
       if(len >= 32 - 4) {
         // first load is masked
@@ -115,7 +121,7 @@ size_t fast_avx2_base64_encode(char* dest, const char* str, size_t len) {
       return (dest - dest_orig) + scalarret;
 }
 
-size_t fast_avx2_base64_decode(char *out, const char *src, size_t srclen) {
+AVX2_TARGET size_t fast_avx2_base64_decode(char *out, const char *src, size_t srclen) {
       char* out_orig = out;
       while (srclen >= 45) {
 
@@ -9,22 +9,36 @@ from . import (
     tile_interpreter_linalg_qr,
 )
 from .tile_array import (
+    IPU_NUM_TILES_PER_IPU,
     TileShardedArray,
+    ipu_num_tiles_per_ipu,
+    make_global_tiles,
     tile_barrier,
     tile_constant_replicated,
     tile_constant_sharded,
+    tile_contiguous_regions,
     tile_data_barrier,
     tile_gather,
+    tile_global_index,
+    tile_ipu_index,
     tile_put_replicated,
     tile_put_sharded,
 )
-from .tile_common_utils import from_ipu_type_to_numpy_dtype, make_ipu_shaped_array
+from .tile_common_utils import (
+    IpuFp8Format,
+    fp8_decode,
+    fp8_encode,
+    from_ipu_type_to_numpy_dtype,
+    make_ipu_shaped_array,
+)
 from .tile_interpreter import (
     create_ipu_tile_primitive,
     create_ipu_tile_primitive_v2,
     declare_ipu_tile_primitive,
     register_ipu_tile_primitive,
     tile_map_primitive,
+    tile_map_primitive_group,
+    tile_pipelined_loop,
 )
 from .tile_interpreter_hw_primitives import (
     hw_cycle_count_p,
@@ -33,15 +47,19 @@ from .tile_interpreter_hw_primitives import (
     ipu_hw_cycle_count,
 )
 from .tile_interpreter_lax_binary import scaled_add_p, scaled_sub_p
-from .tile_interpreter_lax_dot import IpuConvVertexType
+from .tile_interpreter_lax_dot import IpuConvVertexType, tile_fp8_dot
+from .tile_interpreter_lax_fusion import tile_map_fused
+from .tile_interpreter_lax_reduce import tile_reduce_gather
 from .tile_interpreter_lax_unary import tile_copy
-from .tile_interpreter_linalg_jacobi import ipu_eigh
-from .tile_interpreter_linalg_qr import ipu_qr
+from .tile_interpreter_linalg_jacobi import ipu_eigh, ipu_eigh_batched
+from .tile_interpreter_linalg_qr import ipu_qr, ipu_qr_batched
 from .tile_interpreter_primitives import (
     IpuTileMapEquation,
     IpuVertexIOType,
     from_numpy_dtype_to_ipu_type,
     get_ipu_type_name,
+    ipu_tile_constant_pool_clear,
+    ipu_tile_constant_pool_stats,
     make_ipu_vertex_constant_info,
     make_ipu_vertex_in_info,
     make_ipu_vertex_inout_info,
@@ -49,10 +67,21 @@ from .tile_interpreter_primitives import (
     make_ipu_vertex_io_info,
     make_ipu_vertex_out_info,
     make_ipu_vertex_outputs,
+    tile_map_equation_cache_clear,
+    tile_map_equation_cache_set_max_size,
+    tile_map_equation_cache_stats,
 )
 from .tile_interpreter_random import (
     ipu_get_hw_seeds_tmap,
     ipu_random_normal_tmap,
+    ipu_random_truncated_normal_tmap,
     ipu_random_uniform_tmap,
     ipu_set_hw_seeds_tmap,
 )
+from .tile_interpreter_sparse import TileSparseCsrMatrix, make_tile_sparse_csr_matrix, tile_sparse_csr_matvec
+from .tile_memory_estimate import (
+    IPU_TILE_MEMORY_BYTES,
+    TileMemoryEstimate,
+    tile_memory_estimate,
+    tile_memory_estimate_jaxpr,
+)
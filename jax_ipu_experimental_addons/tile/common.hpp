@@ -5,6 +5,7 @@
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <half/half.hpp>
 #include <json/json.hpp>
@@ -70,6 +71,20 @@ poplar::Type toPoplar(IpuType type) {
   throw std::runtime_error("Unknown IPU datatype.");
 }
 
+/**
+ * @brief Convert IPU type enum to the Poplar type used for tensor storage.
+ *
+ * FP8/QUARTER data is stored as raw bytes (i.e. UNSIGNED_CHAR): there is no
+ * FP8 dtype in JAX/XLA, and Poplar QUARTER tensors require format & scale
+ * metadata. FP8 decoding is done in IPU vertices.
+ */
+poplar::Type toPoplarStorage(IpuType type) {
+  if (type == IpuType::QUARTER) {
+    return poplar::UNSIGNED_CHAR;
+  }
+  return toPoplar(type);
+}
+
 /**
  * @brief Get the size (in bytes) of IPU datatype.
  */
@@ -124,6 +139,7 @@ IPU_TYPE_DECLARE_TRAITS(IpuType::UNSIGNED_INT, unsigned int)
 IPU_TYPE_DECLARE_TRAITS(IpuType::INT, int)
 IPU_TYPE_DECLARE_TRAITS(IpuType::UNSIGNED_LONG, unsigned long)
 IPU_TYPE_DECLARE_TRAITS(IpuType::LONG, long)
+IPU_TYPE_DECLARE_TRAITS(IpuType::QUARTER, unsigned char)  // FP8 raw bytes.
 IPU_TYPE_DECLARE_TRAITS(IpuType::HALF, half_float::half)
 IPU_TYPE_DECLARE_TRAITS(IpuType::FLOAT, float)
 
@@ -172,8 +188,7 @@ decltype(auto) applyFnToArray(Fn&& fn, poplar::ArrayRef<char> raw_array,
     case IpuType::UNSIGNED_LONG:
       return fn(makeArrayRef<IpuType::UNSIGNED_LONG>(raw_array));
     case IpuType::QUARTER:
-      // TODO?
-      throw std::runtime_error("Unsupported Quarter IPU datatype.");
+      return fn(makeArrayRef<IpuType::QUARTER>(raw_array));
     case IpuType::HALF:
       return fn(makeArrayRef<IpuType::HALF>(raw_array));
     case IpuType::FLOAT:
@@ -220,6 +235,164 @@ T from_json_str(const std::string& json_str) {
   return j.get<T>();
 }
 
+/**
+ * @brief Does the host CPU support AVX2 instructions? (cached runtime check)
+ */
+inline bool hostSupportsAvx2() noexcept {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+/**
+ * @brief Minimum payload size (in bytes) using the AVX2 base64 code path.
+ * Small payloads are faster with the scalar implementation.
+ */
+constexpr std::size_t kBase64Avx2MinSize = 256;
+
+/**
+ * @brief Base64 encode raw data into a destination buffer.
+ *
+ * Using the AVX2 implementation for large payloads (when supported by the host
+ * CPU), chromium scalar implementation otherwise.
+ *
+ * @param dest Destination buffer, of size at least
+ * `chromium_base64_encode_len(len)`.
+ * @param src Raw data.
+ * @param len Raw data size.
+ * @param use_avx2 Allow the AVX2 code path.
+ * @return Size of the encoded data.
+ */
+inline std::size_t base64EncodeTo(char* dest, const char* src, std::size_t len,
+                                  bool use_avx2 = true) {
+  const std::size_t size = (use_avx2 && len >= kBase64Avx2MinSize &&
+                            hostSupportsAvx2())
+                               ? fast_avx2_base64_encode(dest, src, len)
+                               : chromium_base64_encode(dest, src, len);
+  if (size == MODP_B64_ERROR) {
+    throw std::runtime_error("Base64 encoding error.");
+  }
+  return size;
+}
+
+/**
+ * @brief Base64 decode data into a destination buffer.
+ *
+ * @param dest Destination buffer, of size at least
+ * `chromium_base64_decode_len(len)`.
+ * @param src Base64 encoded data.
+ * @param len Encoded data size.
+ * @param use_avx2 Allow the AVX2 code path.
+ * @return Size of the decoded data.
+ */
+inline std::size_t base64DecodeTo(char* dest, const char* src, std::size_t len,
+                                  bool use_avx2 = true) {
+  const std::size_t size = (use_avx2 && len >= kBase64Avx2MinSize &&
+                            hostSupportsAvx2())
+                               ? fast_avx2_base64_decode(dest, src, len)
+                               : chromium_base64_decode(dest, src, len);
+  if (size == MODP_B64_ERROR) {
+    throw std::runtime_error("Invalid base64 encoded data.");
+  }
+  return size;
+}
+
+/**
+ * @brief Base64 encode a raw data string.
+ */
+inline std::string base64Encode(const std::string& data, bool use_avx2 = true) {
+  std::string encoded(chromium_base64_encode_len(data.size()), '\0');
+  encoded.resize(
+      base64EncodeTo(encoded.data(), data.data(), data.size(), use_avx2));
+  return encoded;
+}
+
+/**
+ * @brief Base64 decode an encoded string.
+ */
+inline std::string base64Decode(const std::string& encoded,
+                                bool use_avx2 = true) {
+  std::string decoded(chromium_base64_decode_len(encoded.size()), '\0');
+  decoded.resize(base64DecodeTo(decoded.data(), encoded.data(), encoded.size(),
+                                use_avx2));
+  return decoded;
+}
+
+/**
+ * @brief Convert (recursively) base64 encoded fields of a JSON object into raw
+ * binary fields. Used for generating binary (MessagePack) attributes.
+ */
+inline void jsonBase64ToBinary(json& j) {
+  if (j.is_object()) {
+    const auto it = j.find("encoded_data");
+    if (it != j.end() && it->is_string()) {
+      // Decoding directly into the binary field buffer.
+      const auto& encoded = it->template get_ref<const std::string&>();
+      std::vector<std::uint8_t> raw(chromium_base64_decode_len(encoded.size()));
+      raw.resize(base64DecodeTo(reinterpret_cast<char*>(raw.data()),
+                                encoded.data(), encoded.size()));
+      j.erase(it);
+      j["raw_data"] = json::binary(std::move(raw));
+      return;
+    }
+    for (auto& item : j.items()) {
+      jsonBase64ToBinary(item.value());
+    }
+  } else if (j.is_array()) {
+    for (auto& v : j) {
+      jsonBase64ToBinary(v);
+    }
+  }
+}
+
+/**
+ * @brief Convert an object to a MessagePack binary string.
+ *
+ * Compact binary alternative to JSON: base64 data fields are stored as raw
+ * bytes, avoiding any text decoding of constant payloads when deserializing.
+ */
+template <typename T>
+std::string to_msgpack_str(const T& v) {
+  json j = v;
+  jsonBase64ToBinary(j);
+  std::string msgpack_str;
+  json::to_msgpack(j, msgpack_str);
+  return msgpack_str;
+}
+/**
+ * @brief Build an object from a MessagePack binary string.
+ */
+template <typename T>
+T from_msgpack_str(const std::string& msgpack_str) {
+  json j = json::from_msgpack(msgpack_str);
+  return j.get<T>();
+}
+
+/**
+ * @brief Is a raw attributes string JSON encoded (or MessagePack binary)?
+ *
+ * NOTE: MessagePack never starts with '{' or '[' for maps and arrays, which
+ * are the only top-level objects used in IPU custom primitive attributes.
+ */
+inline bool isJsonAttributes(const std::string& attributes) noexcept {
+  const auto pos = attributes.find_first_not_of(" \t\n\r");
+  if (pos == std::string::npos) {
+    return true;
+  }
+  return attributes[pos] == '{' || attributes[pos] == '[';
+}
+
+/**
+ * @brief Build an object from raw custom primitive attributes, either JSON
+ * (debug friendly) or MessagePack (compact binary) encoded.
+ */
+template <typename T>
+T from_attributes_str(const std::string& attributes) {
+  if (isJsonAttributes(attributes)) {
+    return from_json_str<T>(attributes);
+  }
+  return from_msgpack_str<T>(attributes);
+}
+
 /**
  * @brief JAX-like shaped array data structure.
  */
@@ -261,24 +434,48 @@ struct Base64Data {
   using byte = std::uint8_t;
   /** Raw data as base64 encoded. */
   std::string encoded_data;
+  /** Raw data already decoded (when deserialized from binary attributes). */
+  std::string raw_data = "";
 
   /** Is the data empty? */
-  bool empty() const noexcept { return encoded_data.empty(); }
+  bool empty() const noexcept {
+    return encoded_data.empty() && raw_data.empty();
+  }
   /**
    * @brief Create base64 encoded data from raw data.
    */
   static Base64Data fromDecodedData(const std::string& data) {
-    return Base64Data{chromium_base64_encode(data)};
+    return Base64Data{base64Encode(data)};
+  }
+  /**
+   * @brief Decode the data (no-op if raw data already available).
+   */
+  std::string decode() const {
+    if (!raw_data.empty()) {
+      return raw_data;
+    }
+    return base64Decode(encoded_data);
   }
   /**
-   * @brief Decode the data.
+   * @brief Decoded data array ref, avoiding any copy of raw data.
+   *
+   * @param buffer Decoding buffer, used only when raw data is not available.
+   * Must outlive the returned array ref.
    */
-  std::string decode() const { return chromium_base64_decode(encoded_data); }
+  poplar::ArrayRef<char> decodeRef(std::string& buffer) const {
+    if (!raw_data.empty()) {
+      return poplar::ArrayRef<char>(raw_data.data(), raw_data.size());
+    }
+    buffer = base64Decode(encoded_data);
+    return poplar::ArrayRef<char>(buffer.data(), buffer.size());
+  }
 };
 // JSON encoding/decoding, supporting empty fields.
 void to_json(json& j, const Base64Data& v) {
-  if (!v.empty()) {
+  if (!v.encoded_data.empty()) {
     j = json{{"encoded_data", v.encoded_data}};
+  } else if (!v.raw_data.empty()) {
+    j = json{{"encoded_data", base64Encode(v.raw_data)}};
   }
 }
 void from_json(const json& j, Base64Data& v) {
@@ -286,6 +483,12 @@ void from_json(const json& j, Base64Data& v) {
   if (it != j.end()) {
     it->get_to(v.encoded_data);
   }
+  // Binary (MessagePack) raw data field.
+  const auto it_raw = j.find("raw_data");
+  if (it_raw != j.end()) {
+    const auto& bin = it_raw->get_binary();
+    v.raw_data.assign(bin.begin(), bin.end());
+  }
 }
 
 /**
@@ -303,6 +506,77 @@ inline void makeBase64DataBindings(pybind11::module& m) {
       .def_static("from_json_str", [](const std::string& j) {
         return from_json_str<Base64Data>(j);
       });
+  // Raw base64 encoding/decoding, mostly for testing & benchmarking.
+  m.def(
+      "base64_encode",
+      [](const pybind11::bytes& data, bool use_avx2) {
+        return pybind11::bytes(base64Encode(std::string(data), use_avx2));
+      },
+      pybind11::arg("data"), pybind11::arg("use_avx2") = true);
+  m.def(
+      "base64_decode",
+      [](const pybind11::bytes& encoded, bool use_avx2) {
+        return pybind11::bytes(base64Decode(std::string(encoded), use_avx2));
+      },
+      pybind11::arg("encoded"), pybind11::arg("use_avx2") = true);
+  m.def("base64_avx2_supported", &hostSupportsAvx2);
+}
+
+/**
+ * @brief Make balanced worker offsets, splitting a 1d array between workers.
+ *
+ * Work is split in grains of `grain` vectors, each worker getting either
+ * floor or ceil of the average number of grains (i.e. at most one grain of
+ * difference between workers). The tail grain (when the number of vectors is
+ * not a multiple of the grain) is assigned to the last worker with work.
+ * Offsets are expressed in vectors, relative to the vertex start index, such
+ * that every worker start keeps the array alignment.
+ *
+ * @param size Size of the array to split.
+ * @param vector_size Vector size (e.g. 2 for float, 4 for half).
+ * @param num_workers Number of workers.
+ * @param grain Worker grain size, in vectors.
+ * @return (num_workers + 1,) worker offsets, in vectors.
+ */
+inline std::vector<uint32_t> makeBalancedWorkerOffsets(std::size_t size,
+                                                       std::size_t vector_size,
+                                                       std::size_t num_workers,
+                                                       std::size_t grain = 1) {
+  if (vector_size == 0 || num_workers == 0 || grain == 0) {
+    throw std::invalid_argument(
+        "Vector size, number of workers and grain must be positive.");
+  }
+  if (size % vector_size != 0) {
+    throw std::invalid_argument(
+        "Worker offsets: size must be a multiple of the vector size.");
+  }
+  const std::size_t num_vectors = size / vector_size;
+  const std::size_t num_grains = (num_vectors + grain - 1) / grain;
+  const std::size_t base_grains = num_grains / num_workers;
+  const std::size_t rem_grains = num_grains % num_workers;
+  std::vector<uint32_t> offsets(num_workers + 1, 0);
+  for (std::size_t w = 0; w < num_workers; ++w) {
+    const std::size_t wgrains = base_grains + (w < rem_grains ? 1 : 0);
+    const std::size_t wend = offsets[w] + wgrains * grain;
+    offsets[w + 1] = static_cast<uint32_t>(std::min(wend, num_vectors));
+  }
+  return offsets;
+}
+
+/**
+ * @brief Make pybind11 bindings of worker partition helpers.
+ */
+inline void makeWorkerOffsetsBindings(pybind11::module& m) {
+  m.def(
+      "make_balanced_worker_offsets",
+      [](std::size_t size, std::size_t vector_size, std::size_t num_workers,
+         std::size_t grain) {
+        const auto offsets =
+            makeBalancedWorkerOffsets(size, vector_size, num_workers, grain);
+        return pybind11::array_t<uint32_t>(offsets.size(), offsets.data());
+      },
+      pybind11::arg("size"), pybind11::arg("vector_size") = 2,
+      pybind11::arg("num_workers") = 6, pybind11::arg("grain") = 1);
 }
 
 }  // namespace ipu
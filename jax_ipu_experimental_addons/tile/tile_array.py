@@ -1,8 +1,10 @@
 # Copyright (c) 2022 Graphcore Ltd. All rights reserved.
 from dataclasses import dataclass
-from typing import Any, Sequence, Tuple, Union
+from functools import lru_cache
+from typing import Any, Optional, Sequence, Tuple, Union
 
 import chex
+import jax
 import numpy as np
 from jax.core import ShapedArray
 from jax.interpreters.xla import DeviceArray
@@ -13,6 +15,7 @@ from jax_ipu_experimental_addons.utils import ArrayLike, DTypeLike, Shape
 from .tile_array_primitives import (
     tile_constant_replicated_prim,
     tile_constant_sharded_prim,
+    tile_contiguous_regions_prim,
     tile_data_barrier_prim,
     tile_gather_prim,
     tile_put_replicated_prim,
@@ -20,9 +23,55 @@ from .tile_array_primitives import (
 )
 
 TilesType = Tuple[int, ...]
+TileIndexLike = Union[int, Tuple[int, int]]
 SliceType = Union[int, slice]
 MultiSliceType = Tuple[SliceType, ...]
 
+IPU_NUM_TILES_PER_IPU: int = 1472
+"""Number of tiles per IPU (Mk2 IPU), default when no IPU device is available.
+"""
+
+
+@lru_cache(maxsize=None)
+def ipu_num_tiles_per_ipu() -> int:
+    """Number of tiles per IPU of the IPU device(s), used for (ipu, tile) indexing in multi-IPU graphs.
+
+    Falling back to `IPU_NUM_TILES_PER_IPU` (Mk2 IPU) when no IPU backend is available.
+    """
+    try:
+        return int(jax.devices("ipu")[0].num_tiles)
+    except (RuntimeError, IndexError):
+        return IPU_NUM_TILES_PER_IPU
+
+
+def tile_global_index(tile: TileIndexLike, num_tiles_per_ipu: Optional[int] = None) -> int:
+    """Global tile index, in a (multi-IPU) Poplar graph.
+
+    Args:
+        tile: Global tile index, or (ipu, tile) pair (with tile local to the IPU).
+        num_tiles_per_ipu: Number of tiles per IPU (default from the IPU device).
+    Returns:
+        Global tile index, i.e. `ipu * num_tiles_per_ipu + tile`.
+    """
+    if isinstance(tile, (tuple, list)):
+        num_tiles_per_ipu = num_tiles_per_ipu or ipu_num_tiles_per_ipu()
+        ipu, local_tile = tile
+        if not (0 <= int(local_tile) < num_tiles_per_ipu) or int(ipu) < 0:
+            raise ValueError(f"Invalid IPU tile index {tuple(tile)}, with {num_tiles_per_ipu} tiles per IPU.")
+        return int(ipu) * num_tiles_per_ipu + int(local_tile)
+    return int(tile)
+
+
+def tile_ipu_index(tile: int, num_tiles_per_ipu: Optional[int] = None) -> Tuple[int, int]:
+    """(ipu, tile) index of a global tile index, in a (multi-IPU) Poplar graph."""
+    num_tiles_per_ipu = num_tiles_per_ipu or ipu_num_tiles_per_ipu()
+    return (int(tile) // num_tiles_per_ipu, int(tile) % num_tiles_per_ipu)
+
+
+def make_global_tiles(tiles: Sequence[TileIndexLike], num_tiles_per_ipu: Optional[int] = None) -> TilesType:
+    """Make a collection of global tile indices, from global indices or (ipu, tile) pairs."""
+    return tuple([tile_global_index(t, num_tiles_per_ipu) for t in tiles])
+
 
 def check_tile_array_multi_slice(slices: MultiSliceType, shape: Shape) -> bool:
     """Check if a tile array multi-slice is valid.
@@ -71,6 +120,9 @@ class TileShardedArray:
         - Must be sharded over the first axis on a given collection of tiles;
         - Each shard is contiguous in memory on every tile;
 
+    In a multi-IPU graph, tiles are global indices (i.e. `ipu * num_tiles_per_ipu + tile`),
+    and can be passed as well as (ipu, tile) pairs.
+
     On non-IPU hardware (for example, CPUs or GPUs), a tile sharded array will
     just be a normal array, with no particular assumption of memory layout.
 
@@ -92,8 +144,8 @@ class TileShardedArray:
             raise ValueError(
                 f"Inconsistent IPU sharded array shape '{self.array.shape}' and number of tiles {len(self.tiles)}."
             )
-        # Make sure we have a tuple of ints.
-        tiles = tuple([int(v) for v in self.tiles])
+        # Make sure we have a tuple of ints (global tile indices).
+        tiles = make_global_tiles(self.tiles)
         object.__setattr__(self, "tiles", tiles)
 
     def tree_flatten(self):
@@ -186,35 +238,43 @@ class TileShardedArray:
         return TileShardedArray(array=self.array[key], tiles=self.tiles[key[0]])  # type:ignore
 
 
-def tile_put_sharded(array: DeviceArray, tiles: Sequence[int]) -> TileShardedArray:
+def tile_put_sharded(array: DeviceArray, tiles: Sequence[TileIndexLike]) -> TileShardedArray:
     """Shard a JAX array over tiles on the first axis.
 
+    On IPU, only the slices not already mapped on their tile are copied (e.g. no
+    copy at all when chaining tile operations on the same tiles). The output is hence
+    declared as aliasing the input, XLA copying the latter when still used afterwards.
+
     Args:
         array: The array to shard on the first axis.
-        tiles: A collection of tile IDs to shard the array on.
+        tiles: A collection of tile IDs ((ipu, tile) pairs supported) to shard the array on.
     Returns:
         The tile sharded array.
     """
     # TODO: support JAX pytrees.
+    tiles = make_global_tiles(tiles)
     return TileShardedArray(array=tile_put_sharded_prim(array, tiles), tiles=tiles)  # type:ignore
 
 
-def tile_put_replicated(array: DeviceArray, tiles: Sequence[int]) -> TileShardedArray:
+def tile_put_replicated(array: DeviceArray, tiles: Sequence[TileIndexLike]) -> TileShardedArray:
     """Replicate a JAX array over tiles on the first axis.
 
     Args:
         array: The array to replicate on tiles
-        tiles: A collection of tile IDs to shard the array on.
+        tiles: A collection of tile IDs ((ipu, tile) pairs supported) to shard the array on.
     Returns:
         The tile sharded array.
     """
     # TODO: support JAX pytrees.
+    tiles = make_global_tiles(tiles)
     return TileShardedArray(array=tile_put_replicated_prim(array, tiles), tiles=tiles)  # type:ignore
 
 
 def tile_data_barrier(*args: TileShardedArray) -> Tuple[TileShardedArray, ...]:
     """Tile sharded arrays data barrier: force aligning between tiles in the Poplar program.
 
+    Any mix of 8, 16 and 32 bits dtypes is supported, in a single barrier compute set.
+
     Args:
         *args: The input tile sharded arrays.
     Returns:
@@ -236,12 +296,16 @@ tile_barrier = tile_data_barrier
 
 
 def tile_gather(
-    arr: Union[DeviceArray, TileShardedArray], indices: Sequence[int], tiles: Sequence[int], copy: bool = False
+    arr: Union[DeviceArray, TileShardedArray],
+    indices: Sequence[int],
+    tiles: Sequence[TileIndexLike],
+    copy: bool = False,
 ) -> TileShardedArray:
     """Gather a JAX array over tiles on the first axis.
 
     By default, if a slice of an input sharded array is already located on the
-    proper tile, data will not be copied (no `Memcpy` vertex inserted).
+    proper tile, data will not be copied (no `Memcpy` vertex inserted). In a multi-IPU
+    graph, on-chip exchange and IPU-Link transfers are grouped in separate copies.
 
     Args:
         arr: An array. Can be generic, or already tile sharded.
@@ -252,6 +316,7 @@ def tile_gather(
         The array sharded over the IPU tiles.
     """
     assert len(indices) == len(tiles)
+    tiles = make_global_tiles(tiles)
     assert min(indices) >= 0
     assert max(indices) <= len(arr) - 1
     # Existing tile mapping? -1 by default when none.
@@ -267,7 +332,7 @@ def tile_gather(
     return TileShardedArray(array=gather_arr, tiles=tiles)  # type:ignore
 
 
-def tile_constant_replicated(data: ArrayLike, tiles: Sequence[int]) -> TileShardedArray:
+def tile_constant_replicated(data: ArrayLike, tiles: Sequence[TileIndexLike]) -> TileShardedArray:
     """Replicate a (constant) NumPy array over tiles on the first axis.
 
     Args:
@@ -277,11 +342,12 @@ def tile_constant_replicated(data: ArrayLike, tiles: Sequence[int]) -> TileShard
         `TileShardedArray` with constant data.
     """
     data = np.asarray(data)
+    tiles = make_global_tiles(tiles)
     arr = tile_constant_replicated_prim(data, tiles)
     return TileShardedArray(array=arr, tiles=tiles)  # type:ignore
 
 
-def tile_constant_sharded(data: ArrayLike, tiles: Sequence[int]) -> TileShardedArray:
+def tile_constant_sharded(data: ArrayLike, tiles: Sequence[TileIndexLike]) -> TileShardedArray:
     """Shard a (constant) NumPy array over tiles on the first axis.
 
     Args:
@@ -292,5 +358,27 @@ def tile_constant_sharded(data: ArrayLike, tiles: Sequence[int]) -> TileShardedA
     """
     data = np.asarray(data)
     assert data.shape[0] == len(tiles)
+    tiles = make_global_tiles(tiles)
     arr = tile_constant_sharded_prim(data, tiles)
     return TileShardedArray(array=arr, tiles=tiles)  # type:ignore
+
+
+def tile_contiguous_regions(arr: TileShardedArray) -> TileShardedArray:
+    """Number of contiguous memory regions of every tile slice of a tile sharded array.
+
+    A tile slice with a single contiguous region can be connected to IPU vertices
+    without any on-tile rearrangement (i.e. no additional copy inserted by Poplar).
+    The value is 0 when some data is not mapped on the expected tile.
+
+    NOTE: the layout is only known at Poplar graph construction, i.e. the query is only
+    meaningful when jitted on the IPU backend (always a single region otherwise).
+
+    Args:
+        arr: The tile sharded array to query.
+    Returns:
+        `TileShardedArray` of shape (T,) with the number of regions per tile.
+    """
+    assert isinstance(arr, TileShardedArray)
+    num_regions = tile_contiguous_regions_prim(arr.array, arr.tiles)
+    return TileShardedArray(array=num_regions, tiles=arr.tiles)  # type:ignore
+
@@ -1,10 +1,11 @@
 # Copyright (c) 2022 Graphcore Ltd. All rights reserved.
 import base64
+import itertools
 import json
 import os
+import weakref
 from typing import Any, Dict, Sequence, Tuple, Union
 
-import cppimport
 import jax.lax
 import jax.numpy as jnp
 import numpy as np
@@ -16,12 +17,14 @@ from jax.ipu.primitive import ipu_mlir_lowering_custom_primitive
 
 from jax_ipu_experimental_addons.utils import DTypeLike, NDArray
 
-from .tile_common_utils import make_ipu_shaped_array
+from .tile_codelet_cache import get_cached_codelet_filename
+from .tile_common_utils import make_ipu_shaped_array, use_binary_attributes
+from .tile_native_modules import import_native_module
 
-# Pybind11 extension import (and compilation if necessary).
+# Pybind11 extension import (prebuilt, or JIT compiled if necessary).
 # Explicit path is more robust to different `pip install` usages.
 ext_filename = os.path.abspath(os.path.join(os.path.dirname(__file__), "tile_array_primitives_impl.cpp"))
-tile_array_primitives_impl = cppimport.imp_from_filepath(
+tile_array_primitives_impl = import_native_module(
     ext_filename, "jax_ipu_experimental_addons.tile.tile_array_primitives_impl"
 )
 
@@ -32,20 +35,52 @@ from .tile_array_primitives_impl import (  # noqa: E402, F401
     TileConstantParams,
     TileConstantReplicatedPrimitive,
     TileConstantShardedPrimitive,
+    TileContiguousRegionsPrimitive,
     TileDataBarrierParams,
     TileDataBarrierPrimitive,
     TileGatherParams,
     TileGatherPrimitive,
     TilePutReplicatedPrimitive,
     TilePutShardedPrimitive,
+    tile_constant_pool_clear,
+    tile_constant_pool_new_lowering,
+    tile_constant_pool_stats,
 )
 
+_tile_constant_pool_module_ref: Any = None
+"""Last lowered MLIR module context, using the tile constant pool."""
+_tile_constant_pool_id: int = 0
+"""Tile constant pool id of the last lowered MLIR module."""
+_tile_constant_pool_id_counter = itertools.count(1)
+
+
+def tile_constant_pool_lowering_begin(ctx: LoweringRuleContext) -> int:
+    """Start a new tile constant pool lowering when lowering a new MLIR module.
+
+    Every lowered module gets a unique pool id, passed in the primitive attributes: the
+    C++ pools are keyed on (Poplar graph, pool id), hence no tensor can be re-used from
+    another module's graph, even if a new graph is allocated at the same address.
+    Clearing previous pools only releases memory.
+
+    Returns:
+        Tile constant pool id of the module.
+    """
+    global _tile_constant_pool_module_ref, _tile_constant_pool_id
+    module_ctx = ctx.module_context
+    if _tile_constant_pool_module_ref is None or _tile_constant_pool_module_ref() is not module_ctx:
+        tile_constant_pool_new_lowering()
+        _tile_constant_pool_module_ref = weakref.ref(module_ctx)
+        _tile_constant_pool_id = next(_tile_constant_pool_id_counter)
+    return _tile_constant_pool_id
+
+
 tile_put_sharded_prim_p = core.Primitive("tile_put_sharded")
 tile_put_replicated_prim_p = core.Primitive("tile_put_replicated")
 tile_gather_prim_p = core.Primitive("tile_gather")
 tile_data_barrier_prim_p = core.Primitive("tile_data_barrier")
 tile_constant_replicated_prim_p = core.Primitive("tile_constant_replicated")
 tile_constant_sharded_prim_p = core.Primitive("tile_constant_sharded")
+tile_contiguous_regions_prim_p = core.Primitive("tile_contiguous_regions")
 
 default_backends = ["cpu", "cuda", "tpu", "rocm"]
 
@@ -212,6 +247,7 @@ def tile_data_barrier_prim_mlir_lowering_default(ctx, *args, **params):
 
 
 _tile_barrier_dtype_mapping: Dict[DTypeLike, DTypeLike] = {
+    np.dtype(np.bool_): np.dtype(np.uint8),
     np.dtype(np.int8): np.dtype(np.uint8),
     np.dtype(np.uint8): np.dtype(np.uint8),
     np.dtype(np.int16): np.dtype(np.uint16),
@@ -241,21 +277,27 @@ def tile_data_barrier_prim_mlir_lowering_ipu(
     inputs_aval = ctx.avals_in
     dtypes = list({aval.dtype for aval in inputs_aval})
     dtypes_size = {dt.itemsize for dt in dtypes}
-    if len(dtypes_size) > 1:
-        raise TypeError(f"Only supporting dtypes of same size in Tile data barrier: {dtypes}.")
+    if not dtypes_size <= {1, 2, 4}:
+        raise TypeError(f"Only supporting 8, 16 and 32 bits dtypes in Tile data barrier: {dtypes}.")
 
     inputs_tiles = params["inputs_tiles"]
     max_tile = max([max(s) for s in inputs_tiles])
     # Is half type accurate on IPU? IPU model is simulating float.
     # TODO: have specific property in IPU device.
     is_half_accurate = not jax.devices("ipu")[0].is_ipu_model
+    # Mixed reference dtypes => multi-dtypes barrier vertex (8, 16, FP16 and 32 bits fields).
+    refdtypes = list({tile_data_barrier_refdtype(dt, is_half_accurate) for dt in dtypes})
+    multi_dtypes = len(refdtypes) > 1
     # Passing the tiles collections as a raw attributes to the C++ implementation.
-    refdtype = tile_data_barrier_refdtype(dtypes[0], is_half_accurate)
-    vname = make_ipu_vertex_name_templated("TileDataBarrierVertex", refdtype)
-    barrier_params = TileDataBarrierParams(vname, inputs_tiles, max_tile)
+    if multi_dtypes:
+        vname = "TileDataBarrierMultiVertex"
+    else:
+        vname = make_ipu_vertex_name_templated("TileDataBarrierVertex", refdtypes[0])
+    barrier_params = TileDataBarrierParams(vname, inputs_tiles, max_tile, multi_dtypes)
     raw_attributes = barrier_params.to_json_str()
 
     gp_filename = os.path.abspath(os.path.join(os.path.dirname(__file__), "vertex", "tile_prim_vertex.cpp"))
+    gp_filename = get_cached_codelet_filename(gp_filename)
     outputs = ipu_mlir_lowering_custom_primitive(
         TileDataBarrierPrimitive,
         ctx,
@@ -277,6 +319,13 @@ mlir.register_lowering(tile_data_barrier_prim_p, tile_data_barrier_prim_mlir_low
 mlir.register_lowering(tile_data_barrier_prim_p, tile_data_barrier_prim_mlir_lowering_default)
 
 
+def encode_constant_params(params: TileConstantParams) -> Union[str, bytes]:
+    """Encode tile constant parameters as custom primitive attributes (JSON or binary MessagePack)."""
+    if use_binary_attributes():
+        return params.to_msgpack_bytes()
+    return params.to_json_str()
+
+
 def tile_constant_replicated_prim(data, tiles):
     # Dummy empty variable to circumvent a bug in XLA custom op (when zero inputs).
     dummy = jnp.empty((), np.float32)
@@ -310,14 +359,16 @@ def tile_constant_replicated_prim_mlir_lowering_ipu(
     ctx: LoweringRuleContext, dummy: ir.Value, data: NDArray[Any], tiles: Any
 ) -> Sequence[ir.Value]:
     """`tile_constant_replicated_prim` IPU backend MLIR lowering, as a custom primitive."""
+    pool_id = tile_constant_pool_lowering_begin(ctx)
     params = TileConstantParams(
         aval=make_ipu_shaped_array(data.shape, data.dtype),
         tiles=tiles,
         data=Base64Data(base64.b64encode(data)),  # type:ignore
+        pool_id=pool_id,
     )
     # TODO: remove `dummy` when bug with zero inputs fixed.
     outputs = ipu_mlir_lowering_custom_primitive(
-        TileConstantReplicatedPrimitive, ctx, [dummy], opaque_attributes=params.to_json_str()
+        TileConstantReplicatedPrimitive, ctx, [dummy], opaque_attributes=encode_constant_params(params)
     )
     return outputs
 
@@ -360,14 +411,16 @@ def tile_constant_sharded_prim_mlir_lowering_ipu(
     ctx: LoweringRuleContext, dummy: ir.Value, data: NDArray[Any], tiles: Any
 ) -> Sequence[ir.Value]:
     """`tile_constant_sharded_prim` IPU backend MLIR lowering, as a custom primitive."""
+    pool_id = tile_constant_pool_lowering_begin(ctx)
     params = TileConstantParams(
         aval=make_ipu_shaped_array(data.shape, data.dtype),
         tiles=tiles,
         data=Base64Data(base64.b64encode(data)),  # type:ignore
+        pool_id=pool_id,
     )
     # TODO: remove `dummy` when bug with zero inputs fixed.
     outputs = ipu_mlir_lowering_custom_primitive(
-        TileConstantShardedPrimitive, ctx, [dummy], opaque_attributes=params.to_json_str()
+        TileConstantShardedPrimitive, ctx, [dummy], opaque_attributes=encode_constant_params(params)
     )
     return outputs
 
@@ -379,3 +432,45 @@ tile_constant_sharded_prim_p.def_abstract_eval(tile_constant_sharded_prim_abstra
 mlir.register_lowering(tile_constant_sharded_prim_p, tile_constant_sharded_prim_mlir_lowering_ipu, platform="ipu")
 # Register MLIR translation for other backends.
 mlir.register_lowering(tile_constant_sharded_prim_p, tile_constant_sharded_prim_mlir_translation_default)
+
+
+def tile_contiguous_regions_prim(x, tiles):
+    return tile_contiguous_regions_prim_p.bind(x, tiles=tiles)
+
+
+def tile_contiguous_regions_prim_impl(x, tiles):
+    # Single region per tile when not jitted.
+    assert x.shape[0] == len(tiles)
+    return np.ones((len(tiles),), dtype=np.int32)
+
+
+def tile_contiguous_regions_prim_abstract_eval(xs, tiles) -> ShapedArray:
+    assert xs.shape[0] == len(tiles)
+    return ShapedArray((len(tiles),), np.int32)
+
+
+def tile_contiguous_regions_prim_mlir_translation_default(
+    ctx: LoweringRuleContext, xc: ir.Value, tiles: Any
+) -> Sequence[ir.Value]:
+    """`tile_contiguous_regions_prim` default MLIR translation, for CPU/GPU backends: single region constant."""
+    data = np.ones((len(tiles),), dtype=np.int32)
+    return mlir._ndarray_constant_handler(data, canonicalize_types=False)
+
+
+def tile_contiguous_regions_prim_mlir_lowering_ipu(
+    ctx: LoweringRuleContext, xc: ir.Value, tiles: Any
+) -> Sequence[ir.Value]:
+    """`tile_contiguous_regions_prim` IPU backend MLIR lowering, as a custom primitive."""
+    raw_attributes = make_tiles_raw_attributes(tiles)
+    outputs = ipu_mlir_lowering_custom_primitive(
+        TileContiguousRegionsPrimitive, ctx, [xc], opaque_attributes=raw_attributes
+    )
+    return outputs
+
+
+tile_contiguous_regions_prim_p.def_impl(tile_contiguous_regions_prim_impl)
+tile_contiguous_regions_prim_p.def_abstract_eval(tile_contiguous_regions_prim_abstract_eval)
+# Register specific MLIR lowering for IPU.
+mlir.register_lowering(tile_contiguous_regions_prim_p, tile_contiguous_regions_prim_mlir_lowering_ipu, platform="ipu")
+# Register MLIR translation for other backends.
+mlir.register_lowering(tile_contiguous_regions_prim_p, tile_contiguous_regions_prim_mlir_translation_default)
@@ -5,8 +5,12 @@
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 
+#include <algorithm>
+#include <array>
 #include <ipu_custom_primitive.hpp>
 #include <json/json.hpp>
+#include <map>
+#include <optional>
 
 #include "tile_array_utils.hpp"
 
@@ -16,6 +20,35 @@ using namespace ipu;
 using TileIndexType = int32_t;
 using TileArrayType = std::vector<TileIndexType>;
 
+/**
+ * @brief Check a collection of (global) tiles is valid in a (multi-IPU) graph,
+ * i.e. every tile index < numIPUs * tilesPerIPU.
+ */
+inline void checkGraphTiles(const poplar::Graph& graph,
+                            const TileArrayType& tiles,
+                            const std::string& prim_name) {
+  const auto& target = graph.getTarget();
+  for (const auto& tile : tiles) {
+    if (tile < 0 || static_cast<std::size_t>(tile) >= target.getNumTiles()) {
+      throw poputil::poplibs_error(fmt::format(
+          "IPU {}: invalid tile {}, in a graph of {} IPU(s) with {} tiles.",
+          prim_name, tile, target.getNumIPUs(), target.getTilesPerIPU()));
+    }
+  }
+}
+
+/**
+ * @brief Set the tile sharded copy statistics in a primitive debug info.
+ */
+inline void setTileShardedCopyDebugInfo(poplar::DebugInfo& debug_info,
+                                        const TileShardedCopyStats& stats) {
+  debug_info.setValue("num_slices", std::uint64_t(stats.num_slices));
+  debug_info.setValue("num_exchange_slices",
+                      std::uint64_t(stats.num_exchange_slices));
+  debug_info.setValue("num_ipu_link_slices",
+                      std::uint64_t(stats.num_ipu_link_slices));
+}
+
 /**
  * @brief Base class for tile put primitives, with common features.
  */
@@ -37,12 +70,18 @@ class TilePutBase : public jax::ipu::PrimitiveInterface {
 class TilePutShardedPrimitive : public TilePutBase {
  public:
   static jax::ipu::PrimitiveMetadata metadata(std::uint32_t num_inputs) {
-    return jax::ipu::PrimitiveMetadata{.num_inputs = num_inputs,
-                                       .is_elementwise = true,
-                                       .is_stateless = true,
-                                       .is_hashable = true,
-                                       .input_to_output_tensor_aliasing = {{}},
-                                       .allocating_indices = {}};
+    // Slices already on their tile are forwarded (no copy): the output may
+    // share the input storage, hence always declared as aliasing the input
+    // (XLA then copies the input first if still used, e.g. by an in-place
+    // tile map on the output).
+    const std::map<std::int64_t, std::int64_t> aliasing = {{0, 0}};
+    return jax::ipu::PrimitiveMetadata{
+        .num_inputs = num_inputs,
+        .is_elementwise = true,
+        .is_stateless = true,
+        .is_hashable = true,
+        .input_to_output_tensor_aliasing = aliasing,
+        .allocating_indices = {}};
   }
 
   static poplar::program::Program program(
@@ -66,14 +105,25 @@ class TilePutShardedPrimitive : public TilePutBase {
                       input.shape()[0], tile_array.size()));
     }
 
-    // Create output tensor, with proper tile mapping.
-    // TODO: link to Slack discussion on VarRegion contiguity.
-    auto output = createShardedVariable(graph, input.elementType(),
-                                        input[0].shape(), tile_array);
-    // Copy data tensor into the output.
-    auto prog = poplar::program::Copy(input, output);
+    checkGraphTiles(graph, tile_array, "tile put sharded");
+
+    // Only copying the input slices not already mapped on their tile (e.g.
+    // chaining tile ops), on-chip and IPU-Link transfers planned separately.
+    std::vector<poplar::Tensor> slices;
+    slices.reserve(tile_array.size());
+    for (std::size_t idx = 0; idx < tile_array.size(); ++idx) {
+      slices.push_back(input[idx]);
+    }
+    poplar::DebugInfo debug_info(debugContext, "tile_put_sharded");
+    const poplar::DebugContext copy_debug_context(debug_info);
+    TileShardedCopyStats stats;
+    auto seq = poplar::program::Sequence();
+    auto output = tileShardedCopy(graph, slices, tile_array, seq,
+                                  copy_debug_context, &stats);
+    // Debug info: copy decision, i.e. number of slices copied.
+    setTileShardedCopyDebugInfo(debug_info, stats);
     outputs.push_back(output);
-    return prog;
+    return seq;
   }
 };
 
@@ -106,6 +156,7 @@ class TilePutReplicatedPrimitive : public TilePutBase {
     auto input = inputs[0];
 
     const auto tile_array = extractTileArray(attributes);
+    checkGraphTiles(graph, tile_array, "tile put replicated");
     // Create output tensor, with proper tile mapping.
     auto input_broadcasted = input.expand({0}).broadcast(tile_array.size(), 0);
     auto output = createShardedVariable(graph, input.elementType(),
@@ -155,32 +206,48 @@ class TileGatherPrimitive : public jax::ipu::PrimitiveInterface {
           "IPU tile gather expecting a single input tensor.");
     }
     const auto& input = inputs[0];
-    const auto item_shape = input[0].shape();
-    const auto item_type = input.elementType();
 
     // Tile gather parameters.
     const auto params = ipu::from_json_str<TileGatherParams>(attributes);
-    // Create the output tensor per gather index, then concat.
+    checkGraphTiles(graph, params.tiles, "tile gather");
+    // Moved items grouped per transfer kind (on-chip exchange or IPU-Link),
+    // with a single sharded variable and copy each.
+    std::vector<poplar::Tensor> slices;
+    std::vector<TileIndexType> slices_tiles;
+    TileShardedCopyStats stats;
     auto seq = poplar::program::Sequence();
-    std::vector<poplar::Tensor> output_slices;
+    std::vector<poplar::Tensor> output_slices(params.tiles.size());
+    std::vector<bool> moved(params.tiles.size(), false);
     for (std::size_t idx = 0; idx < params.tiles.size(); ++idx) {
       const auto gather_idx = params.indices[idx];
-      // Get the proper item at the gather index.
-      const auto input_item = input[gather_idx];
       const auto input_tile = params.previous_tiles[gather_idx];
       const auto output_tile = params.tiles[idx];
-      if (input_tile == output_tile) {
-        // No copy => using directly the existing data on the tile.
-        output_slices.push_back(input_item.expand({0}));
+      if (input_tile != output_tile) {
+        moved[idx] = true;
+        slices.push_back(input[gather_idx]);
+        slices_tiles.push_back(output_tile);
       } else {
-        // New Poplar tensor + copy to the proper tile.
-        auto output_item =
-            graph.addVariable(item_type, item_shape, debug_context);
-        graph.setTileMapping(output_item, output_tile);
-        seq.add(poplar::program::Copy(input_item, output_item));
-        output_slices.push_back(output_item.expand({0}));
+        // No copy => using directly the existing data on the tile.
+        output_slices[idx] = input[gather_idx].expand({0});
+      }
+    }
+    poplar::DebugInfo debug_info(debug_context, "tile_gather");
+    if (!slices.empty()) {
+      const poplar::DebugContext copy_debug_context(debug_info);
+      // Tile mapping of moved items not checked: forcing the copy.
+      auto moved_output = tileShardedCopy(graph, slices, slices_tiles, seq,
+                                          copy_debug_context, &stats, true);
+      std::size_t moved_idx = 0;
+      for (std::size_t idx = 0; idx < params.tiles.size(); ++idx) {
+        if (!moved[idx]) {
+          continue;
+        }
+        output_slices[idx] = moved_output[moved_idx].expand({0});
+        moved_idx++;
       }
     }
+    stats.num_slices = params.tiles.size();
+    setTileShardedCopyDebugInfo(debug_info, stats);
     auto output = poplar::concat(output_slices);
     outputs.push_back(output);
     return seq;
@@ -197,9 +264,11 @@ struct TileDataBarrierParams {
   std::vector<TileArrayType> inputs_tiles;
   /** Max tile index used by inputs. */
   TileIndexType max_tile;
+  /** Multi-dtypes barrier vertex, with tensors grouped per dtype size. */
+  bool multi_dtypes = false;
 };
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TileDataBarrierParams, vname, inputs_tiles,
-                                   max_tile)
+                                   max_tile, multi_dtypes)
 
 /**
  * @brief Reinterpret tensor to a reference type used in the tile data barrier.
@@ -218,6 +287,8 @@ poplar::Tensor tileBarrierReinterpretTensor(const poplar::Tensor& t,
     return t.reinterpret(poplar::UNSIGNED_CHAR);
   else if (t.elementType() == poplar::UNSIGNED_CHAR)
     return t.reinterpret(poplar::UNSIGNED_CHAR);
+  else if (t.elementType() == poplar::QUARTER)
+    return t.reinterpret(poplar::UNSIGNED_CHAR);
   // 16 bits data types.
   else if (t.elementType() == poplar::SHORT)
     return t.reinterpret(poplar::UNSIGNED_SHORT);
@@ -244,6 +315,21 @@ poplar::Tensor tileBarrierReinterpretTensor(const poplar::Tensor& t,
   throw std::runtime_error("Unknown Poplar tensor type in tile data barrier.");
 }
 
+/**
+ * @brief Multi-dtypes barrier vertex field of a (reinterpreted) tensor type.
+ */
+std::size_t tileBarrierMultiFieldIndex(const poplar::Type& type) {
+  if (type == poplar::UNSIGNED_CHAR)
+    return 0;
+  else if (type == poplar::UNSIGNED_SHORT)
+    return 1;
+  else if (type == poplar::HALF)
+    return 2;
+  else if (type == poplar::UNSIGNED_INT)
+    return 3;
+  throw std::runtime_error("Unknown Poplar tensor type in tile data barrier.");
+}
+
 /**
  * @brief IPU tile array data barrier: force to introduce a barrier in Poplar
  * with a single compute set across tiles.
@@ -251,13 +337,17 @@ poplar::Tensor tileBarrierReinterpretTensor(const poplar::Tensor& t,
 class TileDataBarrierPrimitive : public jax::ipu::PrimitiveInterface {
  public:
   static jax::ipu::PrimitiveMetadata metadata(std::uint32_t num_inputs) {
-    // TODO: input/output aliasing.
+    // Barrier outputs are the input tensors: full in-place aliasing.
+    std::map<std::int64_t, std::int64_t> aliasing;
+    for (std::uint32_t idx = 0; idx < num_inputs; ++idx) {
+      aliasing[idx] = idx;
+    }
     return jax::ipu::PrimitiveMetadata{
         .num_inputs = num_inputs,
         .is_elementwise = false,  // Broadcasting over the first axis.
         .is_stateless = true,
         .is_hashable = true,
-        .input_to_output_tensor_aliasing = {{}},
+        .input_to_output_tensor_aliasing = aliasing,
         .allocating_indices = {}};
   }
 
@@ -277,17 +367,26 @@ class TileDataBarrierPrimitive : public jax::ipu::PrimitiveInterface {
     // Tile barrier parameters (with tile sharding).
     const auto params = ipu::from_json_str<TileDataBarrierParams>(attributes);
 
-    // Association of barrier tensors per tile.
-    std::vector<std::vector<poplar::Tensor>> tensors_per_tiles(params.max_tile +
-                                                               1);
+    // Association of barrier tensors per tile (and per vertex field).
+    static constexpr std::array<const char*, 4> multi_fields = {
+        "data8", "data16", "data16f", "data32"};
+    const std::size_t num_fields = params.multi_dtypes ? multi_fields.size() : 1;
+    std::vector<std::vector<std::vector<poplar::Tensor>>> tensors_per_tiles(
+        params.max_tile + 1,
+        std::vector<std::vector<poplar::Tensor>>(num_fields));
     for (size_t idx = 0; idx < inputs.size(); ++idx) {
       // Reinterpret input tensor to a reference type.
       const auto& in_reinterpret =
           tileBarrierReinterpretTensor(inputs[idx], is_half_accurate);
+      const std::size_t field_idx =
+          params.multi_dtypes
+              ? tileBarrierMultiFieldIndex(in_reinterpret.elementType())
+              : 0;
       const auto& tiles = params.inputs_tiles[idx];
       for (size_t k = 0; k < tiles.size(); ++k) {
         // Flatten the tensor on every tile to 1D.
-        tensors_per_tiles[tiles[k]].push_back(in_reinterpret[k].flatten());
+        tensors_per_tiles[tiles[k]][field_idx].push_back(
+            in_reinterpret[k].flatten());
       }
     }
 
@@ -296,15 +395,24 @@ class TileDataBarrierPrimitive : public jax::ipu::PrimitiveInterface {
     for (TileIndexType tile = 0; tile < TileIndexType(tensors_per_tiles.size());
          ++tile) {
       const auto& tensors = tensors_per_tiles[tile];
-      if (tensors.size() == 0) {
+      const bool is_empty = std::all_of(
+          tensors.begin(), tensors.end(),
+          [](const std::vector<poplar::Tensor>& v) { return v.empty(); });
+      if (is_empty) {
         continue;
       }
       // Add barrier vertex on the tile.
       auto v = graph.addVertex(cs, params.vname);
       graph.setTileMapping(v, tile);
       graph.setPerfEstimate(v, 14);
-      // Map collection of tensors to vertex IO.
-      graph.connect(v["data"], tensors);
+      // Map collection of tensors to vertex IO (all fields in multi-dtypes).
+      if (params.multi_dtypes) {
+        for (std::size_t f = 0; f < multi_fields.size(); ++f) {
+          graph.connect(v[multi_fields[f]], tensors[f]);
+        }
+      } else {
+        graph.connect(v["data"], tensors[0]);
+      }
     }
     prog.add(poplar::program::Execute(cs, debug_context));
     outputs = inputs;
@@ -322,8 +430,11 @@ struct TileConstantParams {
   TileArrayType tiles;
   /** Raw data, encoded as base64. */
   Base64Data data = Base64Data();
+  /** Constant pool id (no pooling by default). */
+  TileConstantPool::PoolId pool_id = TileConstantPool::kNoPool;
 };
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TileConstantParams, aval, tiles, data)
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TileConstantParams, aval, tiles, data,
+                                   pool_id)
 
 /**
  * @brief IPU tile constant replicated primitive: replicating a constant array
@@ -345,13 +456,13 @@ class TileConstantReplicatedPrimitive : public jax::ipu::PrimitiveInterface {
       std::vector<poplar::Tensor>& outputs, const std::string& attributes,
       const std::string& debug_prefix) {
     const auto debug_context = poplar::DebugContext(debug_prefix);
-    const auto params = ipu::from_json_str<TileConstantParams>(attributes);
-    const std::string raw_values = params.data.decode();
-    const auto raw_values_ref =
-        poplar::ArrayRef<char>(raw_values.data(), raw_values.size());
-    auto t = createReplicatedConstantTensor(graph, params.aval.dtype,
-                                            params.aval.shape, raw_values_ref,
-                                            params.tiles, debug_context);
+    const auto params =
+        ipu::from_attributes_str<TileConstantParams>(attributes);
+    std::string raw_buffer;
+    const auto raw_values_ref = params.data.decodeRef(raw_buffer);
+    auto t = createReplicatedConstantTensor(
+        graph, params.aval.dtype, params.aval.shape, raw_values_ref,
+        params.tiles, debug_context, params.pool_id);
     outputs.push_back(t);
     return poplar::program::Sequence();
   }
@@ -377,13 +488,53 @@ class TileConstantShardedPrimitive : public jax::ipu::PrimitiveInterface {
       std::vector<poplar::Tensor>& outputs, const std::string& attributes,
       const std::string& debug_prefix) {
     const auto debug_context = poplar::DebugContext(debug_prefix);
-    const auto params = ipu::from_json_str<TileConstantParams>(attributes);
-    const std::string raw_values = params.data.decode();
-    const auto raw_values_ref =
-        poplar::ArrayRef<char>(raw_values.data(), raw_values.size());
-    auto t = createShardedConstantTensor(graph, params.aval.dtype,
-                                         params.aval.shape, raw_values_ref,
-                                         params.tiles, debug_context);
+    const auto params =
+        ipu::from_attributes_str<TileConstantParams>(attributes);
+    std::string raw_buffer;
+    const auto raw_values_ref = params.data.decodeRef(raw_buffer);
+    auto t = createShardedConstantTensor(
+        graph, params.aval.dtype, params.aval.shape, raw_values_ref,
+        params.tiles, debug_context, params.pool_id);
+    outputs.push_back(t);
+    return poplar::program::Sequence();
+  }
+};
+
+/**
+ * @brief IPU tile contiguous regions primitive: number of contiguous memory
+ * regions of every tile slice of a sharded array (as a sharded constant).
+ */
+class TileContiguousRegionsPrimitive : public TilePutBase {
+ public:
+  static jax::ipu::PrimitiveMetadata metadata(std::uint32_t num_inputs) {
+    return jax::ipu::PrimitiveMetadata{.num_inputs = num_inputs,
+                                       .is_elementwise = false,
+                                       .is_stateless = true,
+                                       .is_hashable = true,
+                                       .input_to_output_tensor_aliasing = {{}},
+                                       .allocating_indices = {}};
+  }
+
+  static poplar::program::Program program(
+      poplar::Graph& graph, const std::vector<poplar::Tensor>& inputs,
+      std::vector<poplar::Tensor>& outputs, const std::string& attributes,
+      const std::string& debug_prefix) {
+    const auto debug_context = poplar::DebugContext(debug_prefix);
+    if (inputs.size() != 1) {
+      throw poputil::poplibs_error(
+          "IPU tile contiguous regions expecting a single input tensor.");
+    }
+    const auto tile_array = extractTileArray(attributes);
+    const auto num_regions =
+        tileShardedNumContiguousRegions(graph, inputs[0], tile_array);
+    static_assert(sizeof(std::int32_t) == 4);
+    const auto raw_values_ref = poplar::ArrayRef<char>(
+        reinterpret_cast<const char*>(num_regions.data()),
+        num_regions.size() * sizeof(std::int32_t));
+    const std::vector<std::size_t> shape = {tile_array.size()};
+    auto t = createShardedConstantTensor(graph, IpuType::INT, shape,
+                                         raw_values_ref, tile_array,
+                                         debug_context);
     outputs.push_back(t);
     return poplar::program::Sequence();
   }
@@ -396,6 +547,7 @@ EXPORT_IPU_JAX_PRIMITIVE(TileGatherPrimitive);
 EXPORT_IPU_JAX_PRIMITIVE(TileDataBarrierPrimitive);
 EXPORT_IPU_JAX_PRIMITIVE(TileConstantReplicatedPrimitive);
 EXPORT_IPU_JAX_PRIMITIVE(TileConstantShardedPrimitive);
+EXPORT_IPU_JAX_PRIMITIVE(TileContiguousRegionsPrimitive);
 
 // Declare a pybind11, to provide easy compilation & import from Python.
 PYBIND11_MODULE(tile_array_primitives_impl, m) {
@@ -403,6 +555,7 @@ PYBIND11_MODULE(tile_array_primitives_impl, m) {
   makeIpuTypeBindings(m);
   makeShapeArrayBindings(m);
   makeBase64DataBindings(m);
+  makeWorkerOffsetsBindings(m);
 
   pybind11::class_<TileGatherParams>(m, "TileGatherParams")
       .def(pybind11::init<>())
@@ -423,9 +576,9 @@ PYBIND11_MODULE(tile_array_primitives_impl, m) {
   pybind11::class_<TileDataBarrierParams>(m, "TileDataBarrierParams")
       .def(pybind11::init<>())
       .def(pybind11::init<const std::string&, const std::vector<TileArrayType>&,
-                          TileIndexType>(),
+                          TileIndexType, bool>(),
            pybind11::arg("vname"), pybind11::arg("inputs_tiles"),
-           pybind11::arg("max_tile"))
+           pybind11::arg("max_tile"), pybind11::arg("multi_dtypes") = false)
       .def("to_json_str",
            [](const TileDataBarrierParams& v) { return to_json_str(v); })
       .def_static("from_json_str",
@@ -434,22 +587,33 @@ PYBIND11_MODULE(tile_array_primitives_impl, m) {
                   })
       .def_readwrite("vname", &TileDataBarrierParams::vname)
       .def_readwrite("inputs_tiles", &TileDataBarrierParams::inputs_tiles)
-      .def_readwrite("max_tile", &TileDataBarrierParams::max_tile);
+      .def_readwrite("max_tile", &TileDataBarrierParams::max_tile)
+      .def_readwrite("multi_dtypes", &TileDataBarrierParams::multi_dtypes);
 
   pybind11::class_<TileConstantParams>(m, "TileConstantParams")
       .def(pybind11::init<>())
       .def(pybind11::init<const ShapedArray&, const TileArrayType&,
-                          const Base64Data&>(),
-           pybind11::arg("aval"), pybind11::arg("tiles"), pybind11::arg("data"))
+                          const Base64Data&, TileConstantPool::PoolId>(),
+           pybind11::arg("aval"), pybind11::arg("tiles"), pybind11::arg("data"),
+           pybind11::arg("pool_id") = TileConstantPool::kNoPool)
       .def("to_json_str",
            [](const TileConstantParams& v) { return to_json_str(v); })
       .def_static("from_json_str",
                   [](const std::string& j) {
                     return from_json_str<TileConstantParams>(j);
                   })
+      .def("to_msgpack_bytes",
+           [](const TileConstantParams& v) {
+             return pybind11::bytes(to_msgpack_str(v));
+           })
+      .def_static("from_msgpack_bytes",
+                  [](const pybind11::bytes& b) {
+                    return from_msgpack_str<TileConstantParams>(std::string(b));
+                  })
       .def_readwrite("aval", &TileConstantParams::aval)
       .def_readwrite("tiles", &TileConstantParams::tiles)
-      .def_readwrite("data", &TileConstantParams::data);
+      .def_readwrite("data", &TileConstantParams::data)
+      .def_readwrite("pool_id", &TileConstantParams::pool_id);
 
   pybind11::class_<TilePutShardedPrimitive>(m, "TilePutShardedPrimitive")
       .def_static("metadata", &TilePutShardedPrimitive::metadata,
@@ -471,13 +635,19 @@ PYBIND11_MODULE(tile_array_primitives_impl, m) {
                                                  "TileConstantShardedPrimitive")
       .def_static("metadata", &TileConstantShardedPrimitive::metadata,
                   pybind11::arg("num_inputs"));
+  pybind11::class_<TileContiguousRegionsPrimitive>(
+      m, "TileContiguousRegionsPrimitive")
+      .def_static("metadata", &TileContiguousRegionsPrimitive::metadata,
+                  pybind11::arg("num_inputs"));
+  // Graph constant pool report.
+  makeTileConstantPoolBindings(m);
 }
 
 // cppimport configuration for compiling the pybind11 module.
 // clang-format off
 /*
 <%
-cfg['extra_compile_args'] = ['-std=c++17', '-fPIC', '-O2', '-Wall', '-mavx2']
+cfg['extra_compile_args'] = ['-std=c++17', '-fPIC', '-O2', '-Wall']
 cfg['libraries'] = ['poplar', 'poputil']
 cfg['include_dirs'] = []
 cfg['sources'] = [
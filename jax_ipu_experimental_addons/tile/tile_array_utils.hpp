@@ -2,6 +2,15 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <utility>
 
 #include "common.hpp"
 
@@ -46,28 +55,240 @@ poplar::ArrayRef<T> arraySlice(poplar::ArrayRef<T> arr, std::size_t start,
   return poplar::ArrayRef<T>(arr.data() + start, size);
 }
 
+/**
+ * @brief Default alignment (in bytes) of tile contiguous regions, consistent
+ * with the 8-byte `VectorLayout` alignment used by vertices.
+ */
+constexpr std::size_t kTileRegionAlignment = 8;
+
+/**
+ * @brief Unsigned Poplar type of a given size (in bytes), used for aligned
+ * tile region allocation.
+ */
+inline poplar::Type alignedStorageType(std::size_t alignment) {
+  switch (alignment) {
+    case 1:
+      return poplar::UNSIGNED_CHAR;
+    case 2:
+      return poplar::UNSIGNED_SHORT;
+    case 4:
+      return poplar::UNSIGNED_INT;
+    case 8:
+      return poplar::UNSIGNED_LONGLONG;
+  }
+  throw poputil::poplibs_error("Unsupported tile region alignment: " +
+                               std::to_string(alignment) + " bytes.");
+}
+
 /**
  * @brief Create a tensor/variable sharded over IPU tiles
  *
+ * By default, a single Poplar variable is created and sharded on tiles. With a
+ * non-zero `alignment`, every tile slice is allocated as a separate variable
+ * of an `alignment` bytes element type (reinterpreted as `type`), meaning the
+ * tile region start address and size are both multiples of `alignment`, and
+ * can be safely read with aligned vector loads.
+ *
  * @param graph Poplar graph.
  * @param type Datatype of the tensor.
  * @param shape Tensor shape on every tile.
  * @param tiles Tiles on which to shard the tensor/variable.
  * @param debugContext Optional debug context.
+ * @param alignment Optional tile region alignment (in bytes, up to 8).
  * @return Allocated variable/tensor of shape (T, *shape)
  */
 inline poplar::Tensor createShardedVariable(
     poplar::Graph& graph, const poplar::Type& type,
     poplar::ArrayRef<std::size_t> shape, poplar::ArrayRef<TileIndexType> tiles,
-    const poplar::DebugContext& debug_context = {}) {
+    const poplar::DebugContext& debug_context = {},
+    std::size_t alignment = 0) {
   // Full shape of the sharded tensor.
   const auto sharded_shape = shapePrependAxis(tiles.size(), shape);
-  // Create Poplar variable + map on tiles.
-  auto t = graph.addVariable(type, sharded_shape, debug_context);
+  if (alignment == 0) {
+    // Create Poplar variable + map on tiles.
+    auto t = graph.addVariable(type, sharded_shape, debug_context);
+    for (size_t idx = 0; idx < tiles.size(); ++idx) {
+      graph.setTileMapping(t[idx], tiles[idx]);
+    }
+    return t;
+  }
+  // Alignment at least the type size, so that the region can be reinterpreted.
+  const std::size_t type_size = graph.getTarget().getTypeSize(type);
+  alignment = std::max(alignment, type_size);
+  const auto align_type = alignedStorageType(alignment);
+  const std::size_t size = sizeFromShape(shape);
+  const std::size_t num_words = (size * type_size + alignment - 1) / alignment;
+  const auto expand_shape = shapePrependAxis(1, shape);
+  std::vector<poplar::Tensor> tensor_list;
+  tensor_list.reserve(tiles.size());
   for (size_t idx = 0; idx < tiles.size(); ++idx) {
-    graph.setTileMapping(t[idx], tiles[idx]);
+    auto t = graph.addVariable(align_type, ShapeType{num_words}, debug_context);
+    graph.setTileMapping(t, tiles[idx]);
+    tensor_list.push_back(
+        t.reinterpret(type).slice(0, size).reshape(expand_shape));
+  }
+  return poplar::concat(tensor_list, 0);
+}
+
+/**
+ * @brief Is a tensor fully mapped on a single tile?
+ *
+ * @param graph Poplar graph.
+ * @param t Tensor to check.
+ * @param tile Tile index.
+ * @return True if all the tensor elements are mapped on the tile.
+ */
+inline bool isTensorMappedOnTile(poplar::Graph& graph, const poplar::Tensor& t,
+                                 TileIndexType tile) {
+  const auto mapping = graph.getTileMapping(t, false);
+  std::size_t num_elements_tile = 0;
+  if (static_cast<std::size_t>(tile) < mapping.size()) {
+    for (const auto& interval : mapping[tile]) {
+      num_elements_tile += interval.size();
+    }
+  }
+  return num_elements_tile == t.numElements();
+}
+
+/**
+ * @brief IPU index of a (global) tile, in a multi-IPU graph.
+ */
+inline std::size_t tileIpuIndex(const poplar::Graph& graph,
+                                TileIndexType tile) noexcept {
+  return static_cast<std::size_t>(tile) / graph.getTarget().getTilesPerIPU();
+}
+
+/**
+ * @brief Is a tensor (fully) mapped on the IPU of a tile?
+ */
+inline bool isTensorMappedOnIpu(poplar::Graph& graph, const poplar::Tensor& t,
+                                TileIndexType tile) {
+  const auto mapping = graph.getTileMapping(t, false);
+  const auto tiles_per_ipu = graph.getTarget().getTilesPerIPU();
+  const std::size_t ipu = tileIpuIndex(graph, tile);
+  const std::size_t tile_start = ipu * tiles_per_ipu;
+  const std::size_t tile_end =
+      std::min(tile_start + tiles_per_ipu, mapping.size());
+  std::size_t num_elements_ipu = 0;
+  for (std::size_t idx = tile_start; idx < tile_end; ++idx) {
+    for (const auto& interval : mapping[idx]) {
+      num_elements_ipu += interval.size();
+    }
   }
-  return t;
+  return num_elements_ipu == t.numElements();
+}
+
+/**
+ * @brief Tile sharded copy statistics (e.g. for debug info).
+ */
+struct TileShardedCopyStats {
+  /** Number of slices (i.e. output tiles). */
+  std::size_t num_slices = 0;
+  /** Number of slices copied on-chip (internal exchange). */
+  std::size_t num_exchange_slices = 0;
+  /** Number of slices copied between IPUs (IPU-Link). */
+  std::size_t num_ipu_link_slices = 0;
+};
+
+/**
+ * @brief Shard a collection of slices on tiles, only copying the slices not
+ * already mapped on their tile.
+ *
+ * Moved slices are grouped in one copy per kind of transfer: on-chip exchange
+ * (source on the same IPU as the destination tile), then inter-IPU IPU-Link
+ * transfers (source on other IPU(s), or unmapped), keeping the on-chip
+ * exchange independent of the IPU-Link traffic.
+ *
+ * @param graph Poplar graph (single or multi-IPU).
+ * @param slices Slices to shard, all with the same shape and dtype.
+ * @param tiles (Global) destination tiles.
+ * @param seq Program sequence to which copies are added.
+ * @param debug_context Debug context.
+ * @param stats Optional copy statistics.
+ * @param force_copy Always copy slices, even when already on their tile.
+ * @return Sharded tensor of shape (T, *shape).
+ */
+inline poplar::Tensor tileShardedCopy(
+    poplar::Graph& graph, const std::vector<poplar::Tensor>& slices,
+    poplar::ArrayRef<TileIndexType> tiles, poplar::program::Sequence& seq,
+    const poplar::DebugContext& debug_context,
+    TileShardedCopyStats* stats = nullptr, bool force_copy = false) {
+  // Transfer kinds: 0 = none, 1 = on-chip exchange, 2 = IPU-Link.
+  constexpr std::size_t kNumTransfers = 3;
+  std::array<std::vector<std::size_t>, kNumTransfers> moved_indices;
+  std::array<std::vector<TileIndexType>, kNumTransfers> moved_tiles;
+  std::array<std::vector<poplar::Tensor>, kNumTransfers> moved_inputs;
+  std::vector<std::size_t> slices_transfer(slices.size(), 0);
+  for (std::size_t idx = 0; idx < slices.size(); ++idx) {
+    std::size_t transfer = 0;
+    if (force_copy || !isTensorMappedOnTile(graph, slices[idx], tiles[idx])) {
+      transfer = isTensorMappedOnIpu(graph, slices[idx], tiles[idx]) ? 1 : 2;
+    }
+    slices_transfer[idx] = transfer;
+    moved_indices[transfer].push_back(idx);
+    moved_tiles[transfer].push_back(tiles[idx]);
+    moved_inputs[transfer].push_back(slices[idx].expand({0}));
+  }
+  if (stats != nullptr) {
+    stats->num_slices = slices.size();
+    stats->num_exchange_slices = moved_indices[1].size();
+    stats->num_ipu_link_slices = moved_indices[2].size();
+  }
+  // One sharded variable and copy program per transfer kind.
+  std::array<std::optional<poplar::Tensor>, kNumTransfers> moved_outputs;
+  for (std::size_t transfer = 1; transfer < kNumTransfers; ++transfer) {
+    if (moved_indices[transfer].empty()) {
+      continue;
+    }
+    const auto& item = slices[moved_indices[transfer][0]];
+    moved_outputs[transfer] =
+        createShardedVariable(graph, item.elementType(), item.shape(),
+                              moved_tiles[transfer], debug_context);
+    seq.add(poplar::program::Copy(poplar::concat(moved_inputs[transfer]),
+                                  *moved_outputs[transfer], false,
+                                  debug_context));
+  }
+  // Output tensor: existing data on tiles + moved slices.
+  std::vector<poplar::Tensor> output_slices;
+  output_slices.reserve(slices.size());
+  std::array<std::size_t, kNumTransfers> moved_idx = {0, 0, 0};
+  for (std::size_t idx = 0; idx < slices.size(); ++idx) {
+    const auto transfer = slices_transfer[idx];
+    if (transfer == 0) {
+      // No copy => using directly the existing data on the tile.
+      output_slices.push_back(slices[idx].expand({0}));
+    } else {
+      output_slices.push_back(
+          (*moved_outputs[transfer])[moved_idx[transfer]].expand({0}));
+    }
+    moved_idx[transfer]++;
+  }
+  return poplar::concat(output_slices);
+}
+
+/**
+ * @brief Number of contiguous memory regions of every tile slice of a sharded
+ * tensor. A tile slice with a single region (and only mapped on its tile) can
+ * be connected to vertices without any on-tile rearrangement.
+ *
+ * @param graph Poplar graph.
+ * @param t Sharded tensor of shape (T, *shape).
+ * @param tiles Tiles on which the tensor is sharded.
+ * @return Number of regions per tile (0 if some data is mapped on other tiles).
+ */
+inline std::vector<std::int32_t> tileShardedNumContiguousRegions(
+    poplar::Graph& graph, const poplar::Tensor& t,
+    poplar::ArrayRef<TileIndexType> tiles) {
+  std::vector<std::int32_t> num_regions(tiles.size(), 0);
+  for (size_t idx = 0; idx < tiles.size(); ++idx) {
+    const auto t_tile = t[idx];
+    // Any data mapped on another tile? => exchange required.
+    if (!isTensorMappedOnTile(graph, t_tile, tiles[idx])) {
+      continue;
+    }
+    num_regions[idx] = t_tile.getContiguousRegions().size();
+  }
+  return num_regions;
 }
 
 /**
@@ -77,7 +298,8 @@ inline poplar::Tensor createConstantTensor(
     poplar::Graph& graph, const IpuType& ipu_type,
     poplar::ArrayRef<std::size_t> shape, poplar::ArrayRef<char> raw_values,
     const poplar::DebugContext& debug_context = {}) {
-  auto poplar_type = toPoplar(ipu_type);
+  // FP8/QUARTER constants stored as raw bytes.
+  auto poplar_type = toPoplarStorage(ipu_type);
   // Special case of FP16: need to use a different API.
   if (ipu_type == IpuType::HALF) {
     const uint16_t* val = reinterpret_cast<const uint16_t*>(raw_values.data());
@@ -90,34 +312,336 @@ inline poplar::Tensor createConstantTensor(
       raw_values, ipu_type);
 }
 
+/**
+ * @brief Graph-scoped pool of tile constant tensors.
+ *
+ * Constant tensors mapped on a single tile are deduplicated, using as key
+ * (dtype, shape, content hash), with a single host copy of the content and a
+ * tensor per tile. Reusing the same Poplar constant avoids duplicating in tile
+ * memory (and in the executable) identical data such as vertex worker offsets
+ * or worklists shared by many tile equations.
+ *
+ * NOTE: pools are indexed by (top-level Poplar graph address, pool id), the
+ * pool id being unique per lowered module and passed in the primitives
+ * attributes (see `tile_constant_pool_lowering_begin` in Python). A graph
+ * address re-used by a new graph, or interleaved lowerings/compilations, hence
+ * never share a pool. Pools are also cleared at every new module lowering (see
+ * `newLowering`), only to release memory. Pool id `kNoPool` disables pooling.
+ * A single pool registry is shared between pybind11 modules (see
+ * `makeTileConstantPoolBindings`).
+ *
+ * Pooled tensors are Poplar constants shared between primitives: tile map
+ * equations copy constant InOut operands before any in-place update (see
+ * `TileMapEquation::allocateInputTensors`).
+ */
+class TileConstantPool {
+ public:
+  /** Pool id, unique per lowered module. */
+  using PoolId = std::uint64_t;
+  /** No pooling pool id, i.e. always creating new constants. */
+  static constexpr PoolId kNoPool = 0;
+  /** Constant pool statistics. */
+  struct Stats {
+    /** Number of tile constants created. */
+    std::size_t num_constants = 0;
+    /** Number of constants reused from the pool. */
+    std::size_t num_reused = 0;
+    /** Bytes allocated by Poplar constants. */
+    std::size_t bytes_allocated = 0;
+    /** Bytes saved by constants reuse. */
+    std::size_t bytes_saved = 0;
+  };
+  /** Process-wide registry of constant pools (one per graph). */
+  struct Registry {
+    std::mutex mutex;
+    std::map<std::pair<const poplar::Graph*, PoolId>, TileConstantPool> pools;
+    Stats stats;
+  };
+
+  /**
+   * @brief Find an existing constant of shape `shape` mapped on a tile.
+   */
+  std::optional<poplar::Tensor> find(const IpuType& ipu_type,
+                                     poplar::ArrayRef<std::size_t> shape,
+                                     poplar::ArrayRef<char> raw_values,
+                                     TileIndexType tile) {
+    const std::string_view content(raw_values.data(), raw_values.size());
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    Entry* entry = findEntry(makeKey(ipu_type, shape, content), content);
+    if (entry == nullptr) {
+      return std::nullopt;
+    }
+    const auto it = entry->tensors.find(tile);
+    if (it == entry->tensors.end()) {
+      return std::nullopt;
+    }
+    updateStats(0, 1, content.size());
+    return it->second;
+  }
+
+  /**
+   * @brief Insert a new constant (already mapped on the tile) in the pool.
+   */
+  void insert(const IpuType& ipu_type, poplar::ArrayRef<std::size_t> shape,
+              poplar::ArrayRef<char> raw_values, TileIndexType tile,
+              const poplar::Tensor& tensor) {
+    const std::string_view content(raw_values.data(), raw_values.size());
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    const auto key = makeKey(ipu_type, shape, content);
+    Entry* entry = findEntry(key, content);
+    if (entry == nullptr) {
+      // Single host copy of the content, shared by all tiles.
+      auto& entries = m_entries[key];
+      entries.push_back(Entry{std::string(content), {}});
+      entry = &entries.back();
+    }
+    entry->tensors.insert_or_assign(tile, tensor);
+    updateStats(1, 0, content.size());
+  }
+
+  /**
+   * @brief Get or create a constant of shape `shape` mapped on a tile.
+   */
+  poplar::Tensor getOrCreate(poplar::Graph& graph, const IpuType& ipu_type,
+                             poplar::ArrayRef<std::size_t> shape,
+                             poplar::ArrayRef<char> raw_values,
+                             TileIndexType tile,
+                             const poplar::DebugContext& debug_context) {
+    if (auto t = find(ipu_type, shape, raw_values, tile)) {
+      return *t;
+    }
+    auto t = createConstantTensor(graph, ipu_type, shape, raw_values,
+                                  debug_context);
+    graph.setTileMapping(t, tile);
+    insert(ipu_type, shape, raw_values, tile, t);
+    return t;
+  }
+
+  /**
+   * @brief Pool statistics.
+   */
+  Stats stats() const {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    return m_stats;
+  }
+
+  /**
+   * @brief Get the constant pool associated with a (top-level) Poplar graph
+   * and a pool id.
+   */
+  static TileConstantPool& get(poplar::Graph& graph, PoolId pool_id) {
+    const poplar::Graph* top_graph = &graph.getTopLevelGraph();
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.pools[{top_graph, pool_id}];
+  }
+  /**
+   * @brief Process-wide statistics (all graphs).
+   */
+  static Stats statsAll() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.stats;
+  }
+  /**
+   * @brief Clear all constant pools (and reset statistics).
+   */
+  static void clearAll() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.pools.clear();
+    reg.stats = Stats{};
+  }
+  /**
+   * @brief New module lowering: clear all constant pools (keeping statistics).
+   *
+   * Only releasing the pools memory: pools of different lowerings never
+   * overlap (different pool ids). Cleared pools are re-populated if in use.
+   */
+  static void newLowering() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.pools.clear();
+  }
+
+  /**
+   * @brief Constant pools registry of the (pybind11) module.
+   */
+  static Registry& registry() {
+    Registry*& shared = sharedRegistry();
+    if (shared != nullptr) {
+      return *shared;
+    }
+    static Registry local;
+    return local;
+  }
+  /**
+   * @brief Use the registry of another module (instead of the local one).
+   */
+  static void setSharedRegistry(Registry* shared) { sharedRegistry() = shared; }
+
+ private:
+  using Key = std::tuple<IpuType, ShapeType, std::size_t>;
+  struct Entry {
+    /** Constant content (single copy for all tiles). */
+    std::string content;
+    /** Poplar constant tensor per tile. */
+    std::map<TileIndexType, poplar::Tensor> tensors;
+  };
+
+  static Key makeKey(const IpuType& ipu_type,
+                     poplar::ArrayRef<std::size_t> shape,
+                     std::string_view content) {
+    return Key{ipu_type, ShapeType(shape.begin(), shape.end()),
+               std::hash<std::string_view>{}(content)};
+  }
+  /** Find an entry with the same content (lock already acquired). */
+  Entry* findEntry(const Key& key, std::string_view content) {
+    const auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+      return nullptr;
+    }
+    for (auto& entry : it->second) {
+      // Full content comparison, in case of hash collision.
+      if (entry.content == content) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+  /** Update local and global statistics (lock already acquired). */
+  void updateStats(std::size_t num_constants, std::size_t num_reused,
+                   std::size_t num_bytes) {
+    for (Stats* stats : {&m_stats, &registry().stats}) {
+      stats->num_constants += num_constants;
+      stats->num_reused += num_reused;
+      stats->bytes_allocated += num_constants * num_bytes;
+      stats->bytes_saved += num_reused * num_bytes;
+    }
+  }
+
+  static Registry*& sharedRegistry() {
+    static Registry* shared = nullptr;
+    return shared;
+  }
+
+  // NOTE: std::list, keeping entries addresses valid on insert.
+  std::map<Key, std::list<Entry>> m_entries;
+  Stats m_stats;
+};
+
+/**
+ * @brief Make pybind11 bindings for the tile constant pool (report & clear).
+ *
+ * @param m Pybind11 module.
+ * @param registry_module Optional module owning the constant pool registry,
+ * shared with `m` (one registry per module by default).
+ */
+inline void makeTileConstantPoolBindings(
+    pybind11::module& m, const char* registry_module = nullptr) {
+  static constexpr const char* kRegistryName = "_tile_constant_pool_registry";
+  if (registry_module != nullptr) {
+    auto capsule = pybind11::module::import(registry_module)
+                       .attr(kRegistryName)
+                       .cast<pybind11::capsule>();
+    TileConstantPool::setSharedRegistry(
+        capsule.get_pointer<TileConstantPool::Registry>());
+  }
+  m.attr(kRegistryName) =
+      pybind11::capsule(&TileConstantPool::registry(), kRegistryName);
+  m.def("tile_constant_pool_stats", []() {
+    const auto stats = TileConstantPool::statsAll();
+    pybind11::dict d;
+    d["num_constants"] = stats.num_constants;
+    d["num_reused"] = stats.num_reused;
+    d["bytes_allocated"] = stats.bytes_allocated;
+    d["bytes_saved"] = stats.bytes_saved;
+    return d;
+  });
+  m.def("tile_constant_pool_clear", []() { TileConstantPool::clearAll(); });
+  m.def("tile_constant_pool_new_lowering",
+        []() { TileConstantPool::newLowering(); });
+}
+
 /**
  * @brief Create a replicated constant tensor.
+ *
+ * Constants already mapped on some tiles are re-used from the graph pool, and
+ * a single Poplar constant of shape (N, *shape) is created for the N remaining
+ * tiles, from a replicated host buffer and a single tile mapping pass.
+ *
  * @param graph Poplar graph.
  * @param ipu_type IPU datatype of the tensor.
  * @param shape Tensor shape on every tile.
  * @param raw_values Constant data raw values.
  * @param tiles Tiles on which to replicate the tensor/variable.
  * @param debugContext Optional debug context.
+ * @param pool_id Constant pool id (no pooling by default).
  * @return Allocated constant tensor of shape (T, *shape)
  */
 inline poplar::Tensor createReplicatedConstantTensor(
     poplar::Graph& graph, const IpuType& ipu_type,
     poplar::ArrayRef<std::size_t> shape, poplar::ArrayRef<char> raw_values,
     poplar::ArrayRef<TileIndexType> tiles,
-    const poplar::DebugContext& debug_context = {}) {
+    const poplar::DebugContext& debug_context = {},
+    TileConstantPool::PoolId pool_id = TileConstantPool::kNoPool) {
   // TODO: check raw_values, dtype and shape are consistent.
-  // TODO: get it working with FP16!
   // Expanded shape (used in concat).
   const auto expand_shape = shapePrependAxis(1, shape);
-  // Create Poplar constant per tile. Should I create a single one?
-  std::vector<poplar::Tensor> tensor_list;
+  TileConstantPool* pool = (pool_id != TileConstantPool::kNoPool)
+                               ? &TileConstantPool::get(graph, pool_id)
+                               : nullptr;
+  std::vector<std::optional<poplar::Tensor>> tensor_list(tiles.size());
+  std::vector<std::size_t> missing_indices;
   for (size_t idx = 0; idx < tiles.size(); ++idx) {
-    auto t = createConstantTensor(graph, ipu_type, expand_shape, raw_values,
-                                  debug_context);
-    graph.setTileMapping(t, tiles[idx]);
-    tensor_list.push_back(t);
+    if (pool != nullptr) {
+      tensor_list[idx] =
+          pool->find(ipu_type, expand_shape, raw_values, tiles[idx]);
+    }
+    if (!tensor_list[idx].has_value()) {
+      missing_indices.push_back(idx);
+    }
   }
-  return poplar::concat(tensor_list, 0);
+  if (!missing_indices.empty()) {
+    // Single Poplar constant for all missing tiles, from replicated raw data.
+    const std::size_t num_missing = missing_indices.size();
+    std::string raw_values_rep;
+    raw_values_rep.reserve(num_missing * raw_values.size());
+    for (size_t k = 0; k < num_missing; ++k) {
+      raw_values_rep.append(raw_values.data(), raw_values.size());
+    }
+    const auto raw_values_rep_ref =
+        poplar::ArrayRef<char>(raw_values_rep.data(), raw_values_rep.size());
+    auto t = createConstantTensor(graph, ipu_type,
+                                  shapePrependAxis(num_missing, shape),
+                                  raw_values_rep_ref, debug_context);
+    // Single tile mapping pass.
+    const std::size_t size = sizeFromShape(shape);
+    poplar::Graph::TileToTensorMapping mapping(graph.getTarget().getNumTiles());
+    for (size_t k = 0; k < num_missing; ++k) {
+      const auto tile = tiles[missing_indices[k]];
+      mapping.at(tile).push_back(poplar::Interval(k * size, (k + 1) * size));
+    }
+    graph.setTileMapping(t, mapping);
+    for (size_t k = 0; k < num_missing; ++k) {
+      const auto idx = missing_indices[k];
+      tensor_list[idx] = t.slice(k, k + 1, 0);
+      if (pool != nullptr) {
+        pool->insert(ipu_type, expand_shape, raw_values, tiles[idx],
+                     *tensor_list[idx]);
+      }
+    }
+    // No concat required when no constant re-used.
+    if (num_missing == tiles.size()) {
+      return t;
+    }
+  }
+  std::vector<poplar::Tensor> tensors;
+  tensors.reserve(tensor_list.size());
+  for (const auto& t : tensor_list) {
+    tensors.push_back(*t);
+  }
+  return poplar::concat(tensors, 0);
 }
 
 /**
@@ -128,30 +652,40 @@ inline poplar::Tensor createReplicatedConstantTensor(
  * @param raw_values Constant data raw values (of the full tensor).
  * @param tiles Tiles on which to shard the tensor/variable.
  * @param debugContext Optional debug context.
+ * @param pool_id Constant pool id (no pooling by default).
  * @return Allocated constant tensor of shape (T, *shape)
  */
 inline poplar::Tensor createShardedConstantTensor(
     poplar::Graph& graph, const IpuType& ipu_type,
     poplar::ArrayRef<std::size_t> shape, poplar::ArrayRef<char> raw_values,
     poplar::ArrayRef<TileIndexType> tiles,
-    const poplar::DebugContext& debug_context = {}) {
+    const poplar::DebugContext& debug_context = {},
+    TileConstantPool::PoolId pool_id = TileConstantPool::kNoPool) {
   // TODO: check consistent raw values size.
   // Expanded shape on every tile.
   const auto expand_shape =
       shapePrependAxis(1, arraySlice(shape, 1, shape.size()));
   const auto dtype_size = ipuTypeSize(ipu_type);
   const std::size_t bytes_size = sizeFromShape(expand_shape) * dtype_size;
-  auto poplar_type = toPoplar(ipu_type);
-  // Create Poplar constant per tile. Should I create a single one?
+  // Poplar constant per tile, re-used from the graph pool when possible.
+  TileConstantPool* pool = (pool_id != TileConstantPool::kNoPool)
+                               ? &TileConstantPool::get(graph, pool_id)
+                               : nullptr;
   std::vector<poplar::Tensor> tensor_list;
   for (size_t idx = 0; idx < tiles.size(); ++idx) {
     // Slicing the raw data corresponding to the tile.
     auto raw_values_tile =
         arraySlice(raw_values, idx * bytes_size, (idx + 1) * bytes_size);
-    auto t = createConstantTensor(graph, ipu_type, expand_shape,
-                                  raw_values_tile, debug_context);
-    graph.setTileMapping(t, tiles[idx]);
-    tensor_list.push_back(t);
+    if (pool != nullptr) {
+      tensor_list.push_back(pool->getOrCreate(graph, ipu_type, expand_shape,
+                                              raw_values_tile, tiles[idx],
+                                              debug_context));
+    } else {
+      auto t = createConstantTensor(graph, ipu_type, expand_shape,
+                                    raw_values_tile, debug_context);
+      graph.setTileMapping(t, tiles[idx]);
+      tensor_list.push_back(t);
+    }
   }
   return poplar::concat(tensor_list, 0);
 }
@@ -0,0 +1,143 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+"""Content-hashed ahead-of-time codelet (`.gp`) cache.
+
+Vertex C++ sources passed as `gp_filename` are compiled by Poplar (`popc`) at graph
+build time, in every fresh process. This module compiles every vertex source only once
+per (source content, popc version, targets, optimization flags), into a `.gp` file stored
+in a cache directory shared between processes.
+
+Environment variables:
+    JAX_IPU_CODELET_CACHE: Enable the codelet cache (default: `1`).
+    JAX_IPU_CODELET_CACHE_DIR: Cache directory (default: `~/.cache/jax_ipu_experimental_addons/codelets`).
+    JAX_IPU_CODELET_TARGETS: popc comma-separated targets (default: `cpu,ipu2,ipu21`, where `cpu` is
+        the IPU model target).
+    JAX_IPU_CODELET_OPT_FLAGS: popc optimization flags (default: `-O2`).
+"""
+import hashlib
+import os
+import shutil
+import subprocess
+import warnings
+from functools import lru_cache
+from typing import Dict, List, Optional, Tuple
+
+from .tile_native_modules import get_local_source_dependencies
+
+# Default popc targets: IPU model (`cpu`) and Mk2/Bow IPU hardware.
+_default_codelet_targets = "cpu,ipu2,ipu21"
+# In-process cache: (sources & dependencies mtimes, config) => codelet filename.
+_codelet_filename_cache: Dict[Tuple[Tuple[Tuple[str, float], ...], Tuple[str, ...]], str] = {}
+
+
+def use_codelet_cache() -> bool:
+    """Is the ahead-of-time codelet cache enabled? Disabled with `JAX_IPU_CODELET_CACHE=0`."""
+    return os.environ.get("JAX_IPU_CODELET_CACHE", "1").lower() not in ("0", "false")
+
+
+def get_codelet_cache_directory() -> str:
+    """Get the codelet cache directory, set with the `JAX_IPU_CODELET_CACHE_DIR` environment variable."""
+    default_dir = os.path.join(os.path.expanduser("~"), ".cache", "jax_ipu_experimental_addons", "codelets")
+    return os.environ.get("JAX_IPU_CODELET_CACHE_DIR", default_dir)
+
+
+def get_codelet_targets() -> str:
+    """Get the popc codelet targets (empty string for popc default targets).
+
+    The IPU model target (`cpu`) is included by default: a `.gp` codelet without
+    the target of the Poplar device is rejected by Poplar at graph build time.
+    """
+    return os.environ.get("JAX_IPU_CODELET_TARGETS", _default_codelet_targets)
+
+
+def get_codelet_opt_flags() -> List[str]:
+    """Get the popc codelet optimization flags."""
+    return os.environ.get("JAX_IPU_CODELET_OPT_FLAGS", "-O2").split()
+
+
+@lru_cache(maxsize=None)
+def get_popc_version() -> Optional[str]:
+    """Get the popc compiler version string (None if popc is not available)."""
+    popc = shutil.which("popc")
+    if popc is None:
+        return None
+    try:
+        result = subprocess.run([popc, "--version"], capture_output=True, text=True, check=True)
+    except (OSError, subprocess.CalledProcessError):
+        return None
+    return result.stdout.strip()
+
+
+def make_codelet_cache_key(filename: str, popc_version: str, targets: str, opt_flags: List[str]) -> str:
+    """Make the codelet cache key of a vertex source: hash of sources content & compilation config."""
+    h = hashlib.sha256()
+    for key in (popc_version, targets, " ".join(opt_flags)):
+        h.update(key.encode())
+        h.update(b"\0")
+    # Source filename not part of the key: only the content matters.
+    for fname in get_local_source_dependencies(filename):
+        with open(fname, "rb") as f:
+            h.update(hashlib.sha256(f.read()).digest())
+    return h.hexdigest()
+
+
+def compile_codelet(filename: str, gp_filename: str, targets: str, opt_flags: List[str]):
+    """Compile a vertex source into a `.gp` codelet file with popc.
+
+    The `.gp` file is written atomically, such that concurrent processes can
+    safely compile and use the same cache entry.
+    """
+    tmp_gp_filename = f"{gp_filename}.{os.getpid()}.tmp"
+    cmd = ["popc", *opt_flags]
+    if len(targets) > 0:
+        cmd.append(f"--target={targets}")
+    cmd += ["-I", os.path.dirname(os.path.abspath(filename)), filename, "-o", tmp_gp_filename]
+    try:
+        subprocess.run(cmd, capture_output=True, text=True, check=True)
+        os.replace(tmp_gp_filename, gp_filename)
+    finally:
+        if os.path.isfile(tmp_gp_filename):
+            os.remove(tmp_gp_filename)
+
+
+def get_cached_codelet_filename(filename: str) -> str:
+    """Get the cached `.gp` codelet filename corresponding to a vertex source.
+
+    The vertex source is compiled with popc at the first call (in any process). Falls back
+    to the original filename (i.e. compilation by Poplar at graph build time) when the cache
+    is disabled, popc is not available, the file is not a C++ source or its compilation fails.
+
+    Args:
+        filename: Vertex C++ source filename (or already compiled `.gp` file).
+    Returns:
+        Codelet filename to pass to Poplar.
+    """
+    if len(filename) == 0 or not use_codelet_cache() or not filename.endswith(".cpp"):
+        return filename
+    filename = os.path.abspath(filename)
+    popc_version = get_popc_version()
+    if popc_version is None or not os.path.isfile(filename):
+        return filename
+    targets = get_codelet_targets()
+    opt_flags = get_codelet_opt_flags()
+    cache_dir = get_codelet_cache_directory()
+    # Local includes part of the key: a header update must trigger a new compilation.
+    mtimes = tuple((fname, os.path.getmtime(fname)) for fname in get_local_source_dependencies(filename))
+    memo_key = (mtimes, (cache_dir, popc_version, targets, *opt_flags))
+    if memo_key in _codelet_filename_cache:
+        return _codelet_filename_cache[memo_key]
+
+    basename = os.path.splitext(os.path.basename(filename))[0]
+    cache_key = make_codelet_cache_key(filename, popc_version, targets, opt_flags)
+    gp_filename = os.path.join(cache_dir, f"{basename}_{cache_key[:24]}.gp")
+    if not os.path.isfile(gp_filename):
+        try:
+            os.makedirs(cache_dir, exist_ok=True)
+            compile_codelet(filename, gp_filename, targets, opt_flags)
+        except (OSError, subprocess.CalledProcessError) as e:
+            stderr = getattr(e, "stderr", "") or ""
+            warnings.warn(
+                f"Could not compile IPU codelet '{filename}', using Poplar compilation instead: {e}\n{stderr}"
+            )
+            gp_filename = filename
+    _codelet_filename_cache[memo_key] = gp_filename
+    return gp_filename
@@ -1,19 +1,29 @@
 # Copyright (c) 2022 Graphcore Ltd. All rights reserved.
 import os
+from enum import IntEnum
 from typing import Any, Sequence
 
-import cppimport
 import numpy as np
-from numpy.typing import DTypeLike
+from numpy.typing import ArrayLike, DTypeLike, NDArray
 
-# Pybind11 extension import (and compilation if necessary).
+from .tile_native_modules import import_native_module
+
+# Pybind11 extension import (prebuilt, or JIT compiled if necessary).
 # Explicit path is more robust to different `pip install` usages.
 ext_filename = os.path.abspath(os.path.join(os.path.dirname(__file__), "tile_array_primitives_impl.cpp"))
-tile_array_primitives_impl = cppimport.imp_from_filepath(
+tile_array_primitives_impl = import_native_module(
     ext_filename, "jax_ipu_experimental_addons.tile.tile_array_primitives_impl"
 )
 
-from .tile_array_primitives_impl import Base64Data, IpuShapedArray, IpuType  # noqa: E402, F401
+from .tile_array_primitives_impl import (  # noqa: E402, F401
+    Base64Data,
+    IpuShapedArray,
+    IpuType,
+    base64_avx2_supported,
+    base64_decode,
+    base64_encode,
+    make_balanced_worker_offsets,
+)
 
 _numpy_dtype_to_ipu_type = {
     np.dtype(np.bool_): IpuType.BOOL,
@@ -37,10 +47,11 @@ _ipu_type_to_numpy_dtype = {
     IpuType.CHAR: np.dtype(np.int8),
     IpuType.SHORT: np.dtype(np.int16),
     IpuType.INT: np.dtype(np.int32),
+    IpuType.QUARTER: np.dtype(np.uint8),
     IpuType.HALF: np.dtype(np.float16),
     IpuType.FLOAT: np.dtype(np.float32),
 }
-"""Mapping from IPU type to NumPy dtype.
+"""Mapping from IPU type to NumPy dtype (FP8/QUARTER stored as raw bytes).
 """
 
 _ipu_type_to_name = {
@@ -51,6 +62,7 @@ _ipu_type_to_name = {
     IpuType.CHAR: "signed char",
     IpuType.SHORT: "short",
     IpuType.INT: "int",
+    IpuType.QUARTER: "unsigned char",
     IpuType.HALF: "half",
     IpuType.FLOAT: "float",
 }
@@ -77,6 +89,68 @@ def get_ipu_type_name(v: Any) -> str:
     return _ipu_type_to_name[from_numpy_dtype_to_ipu_type(v)]
 
 
+class IpuFp8Format(IntEnum):
+    """FP8 (IPU QUARTER) formats, following Poplar `QuarterMetadata` naming.
+
+    Both formats have no infinity, and IPU hardware reserves `0x80` (negative zero) for NaN.
+    NaN is not supported in this module: `fp8_encode` never produces `0x80`, and `fp8_decode`
+    and tile vertices decode it as (negative) zero.
+    """
+
+    F143 = 0
+    """1 sign bit, 4 exponent bits (bias 8), 3 mantissa bits. Max value 240."""
+    F152 = 1
+    """1 sign bit, 5 exponent bits (bias 16), 2 mantissa bits. Max value 57344."""
+
+
+def make_fp8_decode_table(fp8_format: IpuFp8Format) -> NDArray[np.float32]:
+    """Make the FP8 decoding table, i.e. FP32 value of all 256 FP8 raw bytes.
+
+    NOTE: NaN (`0x80`) is not supported, decoded as negative zero (as in tile vertices).
+    """
+    ebits, mbits, bias = (4, 3, 8) if fp8_format == IpuFp8Format.F143 else (5, 2, 16)
+    codes = np.arange(256)
+    exponent = (codes >> mbits) & ((1 << ebits) - 1)
+    mantissa = codes & ((1 << mbits) - 1)
+    # Sub-normal numbers when exponent == 0.
+    significand = np.where(exponent > 0, mantissa + (1 << mbits), mantissa).astype(np.float32)
+    values = np.ldexp(significand, np.maximum(exponent, 1) - bias - mbits)
+    return np.where(codes & 0x80, -values, values).astype(np.float32)
+
+
+def fp8_decode(data: NDArray[np.uint8], fp8_format: IpuFp8Format) -> NDArray[np.float32]:
+    """Decode FP8 raw bytes into FP32 values."""
+    return make_fp8_decode_table(fp8_format)[np.asarray(data, dtype=np.uint8)]
+
+
+def fp8_encode(x: ArrayLike, fp8_format: IpuFp8Format) -> NDArray[np.uint8]:
+    """Encode values into FP8 raw bytes, with round to nearest even and saturation.
+
+    FP8 data is stored in `uint8` arrays, as there is no FP8 dtype in JAX.
+    """
+    x = np.asarray(x, dtype=np.float32)
+    # Positive FP8 values, in increasing order.
+    table = make_fp8_decode_table(fp8_format)[:128]
+    xabs = np.minimum(np.abs(x), table[-1])
+    hi = np.clip(np.searchsorted(table, xabs), 1, 127)
+    lo = hi - 1
+    dist_lo, dist_hi = xabs - table[lo], table[hi] - xabs
+    codes = np.where((dist_lo < dist_hi) | ((dist_lo == dist_hi) & (lo % 2 == 0)), lo, hi)
+    # Negative values (avoiding NaN `0x80` for negative zero).
+    codes = np.where((x < 0) & (codes > 0), codes | 0x80, codes)
+    return codes.astype(np.uint8)
+
+
+def use_binary_attributes() -> bool:
+    """Should IPU custom primitives attributes be serialized in binary (MessagePack) format?
+
+    JSON remains the default (human readable, easier to debug). Binary serialization
+    is enabled with the environment variable `JAX_IPU_TILE_BINARY_ATTRIBUTES=1`, and
+    avoids the base64 encoding of constant data.
+    """
+    return os.environ.get("JAX_IPU_TILE_BINARY_ATTRIBUTES", "0").lower() in ("1", "true")
+
+
 def make_ipu_shaped_array(shape: Sequence[int], dtype: DTypeLike) -> IpuShapedArray:
     """Convert to IPU shaped array."""
     return IpuShapedArray(shape, from_numpy_dtype_to_ipu_type(dtype))
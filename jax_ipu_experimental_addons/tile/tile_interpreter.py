@@ -3,13 +3,14 @@
 
 In particular, we need a registry mapping JAX primitives to IPU vertex (and additionally support custom IPU vertex).
 """
+import os
 import re
 from typing import Any, Callable, Dict, List, Optional, Sequence, Tuple, Union
 
 import numpy as np
 from jax.core import Primitive, ShapedArray
 
-from .tile_array import TileShardedArray
+from .tile_array import TileShardedArray, make_global_tiles
 from .tile_common_utils import make_ipu_shaped_array
 from .tile_interpreter_primitives import (
     IpuTileMapEquation,
@@ -20,6 +21,7 @@ from .tile_interpreter_primitives import (
     make_ipu_vertex_io_info,
     tile_map_equation_call_multi_out,
     tile_map_equation_call_single_out,
+    tile_map_equation_group_call,
 )
 
 IpuVertexTranslation = Callable[
@@ -57,7 +59,7 @@ def create_ipu_tile_primitive(
     pname: str,
     vname: str,
     inputs: List[str],
-    outputs: Dict[str, int],
+    outputs: Dict[str, Union[int, ShapedArray, Callable[..., ShapedArray]]],
     constants: Optional[Dict[str, IpuVertexConstantFactory]] = None,
     tmp_space: Optional[Union[int, ShapedArray]] = None,
     gp_filename: Optional[str] = None,
@@ -73,7 +75,7 @@ def create_ipu_tile_primitive(
         pname: Primitive name.
         vname: Vertex name. Supporting templated dtype from input(s).
         inputs: Set of input names.
-        outputs: Set output names (with input index for aval).
+        outputs: Set output names (with input index for aval, static shaped array, or function inavals -> aval).
         constants: Vertex constants factory function: (inavals, outavals, attrs) -> np.ndarray
         tmp_space: Optional tmp space. Either index refering an input array, or a static shaped array.
         gp_filename: Optional IPU gp filename.
@@ -103,6 +105,8 @@ def create_ipu_tile_primitive(
                 return args[outinfo]
             elif isinstance(outinfo, ShapedArray):
                 return outinfo
+            elif callable(outinfo):
+                return outinfo(args)
             raise ValueError(f"Unknown IPU vertex output descriptor: {outinfo}.")
 
         assert len(args) == num_inputs
@@ -178,6 +182,39 @@ def create_ipu_tile_primitive(
     return p
 
 
+def make_tile_map_equation(
+    primitive: Primitive,
+    inputs: Sequence[TileShardedArray],
+    tiles: Optional[Tuple[int, ...]],
+    sync: bool,
+    attributes: Dict[str, Any],
+    profile: bool = False,
+) -> Tuple[Tuple[int, ...], IpuTileMapEquation, Dict[str, Any]]:
+    """Make the IPU tile map equation corresponding to a JAX primitive call.
+
+    Returns:
+        (tiles, tile map equation, attributes)
+    """
+    if primitive.name not in _ipu_tile_primitive_registry:
+        raise KeyError(f"The JAX primitive `{primitive}` is not supported for tile mapping on the IPU.")
+    if not all([isinstance(v, TileShardedArray) for v in inputs]):
+        raise TypeError("Tile map inputs must be `TileShardedArray` instances.")
+
+    # TODO: check tile mapping consistency.
+    check_tile_mapping_consistency(inputs)
+    tiles = make_global_tiles(tiles) if tiles else inputs[0].tiles
+    attributes = attributes or {}
+    # Get the IPU tile map equation corresponding.
+    _, ipu_prim_translation = _ipu_tile_primitive_registry[primitive.name]
+    # TODO: pass outavals as well => no need to do it manually in every translation function.
+    tile_map_eqn: IpuTileMapEquation = ipu_prim_translation(primitive, tiles, [v.tile_aval for v in inputs], attributes)
+    tile_map_eqn.sync = sync
+    if profile:
+        tile_map_eqn.profile = True
+        tile_map_eqn.profile_gp_filename = os.path.join(os.path.dirname(__file__), "vertex", "hw_vertex.cpp")
+    return tiles, tile_map_eqn, attributes
+
+
 def tile_map_primitive(
     primitive: Primitive, *args: TileShardedArray, **kwargs: Any
 ) -> Union[TileShardedArray, Sequence[TileShardedArray]]:
@@ -189,43 +226,45 @@ def tile_map_primitive(
         **kwargs: Attributes to pass to the JAX primitive (and translation rule).
             tiles: Optional tile mapping, provided when there is no input.
             sync: Synchronize tiles before the Poplar compute set.
+            profile: Profiling mode, measuring the compute set cycle count on every tile.
     Returns:
-        List of output sharded arrays.
+        List of output sharded arrays. In profiling mode, an additional (T, 2) uint32 sharded
+        array is returned, with the cycle delta on every tile as (low, high) 32 bits words.
     """
     # Unpack arguments...
     inputs: List[TileShardedArray] = list(args)
     assert all([isinstance(v, TileShardedArray) for v in args])
 
-    # Tiles & sync arguments.
+    # Tiles, sync & profile arguments.
     tiles: Optional[Tuple[int, ...]] = kwargs.get("tiles", None)
     sync: bool = kwargs.get("sync", False)
+    profile: bool = kwargs.get("profile", False)
     # Remove IPU arguments.
     attributes = dict(kwargs)
     attributes.pop("tiles", None)
     attributes.pop("sync", None)
+    attributes.pop("profile", None)
 
     if primitive is None:
         # No primitive: by default a no-op.
         return tuple(inputs)
-    if primitive.name not in _ipu_tile_primitive_registry:
-        raise KeyError(f"The JAX primitive `{primitive}` is not supported for tile mapping on the IPU.")
-    if not all([isinstance(v, TileShardedArray) for v in inputs]):
-        raise TypeError("Tile map inputs must be `TileShardedArray` instances.")
-
-    # TODO: check tile mapping consistency.
-    check_tile_mapping_consistency(inputs)
-    tiles = tiles or inputs[0].tiles
-    attributes = attributes or {}
-    # Get the IPU tile map equation corresponding.
-    _, ipu_prim_translation = _ipu_tile_primitive_registry[primitive.name]
-    # TODO: pass outavals as well => no need to do it manually in every translation function.
-    tile_map_eqn: IpuTileMapEquation = ipu_prim_translation(primitive, tiles, [v.tile_aval for v in inputs], attributes)
-    tile_map_eqn.sync = sync
+    tiles, tile_map_eqn, attributes = make_tile_map_equation(primitive, inputs, tiles, sync, attributes, profile)
     tile_map_eqn_json: str = tile_map_eqn.to_json_str()
 
     # Call JAX tile custom primitive, dispatching properly the equation call.
     # And then convert to proper TileShardedArray
-    if primitive.multiple_results:
+    if profile:
+        # Profiling mode: always multiple outputs, with additional cycle delta.
+        outputs = tile_map_equation_call_multi_out(
+            [v.device_array for v in inputs],
+            pname=primitive.name,
+            tiles=tiles,
+            tile_map_eqn_json=tile_map_eqn_json,
+            ipu_profile=True,
+            **attributes,
+        )
+        return tuple([TileShardedArray(v, tiles) for v in outputs])
+    elif primitive.multiple_results:
         outputs = tile_map_equation_call_multi_out(
             [v.device_array for v in inputs],
             pname=primitive.name,
@@ -245,6 +284,111 @@ def tile_map_primitive(
         return TileShardedArray(output, tiles)
 
 
+TileMapCall = Tuple[Primitive, Sequence[TileShardedArray], Dict[str, Any]]
+"""Tile map primitive call: (primitive, inputs, attributes).
+"""
+
+
+def tile_map_primitive_group(
+    calls: Sequence[TileMapCall],
+) -> List[Union[TileShardedArray, Tuple[TileShardedArray, ...]]]:
+    """Map a group of JAX primitives over disjoint collections of tiles, in a single IPU compute set.
+
+    All vertices are executed concurrently, in the same superstep (i.e. a single compute set sync).
+
+    Args:
+        calls: Collection of (primitive, inputs, attributes) calls. Same semantics as `tile_map_primitive`.
+    Returns:
+        List of outputs per call (sharded array, or tuple of sharded arrays for multiple outputs).
+    """
+    group = []
+    group_inputs = []
+    group_num_outputs = []
+    group_tiles: Dict[int, str] = {}
+    for primitive, inputs, kwargs in calls:
+        tiles: Optional[Tuple[int, ...]] = kwargs.get("tiles", None)
+        sync: bool = kwargs.get("sync", False)
+        attributes = dict(kwargs)
+        attributes.pop("tiles", None)
+        attributes.pop("sync", None)
+        if attributes.pop("profile", False):
+            raise ValueError(f"Profiling mode not supported in a tile map group (primitive `{primitive.name}`).")
+
+        tiles, tile_map_eqn, attributes = make_tile_map_equation(primitive, inputs, tiles, sync, attributes)
+        # Tiles overlapping check between equations.
+        for t in tiles:
+            if t in group_tiles:
+                raise ValueError(
+                    f"Tile {t} used by primitives `{group_tiles[t]}` and `{primitive.name}` in a tile map group."
+                )
+            group_tiles[t] = primitive.name
+        group.append((primitive.name, tiles, tile_map_eqn.to_json_str(), len(inputs), tuple(attributes.items())))
+        group_inputs.extend([v.device_array for v in inputs])
+        group_num_outputs.append(len(tile_map_eqn.outputs_info) if primitive.multiple_results else 1)
+
+    group_outputs = tile_map_equation_group_call(group_inputs, group=tuple(group))
+    # Re-split outputs between primitive calls.
+    outputs: List[Union[TileShardedArray, Tuple[TileShardedArray, ...]]] = []
+    offset = 0
+    for (primitive, _, _), (_, tiles, _, _, _), num_outputs in zip(calls, group, group_num_outputs):
+        call_outputs = tuple([TileShardedArray(v, tiles) for v in group_outputs[offset : offset + num_outputs]])
+        outputs.append(call_outputs if primitive.multiple_results else call_outputs[0])
+        offset += num_outputs
+    return outputs
+
+
+def tile_pipelined_loop(
+    num_steps: int,
+    lead_compute_fn: Callable[[int, Any], TileMapCall],
+    lead_exchange_fn: Callable[[int, Any, Any], Tuple[Any, Any]],
+    lag_compute_fn: Callable[[int, Any, Any], TileMapCall],
+    lag_exchange_fn: Callable[[int, Any, Any], Any],
+    lead_state: Any,
+    lag_state: Any,
+) -> Tuple[Any, Any]:
+    """Software pipelined (static) tile loop, over two stages mapped on disjoint collections of tiles.
+
+    Every step of a stage is a tile map compute call, followed by an exchange (i.e. any tile ops).
+    The lag stage is running one step behind the lead stage, and is consuming the message produced by
+    the lead stage at the same step: at every superstep, the lead compute of step k and the lag compute
+    of step k-1 are grouped in a single compute set, saving a compute phase (and tiles sync) per step.
+    The lag and lead exchanges then follow as separate (sequential) tile ops.
+
+    Note: no explicit double buffering: every step message is a new tensor returned by the lead
+    exchange function (e.g. `tile_put_sharded`), and memory re-use between steps is left to Poplar.
+
+    Note: exchange functions are not restricted to data movement, and may contain additional compute
+    (e.g. tile map calls). These are not grouped with the other stage compute, meaning that they will
+    be serialized with the other stage exchange, and reduce the compute/exchange overlap accordingly.
+
+    Args:
+        num_steps: Number of (static) steps.
+        lead_compute_fn: (step, lead_state) -> lead stage tile map call.
+        lead_exchange_fn: (step, lead_state, call outputs) -> (lead_state, message).
+        lag_compute_fn: (step, lag_state, message) -> lag stage tile map call.
+        lag_exchange_fn: (step, lag_state, call outputs) -> lag_state.
+        lead_state: Initial lead stage state.
+        lag_state: Initial lag stage state.
+    Returns:
+        Final (lead_state, lag_state).
+    """
+    if num_steps == 0:
+        return lead_state, lag_state
+    message = None
+    for k in range(num_steps + 1):
+        calls = []
+        if k < num_steps:
+            calls.append(lead_compute_fn(k, lead_state))
+        if k > 0:
+            calls.append(lag_compute_fn(k - 1, lag_state, message))
+        outputs = tile_map_primitive_group(calls)
+        if k > 0:
+            lag_state = lag_exchange_fn(k - 1, lag_state, outputs[-1])
+        if k < num_steps:
+            lead_state, message = lead_exchange_fn(k, lead_state, outputs[0])
+    return lead_state, lag_state
+
+
 def register_ipu_tile_primitive(primitive: Primitive, translation: IpuVertexTranslation):
     """Register an IPU tile vertex translation from JAX primitive.
 
@@ -1,15 +1,19 @@
 # Copyright (c) 2022 Graphcore Ltd. All rights reserved.
+import os
 from dataclasses import dataclass
 from enum import IntEnum
-from typing import Any, Dict, List, Tuple
+from typing import Any, Dict, List, Optional, Tuple
 
+import jax.numpy as jnp
 import numpy as np
 from jax.core import Primitive, ShapedArray
 from jax.lax import dot_general_p
 
 from jax_ipu_experimental_addons.utils import DType, DTypeLike, NDArray
 
-from .tile_interpreter import register_ipu_tile_primitive
+from .tile_array import TileShardedArray
+from .tile_common_utils import IpuFp8Format, make_fp8_decode_table
+from .tile_interpreter import register_ipu_tile_primitive, tile_map_primitive
 from .tile_interpreter_primitives import (
     IpuTileMapEquation,
     from_numpy_dtype_to_ipu_type,
@@ -27,7 +31,7 @@ from .tile_interpreter_primitives_impl import (  # noqa: F401
     ipuReverseTransformedInStride,
     ipuReverseTransformedOutStride,
 )
-from .tile_interpreter_vertex_utils import make_num_elements_per_worker
+from .tile_interpreter_vertex_utils import make_ipu_vector1d_worker_offsets, make_num_elements_per_worker
 
 
 class IpuConvVertexType(IntEnum):
@@ -41,6 +45,11 @@ class IpuConvVertexType(IntEnum):
     Automatic = 0
     ConvPartial1x1 = 1
     ConvPartialHMAC = 2
+    VectorMac = 3
+
+
+def get_dot_vertex_gp_filename() -> str:
+    return os.path.join(os.path.dirname(__file__), "vertex", "tile_dot_vertex.cpp")
 
 
 @dataclass
@@ -526,6 +535,121 @@ def ipu_dot_general_conv_hmac_primitive_translation(
     return ipu_prim_info
 
 
+def make_dot_worker_offsets(num_outputs: int, outdtype: DTypeLike) -> NDArray[np.uint16]:
+    """Make the vector MAC dot vertices worker offsets, in output elements.
+
+    Workers are split in grains of 32 bits words of outputs (i.e. 2 elements for 16 bits
+    outputs), avoiding two workers writing the two halves of the same word.
+    """
+    grain = 4 // np.dtype(outdtype).itemsize
+    return make_ipu_vector1d_worker_offsets(num_outputs, vector_size=1, wdtype=np.uint16, grain=grain)
+
+
+def ipu_dot_general_vector_mac_primitive_translation(
+    p: Primitive,
+    tiles: Tuple[int, ...],
+    inavals: List[ShapedArray],
+    attributes: Dict[str, Any],
+) -> IpuTileMapEquation:
+    """IPU `dot_general` primitive translation rule to the (custom) vector unit `DotGeneralVectorMac` vertex.
+
+    Generic fallback, supporting any (1d or 2d) lhs and rhs, contracting on the last axis.
+
+    Args:
+        p: JAX primitive.
+        tiles: Collection of tiles.
+        inavals: Input shaped arrays.
+        attributes: (unused) attributes.
+    Returns:
+        IPU tile map primitive structure.
+    """
+    lhs_aval, rhs_aval = inavals
+    assert lhs_aval.dtype == rhs_aval.dtype
+    assert lhs_aval.ndim in (1, 2)
+    assert rhs_aval.ndim in (1, 2)
+    outaval = p.abstract_eval(*inavals, **attributes)[0]
+
+    ((lhs_contracting_dims, rhs_contracting_dims), (lhs_batch_dims, rhs_batch_dims)) = attributes["dimension_numbers"]
+    # Only last dimension contracting supported.
+    assert list(lhs_contracting_dims) == [lhs_aval.ndim - 1]
+    assert list(rhs_contracting_dims) == [rhs_aval.ndim - 1]
+    # No batching supported.
+    assert len(lhs_batch_dims) == 0
+    assert len(rhs_batch_dims) == 0
+    fp_dtype = np.dtype(lhs_aval.dtype)
+    accum_dtype = np.dtype(attributes.get("preferred_element_type", None) or lhs_aval.dtype)
+    assert fp_dtype in (np.float16, np.float32)
+    assert accum_dtype in (np.float16, np.float32)
+    assert not (accum_dtype == np.float16 and fp_dtype == np.float32)
+
+    K = lhs_aval.shape[-1]
+    O = 1 if rhs_aval.ndim == 1 else rhs_aval.shape[0]
+    num_outputs = outaval.size
+    assert num_outputs < 2**16
+    fp_dtype_ipu = from_numpy_dtype_to_ipu_type(fp_dtype).name.lower()
+    accum_dtype_ipu = from_numpy_dtype_to_ipu_type(accum_dtype).name.lower()
+    worker_offsets = make_dot_worker_offsets(num_outputs, outaval.dtype)
+    # Vector unit estimate: 64 bits loads, i.e. 2 (FP32) or 4 (FP16) MACs per cycle.
+    vector_size = 8 // fp_dtype.itemsize
+    perf_estimate = int(np.ceil(num_outputs / 6)) * (K // vector_size + K % vector_size + 10)
+
+    ipu_prim_info = IpuTileMapEquation(
+        vname=f"DotGeneralVectorMac<{fp_dtype_ipu},{accum_dtype_ipu}>",
+        pname=p.name,
+        tiles=tiles,
+        inputs_info=[
+            make_ipu_vertex_in_info("lhs", lhs_aval),
+            make_ipu_vertex_in_info("rhs", rhs_aval),
+            make_ipu_vertex_constant_info("worker_offsets", worker_offsets),
+        ],
+        outputs_info=[make_ipu_vertex_out_info("out", outaval)],
+        attributes_i32=[IpuVertexAttributeI32("K", K), IpuVertexAttributeI32("O", O)],
+        attributes_f32=[],
+        gp_filename=get_dot_vertex_gp_filename(),
+        perf_estimate=perf_estimate,
+    )
+    return ipu_prim_info
+
+
+def ipu_dot_general_plan(
+    lhs_aval: ShapedArray, rhs_aval: ShapedArray, attributes: Dict[str, Any]
+) -> IpuConvVertexType:
+    """IPU `dot_general` planner: choose the fastest IPU vertex supporting the (tile) dot shapes and dtypes.
+
+    Selection order:
+        - `ConvPartial1x1`: AMP unit, (M, K) x (O, K) matmul with K = 8 (FP32) or 16 (FP16)
+            and O a multiple of the number of AMP conv. units;
+        - `ConvPartialHMAC`: HMAC unit, 1d (K,) x (K,) dot product, with K even;
+        - `VectorMac`: vector unit fallback, any 1d or 2d inputs.
+
+    Args:
+        lhs_aval: Lhs (tile) shaped array.
+        rhs_aval: Rhs (tile) shaped array.
+        attributes: Dot general attributes.
+    Returns:
+        IPU vertex type to use.
+    """
+    ((lhs_contracting_dims, rhs_contracting_dims), (lhs_batch_dims, rhs_batch_dims)) = attributes["dimension_numbers"]
+    fp_dtype = np.dtype(lhs_aval.dtype)
+    accum_dtype = np.dtype(attributes.get("preferred_element_type", None) or lhs_aval.dtype)
+    lhs_last_axis = list(lhs_contracting_dims) == [lhs_aval.ndim - 1]
+    rhs_last_axis = list(rhs_contracting_dims) == [rhs_aval.ndim - 1]
+    last_axis_contracting = lhs_last_axis and rhs_last_axis
+    no_batching = len(lhs_batch_dims) == 0 and len(rhs_batch_dims) == 0
+    if not (last_axis_contracting and no_batching and fp_dtype in (np.float16, np.float32)):
+        raise ValueError(f"Unsupported IPU tile `dot_general` configuration: {lhs_aval}, {rhs_aval}, {attributes}.")
+
+    K = lhs_aval.shape[-1]
+    if lhs_aval.ndim == 2 and rhs_aval.ndim == 2:
+        amp_static_args = IpuConvPartial1x1StaticArgs(fp_dtype=fp_dtype, accum_dtype=accum_dtype)
+        amp_in_chans = 8 if fp_dtype == np.float32 else 16
+        if K == amp_in_chans and rhs_aval.shape[0] % amp_static_args.num_conv_units == 0:
+            return IpuConvVertexType.ConvPartial1x1
+    if lhs_aval.ndim == 1 and rhs_aval.ndim == 1 and K % 2 == 0:
+        return IpuConvVertexType.ConvPartialHMAC
+    return IpuConvVertexType.VectorMac
+
+
 def ipu_dot_general_primitive_translation(
     p: Primitive,
     tiles: Tuple[int, ...],
@@ -534,8 +658,9 @@ def ipu_dot_general_primitive_translation(
 ) -> IpuTileMapEquation:
     """IPU `dot_general` primitive translation rule to IPU vertex.
 
-    NOTE: for now, we are restricting the implementation to only support inputs compatible
-    with the IPU optimized AMP vertex (as an incentive for users to write performant tile code!)
+    NOTE: by default, we are restricting the implementation to only support inputs compatible
+    with the IPU optimized AMP vertex (as an incentive for users to write performant tile code!).
+    `IpuConvVertexType.Automatic` is using `ipu_dot_general_plan` to select the fastest supported vertex.
 
     Args:
         p: JAX primitive.
@@ -549,16 +674,113 @@ def ipu_dot_general_primitive_translation(
     assert attributes is not None
     ipu_vertex_type = attributes.get("ipu_vertex_type", IpuConvVertexType.ConvPartial1x1)
     attributes = tile_map_remove_ipu_attributes(attributes)
-    # Default basic automatic rule!
     if ipu_vertex_type == IpuConvVertexType.Automatic:
-        ipu_vertex_type = IpuConvVertexType.ConvPartial1x1
+        ipu_vertex_type = ipu_dot_general_plan(inavals[0], inavals[1], attributes)
 
     if ipu_vertex_type == IpuConvVertexType.ConvPartial1x1:
         return ipu_dot_general_conv_1x1_primitive_translation(p, tiles, inavals, attributes)
     elif ipu_vertex_type == IpuConvVertexType.ConvPartialHMAC:
         return ipu_dot_general_conv_hmac_primitive_translation(p, tiles, inavals, attributes)
+    elif ipu_vertex_type == IpuConvVertexType.VectorMac:
+        return ipu_dot_general_vector_mac_primitive_translation(p, tiles, inavals, attributes)
     raise ValueError(f"Unknown IPU conv/dot vertex: '{ipu_vertex_type}'.")
 
 
 # Register JAX dot_general op for `tile_map``.
 register_ipu_tile_primitive(dot_general_p, ipu_dot_general_primitive_translation)
+
+
+fp8_dot_general_p = Primitive("fp8_dot_general")
+fp8_dot_general_p.map_primitive = False
+
+
+def fp8_dot_general_abstract_eval(
+    lhs: ShapedArray, rhs: ShapedArray, fp8_format: IpuFp8Format, preferred_element_type: Any = None
+) -> ShapedArray:
+    # FP8 data stored as raw bytes.
+    assert lhs.dtype == np.uint8
+    assert rhs.dtype == np.uint8
+    assert lhs.ndim in (1, 2)
+    assert rhs.ndim in (1, 2)
+    assert lhs.shape[-1] == rhs.shape[-1]
+    outdtype = np.dtype(np.float32 if preferred_element_type is None else preferred_element_type)
+    assert outdtype in (np.float16, np.float32)
+    return ShapedArray(lhs.shape[:-1] + rhs.shape[:-1], outdtype)
+
+
+def fp8_dot_general_impl(lhs: Any, rhs: Any, fp8_format: IpuFp8Format, preferred_element_type: Any = None):
+    """FP8 dot general (contracting last axis), JAX NumPy default implementation."""
+    outaval = fp8_dot_general_abstract_eval(lhs, rhs, fp8_format, preferred_element_type)
+    table = jnp.asarray(make_fp8_decode_table(fp8_format))
+    lhs, rhs = table[lhs.astype(np.int32)], table[rhs.astype(np.int32)]
+    return jnp.tensordot(lhs, rhs, axes=([-1], [-1])).astype(outaval.dtype)
+
+
+def fp8_dot_general_translation_ipu(
+    p: Primitive,
+    tiles: Tuple[int, ...],
+    inavals: List[ShapedArray],
+    attributes: Dict[str, Any] = None,
+) -> IpuTileMapEquation:
+    """IPU `fp8_dot_general` primitive translation rule to the (custom) vector unit `DotGeneralFp8VectorMac` vertex."""
+    assert len(inavals) == 2
+    lhs_aval, rhs_aval = inavals
+    outaval = fp8_dot_general_abstract_eval(lhs_aval, rhs_aval, **attributes)
+    K = lhs_aval.shape[-1]
+    O = 1 if rhs_aval.ndim == 1 else rhs_aval.shape[0]
+    num_outputs = outaval.size
+    assert num_outputs < 2**16
+    is_f143 = IpuFp8Format(attributes["fp8_format"]) == IpuFp8Format.F143
+    outdtype_ipu = from_numpy_dtype_to_ipu_type(outaval.dtype).name.lower()
+    worker_offsets = make_dot_worker_offsets(num_outputs, outaval.dtype)
+    # Vector unit estimate: FP8 decoding of lhs and rhs + MAC per element.
+    perf_estimate = int(np.ceil(num_outputs / 6)) * (8 * K + 10)
+
+    return IpuTileMapEquation(
+        vname=f"DotGeneralFp8VectorMac<{outdtype_ipu},{str(is_f143).lower()}>",
+        pname=p.name,
+        tiles=tiles,
+        inputs_info=[
+            make_ipu_vertex_in_info("lhs", lhs_aval),
+            make_ipu_vertex_in_info("rhs", rhs_aval),
+            make_ipu_vertex_constant_info("worker_offsets", worker_offsets),
+        ],
+        outputs_info=[make_ipu_vertex_out_info("out", outaval)],
+        attributes_i32=[IpuVertexAttributeI32("K", K), IpuVertexAttributeI32("O", O)],
+        attributes_f32=[],
+        gp_filename=get_dot_vertex_gp_filename(),
+        perf_estimate=perf_estimate,
+    )
+
+
+fp8_dot_general_p.def_impl(fp8_dot_general_impl)
+fp8_dot_general_p.def_abstract_eval(fp8_dot_general_abstract_eval)
+register_ipu_tile_primitive(fp8_dot_general_p, fp8_dot_general_translation_ipu)
+
+
+def tile_fp8_dot(
+    lhs: TileShardedArray,
+    rhs: TileShardedArray,
+    fp8_format: IpuFp8Format = IpuFp8Format.F143,
+    preferred_element_type: Optional[Any] = np.float32,
+) -> TileShardedArray:
+    """Tile FP8 dot product `lhs @ rhs.T`, contracting on the last axis (FP32 accumulation).
+
+    FP8 inputs are `uint8` raw bytes (see `fp8_encode`), halving memory and exchange
+    compared to FP16 inputs.
+
+    Args:
+        lhs: (T, M, K) or (T, K) FP8 lhs.
+        rhs: (T, O, K) or (T, K) FP8 rhs.
+        fp8_format: FP8 format of inputs.
+        preferred_element_type: Output dtype (float32 or float16).
+    Returns:
+        (T, M, O) tile sharded output (or lower rank with 1d inputs).
+    """
+    return tile_map_primitive(  # type:ignore
+        fp8_dot_general_p,
+        lhs,
+        rhs,
+        fp8_format=IpuFp8Format(fp8_format),
+        preferred_element_type=np.dtype(preferred_element_type),
+    )
@@ -0,0 +1,330 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+"""Fusion of elementwise JAX chains into a single generated IPU tile vertex.
+
+Every unary/binary `tile_map_primitive` call is lowered to its own IPU compute set, output allocation
+and memory pass. `tile_map_fused` traces a JAX function of elementwise ops, and generates a single custom
+MultiVertex (C++ source compiled by Poplar through the `gp_filename` path) evaluating the full chain
+in registers, element by element.
+"""
+import hashlib
+import os
+import tempfile
+from typing import Any, Callable, Dict, List, Sequence, Tuple, Union
+
+import jax
+import numpy as np
+from jax import core, lax
+from jax.core import Primitive, ShapedArray
+
+from .tile_array import TileShardedArray
+from .tile_interpreter import check_tile_mapping_consistency, register_ipu_tile_primitive, tile_map_primitive
+from .tile_interpreter_primitives import (
+    IpuTileMapEquation,
+    get_ipu_type_name,
+    make_ipu_vertex_attributes,
+    make_ipu_vertex_constant_info,
+    make_ipu_vertex_in_info,
+    make_ipu_vertex_out_info,
+)
+from .tile_interpreter_vertex_utils import make_ipu_vector1d_worker_offsets
+
+_fused_supported_dtypes = {np.dtype(np.float16), np.dtype(np.float32)}
+"""Supported fused vertex IO dtypes. All computations are done in FP32.
+"""
+
+_fused_unary_primitive_to_cpp: Dict[Primitive, str] = {
+    lax.abs_p: "std::fabs({0})",
+    lax.ceil_p: "std::ceil({0})",
+    lax.cos_p: "std::cos({0})",
+    lax.exp_p: "std::exp({0})",
+    lax.expm1_p: "std::expm1({0})",
+    lax.floor_p: "std::floor({0})",
+    lax.log_p: "std::log({0})",
+    lax.log1p_p: "std::log1p({0})",
+    lax.neg_p: "-({0})",
+    lax.rsqrt_p: "1.0f / std::sqrt({0})",
+    lax.sin_p: "std::sin({0})",
+    lax.sqrt_p: "std::sqrt({0})",
+    lax.tan_p: "std::tan({0})",
+    lax.tanh_p: "std::tanh({0})",
+}
+"""Mapping from unary JAX primitives to C++ FP32 expression.
+"""
+
+_fused_binary_primitive_to_cpp: Dict[Primitive, str] = {
+    lax.add_p: "{0} + {1}",
+    lax.atan2_p: "std::atan2({0}, {1})",
+    lax.div_p: "{0} / {1}",
+    lax.max_p: "std::fmax({0}, {1})",
+    lax.min_p: "std::fmin({0}, {1})",
+    lax.mul_p: "{0} * {1}",
+    lax.pow_p: "std::pow({0}, {1})",
+    lax.sub_p: "{0} - {1}",
+}
+"""Mapping from binary JAX primitives to C++ FP32 expression.
+"""
+
+_fused_primitive_cycles: Dict[Primitive, int] = {
+    lax.add_p: 1,
+    lax.sub_p: 1,
+    lax.mul_p: 1,
+    lax.neg_p: 1,
+    lax.abs_p: 1,
+    lax.max_p: 1,
+    lax.min_p: 1,
+    lax.convert_element_type_p: 2,
+    lax.integer_pow_p: 2,
+}
+"""Approximate cycle count per element of fused primitives (default: transcendental cost).
+"""
+_fused_primitive_default_cycles: int = 20
+
+_fused_primitive_registry: Dict[str, Primitive] = {}
+"""Registry of fused elementwise primitives, indexed by vertex name (i.e. generated source hash).
+"""
+
+
+def get_fused_vertex_directory() -> str:
+    """Get the directory where generated fused vertex sources are written.
+
+    Can be set with the `JAX_IPU_FUSED_VERTEX_DIR` environment variable (default: system temporary directory).
+    """
+    default_dir = os.path.join(tempfile.gettempdir(), "jax_ipu_fused_vertex")
+    return os.environ.get("JAX_IPU_FUSED_VERTEX_DIR", default_dir)
+
+
+def make_cpp_float_literal(value: Any) -> str:
+    """Make a C++ FP32 literal from a JAX literal value."""
+    value = float(np.float32(value))
+    if not np.isfinite(value):
+        raise ValueError(f"Unsupported non-finite literal '{value}' in fused elementwise vertex.")
+    return f"{repr(value)}f"
+
+
+def make_fused_integer_pow_expr(x: str, y: int) -> str:
+    """Make the C++ expression of `integer_pow`, unrolling multiplications."""
+    if y == 0:
+        return "1.0f"
+    expr = " * ".join([x] * abs(y))
+    return expr if y > 0 else f"1.0f / ({expr})"
+
+
+def make_fused_eqn_cpp_expr(eqn: core.JaxprEqn, args: List[str]) -> str:
+    """Make the C++ FP32 expression corresponding to a JAX elementwise equation."""
+    p = eqn.primitive
+    if p in _fused_unary_primitive_to_cpp:
+        return _fused_unary_primitive_to_cpp[p].format(*args)
+    elif p in _fused_binary_primitive_to_cpp:
+        return _fused_binary_primitive_to_cpp[p].format(*args)
+    elif p is lax.integer_pow_p:
+        return make_fused_integer_pow_expr(args[0], int(eqn.params["y"]))
+    elif p is lax.convert_element_type_p:
+        outdtype = np.dtype(eqn.params["new_dtype"])
+        # Keep the rounding semantics of FP16 intermediate values.
+        return f"float(half({args[0]}))" if outdtype == np.float16 else args[0]
+    raise ValueError(f"Unsupported JAX primitive `{p}` in fused elementwise vertex.")
+
+
+def check_fused_aval(aval: ShapedArray, shape: Tuple[int, ...]):
+    """Check a fused jaxpr variable is supported: same shape as inputs, floating dtype."""
+    if tuple(aval.shape) != tuple(shape):
+        raise ValueError(f"Fused elementwise vertex requires no broadcasting, shapes: {aval.shape} vs {shape}.")
+    if np.dtype(aval.dtype) not in _fused_supported_dtypes:
+        raise TypeError(f"Unsupported dtype '{aval.dtype}' in fused elementwise vertex.")
+
+
+def make_fused_elementwise_vertex(jaxpr: core.Jaxpr) -> Tuple[str, str]:
+    """Generate a fused elementwise IPU vertex from a JAX (tile) jaxpr.
+
+    The generated MultiVertex loops over elements, loading every input once, evaluating the full
+    chain of elementwise ops in FP32 registers, and storing every output once.
+    Work is split between workers in pairs of elements (i.e. 32 bits aligned FP16 stores).
+
+    Args:
+        jaxpr: JAX jaxpr, with only elementwise equations on same shape variables.
+    Returns:
+        (vertex name, C++ vertex source).
+    """
+    if len(jaxpr.constvars) > 0:
+        raise ValueError("Fused elementwise vertex does not support captured constants.")
+    if len(jaxpr.invars) == 0:
+        raise ValueError("Fused elementwise vertex requires at least one input.")
+    shape = tuple(jaxpr.invars[0].aval.shape)
+
+    names: Dict[core.Var, str] = {}
+    fields: List[str] = []
+    body: List[str] = []
+
+    def get_arg_name(v: Any) -> str:
+        if isinstance(v, core.Literal):
+            return make_cpp_float_literal(v.val)
+        return names[v]
+
+    for idx, v in enumerate(jaxpr.invars):
+        check_fused_aval(v.aval, shape)
+        ipu_dtype = get_ipu_type_name(v.aval.dtype)
+        fields.append(f"  Input<Vector<{ipu_dtype}, poplar::VectorLayout::ONE_PTR, 8>> in{idx};")
+        names[v] = f"v{len(names)}"
+        body.append(f"      const float {names[v]} = float(in{idx}[idx]);")
+    for eqn in jaxpr.eqns:
+        if len(eqn.outvars) != 1:
+            raise ValueError(f"Unsupported JAX primitive `{eqn.primitive}` in fused elementwise vertex.")
+        outvar = eqn.outvars[0]
+        check_fused_aval(outvar.aval, shape)
+        expr = make_fused_eqn_cpp_expr(eqn, [get_arg_name(v) for v in eqn.invars])
+        names[outvar] = f"v{len(names)}"
+        body.append(f"      const float {names[outvar]} = {expr};")
+    for idx, v in enumerate(jaxpr.outvars):
+        if isinstance(v, core.Literal):
+            raise ValueError("Fused elementwise vertex does not support literal outputs.")
+        ipu_dtype = get_ipu_type_name(v.aval.dtype)
+        fields.append(f"  Output<Vector<{ipu_dtype}, poplar::VectorLayout::ONE_PTR, 8>> out{idx};")
+        body.append(f"      out{idx}[idx] = {ipu_dtype}({names[v]});")
+
+    # Vertex name based on the generated content => unique codelet.
+    vertex_content = "\n".join(fields + body)
+    vname = "FusedElementwiseVertex_" + hashlib.sha1(vertex_content.encode()).hexdigest()[:16]
+    fields_str = "\n".join(fields)
+    body_str = "\n".join(body)
+    source = f"""// Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+// Generated fused elementwise vertex (see `tile_interpreter_lax_fusion.py`).
+#include <poplar/HalfFloat.hpp>
+#include <poplar/Vertex.hpp>
+
+#include <cmath>
+
+using namespace poplar;
+
+class {vname} : public MultiVertex {{
+ public:
+{fields_str}
+  Input<Vector<unsigned short, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads work size + 1, in pairs of elements.
+
+  const unsigned size;  // number of elements
+
+  bool compute(unsigned wid) {{
+    const unsigned wstart = 2 * worker_offsets[wid];
+    const unsigned wend_pairs = 2 * worker_offsets[wid + 1];
+    const unsigned wend = wend_pairs < size ? wend_pairs : size;
+    for (unsigned idx = wstart; idx < wend; ++idx) {{
+{body_str}
+    }}
+    return true;
+  }}
+}};
+"""
+    return vname, source
+
+
+def get_fused_vertex_gp_filename(vname: str, source: str) -> str:
+    """Write (if necessary) the generated fused vertex source, and return its filename."""
+    dirname = get_fused_vertex_directory()
+    os.makedirs(dirname, exist_ok=True)
+    filename = os.path.join(dirname, f"{vname}.cpp")
+    if not os.path.isfile(filename):
+        # Atomic write, robust to concurrent processes.
+        tmp_filename = f"{filename}.{os.getpid()}.tmp"
+        with open(tmp_filename, "w") as f:
+            f.write(source)
+        os.replace(tmp_filename, filename)
+    return filename
+
+
+def make_fused_worker_offsets(size: int) -> np.ndarray:
+    """Make the fused vertex worker offsets, in pairs of elements."""
+    num_pairs = (size + 1) // 2
+    if num_pairs == 0:
+        return np.zeros((7,), dtype=np.uint16)
+    return make_ipu_vector1d_worker_offsets(num_pairs, vector_size=1, wdtype=np.uint16)
+
+
+def make_fused_elementwise_primitive(jaxpr: core.Jaxpr) -> Primitive:
+    """Make (or get from the registry) the fused elementwise JAX primitive corresponding to a tile jaxpr.
+
+    Args:
+        jaxpr: JAX (tile) jaxpr of elementwise ops.
+    Returns:
+        JAX primitive, registered for IPU tile mapping.
+    """
+    vname, source = make_fused_elementwise_vertex(jaxpr)
+    if vname in _fused_primitive_registry:
+        return _fused_primitive_registry[vname]
+
+    perf_estimate_per_elem = 2 * (len(jaxpr.invars) + len(jaxpr.outvars)) + sum(
+        [_fused_primitive_cycles.get(eqn.primitive, _fused_primitive_default_cycles) for eqn in jaxpr.eqns]
+    )
+    outavals = [ShapedArray(v.aval.shape, v.aval.dtype) for v in jaxpr.outvars]
+
+    p = Primitive(f"fused_elementwise_{vname.split('_')[-1]}")
+    p.map_primitive = False
+    p.multiple_results = len(outavals) > 1
+
+    def p_impl(*args):
+        outputs = core.eval_jaxpr(jaxpr, [], *args)
+        return tuple(outputs) if p.multiple_results else outputs[0]
+
+    def p_abstract_aval(*args, **kwargs):
+        return tuple(outavals) if p.multiple_results else outavals[0]
+
+    def p_tile_translation_ipu(
+        p: Primitive,
+        tiles: Tuple[int, ...],
+        inavals: List[ShapedArray],
+        attributes: Dict[str, Any] = None,
+    ) -> IpuTileMapEquation:
+        """IPU tile translation for the fused elementwise vertex."""
+        assert len(inavals) == len(jaxpr.invars)
+        size = inavals[0].size
+        worker_offsets = make_fused_worker_offsets(size)
+        attrs_i32, attrs_f32 = make_ipu_vertex_attributes(size=size)
+        max_worker_size = 2 * int(np.max(np.diff(worker_offsets.astype(np.int32))))
+        return IpuTileMapEquation(
+            vname=vname,
+            pname=p.name,
+            tiles=tiles,
+            inputs_info=[make_ipu_vertex_in_info(f"in{idx}", aval) for idx, aval in enumerate(inavals)]
+            + [make_ipu_vertex_constant_info("worker_offsets", worker_offsets)],
+            outputs_info=[make_ipu_vertex_out_info(f"out{idx}", aval) for idx, aval in enumerate(outavals)],
+            attributes_i32=attrs_i32,
+            attributes_f32=attrs_f32,
+            gp_filename=get_fused_vertex_gp_filename(vname, source),
+            perf_estimate=max_worker_size * perf_estimate_per_elem + 50,
+        )
+
+    p.def_impl(p_impl)
+    p.def_abstract_eval(p_abstract_aval)
+    register_ipu_tile_primitive(p, p_tile_translation_ipu)
+    _fused_primitive_registry[vname] = p
+    return p
+
+
+def tile_map_fused(
+    fn: Callable[..., Any], *args: TileShardedArray, **kwargs: Any
+) -> Union[TileShardedArray, Sequence[TileShardedArray]]:
+    """Map a fused chain of elementwise JAX ops over tiles, using a single generated IPU vertex.
+
+    Compared to mapping every primitive with `tile_map_primitive`, the fused vertex is using a single
+    compute set, with no intermediate temporary arrays and a single memory pass.
+
+    Supporting (FP16/FP32 inputs & outputs, FP32 compute): add, sub, mul, div, max, min, pow, atan2,
+    abs, neg, exp, expm1, log, log1p, sqrt, rsqrt, sin, cos, tan, tanh, floor, ceil, integer_pow
+    and convert_element_type, with Python scalar literals. All inputs must have the same tile shape.
+
+    Example:
+        out = tile_map_fused(lambda a, x, b: jnp.exp(a * x + b), a, x, b)
+
+    Args:
+        fn: JAX function of elementwise ops, applied on every tile.
+        *args: List of input (tile) sharded arrays.
+        **kwargs: IPU tile map arguments (e.g. `sync`).
+    Returns:
+        Output sharded array(s), following `fn` outputs structure (single array or tuple).
+    """
+    inputs: List[TileShardedArray] = list(args)
+    if not all([isinstance(v, TileShardedArray) for v in inputs]):
+        raise TypeError("Tile map fused inputs must be `TileShardedArray` instances.")
+    check_tile_mapping_consistency(inputs)
+    closed_jaxpr = jax.make_jaxpr(fn)(*[jax.ShapeDtypeStruct(v.tile_shape, v.dtype) for v in inputs])
+    p = make_fused_elementwise_primitive(closed_jaxpr.jaxpr)
+    return tile_map_primitive(p, *inputs, **kwargs)
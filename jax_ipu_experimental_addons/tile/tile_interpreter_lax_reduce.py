@@ -1,19 +1,24 @@
 # Copyright (c) 2022 Graphcore Ltd. All rights reserved.
-from typing import Any, Dict, List, Tuple
+import math
+import os
+from typing import Any, Dict, List, Sequence, Tuple
 
 import numpy as np
 from jax.core import Primitive, ShapedArray
 from jax.lax import reduce_and_p, reduce_max_p, reduce_min_p, reduce_or_p, reduce_prod_p, reduce_sum_p
-from numpy.typing import DTypeLike
+from numpy.typing import DTypeLike, NDArray
 
-from .tile_interpreter import register_ipu_tile_primitive
+from .tile_array import TileShardedArray, tile_put_sharded
+from .tile_interpreter import register_ipu_tile_primitive, tile_map_primitive
 from .tile_interpreter_primitives import (
     IpuTileMapEquation,
     IpuVertexIOType,
     make_ipu_vertex_attributes,
+    make_ipu_vertex_constant_info,
     make_ipu_vertex_io_info,
     make_ipu_vertex_name_templated,
 )
+from .tile_interpreter_vertex_utils import make_ipu_vector1d_worker_offsets
 
 _reduce_primitive_to_basename: Dict[Primitive, str] = {
     reduce_sum_p: "ReduceAdd",
@@ -24,6 +29,23 @@ _reduce_primitive_to_basename: Dict[Primitive, str] = {
     reduce_and_p: "ReduceAnd",
 }
 
+_reduce_primitive_to_general_op: Dict[Primitive, str] = {
+    reduce_sum_p: "ReduceAddOp",
+    reduce_max_p: "ReduceMaxOp",
+    reduce_min_p: "ReduceMinOp",
+    reduce_prod_p: "ReduceMulOp",
+}
+"""Reduce primitives supported by the custom `ReduceGeneralVertex` (FP16/FP32).
+"""
+
+ReduceDims = List[Tuple[int, int]]
+"""Reduce vertex dimensions description: list of (size, stride), innermost dimension last.
+"""
+
+
+def get_reduce_vertex_gp_filename() -> str:
+    return os.path.abspath(os.path.join(os.path.dirname(__file__), "vertex", "tile_reduce_vertex.cpp"))
+
 
 def make_continuous_reduce_vertex_fullname(
     reduce_p: Primitive, partial_dtype: DTypeLike, out_dtype: DTypeLike, is_update: bool = False
@@ -43,6 +65,116 @@ def make_continuous_reduce_vertex_fullname(
     return make_ipu_vertex_name_templated("popops::ContinuousReduce", basename, partial_dtype, out_dtype, is_update)
 
 
+def make_reduce_canonical_dims(shape: Sequence[int], axes: Sequence[int]) -> Tuple[ReduceDims, ReduceDims]:
+    """Make the canonical (kept, reduced) dimensions of a reduction.
+
+    Size one dimensions are removed, and contiguous dimensions of the same kind (kept or reduced)
+    are merged, i.e. `(3, 5, 7, 9)` reduced on axes `(2, 3)` is described as `[(15, 63)], [(63, 1)]`.
+
+    Args:
+        shape: Input shape.
+        axes: Reduced axes.
+    Returns:
+        (kept dims, reduced dims), as (size, stride) lists. Padded with a size one dimension if empty.
+    """
+    strides = [int(np.prod(shape[d + 1 :])) for d in range(len(shape))]
+    groups: List[List[Any]] = []
+    for d, size in enumerate(shape):
+        if size == 1:
+            continue
+        is_reduced = d in axes
+        if len(groups) > 0 and groups[-1][2] == is_reduced:
+            # Contiguous with the previous (outer) dimension: merge.
+            groups[-1][0] *= size
+            groups[-1][1] = strides[d]
+        else:
+            groups.append([size, strides[d], is_reduced])
+    out_dims = [(g[0], g[1]) for g in groups if not g[2]] or [(1, 0)]
+    red_dims = [(g[0], g[1]) for g in groups if g[2]] or [(1, 0)]
+    return out_dims, red_dims
+
+
+def make_reduce_vector_mode(out_dims: ReduceDims, red_dims: ReduceDims, dtype: DTypeLike) -> Tuple[int, int]:
+    """Choose the `ReduceGeneralVertex` vectorization mode and worker grain size.
+
+    Args:
+        out_dims: Kept dimensions.
+        red_dims: Reduced dimensions.
+        dtype: Input dtype.
+    Returns:
+        (vector mode, grain size in output elements).
+    """
+    itemsize = np.dtype(dtype).itemsize
+    vector_size = 8 // itemsize
+    # Minimal grain: 32 bits output stores per worker.
+    scalar_grain = 4 // itemsize
+    if out_dims[-1][1] == 1 and out_dims[-1][0] % vector_size == 0:
+        return 1, vector_size
+    if red_dims[-1][1] == 1 and red_dims[-1][0] % vector_size == 0:
+        return 2, scalar_grain
+    return 0, scalar_grain
+
+
+def make_reduce_worker_offsets(num_outputs: int, grain: int) -> NDArray[np.uint16]:
+    """Make the `ReduceGeneralVertex` worker offsets, in grains of outputs."""
+    num_grains = math.ceil(num_outputs / grain)
+    if num_grains == 0:
+        return np.zeros((7,), dtype=np.uint16)
+    return make_ipu_vector1d_worker_offsets(num_grains, vector_size=1, wdtype=np.uint16)
+
+
+def ipu_reduce_general_translation(
+    p: Primitive, tiles: Tuple[int, ...], inaval: ShapedArray, outaval: ShapedArray, axes: Tuple[int, ...]
+) -> IpuTileMapEquation:
+    """IPU `reduce` translation rule to the custom `ReduceGeneralVertex`, supporting any set of axes.
+
+    Args:
+        p: JAX reduce primitive.
+        tiles: Collection of tiles.
+        inaval: Input shaped array.
+        outaval: Output shaped array.
+        axes: Reduced axes.
+    Returns:
+        IPU tile map primitive structure.
+    """
+    out_dims, red_dims = make_reduce_canonical_dims(inaval.shape, axes)
+    vector_mode, grain = make_reduce_vector_mode(out_dims, red_dims, inaval.dtype)
+    num_outputs = outaval.size
+    worker_offsets = make_reduce_worker_offsets(num_outputs, grain)
+    attrs_i32, attrs_f32 = make_ipu_vertex_attributes(
+        num_out_dims=len(out_dims),
+        num_red_dims=len(red_dims),
+        num_outputs=num_outputs,
+        grain=grain,
+        vector_mode=vector_mode,
+    )
+    # Perf. estimate: outputs per worker x reduction size (vectorized or not).
+    vector_size = 8 // inaval.dtype.itemsize
+    red_size = int(np.prod([d[0] for d in red_dims]))
+    red_cycles = red_size if vector_mode == 0 else math.ceil(red_size / vector_size)
+    worker_outputs = int(np.max(np.diff(worker_offsets.astype(np.int32)))) * grain
+    worker_outputs = math.ceil(worker_outputs / vector_size) if vector_mode == 1 else worker_outputs
+    perf_estimate = worker_outputs * (red_cycles + 12) + 30
+
+    vname = make_ipu_vertex_name_templated("ReduceGeneralVertex", inaval.dtype, _reduce_primitive_to_general_op[p])
+    return IpuTileMapEquation(
+        vname=vname,
+        pname=p.name,
+        tiles=tiles,
+        inputs_info=[
+            make_ipu_vertex_io_info("in", IpuVertexIOType.In, inaval),
+            make_ipu_vertex_constant_info("worker_offsets", worker_offsets),
+            make_ipu_vertex_constant_info("out_dims", np.array(out_dims, dtype=np.uint32)),
+            make_ipu_vertex_constant_info("red_dims", np.array(red_dims, dtype=np.uint32)),
+        ],
+        outputs_info=[make_ipu_vertex_io_info("out", IpuVertexIOType.Out, outaval)],
+        attributes_i32=attrs_i32,
+        attributes_f32=attrs_f32,
+        gp_filename=get_reduce_vertex_gp_filename(),
+        perf_estimate=perf_estimate,
+    )
+
+
 def ipu_reduce_primitive_translation(
     p: Primitive,
     tiles: Tuple[int, ...],
@@ -66,12 +198,16 @@ def ipu_reduce_primitive_translation(
     axes = tuple(sorted(attributes["axes"]))
     assert len(axes) > 0
     first_axis = axes[0]
-    # Only supporting reduction on the last axes for now (i.e. no striding).
+    outaval = p.abstract_eval(*inavals, axes=axes)[0]
+    # Reduction on the last axes (i.e. no striding): Poplar optimized continuous reduce.
     if axes != tuple(range(axes[0], inaval.ndim)):
+        # Any other set of axes: custom general reduce vertex.
+        if p in _reduce_primitive_to_general_op and inaval.dtype in (np.float16, np.float32):
+            return ipu_reduce_general_translation(p, tiles, inaval, outaval, axes)
         raise NotImplementedError(
-            f"IPU tile mapped `{p.name}` only supporting (partial or full) reduction on the last axes."
+            f"IPU tile mapped `{p.name}` only supporting (partial or full) reduction on the last axes "
+            f"for dtype `{inaval.dtype}`."
         )
-    outaval = p.abstract_eval(*inavals, axes=axes)[0]
 
     # Supporting partial reduce (i.e. last dimensions only).
     attrs_i32, attrs_f32 = make_ipu_vertex_attributes(
@@ -93,3 +229,25 @@ def ipu_reduce_primitive_translation(
 # Register all supported JAX reduce ops.
 for p in _reduce_primitive_to_basename.keys():
     register_ipu_tile_primitive(p, ipu_reduce_primitive_translation)
+
+
+def tile_reduce_gather(
+    input: TileShardedArray, reduce_p: Primitive, axes: Sequence[int], tile: int
+) -> TileShardedArray:
+    """Cross-tile reduction: tile reduce, followed by a gather of partials on a single tile and a final reduce.
+
+    Args:
+        input: Tile sharded array.
+        reduce_p: JAX reduce primitive (reduce_sum_p, reduce_max_p, ...).
+        axes: Reduced axes, at the tile level (i.e. excluding the tile axis).
+        tile: Tile on which the final result is stored.
+    Returns:
+        `(1, *out_shape)` array, tile mapped on `tile`, reduced over all input tiles and `axes`.
+    """
+    axes = tuple(axes)
+    partials = input if len(axes) == 0 else tile_map_primitive(reduce_p, input, axes=axes)
+    num_tiles = len(partials.tiles)
+    # Gather all partials on the destination tile (single exchange).
+    gathered = tile_put_sharded(partials.array.reshape((1, num_tiles, *partials.tile_shape)), (tile,))
+    output: TileShardedArray = tile_map_primitive(reduce_p, gathered, axes=(0,))  # type:ignore
+    return output
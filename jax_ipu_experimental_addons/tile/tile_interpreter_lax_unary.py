@@ -2,9 +2,11 @@
 import os
 from typing import Any, Dict, List, Tuple
 
+import numpy as np
 from jax import lax
 from jax._src.lax.lax import copy_p
 from jax.core import Primitive, ShapedArray
+from numpy.typing import NDArray
 
 from jax_ipu_experimental_addons.utils import DTypeLike
 
@@ -15,10 +17,12 @@ from .tile_interpreter_primitives import (
     from_numpy_dtype_to_ipu_type,
     get_ipu_type_name,
     make_ipu_vertex_attributes,
+    make_ipu_vertex_constant_info,
     make_ipu_vertex_in_info,
     make_ipu_vertex_name_templated,
     make_ipu_vertex_out_info,
 )
+from .tile_interpreter_vertex_utils import make_ipu_vector1d_worker_offsets
 
 # popops definition.
 # enum class UnaryOpType {
@@ -219,9 +223,9 @@ def ipu_tile_memcpy(
 ) -> IpuTileMapEquation:
     """IPU `copy` primitive translation rule to IPU vertex.
 
-    TODO: not using Poplar optimized ASM vertex yet. How to do
-    reinterpret_cast to `char` in general case? Custom `TileMemcpy`
-    in the meantime.
+    Custom `TileMemcpy` vertex, splitting the copy between the 6 workers,
+    using 64-bit loads & stores (i.e. avoiding a general `char` reinterpret_cast
+    of the tensors required by Poplar optimized ASM vertex).
 
     Args:
         p: JAX primitive.
@@ -233,6 +237,10 @@ def ipu_tile_memcpy(
     """
     assert len(inavals) == 1
     inaval = inavals[0]
+    # Work split between workers, in 64-bit words. Tail handled by the last worker.
+    nbytes = inaval.size * inaval.dtype.itemsize
+    nwords = nbytes // 8
+    worker_offsets = make_ipu_memcpy_worker_offsets(nwords)
 
     gp_filename = os.path.abspath(os.path.join(os.path.dirname(__file__), "vertex", "tile_prim_vertex.cpp"))
     vname = make_ipu_vertex_name_templated("TileMemcpyVertex", inaval.dtype)
@@ -240,17 +248,33 @@ def ipu_tile_memcpy(
         vname=vname,
         pname=p.name,
         tiles=tiles,
-        inputs_info=[make_ipu_vertex_in_info("in", inaval)],
+        inputs_info=[
+            make_ipu_vertex_in_info("in", inaval),
+            make_ipu_vertex_constant_info("worker_offsets", worker_offsets),
+        ],
         outputs_info=[make_ipu_vertex_out_info("out", inaval)],
         attributes_i32=[],
         attributes_f32=[],
         gp_filename=gp_filename,
-        # Very approximate perf. estimate. TODO: refine, once optimized!
-        perf_estimate=inaval.size * inaval.dtype.itemsize,
+        # Approximate perf. estimate: ld64/st64 per worker + scalar tail.
+        perf_estimate=int(np.max(np.diff(worker_offsets))) * 2 + (nbytes - nwords * 8) + 20,
     )
     return ipu_prim_info
 
 
+def make_ipu_memcpy_worker_offsets(nwords: int) -> NDArray[np.uint16]:
+    """Make the `TileMemcpyVertex` worker offsets, i.e. 64-bit words per worker thread.
+
+    Args:
+        nwords: Number of 64-bit words to copy.
+    Returns:
+        (7,) worker offsets.
+    """
+    if nwords == 0:
+        return np.zeros((7,), dtype=np.uint16)
+    return make_ipu_vector1d_worker_offsets(nwords, vector_size=1, wdtype=np.uint16)
+
+
 register_ipu_tile_primitive(copy_p, ipu_tile_memcpy)
 
 
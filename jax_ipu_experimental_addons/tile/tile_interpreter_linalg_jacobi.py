@@ -1,6 +1,6 @@
 # Copyright (c) 2022 Graphcore Ltd. All rights reserved.
 import os
-from typing import Any, Tuple
+from typing import Any, Optional, Tuple, Union
 
 import jax.lax
 import jax.numpy as jnp
@@ -18,7 +18,7 @@ from .tile_array import (
     tile_put_replicated,
     tile_put_sharded,
 )
-from .tile_interpreter import create_ipu_tile_primitive, tile_map_primitive
+from .tile_interpreter import create_ipu_tile_primitive, tile_map_primitive, tile_pipelined_loop
 from .tile_interpreter_vertex_utils import make_ipu_vector1d_worker_offsets
 
 Array = Any
@@ -38,14 +38,15 @@ jacobi_sym_schur2_p = create_ipu_tile_primitive(
     perf_estimate=200,
 )
 
+# NOTE: columns supported in float32 or float16 storage (FP32 compute + (c, s) values), using 64 bits vectors.
 jacobi_update_first_step_p = create_ipu_tile_primitive(
     "jacobi_update_first_step",
-    "JacobiUpdateFirstStep",
+    "JacobiUpdateFirstStep<{pcol}>",
     inputs=["rotset", "pcol", "qcol"],
     outputs={"cs": ShapedArray((2,), dtype=np.float32), "pcol_updated": 1, "qcol_updated": 2},
     constants={
         "worker_offsets": lambda inavals, *_: make_ipu_vector1d_worker_offsets(
-            inavals[1].size, vector_size=2, wdtype=np.uint16
+            inavals[1].size, vector_size=8 // inavals[1].dtype.itemsize, wdtype=np.uint16
         )
     },
     gp_filename=get_jacobi_vertex_gp_filename(),
@@ -67,14 +68,108 @@ jacobi_update_second_step_p = create_ipu_tile_primitive(
     perf_estimate=200,
 )
 
+jacobi_update_second_step_packed_p = create_ipu_tile_primitive(
+    "jacobi_update_second_step_packed",
+    "JacobiUpdateSecondStepPacked",
+    inputs=["cs_arr", "rotset_packed", "rotset_idx_ignored", "pcol", "qcol"],
+    outputs={"cs_arr": 0, "pcol_updated": 3, "qcol_updated": 4},
+    constants={
+        # Grains of 2 rotations: 64 bits loads of packed indices and (c, s) pairs.
+        "worker_offsets": lambda inavals, *_: make_ipu_vector1d_worker_offsets(
+            inavals[1].size, vector_size=1, wdtype=np.uint16, grain=2
+        )
+    },
+    gp_filename=get_jacobi_vertex_gp_filename(),
+    perf_estimate=200,
+)
+
 jacobi_update_eigenvectors_p = create_ipu_tile_primitive(
     "jacobi_update_eigenvectors",
-    "JacobiUpdateEigenvectors",
+    "JacobiUpdateEigenvectors<{vpcol}>",
     inputs=["cs", "vpcol", "vqcol"],
     outputs={"vpcol_out": 1, "vqcol_out": 2},  # Bug when inplace update?
     constants={
         "worker_offsets": lambda inavals, *_: make_ipu_vector1d_worker_offsets(
-            inavals[1].size, vector_size=2, wdtype=np.uint16
+            inavals[1].size, vector_size=8 // inavals[1].dtype.itemsize, wdtype=np.uint16
+        )
+    },
+    gp_filename=get_jacobi_vertex_gp_filename(),
+    perf_estimate=200,
+)
+
+
+# Block Jacobi primitives: B column pairs per tile, (B, N) shaped p/q columns.
+jacobi_update_first_step_block_p = create_ipu_tile_primitive(
+    "jacobi_update_first_step_block",
+    "JacobiUpdateFirstStepBlock",
+    inputs=["rotset", "pcols", "qcols"],
+    outputs={
+        "cs": lambda inavals, *_: ShapedArray((inavals[0].shape[0], 2), dtype=np.float32),
+        "pcols_updated": 1,
+        "qcols_updated": 2,
+    },
+    constants={
+        "worker_offsets": lambda inavals, *_: make_ipu_vector1d_worker_offsets(
+            inavals[1].shape[-1], vector_size=2, wdtype=np.uint16
+        )
+    },
+    gp_filename=get_jacobi_vertex_gp_filename(),
+    perf_estimate=200,
+)
+
+jacobi_update_second_step_block_p = create_ipu_tile_primitive(
+    "jacobi_update_second_step_block",
+    "JacobiUpdateSecondStepPackedBlock",
+    inputs=["cs_arr", "rotset_packed", "rotset_idx_ignored", "pcols", "qcols"],
+    outputs={"pcols_updated": 3, "qcols_updated": 4},
+    constants={
+        "worker_offsets": lambda inavals, *_: make_ipu_vector1d_worker_offsets(
+            inavals[1].size, vector_size=1, wdtype=np.uint16
+        )
+    },
+    gp_filename=get_jacobi_vertex_gp_filename(),
+    perf_estimate=200,
+)
+
+jacobi_update_eigenvectors_block_p = create_ipu_tile_primitive(
+    "jacobi_update_eigenvectors_block",
+    "JacobiUpdateEigenvectorsBlock",
+    inputs=["cs", "vpcols", "vqcols"],
+    outputs={"vpcols_out": 1, "vqcols_out": 2},
+    constants={
+        "worker_offsets": lambda inavals, *_: make_ipu_vector1d_worker_offsets(
+            inavals[1].shape[-1], vector_size=2, wdtype=np.uint16
+        )
+    },
+    gp_filename=get_jacobi_vertex_gp_filename(),
+    perf_estimate=200,
+)
+
+
+jacobi_offdiag_norm_square_p = create_ipu_tile_primitive(
+    "jacobi_offdiag_norm_square",
+    "JacobiOffDiagNormSquare",
+    inputs=["rotset", "pcols", "qcols"],
+    outputs={"norm_partials": ShapedArray((6,), dtype=np.float32)},
+    constants={
+        "worker_offsets": lambda inavals, *_: make_ipu_vector1d_worker_offsets(
+            inavals[1].shape[-1], vector_size=2, wdtype=np.uint16
+        )
+    },
+    gp_filename=get_jacobi_vertex_gp_filename(),
+    perf_estimate=200,
+)
+
+
+# Batched Jacobi eigh: full decomposition of every tile local (small) matrix.
+jacobi_eigh_batched_p = create_ipu_tile_primitive(
+    "jacobi_eigh_batched",
+    "JacobiEighBatched",
+    inputs=["A"],
+    outputs={"A": 0, "V": 0},
+    constants={
+        "worker_offsets": lambda inavals, *_: make_ipu_vector1d_worker_offsets(
+            inavals[0].shape[0], vector_size=1, wdtype=np.uint16
         )
     },
     gp_filename=get_jacobi_vertex_gp_filename(),
@@ -112,6 +207,16 @@ def jacobi_sort_rotation_set(rotset: NDArray[np.uint32]) -> NDArray[np.uint32]:
     return np.stack([pindices, qindices], axis=-1)
 
 
+def jacobi_pack_rotation_set(rotset: NDArray[np.uint32]) -> NDArray[np.uint32]:
+    """Pack the (sorted) Jacobi rotation set (N/2, 2) into (N/2,) 32 bits values `p | q << 16`.
+
+    Used by the `JacobiUpdateSecondStepPacked` vertex, loading the (p, q) indices in a single load.
+    """
+    rotset = np.asarray(rotset, dtype=np.uint32)
+    assert np.all(rotset < 2**16)
+    return rotset[:, 0] | (rotset[:, 1] << 16)
+
+
 def ipu_jacobi_eigh_iteration(all_AV_cols: Tuple[Array, ...], Atiles: Any, Vtiles: Any) -> Tuple[Array, ...]:
     """IPU Eigen decomposition: single iteration of the Jacobi algorithm.
 
@@ -143,7 +248,7 @@ def ipu_jacobi_eigh_iteration(all_AV_cols: Tuple[Array, ...], Atiles: Any, Vtile
         # Sorted rotation set: p < q indices.
         rotset_sorted = jacobi_sort_rotation_set(rotset)
         # On tile constant rotation set tensor building.
-        rotset_replicated = tile_constant_replicated(rotset_sorted, tiles=Atiles)
+        rotset_packed_replicated = tile_constant_replicated(jacobi_pack_rotation_set(rotset_sorted), tiles=Atiles)
         rotset_sharded = tile_constant_sharded(rotset_sorted, tiles=Atiles)
 
         # Compute Schur decomposition + on-tile update of columns.
@@ -157,13 +262,12 @@ def ipu_jacobi_eigh_iteration(all_AV_cols: Tuple[Array, ...], Atiles: Any, Vtile
 
         # Second Jacobi update step.
         cs_replicated, Apcols, Aqcols = tile_map_primitive(  # type:ignore
-            jacobi_update_second_step_p,
+            jacobi_update_second_step_packed_p,
             cs_replicated,
-            rotset_replicated,
+            rotset_packed_replicated,
             rotset_index_ignored,
             Apcols,
             Aqcols,
-            halfN=halfN,
         )
         # Jacobi eigenvectors update step.
         Vpcols, Vqcols = tile_map_primitive(  # type:ignore
@@ -185,23 +289,202 @@ def ipu_jacobi_eigh_iteration(all_AV_cols: Tuple[Array, ...], Atiles: Any, Vtile
     return (Apcols.array, Aqcols.array, Vpcols.array, Vqcols.array)
 
 
-def ipu_jacobi_eigh(x: Array, num_iters: int = 1) -> Tuple[Array, Array]:
+def ipu_jacobi_eigh_pipelined_iteration(all_AV_cols: Tuple[Array, ...], Atiles: Any, Vtiles: Any) -> Tuple[Array, ...]:
+    """IPU Eigen decomposition: single iteration of the Jacobi algorithm, software pipelined.
+
+    Same result as `ipu_jacobi_eigh_iteration`, with columns split between the A half (lead stage)
+    and the V half (lag stage) of the tiles: eigenvectors updates and rotations are running one step
+    behind, with the eigenvectors update grouped with the A first Jacobi update step in a single
+    compute set. A and V tiles are only synced once per iteration.
+
+    Note: the V columns rotation, the Schur decompositions exchange and the A second Jacobi update step
+    (part of the lead exchange function, as it requires the replicated Schur decompositions) are
+    separate sequential tile ops: only the eigenvectors update compute is grouped with another stage.
+
+    Args:
+        all_AV_cols: A and V matrices p/q columns.
+        Atiles: A matrix tiles.
+        Vtiles: V matrix tiles.
+    Returns:
+        Tuple of updated A and V matrices p/q columns.
+    """
+    Apcols, Aqcols, Vpcols, Vqcols = all_AV_cols
+    N = Apcols.shape[-1]
+    halfN = N // 2
+    Apcols = tile_put_sharded(Apcols, tiles=Atiles)
+    Aqcols = tile_put_sharded(Aqcols, tiles=Atiles)
+    Vpcols = tile_put_sharded(Vpcols, tiles=Vtiles)
+    Vqcols = tile_put_sharded(Vqcols, tiles=Vtiles)
+    rotset_index_ignored = tile_constant_sharded(np.arange(0, halfN, dtype=np.uint32), tiles=Atiles)
+    # All (static) rotation sets of the sweep.
+    rotsets = [jacobi_initial_rotation_set(N)]
+    for _ in range(2, N):
+        rotsets.append(jacobi_next_rotation_set(rotsets[-1]))
+
+    def lead_compute_fn(k, Acols):
+        rotset_sharded = tile_constant_sharded(jacobi_sort_rotation_set(rotsets[k]), tiles=Atiles)
+        return (jacobi_update_first_step_p, [rotset_sharded, *Acols], {"N": N})
+
+    def lead_exchange_fn(k, Acols, outputs):
+        cs_per_tile, Apcols, Aqcols = outputs
+        rotset_packed = jacobi_pack_rotation_set(jacobi_sort_rotation_set(rotsets[k]))
+        rotset_packed_replicated = tile_constant_replicated(rotset_packed, tiles=Atiles)
+        cs_replicated = tile_put_replicated(cs_per_tile.array, tiles=Atiles)
+        # Schur decomposition message to V tiles (new tensor every step).
+        cs_Vtiles = tile_put_sharded(cs_per_tile.array, tiles=Vtiles)
+        _, Apcols, Aqcols = tile_map_primitive(  # type:ignore
+            jacobi_update_second_step_packed_p,
+            cs_replicated,
+            rotset_packed_replicated,
+            rotset_index_ignored,
+            Apcols,
+            Aqcols,
+        )
+        return tile_rotate_columns(Apcols, Aqcols, rotsets[k]), cs_Vtiles
+
+    def lag_compute_fn(k, Vcols, cs_Vtiles):
+        return (jacobi_update_eigenvectors_p, [cs_Vtiles, *Vcols], {})
+
+    def lag_exchange_fn(k, Vcols, outputs):
+        return tile_rotate_columns(*outputs, rotsets[k])
+
+    (Apcols, Aqcols), (Vpcols, Vqcols) = tile_pipelined_loop(
+        N - 1, lead_compute_fn, lead_exchange_fn, lag_compute_fn, lag_exchange_fn, (Apcols, Aqcols), (Vpcols, Vqcols)
+    )
+    # Sync. A and V tiles once per iteration.
+    Apcols, Aqcols, Vpcols, Vqcols = tile_data_barrier(Apcols, Aqcols, Vpcols, Vqcols)
+    return (Apcols.array, Aqcols.array, Vpcols.array, Vqcols.array)
+
+
+def ipu_jacobi_eigh_block_iteration(
+    all_AV_cols: Tuple[Array, ...], Atiles: Any, Vtiles: Any, block_size: int
+) -> Tuple[Array, ...]:
+    """IPU Eigen decomposition: single iteration of the block Jacobi algorithm.
+
+    Same as `ipu_jacobi_eigh_iteration`, with every tile holding a block of `block_size`
+    contiguous column pairs: Schur decompositions and rotations are applied on tile
+    for all pairs in a block, and only block boundary columns are exchanged between tiles.
+
+    Args:
+        all_AV_cols: A and V matrices p/q columns, (N/2, N) shaped.
+        Atiles: A matrix tiles (N / (2 * block_size) tiles).
+        Vtiles: V matrix tiles (N / (2 * block_size) tiles).
+        block_size: Number of column pairs per tile.
+    Returns:
+        Tuple of updated A and V matrices p/q columns.
+    """
+    Apcols, Aqcols, Vpcols, Vqcols = all_AV_cols
+    N = Apcols.shape[-1]
+    halfN = N // 2
+    num_tiles = halfN // block_size
+    assert len(Atiles) == num_tiles
+    assert len(Vtiles) == num_tiles
+
+    def to_block_cols(cols: Array, tiles: Any) -> TileShardedArray:
+        return tile_put_sharded(cols.reshape((num_tiles, block_size, N)), tiles=tiles)
+
+    Apcols, Aqcols = to_block_cols(Apcols, Atiles), to_block_cols(Aqcols, Atiles)
+    Vpcols, Vqcols = to_block_cols(Vpcols, Vtiles), to_block_cols(Vqcols, Vtiles)
+    # Constant tensor of indices to ignore (per column pair) at every iteration.
+    rotset_index_ignored = tile_constant_sharded(
+        np.arange(0, halfN, dtype=np.uint32).reshape((num_tiles, block_size)), tiles=Atiles
+    )
+    rotset = jacobi_initial_rotation_set(N)
+
+    # All different size 2 partitions on columns.
+    for _ in range(1, N):
+        rotset_sorted = jacobi_sort_rotation_set(rotset)
+        rotset_packed_replicated = tile_constant_replicated(jacobi_pack_rotation_set(rotset_sorted), tiles=Atiles)
+        rotset_sharded = tile_constant_sharded(rotset_sorted.reshape((num_tiles, block_size, 2)), tiles=Atiles)
+
+        # Compute Schur decompositions + on-tile update of block columns.
+        cs_per_tile, Apcols, Aqcols = tile_map_primitive(  # type:ignore
+            jacobi_update_first_step_block_p, rotset_sharded, Apcols, Aqcols, N=N, num_blocks=block_size
+        )
+        # Replicate Schur decompositions across all A tiles: (2*N//2) comms.
+        cs_replicated = tile_put_replicated(cs_per_tile.array.reshape((halfN, 2)), tiles=Atiles)
+        cs_Vtiles = tile_put_sharded(cs_per_tile.array, tiles=Vtiles)
+
+        # Second Jacobi update step.
+        Apcols, Aqcols = tile_map_primitive(  # type:ignore
+            jacobi_update_second_step_block_p,
+            cs_replicated,
+            rotset_packed_replicated,
+            rotset_index_ignored,
+            Apcols,
+            Aqcols,
+            N=N,
+            num_blocks=block_size,
+        )
+        # Jacobi eigenvectors update step.
+        Vpcols, Vqcols = tile_map_primitive(  # type:ignore
+            jacobi_update_eigenvectors_block_p, cs_Vtiles, Vpcols, Vqcols, N=N, num_blocks=block_size
+        )
+
+        Apcols, Aqcols, Vpcols, Vqcols = tile_data_barrier(Apcols, Aqcols, Vpcols, Vqcols)
+        # Move columns: only block boundary columns are exchanged between tiles.
+        Apcols, Aqcols = tile_rotate_block_columns(Apcols, Aqcols, rotset)
+        Vpcols, Vqcols = tile_rotate_block_columns(Vpcols, Vqcols, rotset)
+        rotset = jacobi_next_rotation_set(rotset)
+
+    return tuple([v.array.reshape((halfN, N)) for v in (Apcols, Aqcols, Vpcols, Vqcols)])
+
+
+def ipu_jacobi_offdiag_norm(all_AV_cols: Tuple[Array, ...], Atiles: Any, block_size: int = 1) -> Array:
+    """IPU Jacobi algorithm: off-diagonal Frobenius norm of the A matrix.
+
+    Partial sums of squares are computed on every A tile, followed by a cross-tile reduction.
+
+    Args:
+        all_AV_cols: A and V matrices p/q columns, (N/2, N) shaped, in the initial rotation set order.
+        Atiles: A matrix tiles.
+        block_size: Number of column pairs per tile.
+    Returns:
+        Off-diagonal norm (scalar).
+    """
+    Apcols, Aqcols = all_AV_cols[0], all_AV_cols[1]
+    N = Apcols.shape[-1]
+    num_tiles = N // (2 * block_size)
+    Apcols = tile_put_sharded(Apcols.reshape((num_tiles, block_size, N)), tiles=Atiles)
+    Aqcols = tile_put_sharded(Aqcols.reshape((num_tiles, block_size, N)), tiles=Atiles)
+    rotset = tile_constant_sharded(jacobi_initial_rotation_set(N).reshape((num_tiles, block_size, 2)), tiles=Atiles)
+    norm_partials = tile_map_primitive(  # type:ignore
+        jacobi_offdiag_norm_square_p, rotset, Apcols, Aqcols, N=N, num_blocks=block_size
+    )
+    return jnp.sqrt(jnp.sum(norm_partials.array))
+
+
+def ipu_jacobi_eigh(
+    x: Array, num_iters: int = 1, block_size: int = 1, tol: Optional[float] = None, pipelined: bool = False
+) -> Union[Tuple[Array, Array], Tuple[Array, Array, Array]]:
     """IPU Eigen decomposition, implemented using Jacobi algorithm.
 
     Args:
         x: Symmetric matrix.
+        num_iters: Number of Jacobi sweeps (maximum number when `tol` is set).
+        block_size: Number of column pairs per tile. Block Jacobi (`block_size > 1`) is
+            using N / block_size tiles, and reducing the inter-tile exchange accordingly.
+        tol: Optional convergence tolerance. When set, sweeps are stopped (in a `while_loop`)
+            once the off-diagonal norm of A is smaller than `tol * norm(x)`.
+        pipelined: Software pipelined Jacobi iterations, grouping V tiles update with A tiles
+            compute in single compute sets (`block_size == 1` only).
     Returns:
-        (eigenvectors (N, N), eigenvalues (N,))
+        (eigenvectors (N, N), eigenvalues (N,)), with the number of sweeps performed
+        appended when `tol` is set.
     """
     assert x.ndim == 2
     assert x.shape[0] == x.shape[1]
     N = x.shape[0]
     assert N % 2 == 0
-    assert N <= 1024
     halfN = N // 2
-
-    Atiles = tuple(range(0, halfN))
-    Vtiles = tuple(range(halfN, 2 * halfN))
+    assert block_size >= 1
+    assert halfN % block_size == 0
+    num_tiles = halfN // block_size
+    assert 2 * num_tiles <= 1024
+    assert not pipelined or block_size == 1
+
+    Atiles = tuple(range(0, num_tiles))
+    Vtiles = tuple(range(num_tiles, 2 * num_tiles))
     # Initial "eigenvalues" matrix.
     Apcols = jax.lax.slice_in_dim(x, 0, N, stride=2)
     Aqcols = jax.lax.slice_in_dim(x, 1, N, stride=2)
@@ -210,11 +493,35 @@ def ipu_jacobi_eigh(x: Array, num_iters: int = 1) -> Tuple[Array, Array]:
     Vqcols = np.identity(N)[1::2]
 
     # Set A and V tiling static.
-    eigh_iteration_fn = lambda _, x: ipu_jacobi_eigh_iteration(x, Atiles, Vtiles)
-    # JAX fori_loop => no Python unrolling and code bloating!
-    Apcols, Aqcols, Vpcols, Vqcols = jax.lax.fori_loop(
-        0, num_iters, eigh_iteration_fn, (Apcols, Aqcols, Vpcols, Vqcols)
-    )
+    if pipelined:
+        eigh_iteration_fn = lambda _, x: ipu_jacobi_eigh_pipelined_iteration(x, Atiles, Vtiles)
+    elif block_size == 1:
+        eigh_iteration_fn = lambda _, x: ipu_jacobi_eigh_iteration(x, Atiles, Vtiles)
+    else:
+        eigh_iteration_fn = lambda _, x: ipu_jacobi_eigh_block_iteration(x, Atiles, Vtiles, block_size)
+    num_sweeps = None
+    if tol is None:
+        # JAX fori_loop => no Python unrolling and code bloating!
+        Apcols, Aqcols, Vpcols, Vqcols = jax.lax.fori_loop(
+            0, num_iters, eigh_iteration_fn, (Apcols, Aqcols, Vpcols, Vqcols)
+        )
+    else:
+        # Frobenius norm invariant under orthogonal similarity transforms.
+        norm_tol = tol * jnp.linalg.norm(x)
+
+        def eigh_cond_fn(state):
+            idx, offdiag_norm, _ = state
+            return jnp.logical_and(idx < num_iters, offdiag_norm > norm_tol)
+
+        def eigh_body_fn(state):
+            idx, _, all_AV_cols = state
+            all_AV_cols = eigh_iteration_fn(idx, all_AV_cols)
+            return (idx + 1, ipu_jacobi_offdiag_norm(all_AV_cols, Atiles, block_size), all_AV_cols)
+
+        all_AV_cols = (Apcols, Aqcols, Vpcols, Vqcols)
+        init_state = (jnp.int32(0), ipu_jacobi_offdiag_norm(all_AV_cols, Atiles, block_size), all_AV_cols)
+        num_sweeps, _, all_AV_cols = jax.lax.while_loop(eigh_cond_fn, eigh_body_fn, init_state)
+        Apcols, Aqcols, Vpcols, Vqcols = all_AV_cols
 
     # Expect the output to follow the initial rotation set columns split.
     rotset = jacobi_initial_rotation_set(N)
@@ -230,6 +537,8 @@ def ipu_jacobi_eigh(x: Array, num_iters: int = 1) -> Tuple[Array, Array]:
 
     A = jax.lax.concatenate(Aresult_rows, dimension=0)
     VT = jax.lax.concatenate(Vresult_cols, dimension=0)
+    if num_sweeps is not None:
+        return A, VT, num_sweeps
     return A, VT
 
 
@@ -287,8 +596,39 @@ def tile_rotate_columns(
     return all_cols_updated[:halfN], all_cols_updated[halfN:]
 
 
+def tile_rotate_block_columns(
+    pcols: TileShardedArray, qcols: TileShardedArray, rotset: NDArray[np.uint32]
+) -> Tuple[TileShardedArray, TileShardedArray]:
+    """Rotate block columns (T, B, N) between tiles, using the same static `tile_gather` as `tile_rotate_columns`.
+
+    Block columns are seen as (T*B, N) sharded arrays with every tile repeated B times: columns
+    staying on the same tile are not exchanged, and only block boundary columns are moved between tiles.
+    """
+    assert pcols.shape == qcols.shape
+    assert pcols.tiles == qcols.tiles
+    num_tiles, block_size, N = pcols.shape
+    halfN = num_tiles * block_size
+    # Flatten representation, with repeated tiles.
+    flat_tiles = tuple([t for t in pcols.tiles for _ in range(block_size)])
+    flat_pcols = TileShardedArray(pcols.array.reshape((halfN, N)), flat_tiles)
+    flat_qcols = TileShardedArray(qcols.array.reshape((halfN, N)), flat_tiles)
+    flat_pcols, flat_qcols = tile_rotate_columns(flat_pcols, flat_qcols, rotset)
+    return (
+        TileShardedArray(flat_pcols.array.reshape(pcols.shape), pcols.tiles),
+        TileShardedArray(flat_qcols.array.reshape(qcols.shape), qcols.tiles),
+    )
+
+
 def ipu_eigh(
-    x: Array, *, lower: bool = True, symmetrize_input: bool = False, sort_eigenvalues: bool = True, num_iters: int = 1
+    x: Array,
+    *,
+    lower: bool = True,
+    symmetrize_input: bool = False,
+    sort_eigenvalues: bool = True,
+    num_iters: int = 1,
+    block_size: int = 1,
+    tol: Optional[float] = None,
+    pipelined: bool = False,
 ) -> Tuple[Array, Array]:
     """IPU (optimized) eigh implementation.
 
@@ -297,6 +637,10 @@ def ipu_eigh(
         lower: Not supported.
         symmetrize_input: Not supported, must be false.
         sort_eigenvalues: Sort in ascending order.
+        num_iters: Number of Jacobi sweeps.
+        block_size: Number of column pairs per tile (block Jacobi when > 1).
+        tol: Optional convergence tolerance, stopping Jacobi sweeps early (`num_iters` maximum).
+        pipelined: Software pipelined Jacobi iterations (see `ipu_jacobi_eigh_pipelined_iteration`).
     Returns:
         Tuple of eigenvectors (N, N), eigenvalues (N,)
     """
@@ -304,10 +648,14 @@ def ipu_eigh(
     assert x.shape[0] == x.shape[1]
     N = x.shape[0]
     assert N % 2 == 0
-    assert N <= 1024
+    if N // block_size > 1024:
+        raise ValueError(
+            f"IPU eigh of size {N} requires {N // block_size} tiles (at most 1024), "
+            f"please use a `block_size` >= {N // 1024}."
+        )
     assert not symmetrize_input
 
-    A, VT = ipu_jacobi_eigh(x, num_iters=num_iters)
+    A, VT, *_ = ipu_jacobi_eigh(x, num_iters=num_iters, block_size=block_size, tol=tol, pipelined=pipelined)
     eigvalues = jnp.diag(A)
     eigvectors_tr = VT
     # Sorting eigen values.
@@ -318,5 +666,41 @@ def ipu_eigh(
 
     # TODO: understand memory layout bug when not forcing the data to be re-organized.
     # Is it related to host rearrangement?
-    eigvectors = tile_put_sharded(eigvectors_tr.T, tiles=tuple(range(N)))
-    return eigvectors.array, eigvalues
+    # Blocks of `block_size` rows per tile, i.e. at most 1024 tiles used (as in Jacobi sweeps).
+    num_tiles = N // block_size
+    eigvectors = tile_put_sharded(eigvectors_tr.T.reshape((num_tiles, block_size, N)), tiles=tuple(range(num_tiles)))
+    return eigvectors.array.reshape((N, N)), eigvalues
+
+
+def ipu_eigh_batched(
+    x: Array, *, sort_eigenvalues: bool = True, num_sweeps: int = 10, matrices_per_tile: int = 1
+) -> Tuple[Array, Array]:
+    """IPU batched eigh of small symmetric matrices, with whole matrices mapped on tiles.
+
+    Every tile is running the full Jacobi algorithm on its `matrices_per_tile` matrices,
+    distributed between the 6 worker threads: throughput scales with the number of tiles.
+
+    Args:
+        x: Batch of symmetric matrices (M, N, N), with `M % matrices_per_tile == 0`.
+        sort_eigenvalues: Sort in ascending order.
+        num_sweeps: Number of (cyclic) Jacobi sweeps.
+        matrices_per_tile: Number of matrices per tile.
+    Returns:
+        Tuple of eigenvectors (M, N, N), eigenvalues (M, N)
+    """
+    assert x.ndim == 3
+    assert x.shape[1] == x.shape[2]
+    M, N = x.shape[0], x.shape[1]
+    assert M % matrices_per_tile == 0
+    num_tiles = M // matrices_per_tile
+    tiles = tuple(range(num_tiles))
+
+    A = tile_put_sharded(x.reshape((num_tiles, matrices_per_tile, N, N)), tiles)
+    A, V = tile_map_primitive(jacobi_eigh_batched_p, A, N=N, num_sweeps=num_sweeps)  # type:ignore
+    eigvalues = jnp.diagonal(A.array.reshape((M, N, N)), axis1=1, axis2=2)
+    eigvectors = V.array.reshape((M, N, N))
+    if sort_eigenvalues:
+        indices = jax.lax.broadcasted_iota(np.int32, eigvalues.shape, 1)
+        eigvalues, indices = jax.lax.sort_key_val(eigvalues, indices, dimension=1)
+        eigvectors = jnp.take_along_axis(eigvectors, indices[:, None, :], axis=2)
+    return eigvectors, eigvalues
@@ -17,14 +17,15 @@ def get_qr_vertex_gp_filename() -> str:
     return os.path.join(os.path.dirname(__file__), "vertex", "tile_qr_vertex.cpp")
 
 
+# NOTE: x and y supported in float32 or float16 storage (FP32 accumulation), using 64 bits vectors.
 dot_product1d_p = create_ipu_tile_primitive(
     "dot_product1d",
-    "DotProduct1dVertex",
+    "DotProduct1dVertex<{x}>",
     inputs=["x", "y"],
     outputs={"partials": ShapedArray((12,), dtype=np.float32)},
     constants={
         "worker_offsets": lambda inavals, *_: make_ipu_vector1d_worker_offsets(
-            inavals[0].size, vector_size=2, num_workers=6, wdtype=np.uint16
+            inavals[0].size, vector_size=8 // inavals[0].dtype.itemsize, num_workers=6, wdtype=np.uint16
         )
     },
     # tmp_space=ShapedArray((12,), dtype=np.float32),
@@ -43,16 +44,84 @@ qr_correction_vector_p = create_ipu_tile_primitive(
     perf_estimate=1000,
 )
 
+"""Vertices computing QR correction vector in two steps (no worker spin-wait): partial norms + finalize.
+"""
+qr_correction_vector_partial_p = create_ipu_tile_primitive(
+    "qr_correction_vector_partial",
+    "QRCorrectionVectorPartialVertex",
+    inputs=["Rcol"],
+    outputs={"v": 0, "partials": ShapedArray((6,), dtype=np.float32)},
+    gp_filename=get_qr_vertex_gp_filename(),
+    perf_estimate=1000,
+)
+qr_correction_vector_finalize_p = create_ipu_tile_primitive(
+    "qr_correction_vector_finalize",
+    "QRCorrectionVectorFinalizeVertex",
+    inputs=["Rcol", "sdiag", "partials", "v"],
+    outputs={"v": 3, "vrescale": ShapedArray((1,), dtype=np.float32)},
+    gp_filename=get_qr_vertex_gp_filename(),
+    perf_estimate=100,
+)
+
+
+def ipu_qr_correction_vector(
+    Rcol: TileShardedArray, sdiag: TileShardedArray, col_idx: int, split: bool = False
+) -> Tuple[TileShardedArray, TileShardedArray]:
+    """IPU QR correction vector.
+
+    Args:
+        Rcol: R column.
+        sdiag: R diagonal sign.
+        col_idx: R column index.
+        split: Use the two steps (partial norms + finalize) vertices, without static worker
+            shared state. Deterministic, and supporting multiple instances per tile.
+    Returns:
+        (v, vrescale) correction vector and rescaling factor.
+    """
+    if not split:
+        return tile_map_primitive(qr_correction_vector_p, Rcol, sdiag, col_idx=col_idx)  # type:ignore
+    v, partials = tile_map_primitive(qr_correction_vector_partial_p, Rcol, col_idx=col_idx)  # type:ignore
+    return tile_map_primitive(qr_correction_vector_finalize_p, Rcol, sdiag, partials, v, col_idx=col_idx)  # type:ignore
+
+
 """Vertex QR HouseHolder performing row inplace update: x -= scale1[0] * scale2[0] * v
+
+x and v supported in float32 or float16 storage, with float32 scaling factors.
 """
-qr_householder_row_update_p = create_ipu_tile_primitive(
-    "qr_householder_row_update",
-    "QRHouseholderRowUpdateVertex",
-    inputs=["x", "v", "scale1", "scale2"],
-    outputs={"x": 0},
+def make_qr_householder_row_update_primitive(name: str, bundled: bool):
+    """Make a QR Householder row update primitive, with bundled (default) or unbundled inner loop."""
+    return create_ipu_tile_primitive(
+        name,
+        f"QRHouseholderRowUpdateVertex<{{x}},{str(bundled).lower()}>",
+        inputs=["x", "v", "scale1", "scale2"],
+        outputs={"x": 0},
+        constants={
+            "worker_offsets": lambda inavals, *_: make_ipu_vector1d_worker_offsets(
+                inavals[1].size, vector_size=8 // inavals[1].dtype.itemsize, wdtype=np.uint16
+            )
+        },
+        gp_filename=get_qr_vertex_gp_filename(),
+        perf_estimate=1000,
+    )
+
+
+qr_householder_row_update_p = make_qr_householder_row_update_primitive("qr_householder_row_update", bundled=True)
+# Unbundled inner loop reference, only supporting FP32 (benchmarking comparison point).
+qr_householder_row_update_unbundled_p = make_qr_householder_row_update_primitive(
+    "qr_householder_row_update_unbundled", bundled=False
+)
+
+
+"""Vertex running the full Householder QR on every tile local (small) matrix: R inplace, and Q.
+"""
+qr_householder_batched_p = create_ipu_tile_primitive(
+    "qr_householder_batched",
+    "QRHouseholderBatchedVertex",
+    inputs=["R"],
+    outputs={"R": 0, "Q": 0},
     constants={
         "worker_offsets": lambda inavals, *_: make_ipu_vector1d_worker_offsets(
-            inavals[1].size, vector_size=2, wdtype=np.uint16
+            inavals[0].shape[0], vector_size=1, wdtype=np.uint16
         )
     },
     gp_filename=get_qr_vertex_gp_filename(),
@@ -84,7 +153,7 @@ def ipu_qr_shard_inputs(x: Array, xsdiag: Array) -> Tuple[TileShardedArray, Tile
 
 
 def ipu_qr_iterations(
-    Q: TileShardedArray, RT: TileShardedArray, sdiag_full: TileShardedArray
+    Q: TileShardedArray, RT: TileShardedArray, sdiag_full: TileShardedArray, split_correction_vector: bool = False
 ) -> Tuple[TileShardedArray, TileShardedArray]:
     """IPU QR algorithm iterations.
 
@@ -92,6 +161,7 @@ def ipu_qr_iterations(
         Q: Initial Q sharded array.
         RT: Initial R.T sharded array.
         sdiag_full: Diagonal sign (replicated).
+        split_correction_vector: Compute the correction vector in two steps, without worker spin-wait.
     Returns:
         (Q, RT) after N-1 iterations.
     """
@@ -108,7 +178,7 @@ def ipu_qr_iterations(
         Rcol = RT[cidx]
         sdiag = sdiag_full[cidx]
         # Correction vector. NOTE: computed on a single tile, changing at every loop.
-        v, vrescale = tile_map_primitive(qr_correction_vector_p, Rcol, sdiag, col_idx=cidx)  # type:ignore
+        v, vrescale = ipu_qr_correction_vector(Rcol, sdiag, col_idx=cidx, split=split_correction_vector)
 
         # Replicate to all Q and R tiles.
         vQ = tile_put_replicated(v.array[0], Q_tiles)
@@ -137,7 +207,7 @@ def ipu_qr_iterations(
     return (Q, RT)
 
 
-def ipu_qr(x: Array, xsdiag: Array) -> Tuple[Array, Array]:
+def ipu_qr(x: Array, xsdiag: Array, split_correction_vector: bool = False) -> Tuple[Array, Array]:
     """IPU implementation of the QR algorithm.
 
     This implementation is returing R^T instead of R, as it is more
@@ -145,10 +215,36 @@ def ipu_qr(x: Array, xsdiag: Array) -> Tuple[Array, Array]:
 
     Args:
         x: Symmetric matrix.
+        xsdiag: X diagonal sign.
+        split_correction_vector: Compute the correction vector in two steps, without worker spin-wait.
     Returns:
         Q, R^T matrices (as tile sharded arrays).
     """
     # Initialize Q, RT, sdiag.
     Q, RT, sdiag_full = ipu_qr_shard_inputs(x, xsdiag)
     # IPU QR iterations.
-    return ipu_qr_iterations(Q, RT, sdiag_full)
+    return ipu_qr_iterations(Q, RT, sdiag_full, split_correction_vector=split_correction_vector)
+
+
+def ipu_qr_batched(x: Array, matrices_per_tile: int = 1) -> Tuple[Array, Array]:
+    """IPU batched QR of small matrices, with whole matrices mapped on tiles.
+
+    Every tile is running the full QR decomposition of its `matrices_per_tile` matrices,
+    distributed between the 6 worker threads: throughput scales with the number of tiles.
+
+    Args:
+        x: Batch of square matrices (M, N, N), with `M % matrices_per_tile == 0`.
+        matrices_per_tile: Number of matrices per tile.
+    Returns:
+        Q, R batched matrices, (M, N, N) shaped.
+    """
+    assert x.ndim == 3
+    assert x.shape[1] == x.shape[2]
+    M, N = x.shape[0], x.shape[1]
+    assert M % matrices_per_tile == 0
+    num_tiles = M // matrices_per_tile
+    tiles = tuple(range(num_tiles))
+
+    R = tile_put_sharded(x.reshape((num_tiles, matrices_per_tile, N, N)), tiles)
+    R, Q = tile_map_primitive(qr_householder_batched_p, R, N=N)  # type:ignore
+    return Q.array.reshape((M, N, N)), R.array.reshape((M, N, N))
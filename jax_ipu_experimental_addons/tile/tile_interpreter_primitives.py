@@ -5,7 +5,7 @@ import os
 from copy import copy
 from typing import Any, Dict, List, Optional, Sequence, Set, Tuple, Union
 
-import cppimport
+import jax.numpy as jnp
 import numpy as np
 from jax import core, vmap
 from jax.core import ShapedArray
@@ -16,28 +16,52 @@ from jax.ipu.primitive import ipu_mlir_lowering_custom_primitive
 
 from jax_ipu_experimental_addons.utils import NDArray
 
-from .tile_array_primitives import Base64Data, IpuType
-from .tile_common_utils import from_numpy_dtype_to_ipu_type, get_ipu_type_name
+from . import tile_array_primitives
+from .tile_array_primitives import Base64Data, IpuType, tile_constant_pool_lowering_begin
+from .tile_codelet_cache import get_cached_codelet_filename
+from .tile_common_utils import from_numpy_dtype_to_ipu_type, get_ipu_type_name, use_binary_attributes
+from .tile_native_modules import import_native_module
 
 Array = Any
 
-# Pybind11 extension import (and compilation if necessary).
+# Pybind11 extension import (prebuilt, or JIT compiled if necessary).
 # Explicit path is more robust to different `pip install` usages.
 ext_filename = os.path.abspath(os.path.join(os.path.dirname(__file__), "tile_interpreter_primitives_impl.cpp"))
-tile_interpreter_primitives_impl = cppimport.imp_from_filepath(
+tile_interpreter_primitives_impl = import_native_module(
     ext_filename, "jax_ipu_experimental_addons.tile.tile_interpreter_primitives_impl"
 )
 
 from .tile_interpreter_primitives_impl import (  # noqa: E402
     IpuTileMapEquation,
+    IpuTileMapEquationGroup,
     IpuVertexAttributeF32,
     IpuVertexAttributeI32,
     IpuVertexIOInfo,
     IpuVertexIOType,
     TileMapEquationCall,
+    TileMapEquationGroupCall,
+    tile_map_equation_cache_clear,
+    tile_map_equation_cache_get,
+    tile_map_equation_cache_set_max_size,
+    tile_map_equation_cache_stats,
 )
 
 
+def ipu_tile_constant_pool_stats() -> Dict[str, int]:
+    """IPU tile constant pool report, aggregated over all custom primitives.
+
+    Returns:
+        Number of Poplar constants created and reused, with bytes allocated and saved.
+    """
+    # Single registry of constant pools, shared between native modules.
+    return tile_array_primitives.tile_constant_pool_stats()
+
+
+def ipu_tile_constant_pool_clear():
+    """Clear all IPU tile constant pools (and statistics)."""
+    tile_array_primitives.tile_constant_pool_clear()
+
+
 def primitive_has_impl(p: core.Primitive) -> bool:
     """Check if a JAX primitive has a default NumPy-like implementation."""
     # Is it the default empty `impl` function?
@@ -85,27 +109,47 @@ def make_ipu_vertex_io_info(
     return IpuVertexIOInfo(name=name, iotype=iotype, shape=aval.shape, dtype=ipu_type, vertex_dim2=int(vertex_dim2))
 
 
-def make_ipu_vertex_constant_info(name: str, data: NDArray[Any], vertex_dim2: int = 0) -> IpuVertexIOInfo:
+def make_ipu_vertex_constant_info(
+    name: str,
+    data: NDArray[Any],
+    vertex_dim2: int = 0,
+    sharded: bool = False,
+    ipu_type: Optional[IpuType] = None,
+) -> IpuVertexIOInfo:
     """Make IPU vertex constant input info.
 
     Args:
         name: IO field name.
-        data: NumPy array with the constant data.
+        data: NumPy array with the constant data. (T, *shape) array in the sharded case.
         vertex_dim2: Vertex IO tensor 2nd dimension.
+        sharded: Sharded constant, i.e. a different `data[idx]` slice stored on every tile.
+            Replicated on all tiles otherwise.
+        ipu_type: Optional IPU type of the constant, overriding the NumPy dtype one.
+            Only supported for `QUARTER` FP8 constants, passed as `uint8` raw bytes.
     Returns:
         IPU vertex IO info.
     """
-    data = np.asarray(data)
-    ipu_type = from_numpy_dtype_to_ipu_type(data.dtype)
+    data = np.ascontiguousarray(data)
+    if sharded and data.ndim == 0:
+        raise ValueError(f"Sharded vertex constant `{name}` requires a (T, *shape) array.")
+    if ipu_type is None:
+        ipu_type = from_numpy_dtype_to_ipu_type(data.dtype)
+    elif ipu_type != IpuType.QUARTER or data.dtype != np.uint8:
+        raise ValueError(
+            f"Unsupported IPU type `{ipu_type}` for vertex constant `{name}` of dtype `{data.dtype}`: "
+            "only `QUARTER` constants from `uint8` raw bytes are supported."
+        )
     constant_data = Base64Data(base64.b64encode(data))  # type: ignore
-    return IpuVertexIOInfo(
+    ioinfo = IpuVertexIOInfo(
         name=name,
         iotype=IpuVertexIOType.In,
-        shape=data.shape,
+        shape=data.shape[1:] if sharded else data.shape,
         dtype=ipu_type,
         vertex_dim2=vertex_dim2,
         constant_data=constant_data,
     )
+    ioinfo.constant_sharded = sharded
+    return ioinfo
 
 
 def make_ipu_vertex_in_info(name: str, aval: ShapedArray, vertex_dim2: int = 0) -> IpuVertexIOInfo:
@@ -214,6 +258,27 @@ def get_primitive_arguments(params: Dict[str, Any]) -> Dict[str, Any]:
     return params
 
 
+tile_map_profile_cycles_dtype = np.uint32
+"""Tile map profiling mode: dtype of the (T, 2) cycle delta output (low, high 32 bits words).
+"""
+
+
+def tile_map_profile_enabled(params: Dict[str, Any]) -> bool:
+    """Is the tile map equation call in profiling mode, i.e. with an additional cycle delta output?"""
+    return bool(params.get("ipu_profile", False))
+
+
+def tile_map_profile_wrap_fn(fn: Any, multiple_results: bool, num_tiles: int) -> Any:
+    """Wrap a (vmapped) tile map function, adding the (zero) cycle delta output of the profiling mode."""
+
+    def profile_fn(*args):
+        outputs = fn(*args)
+        outputs = tuple(outputs) if multiple_results else (outputs,)
+        return (*outputs, jnp.zeros((num_tiles, 2), dtype=tile_map_profile_cycles_dtype))
+
+    return profile_fn
+
+
 # Two primitives required, to differentiate single/multi output cases.
 tile_map_equation_call_single_out_p = core.Primitive("tile_map_equation_call_single_out")
 tile_map_equation_call_multi_out_p = core.Primitive("tile_map_equation_call_multi_out")
@@ -238,7 +303,7 @@ def tile_map_equation_call_multi_out(
 def tile_map_equation_call_impl(*args, **params):
     from .tile_interpreter import get_ipu_tile_primitive_translation
 
-    pname, _, _ = get_tile_map_ipu_arguments(**params)
+    pname, tiles, _ = get_tile_map_ipu_arguments(**params)
     primitive, _ = get_ipu_tile_primitive_translation(pname)
 
     def primitive_fn(*args):
@@ -247,6 +312,8 @@ def tile_map_equation_call_impl(*args, **params):
     # Use `vmap` to run the equivalent computation on any device.
     # TODO: caching of vmap function?
     vmap_primitive_fn = vmap(primitive_fn, in_axes=0, out_axes=0)
+    if tile_map_profile_enabled(params):
+        vmap_primitive_fn = tile_map_profile_wrap_fn(vmap_primitive_fn, primitive.multiple_results, len(tiles))
     return vmap_primitive_fn(*args)
 
 
@@ -266,6 +333,9 @@ def tile_map_equation_call_abstract_eval(*args, **params) -> Union[ShapedArray,
     if not primitive.multiple_results:
         tile_outputs = [tile_outputs]
     outputs = tuple([ShapedArray((num_tiles, *v.shape), v.dtype) for v in tile_outputs])
+    # Profiling mode: additional (T, 2) cycle delta output.
+    if tile_map_profile_enabled(params):
+        return (*outputs, ShapedArray((num_tiles, 2), tile_map_profile_cycles_dtype))
     if not primitive.multiple_results:
         outputs = outputs[0]
     return outputs
@@ -277,8 +347,9 @@ def tile_map_equation_call_mlir_translation_default(
     """`tile_map_equation_call` default MLIR translation, for CPU/GPU backends."""
     from .tile_interpreter import get_ipu_tile_primitive_translation
 
-    pname, _, _ = get_tile_map_ipu_arguments(**params)
+    pname, tiles, _ = get_tile_map_ipu_arguments(**params)
     primitive, _ = get_ipu_tile_primitive_translation(pname)
+    profile = tile_map_profile_enabled(params)
 
     if primitive_has_batching(primitive):
         # Not sure using a local function is a good idea?
@@ -287,8 +358,12 @@ def tile_map_equation_call_mlir_translation_default(
 
         # Primitive has batching rule (e.g. standard JAX primitives) => directly use `vmap`
         vmap_primitive_fn = vmap(primitive_fn, in_axes=0, out_axes=0)
+        if profile:
+            vmap_primitive_fn = tile_map_profile_wrap_fn(vmap_primitive_fn, primitive.multiple_results, len(tiles))
         # Lower to MLIR using JAX tooling. TODO: cache lowering?
-        vmap_primitive_lower_fn = mlir.lower_fun(vmap_primitive_fn, multiple_results=primitive.multiple_results)
+        vmap_primitive_lower_fn = mlir.lower_fun(
+            vmap_primitive_fn, multiple_results=primitive.multiple_results or profile
+        )
         return vmap_primitive_lower_fn(ctx, *args)
 
     elif primitive_has_impl(primitive):
@@ -298,14 +373,55 @@ def tile_map_equation_call_mlir_translation_default(
 
         # Use `vmap` on the primitive implementation => does not required batching rule of the primitive itself.
         vmap_primitive_impl_fn = vmap(primitive_impl_fn, in_axes=0, out_axes=0)
+        if profile:
+            vmap_primitive_impl_fn = tile_map_profile_wrap_fn(
+                vmap_primitive_impl_fn, primitive.multiple_results, len(tiles)
+            )
         # Lower to MLIR using JAX tooling. TODO: cache lowering?
-        vmap_primitive_lower_fn = mlir.lower_fun(vmap_primitive_impl_fn, multiple_results=primitive.multiple_results)
+        vmap_primitive_lower_fn = mlir.lower_fun(
+            vmap_primitive_impl_fn, multiple_results=primitive.multiple_results or profile
+        )
         return vmap_primitive_lower_fn(ctx, *args)
 
     # Not much we can do without implementation or batching rule!
     raise NotImplementedError(f"No implementation or batching provided for JAX primitive '{primitive}'.")
 
 
+def make_ipu_custom_primitive_with_metadata(primitive: Any, metadata: Any) -> Any:
+    """Make an IPU custom primitive proxy class, with pre-computed metadata (e.g. depending on attributes).
+
+    The proxy keeps the naming of the original pybind11 class, in order to find
+    the primitive exported in the shared library.
+    """
+
+    def metadata_fn(num_inputs: int) -> Any:
+        return metadata
+
+    return type(
+        primitive.__name__,
+        (),
+        {
+            "metadata": staticmethod(metadata_fn),
+            "__module__": primitive.__module__,
+            "__qualname__": primitive.__qualname__,
+        },
+    )
+
+
+def use_cached_codelets(tile_map_eqn: IpuTileMapEquation) -> bool:
+    """Replace the vertex sources of a tile map equation by ahead-of-time compiled codelets (when available).
+
+    Returns:
+        Has the tile map equation been modified?
+    """
+    gp_filename = get_cached_codelet_filename(tile_map_eqn.gp_filename)
+    profile_gp_filename = get_cached_codelet_filename(tile_map_eqn.profile_gp_filename)
+    modified = gp_filename != tile_map_eqn.gp_filename or profile_gp_filename != tile_map_eqn.profile_gp_filename
+    tile_map_eqn.gp_filename = gp_filename
+    tile_map_eqn.profile_gp_filename = profile_gp_filename
+    return modified
+
+
 def tile_map_equation_call_mlir_lowering_ipu(
     ctx: LoweringRuleContext, *args: ir.Value, **params: Any
 ) -> Sequence[ir.Value]:
@@ -316,18 +432,29 @@ def tile_map_equation_call_mlir_lowering_ipu(
         args: IR operands
         params: Additional parameters/attributes to pass.
     """
+    pool_id = tile_constant_pool_lowering_begin(ctx)
     _, _, tile_map_eqn_json = get_tile_map_ipu_arguments(**params)
-    # Tile map equation (serialized as json).
+    # Tile map equation (serialized as json), with the module constant pool.
     tile_map_eqn = IpuTileMapEquation.from_json_str(tile_map_eqn_json)
+    use_cached_codelets(tile_map_eqn)
+    tile_map_eqn.constant_pool_id = pool_id
+    tile_map_eqn_json = tile_map_eqn.to_json_str()
     # Load optional vertex compiled file (or cpp)
     ipu_gp_filename: Optional[str] = None
     if len(tile_map_eqn.gp_filename) > 0:
         ipu_gp_filename = os.path.abspath(tile_map_eqn.gp_filename)
+    # Binary MessagePack attributes, avoiding base64 encoding of constants.
+    opaque_attributes = tile_map_eqn.to_msgpack_bytes() if use_binary_attributes() else tile_map_eqn_json
+    # InOut vertex tensors aliasing, for in-place tile operations.
+    primitive = TileMapEquationCall
+    metadata = TileMapEquationCall.metadata_with_attributes(len(args), opaque_attributes)
+    if len(metadata.input_to_output_tensor_aliasing) > 0:
+        primitive = make_ipu_custom_primitive_with_metadata(TileMapEquationCall, metadata)
     outputs = ipu_mlir_lowering_custom_primitive(
-        TileMapEquationCall,
+        primitive,
         ctx,
         args,
-        opaque_attributes=tile_map_eqn_json,
+        opaque_attributes=opaque_attributes,
         ipu_gp_filename=ipu_gp_filename,
     )
     # With MLIR lowering, always returns a tuple of results.
@@ -349,3 +476,101 @@ mlir.register_lowering(tile_map_equation_call_multi_out_p, tile_map_equation_cal
 # Register MLIR translation for other backends.
 mlir.register_lowering(tile_map_equation_call_single_out_p, tile_map_equation_call_mlir_translation_default)
 mlir.register_lowering(tile_map_equation_call_multi_out_p, tile_map_equation_call_mlir_translation_default)
+
+
+# Group of tile map equations, executed in a single compute set.
+tile_map_equation_group_call_p = core.Primitive("tile_map_equation_group_call")
+TileMapGroupParams = Tuple[Tuple[str, Tuple[int, ...], str, int, Tuple[Tuple[str, Any], ...]], ...]
+"""Tile map group parameters: (pname, tiles, tile_map_eqn_json, num_inputs, attributes) per equation.
+"""
+
+
+def tile_map_equation_group_call(inputs: Sequence[Array], group: TileMapGroupParams) -> Sequence[Array]:
+    return tile_map_equation_group_call_p.bind(*inputs, group=group)
+
+
+def tile_map_group_split_params(args: Sequence[Any], group: TileMapGroupParams) -> List[Tuple[Any, Dict[str, Any]]]:
+    """Split group (concatenated) arguments and parameters between tile map equations."""
+    assert sum([g[3] for g in group]) == len(args)
+    outputs = []
+    offset = 0
+    for pname, tiles, tile_map_eqn_json, num_inputs, attributes in group:
+        params = dict(pname=pname, tiles=tiles, tile_map_eqn_json=tile_map_eqn_json, **dict(attributes))
+        outputs.append((args[offset : offset + num_inputs], params))
+        offset += num_inputs
+    return outputs
+
+
+def tile_map_group_flatten_outputs(pname: str, outputs: Any) -> List[Any]:
+    """Flatten the outputs of a tile map equation (single or multiple outputs)."""
+    from .tile_interpreter import get_ipu_tile_primitive_translation
+
+    primitive, _ = get_ipu_tile_primitive_translation(pname)
+    return list(outputs) if primitive.multiple_results else [outputs]
+
+
+def tile_map_equation_group_call_impl(*args, group: TileMapGroupParams) -> List[Any]:
+    outputs = []
+    for eqn_args, params in tile_map_group_split_params(args, group):
+        eqn_outputs = tile_map_equation_call_impl(*eqn_args, **params)
+        outputs.extend(tile_map_group_flatten_outputs(params["pname"], eqn_outputs))
+    return outputs
+
+
+def tile_map_equation_group_call_abstract_eval(*args, group: TileMapGroupParams) -> Tuple[ShapedArray, ...]:
+    outputs = []
+    for eqn_args, params in tile_map_group_split_params(args, group):
+        eqn_outputs = tile_map_equation_call_abstract_eval(*eqn_args, **params)
+        outputs.extend(tile_map_group_flatten_outputs(params["pname"], eqn_outputs))
+    return tuple(outputs)
+
+
+def tile_map_equation_group_call_mlir_translation_default(
+    ctx: LoweringRuleContext, *args: Union[ir.Value, Sequence[ir.Value]], group: TileMapGroupParams
+) -> Sequence[Union[ir.Value, Sequence[ir.Value]]]:
+    """`tile_map_equation_group_call` default MLIR translation, for CPU/GPU backends."""
+
+    def group_fn(*inputs):
+        return tile_map_equation_group_call_impl(*inputs, group=group)
+
+    group_lower_fn = mlir.lower_fun(group_fn, multiple_results=True)
+    return group_lower_fn(ctx, *args)
+
+
+def tile_map_equation_group_call_mlir_lowering_ipu(
+    ctx: LoweringRuleContext, *args: ir.Value, group: TileMapGroupParams
+) -> Sequence[ir.Value]:
+    """`tile_map_equation_group_call` IPU backend MLIR lowering, as a single custom primitive."""
+    pool_id = tile_constant_pool_lowering_begin(ctx)
+    equations = [IpuTileMapEquation.from_json_str(g[2]) for g in group]
+    for eqn in equations:
+        use_cached_codelets(eqn)
+        eqn.constant_pool_id = pool_id
+    tile_map_group = IpuTileMapEquationGroup(equations)
+    tile_map_group.check_tiles_overlap()
+    # First vertex compiled file loaded by JAX, others directly in the C++ primitive.
+    gp_filenames = [eqn.gp_filename for eqn in tile_map_group.equations if len(eqn.gp_filename) > 0]
+    ipu_gp_filename = os.path.abspath(gp_filenames[0]) if len(gp_filenames) > 0 else None
+    opaque_attributes = tile_map_group.to_msgpack_bytes() if use_binary_attributes() else tile_map_group.to_json_str()
+    # InOut vertex tensors aliasing, for in-place tile operations.
+    primitive = TileMapEquationGroupCall
+    metadata = TileMapEquationGroupCall.metadata_with_attributes(len(args), opaque_attributes)
+    if len(metadata.input_to_output_tensor_aliasing) > 0:
+        primitive = make_ipu_custom_primitive_with_metadata(TileMapEquationGroupCall, metadata)
+    outputs = ipu_mlir_lowering_custom_primitive(
+        primitive,
+        ctx,
+        args,
+        opaque_attributes=opaque_attributes,
+        ipu_gp_filename=ipu_gp_filename,
+    )
+    return outputs
+
+
+tile_map_equation_group_call_p.multiple_results = True
+tile_map_equation_group_call_p.def_abstract_eval(tile_map_equation_group_call_abstract_eval)
+tile_map_equation_group_call_p.def_impl(tile_map_equation_group_call_impl)
+# Register IPU MLIR lowering.
+mlir.register_lowering(tile_map_equation_group_call_p, tile_map_equation_group_call_mlir_lowering_ipu, platform="ipu")
+# Register MLIR translation for other backends.
+mlir.register_lowering(tile_map_equation_group_call_p, tile_map_equation_group_call_mlir_translation_default)
@@ -8,7 +8,14 @@
 #include <half/half.hpp>
 #include <ipu_custom_primitive.hpp>
 #include <json/json.hpp>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
 
 #include "tile_array_utils.hpp"
 #include "tile_dot_vertex_utils.hpp"
@@ -63,6 +70,8 @@ struct VertexIOInfo {
   Base64Data constant_data = Base64Data();
   /** Slices, in the case of 2d tensor input. */
   std::vector<TensorSlice> slices2d;
+  /** Sharded constant: (T, *shape) data, with a different slice per tile. */
+  bool constant_sharded = false;
 
   /**
    * @brief Build a vertex IO info (with vertex second dim info).
@@ -118,8 +127,10 @@ struct VertexIOInfo {
     }
   }
 };
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(VertexIOInfo, name, iotype, aval,
-                                   constant_data, slices2d)
+// Default values for backward compatibility with serialized equations.
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(VertexIOInfo, name, iotype,
+                                                aval, constant_data, slices2d,
+                                                constant_sharded)
 
 bool operator==(const VertexIOInfo& lhs, const VertexIOInfo& rhs) {
   return lhs.name == rhs.name && lhs.iotype == rhs.iotype &&
@@ -218,6 +229,16 @@ struct TileMapEquation {
   uint64_t perf_estimate = 0;
   /** Synchronization of tiles before the compute set. */
   bool sync = false;
+  /**
+   * Profiling mode: cycle count vertices (on every tile) before and after the
+   * compute set, and additional (T, 2) cycle delta output.
+   */
+  bool profile = false;
+  /** Cycle count vertices (absolute) gp filename, used in profiling mode. */
+  std::string profile_gp_filename = "";
+  /** Constant pool id of vertex constants (set at lowering, no pooling
+   * otherwise). */
+  TileConstantPool::PoolId constant_pool_id = TileConstantPool::kNoPool;
 
   /**
    * @brief Does it require temporary vertex space?
@@ -226,12 +247,19 @@ struct TileMapEquation {
 
   /**
    * @brief Allocate all input tensors (including missing constant).
+   *
+   * InOut operands containing Poplar constants (e.g. pooled tile constants,
+   * shared with other primitives) are first copied into new variables, such
+   * that an in-place update never modifies a constant.
+   *
    * @param graph Poplar graph.
+   * @param prog Poplar sequence program, to which InOut copies are added.
    * @param inputs Pre-existing input tensors.
    * @return Collection of input tensors.
    */
   std::vector<poplar::Tensor> allocateInputTensors(
-      poplar::Graph& graph, const std::vector<poplar::Tensor>& inputs) const {
+      poplar::Graph& graph, poplar::program::Sequence& prog,
+      const std::vector<poplar::Tensor>& inputs) const {
     FMT_ASSERT(inputs.size() <= inputs_info.size(),
                "Inconsistent input vector size.");
 
@@ -239,15 +267,39 @@ struct TileMapEquation {
     int input_idx = 0;
     for (const auto& input_info : inputs_info) {
       if (input_info.isConstantInput()) {
-        // Create a replicated constant tensor.
-        // TODO: support sharded constant as well.
-        const std::string raw_values = input_info.constant_data.decode();
+        std::string raw_buffer;
         const auto raw_values_ref =
-            poplar::ArrayRef<char>(raw_values.data(), raw_values.size());
-        auto t = createReplicatedConstantTensor(graph, input_info.aval.dtype,
-                                                input_info.aval.shape,
-                                                raw_values_ref, this->tiles);
+            input_info.constant_data.decodeRef(raw_buffer);
+        if (input_info.constant_sharded) {
+          // Sharded constant tensor: only the tile slice stored on every tile.
+          const std::size_t tile_bytes = input_info.aval.size() *
+                                         ipuTypeSize(input_info.aval.dtype);
+          if (raw_values_ref.size() != tiles.size() * tile_bytes) {
+            throw std::runtime_error(fmt::format(
+                "Inconsistent sharded constant `{}` data size: {} bytes "
+                "instead of {}.",
+                input_info.name, raw_values_ref.size(),
+                tiles.size() * tile_bytes));
+          }
+          auto t = createShardedConstantTensor(
+              graph, input_info.aval.dtype,
+              shapePrependAxis(tiles.size(), input_info.aval.shape),
+              raw_values_ref, this->tiles, {}, constant_pool_id);
+          inputs_all.push_back(t);
+        } else {
+          // Replicated constant tensor.
+          auto t = createReplicatedConstantTensor(
+              graph, input_info.aval.dtype, input_info.aval.shape,
+              raw_values_ref, this->tiles, {}, constant_pool_id);
+          inputs_all.push_back(t);
+        }
+      } else if (input_info.iotype == VertexIOType::InOut &&
+                 inputs[input_idx].containsConstant()) {
+        // In-place update of a constant: copy into a new variable first.
+        auto t = graph.clone(inputs[input_idx], {input_info.name});
+        prog.add(poplar::program::Copy(inputs[input_idx], t));
         inputs_all.push_back(t);
+        input_idx++;
       } else {
         // Keep existing input tensor.
         inputs_all.push_back(inputs[input_idx]);
@@ -281,7 +333,7 @@ struct TileMapEquation {
       } else if (outinfo.iotype == VertexIOType::Out) {
         // Allocate an output tensor with proper shape.
         outputs.push_back(
-            createShardedVariable(graph, toPoplar(outinfo.aval.dtype),
+            createShardedVariable(graph, toPoplarStorage(outinfo.aval.dtype),
                                   outinfo.aval.shape, this->tiles));
       } else {
         throw std::runtime_error("Unknown IO type for vertex output tensor.");
@@ -290,6 +342,41 @@ struct TileMapEquation {
     return outputs;
   }
 
+  /**
+   * @brief Number of custom primitive operands (i.e. non-constant inputs).
+   */
+  std::size_t numOperands() const {
+    return std::count_if(
+        inputs_info.begin(), inputs_info.end(),
+        [](const VertexIOInfo& info) { return !info.isConstantInput(); });
+  }
+
+  /**
+   * @brief Input to output tensors aliasing, built from InOut vertex tensors.
+   *
+   * Input indices correspond to the custom primitive operands, i.e. excluding
+   * constant inputs (allocated in the Poplar graph directly).
+   */
+  std::map<std::int64_t, std::int64_t> inputToOutputTensorAliasing() const {
+    std::map<std::int64_t, std::int64_t> aliasing;
+    for (std::size_t out_idx = 0; out_idx < outputs_info.size(); ++out_idx) {
+      const auto& outinfo = outputs_info[out_idx];
+      if (outinfo.iotype != VertexIOType::InOut) {
+        continue;
+      }
+      std::int64_t in_idx = 0;
+      for (const auto& ininfo : inputs_info) {
+        if (ininfo.name == outinfo.name) {
+          aliasing[in_idx] = out_idx;
+          break;
+        }
+        // Constant inputs are not custom primitive operands.
+        in_idx += ininfo.isConstantInput() ? 0 : 1;
+      }
+    }
+    return aliasing;
+  }
+
   /**
    * @brief Allocate the temporary-scratch space tensor (if used).
    */
@@ -298,34 +385,30 @@ struct TileMapEquation {
     if (!useTmpSpace()) {
       return std::nullopt;
     }
-    return createShardedVariable(graph, toPoplar(tmp_space_aval.dtype),
-                                 {tmp_space_aval.size()}, this->tiles);
+    // Vertex scratch space: aligned tile regions, for vector loads/stores.
+    return createShardedVariable(graph, toPoplarStorage(tmp_space_aval.dtype),
+                                 {tmp_space_aval.size()}, this->tiles, {},
+                                 kTileRegionAlignment);
   }
 
   /**
-   * @brief Add vertex/equation to Poplar graph & compute set.
+   * @brief Add equation vertices to an existing Poplar compute set.
    *
    * @param graph Poplar graph.
-   * @param prog Poplar sequence program.
+   * @param cs Poplar compute set.
    * @param inputs Vector of (sharded) input tensors (including constant
    * tensors).
    * @param outputs Vector of (sharded) output tensors (already allocated).
-   * @param debug_prefix Debug context prefix.
    */
-  void add(poplar::Graph& graph, poplar::program::Sequence& prog,
-           const std::vector<poplar::Tensor>& inputs,
-           const std::vector<poplar::Tensor>& outputs,
-           const poplar::DebugContext& debug_prefix) const {
+  void addVertices(poplar::Graph& graph, poplar::ComputeSet& cs,
+                   const std::vector<poplar::Tensor>& inputs,
+                   const std::vector<poplar::Tensor>& outputs) const {
     FMT_ASSERT(inputs.size() == inputs_info.size(),
                "Inconsistent inputs vector size.");
     FMT_ASSERT(outputs.size() == outputs_info.size(),
                "Inconsistent outputs vector size.");
-    poplar::DebugContext debug_context(debug_prefix, this->pname);
-
     // Tensor used for vertex temp. scratch space.
     auto tmp_space_tensor_opt = allocateTmpSpaceTensor(graph);
-
-    poplar::ComputeSet cs = graph.addComputeSet(debug_context);
     for (size_t tidx = 0; tidx < tiles.size(); ++tidx) {
       const auto tile = tiles[tidx];
       // Add vertex on the tile.
@@ -360,6 +443,25 @@ struct TileMapEquation {
         graph.setInitialValue(v[attr.name], attr.value);
       }
     }
+  }
+
+  /**
+   * @brief Add vertex/equation to Poplar graph & compute set.
+   *
+   * @param graph Poplar graph.
+   * @param prog Poplar sequence program.
+   * @param inputs Vector of (sharded) input tensors (including constant
+   * tensors).
+   * @param outputs Vector of (sharded) output tensors (already allocated).
+   * @param debug_prefix Debug context prefix.
+   */
+  void add(poplar::Graph& graph, poplar::program::Sequence& prog,
+           const std::vector<poplar::Tensor>& inputs,
+           const std::vector<poplar::Tensor>& outputs,
+           const poplar::DebugContext& debug_prefix) const {
+    poplar::DebugContext debug_context(debug_prefix, this->pname);
+    poplar::ComputeSet cs = graph.addComputeSet(debug_context);
+    this->addVertices(graph, cs, inputs, outputs);
     prog.add(poplar::program::Execute(cs, debug_context));
   }
 
@@ -378,22 +480,299 @@ struct TileMapEquation {
       const std::vector<poplar::Tensor>& inputs,
       const poplar::DebugContext& debug_prefix) const {
     // All input tensors: i.e. add constant tensors.
-    const auto inputs_all = this->allocateInputTensors(graph, inputs);
+    const auto inputs_all = this->allocateInputTensors(graph, prog, inputs);
+    // Profiling mode: per tile cycle count start.
+    std::optional<poplar::Tensor> cycles;
+    if (this->profile) {
+      cycles = this->addCycleCountVertices(graph, prog, std::nullopt,
+                                           debug_prefix);
+    }
     // No vertex => assume identity function, i.e. forward inputs.
-    if (this->vname.empty()) {
-      return inputs_all;
+    auto outputs = inputs_all;
+    if (!this->vname.empty()) {
+      outputs = this->allocateOutputTensors(graph, inputs_all);
+      this->add(graph, prog, inputs_all, outputs, debug_prefix);
+    }
+    // Profiling mode: per tile cycle count delta, as an additional output.
+    if (cycles.has_value()) {
+      this->addCycleCountVertices(graph, prog, cycles, debug_prefix);
+      outputs.push_back(cycles.value());
     }
-    const auto outputs = this->allocateOutputTensors(graph, inputs);
-    this->add(graph, prog, inputs_all, outputs, debug_prefix);
     return outputs;
   }
+
+  /**
+   * @brief Add a compute set of cycle count vertices (profiling mode).
+   *
+   * No tiles synchronization is added, such that the cycle delta measured on
+   * every tile corresponds to the compute set execution on the tile.
+   *
+   * @param graph Poplar graph.
+   * @param prog Poplar sequence program.
+   * @param cycles (T, 2) cycle count tensor. Allocated and initialized with
+   * the start cycle count when not provided, and updated to the cycle delta
+   * otherwise.
+   * @param debug_prefix Debug context prefix.
+   * @return (T, 2) cycle count tensor.
+   */
+  poplar::Tensor addCycleCountVertices(
+      poplar::Graph& graph, poplar::program::Sequence& prog,
+      std::optional<poplar::Tensor> cycles,
+      const poplar::DebugContext& debug_prefix) const {
+    const bool is_start = !cycles.has_value();
+    const std::string vname_cycles =
+        is_start ? "CycleCountStart" : "CycleCountDelta";
+    poplar::DebugContext debug_context(debug_prefix,
+                                       this->pname + "_" + vname_cycles);
+    if (!profile_gp_filename.empty() && !graph.hasCodelet(vname_cycles)) {
+      graph.addCodelets(profile_gp_filename);
+    }
+    if (is_start) {
+      cycles = createShardedVariable(graph, poplar::UNSIGNED_INT, {2},
+                                     this->tiles, debug_context);
+    }
+    poplar::ComputeSet cs = graph.addComputeSet(debug_context);
+    for (size_t tidx = 0; tidx < tiles.size(); ++tidx) {
+      auto v = graph.addVertex(cs, vname_cycles);
+      graph.setTileMapping(v, tiles[tidx]);
+      graph.setPerfEstimate(v, 14);
+      graph.connect(v["cycles"], cycles.value()[tidx]);
+    }
+    prog.add(poplar::program::Execute(cs, debug_context));
+    return cycles.value();
+  }
 };
 
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TileMapEquation, pname, vname, tiles,
                                    inputs_info, outputs_info, attributes_i32,
                                    attributes_f32, tmp_space_name,
                                    tmp_space_aval, gp_filename, perf_estimate,
-                                   sync)
+                                   sync, profile, profile_gp_filename,
+                                   constant_pool_id)
+
+/**
+ * @brief Group of tile map equations, executed in a single compute set.
+ *
+ * Equations must be mapped on disjoint collections of tiles, such that all
+ * vertices can run concurrently in the same superstep.
+ */
+struct TileMapEquationGroup {
+  /** Tile map equations. */
+  std::vector<TileMapEquation> equations;
+
+  /**
+   * @brief Check tiles are not overlapping between equations.
+   * @throw std::invalid_argument if some tiles are overlapping.
+   */
+  void checkTilesOverlap() const {
+    std::map<TileIndexType, std::size_t> tiles_eqn;
+    for (std::size_t idx = 0; idx < equations.size(); ++idx) {
+      for (const auto tile : equations[idx].tiles) {
+        const auto [it, inserted] = tiles_eqn.emplace(tile, idx);
+        if (!inserted) {
+          throw std::invalid_argument(fmt::format(
+              "IPU tile map equation group: tile {} used by equations '{}' "
+              "and '{}'.",
+              tile, equations[it->second].pname, equations[idx].pname));
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Input to output tensors aliasing of the group (concatenating
+   * equations operands and outputs).
+   */
+  std::map<std::int64_t, std::int64_t> inputToOutputTensorAliasing() const {
+    std::map<std::int64_t, std::int64_t> aliasing;
+    std::int64_t in_offset = 0;
+    std::int64_t out_offset = 0;
+    for (const auto& eqn : equations) {
+      for (const auto& [in_idx, out_idx] : eqn.inputToOutputTensorAliasing()) {
+        aliasing[in_offset + in_idx] = out_offset + out_idx;
+      }
+      in_offset += eqn.numOperands();
+      out_offset += eqn.outputs_info.size();
+    }
+    return aliasing;
+  }
+
+  /**
+   * @brief Add the group of equations to Poplar graph, in a single compute set.
+   *
+   * @param graph Poplar graph.
+   * @param prog Poplar sequence program.
+   * @param inputs Vector of (sharded) input tensors (concatenated operands).
+   * @param debug_prefix Debug context prefix.
+   * @return Vector of (tile sharded) output tensors (concatenated).
+   */
+  std::vector<poplar::Tensor> add(
+      poplar::Graph& graph, poplar::program::Sequence& prog,
+      const std::vector<poplar::Tensor>& inputs,
+      const poplar::DebugContext& debug_prefix) const {
+    checkTilesOverlap();
+    poplar::DebugContext debug_context(debug_prefix, "tile_map_group");
+    poplar::ComputeSet cs = graph.addComputeSet(debug_context);
+    std::vector<poplar::Tensor> outputs_all;
+    std::size_t in_offset = 0;
+    for (const auto& eqn : equations) {
+      const std::size_t num_operands = eqn.numOperands();
+      FMT_ASSERT(in_offset + num_operands <= inputs.size(),
+                 "Inconsistent input vector size.");
+      const std::vector<poplar::Tensor> eqn_inputs(
+          inputs.begin() + in_offset,
+          inputs.begin() + in_offset + num_operands);
+      in_offset += num_operands;
+      // Optional vertex codelets, when not yet loaded.
+      if (!eqn.gp_filename.empty() && !graph.hasCodelet(eqn.vname)) {
+        graph.addCodelets(eqn.gp_filename);
+      }
+      const auto eqn_inputs_all =
+          eqn.allocateInputTensors(graph, prog, eqn_inputs);
+      if (eqn.vname.empty()) {
+        outputs_all.insert(outputs_all.end(), eqn_inputs_all.begin(),
+                           eqn_inputs_all.end());
+        continue;
+      }
+      const auto eqn_outputs =
+          eqn.allocateOutputTensors(graph, eqn_inputs_all);
+      eqn.addVertices(graph, cs, eqn_inputs_all, eqn_outputs);
+      outputs_all.insert(outputs_all.end(), eqn_outputs.begin(),
+                         eqn_outputs.end());
+    }
+    prog.add(poplar::program::Execute(cs, debug_context));
+    return outputs_all;
+  }
+
+  /**
+   * @brief Synchronization of tiles before the compute set?
+   */
+  bool sync() const {
+    return std::any_of(equations.begin(), equations.end(),
+                       [](const TileMapEquation& eqn) { return eqn.sync; });
+  }
+};
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TileMapEquationGroup, equations)
+
+/**
+ * @brief Process-wide cache of deserialized tile map equations.
+ *
+ * The same equation attributes are often lowered many times (e.g. every
+ * Jacobi sweep), hence the cache avoids repeated parsing and base64 decoding
+ * of constant data. Cached equations keep their constants in raw format.
+ *
+ * Entries are keyed on the full raw attributes, with a least recently used
+ * eviction policy once the cache reaches its maximum size.
+ */
+class TileMapEquationCache {
+ public:
+  /** Default maximum number of cached equations. */
+  static constexpr std::size_t kDefaultMaxSize = 1024;
+
+  /** Cache statistics. */
+  struct Stats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t size = 0;
+  };
+
+  /**
+   * @brief Global cache instance.
+   */
+  static TileMapEquationCache& instance() {
+    static TileMapEquationCache cache;
+    return cache;
+  }
+
+  /**
+   * @brief Get the (cached) tile map equation corresponding to raw attributes
+   * (JSON or binary encoded).
+   */
+  std::shared_ptr<const TileMapEquation> get(const std::string& attributes) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      const auto it = m_index.find(attributes);
+      if (it != m_index.end()) {
+        ++m_stats.hits;
+        // Most recently used entry at the front.
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return it->second->equation;
+      }
+      ++m_stats.misses;
+    }
+    // Deserialize & decode constants outside of the lock.
+    auto equation = std::make_shared<TileMapEquation>(
+        from_attributes_str<TileMapEquation>(attributes));
+    for (auto& info : equation->inputs_info) {
+      if (info.isConstantInput() && info.constant_data.raw_data.empty()) {
+        info.constant_data.raw_data = info.constant_data.decode();
+        info.constant_data.encoded_data.clear();
+      }
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Entry possibly inserted by another thread in the meantime.
+    if (m_index.find(attributes) == m_index.end()) {
+      m_entries.push_front(Entry{attributes, equation});
+      m_index.emplace(m_entries.front().attributes, m_entries.begin());
+      evict();
+    }
+    return equation;
+  }
+
+  /**
+   * @brief Cache statistics (hits, misses and size).
+   */
+  Stats stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.size = m_entries.size();
+    return stats;
+  }
+
+  /**
+   * @brief Set the maximum number of cached equations (evicting the least
+   * recently used ones if necessary).
+   */
+  void setMaxSize(std::size_t max_size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_max_size = max_size;
+    evict();
+  }
+
+  /**
+   * @brief Clear the cache (and reset statistics).
+   */
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.clear();
+    m_entries.clear();
+    m_stats = Stats{};
+  }
+
+ private:
+  struct Entry {
+    std::string attributes;
+    std::shared_ptr<const TileMapEquation> equation;
+  };
+  using EntryList = std::list<Entry>;
+
+  /** Evict least recently used entries above the maximum size. */
+  void evict() {
+    while (m_entries.size() > m_max_size) {
+      m_index.erase(m_entries.back().attributes);
+      m_entries.pop_back();
+    }
+  }
+
+  mutable std::mutex m_mutex;
+  /** Entries, from most to least recently used. */
+  EntryList m_entries;
+  /** Index on full attributes (views on the entries strings). */
+  std::unordered_map<std::string_view, EntryList::iterator> m_index;
+  std::size_t m_max_size = kDefaultMaxSize;
+  Stats m_stats;
+};
 
 }  // namespace ipu
 
@@ -404,7 +783,6 @@ NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TileMapEquation, pname, vname, tiles,
 class TileMapEquationCall : public jax::ipu::PrimitiveInterface {
  public:
   static jax::ipu::PrimitiveMetadata metadata(std::uint32_t num_inputs) {
-    // TODO. check InOut tensors for aliasing.
     return jax::ipu::PrimitiveMetadata{.num_inputs = num_inputs,
                                        .is_elementwise = false,
                                        .is_stateless = true,
@@ -413,14 +791,30 @@ class TileMapEquationCall : public jax::ipu::PrimitiveInterface {
                                        .allocating_indices = {}};
   }
 
+  /**
+   * @brief Primitive metadata, with InOut tensors aliasing extracted from the
+   * tile equation attributes (JSON or binary).
+   */
+  static jax::ipu::PrimitiveMetadata metadataWithAttributes(
+      std::uint32_t num_inputs, const std::string& attributes) {
+    auto metadata = TileMapEquationCall::metadata(num_inputs);
+    const auto tile_equation =
+        ipu::TileMapEquationCache::instance().get(attributes);
+    metadata.input_to_output_tensor_aliasing =
+        tile_equation->inputToOutputTensorAliasing();
+    return metadata;
+  }
+
   static poplar::program::Program program(
       poplar::Graph& graph, const std::vector<poplar::Tensor>& inputs,
       std::vector<poplar::Tensor>& outputs, const std::string& attributes,
       const std::string& debug_prefix) {
     const auto debug_context = poplar::DebugContext(debug_prefix);
-    // Deserialize tile mapped equation, and add to the graph.
-    const auto tile_equation =
-        ipu::from_json_str<ipu::TileMapEquation>(attributes);
+    // Deserialize tile mapped equation (JSON or binary, cached), and add to
+    // the graph.
+    const auto tile_equation_ptr =
+        ipu::TileMapEquationCache::instance().get(attributes);
+    const auto& tile_equation = *tile_equation_ptr;
     auto prog = poplar::program::Sequence();
     // IPU tiles synchronization before compute set.
     if (tile_equation.sync) {
@@ -432,8 +826,51 @@ class TileMapEquationCall : public jax::ipu::PrimitiveInterface {
   }
 };
 
+/**
+ * @brief IPU tile map equation group primitive: a collection of tile map
+ * equations (on disjoint tiles) executed in a single compute set.
+ */
+class TileMapEquationGroupCall : public jax::ipu::PrimitiveInterface {
+ public:
+  static jax::ipu::PrimitiveMetadata metadata(std::uint32_t num_inputs) {
+    return TileMapEquationCall::metadata(num_inputs);
+  }
+
+  /**
+   * @brief Primitive metadata, with InOut tensors aliasing extracted from the
+   * equations group attributes.
+   */
+  static jax::ipu::PrimitiveMetadata metadataWithAttributes(
+      std::uint32_t num_inputs, const std::string& attributes) {
+    auto metadata = TileMapEquationGroupCall::metadata(num_inputs);
+    const auto group =
+        ipu::from_attributes_str<ipu::TileMapEquationGroup>(attributes);
+    metadata.input_to_output_tensor_aliasing =
+        group.inputToOutputTensorAliasing();
+    return metadata;
+  }
+
+  static poplar::program::Program program(
+      poplar::Graph& graph, const std::vector<poplar::Tensor>& inputs,
+      std::vector<poplar::Tensor>& outputs, const std::string& attributes,
+      const std::string& debug_prefix) {
+    const auto debug_context = poplar::DebugContext(debug_prefix);
+    const auto group =
+        ipu::from_attributes_str<ipu::TileMapEquationGroup>(attributes);
+    auto prog = poplar::program::Sequence();
+    // IPU tiles synchronization before compute set.
+    if (group.sync()) {
+      const auto sync_type = poplar::SyncType::INTERNAL;
+      prog.add(poplar::program::Sync(sync_type, debug_context));
+    }
+    outputs = group.add(graph, prog, inputs, debug_context);
+    return prog;
+  }
+};
+
 // Export the IPU JAX primitives in the shared library.
 EXPORT_IPU_JAX_PRIMITIVE(TileMapEquationCall);
+EXPORT_IPU_JAX_PRIMITIVE(TileMapEquationGroupCall);
 
 // Declare a pybind11, to provide easy compilation & import from Python.
 PYBIND11_MODULE(tile_interpreter_primitives_impl, m) {
@@ -481,11 +918,20 @@ PYBIND11_MODULE(tile_interpreter_primitives_impl, m) {
       .def_static(
           "from_json_str",
           [](const std::string& j) { return from_json_str<VertexIOInfo>(j); })
+      .def("to_msgpack_bytes",
+           [](const VertexIOInfo& v) {
+             return pybind11::bytes(to_msgpack_str(v));
+           })
+      .def_static("from_msgpack_bytes",
+                  [](const pybind11::bytes& b) {
+                    return from_msgpack_str<VertexIOInfo>(std::string(b));
+                  })
       .def_readwrite("name", &VertexIOInfo::name)
       .def_readwrite("iotype", &VertexIOInfo::iotype)
       .def_readwrite("aval", &VertexIOInfo::aval)
       .def_readwrite("constant_data", &VertexIOInfo::constant_data)
       .def_readwrite("slices2d", &VertexIOInfo::slices2d)
+      .def_readwrite("constant_sharded", &VertexIOInfo::constant_sharded)
       .def_property_readonly("shape",
                              [](const VertexIOInfo& v) { return v.aval.shape; })
       .def_property_readonly("dtype",
@@ -523,6 +969,14 @@ PYBIND11_MODULE(tile_interpreter_primitives_impl, m) {
                   [](const std::string& j) {
                     return from_json_str<TileMapEquation>(j);
                   })
+      .def("to_msgpack_bytes",
+           [](const TileMapEquation& v) {
+             return pybind11::bytes(to_msgpack_str(v));
+           })
+      .def_static("from_msgpack_bytes",
+                  [](const pybind11::bytes& b) {
+                    return from_msgpack_str<TileMapEquation>(std::string(b));
+                  })
       .def_readwrite("pname", &TileMapEquation::pname)
       .def_readwrite("vname", &TileMapEquation::vname)
       .def_readwrite("tiles", &TileMapEquation::tiles)
@@ -535,21 +989,85 @@ PYBIND11_MODULE(tile_interpreter_primitives_impl, m) {
       .def_readwrite("gp_filename", &TileMapEquation::gp_filename)
       .def_readwrite("perf_estimate", &TileMapEquation::perf_estimate)
       .def_readwrite("sync", &TileMapEquation::sync)
-      .def_property_readonly("use_tmp_space", &TileMapEquation::useTmpSpace);
+      .def_readwrite("profile", &TileMapEquation::profile)
+      .def_readwrite("profile_gp_filename",
+                     &TileMapEquation::profile_gp_filename)
+      .def_readwrite("constant_pool_id", &TileMapEquation::constant_pool_id)
+      .def_property_readonly("use_tmp_space", &TileMapEquation::useTmpSpace)
+      .def("input_to_output_tensor_aliasing",
+           &TileMapEquation::inputToOutputTensorAliasing);
 
   pybind11::class_<TileMapEquationCall>(m, "TileMapEquationCall")
       .def_static("metadata", &TileMapEquationCall::metadata,
-                  pybind11::arg("num_inputs"));
+                  pybind11::arg("num_inputs"))
+      .def_static("metadata_with_attributes",
+                  &TileMapEquationCall::metadataWithAttributes,
+                  pybind11::arg("num_inputs"), pybind11::arg("attributes"));
+
+  pybind11::class_<TileMapEquationGroup>(m, "IpuTileMapEquationGroup")
+      .def(pybind11::init<>())
+      .def(pybind11::init([](const std::vector<TileMapEquation>& equations) {
+             return TileMapEquationGroup{equations};
+           }),
+           pybind11::arg("equations"))
+      .def("to_json_str",
+           [](const TileMapEquationGroup& v) { return to_json_str(v); })
+      .def_static("from_json_str",
+                  [](const std::string& j) {
+                    return from_json_str<TileMapEquationGroup>(j);
+                  })
+      .def("to_msgpack_bytes",
+           [](const TileMapEquationGroup& v) {
+             return pybind11::bytes(to_msgpack_str(v));
+           })
+      .def("check_tiles_overlap", &TileMapEquationGroup::checkTilesOverlap)
+      .def("input_to_output_tensor_aliasing",
+           &TileMapEquationGroup::inputToOutputTensorAliasing)
+      .def_readwrite("equations", &TileMapEquationGroup::equations);
+
+  pybind11::class_<TileMapEquationGroupCall>(m, "TileMapEquationGroupCall")
+      .def_static("metadata", &TileMapEquationGroupCall::metadata,
+                  pybind11::arg("num_inputs"))
+      .def_static("metadata_with_attributes",
+                  &TileMapEquationGroupCall::metadataWithAttributes,
+                  pybind11::arg("num_inputs"), pybind11::arg("attributes"));
+
+  // Tile map equation deserialization cache.
+  m.def(
+      "tile_map_equation_cache_get",
+      [](const std::string& attributes) {
+        return *TileMapEquationCache::instance().get(attributes);
+      },
+      pybind11::arg("attributes"));
+  m.def("tile_map_equation_cache_stats", []() {
+    const auto stats = TileMapEquationCache::instance().stats();
+    pybind11::dict d;
+    d["hits"] = stats.hits;
+    d["misses"] = stats.misses;
+    d["size"] = stats.size;
+    return d;
+  });
+  m.def("tile_map_equation_cache_clear",
+        []() { TileMapEquationCache::instance().clear(); });
+  m.def(
+      "tile_map_equation_cache_set_max_size",
+      [](std::size_t max_size) {
+        TileMapEquationCache::instance().setMaxSize(max_size);
+      },
+      pybind11::arg("max_size"));
 
   // IPU vertex utils.
   makeIpuDotVertexUtilsBindings(m);
+  // Graph constant pool report (registry shared with the tile array module).
+  makeTileConstantPoolBindings(
+      m, "jax_ipu_experimental_addons.tile.tile_array_primitives_impl");
 }
 
 // cppimport configuration for compiling the pybind11 module.
 // clang-format off
 /*
 <%
-cfg['extra_compile_args'] = ['-std=c++17', '-fPIC', '-O2', '-Wall', '-mavx2']
+cfg['extra_compile_args'] = ['-std=c++17', '-fPIC', '-O2', '-Wall']
 cfg['libraries'] = ['poplar', 'poputil', 'popops']
 cfg['include_dirs'] = []
 cfg['sources'] = [
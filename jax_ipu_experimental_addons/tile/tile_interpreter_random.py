@@ -1,4 +1,5 @@
 # Copyright (c) 2022 Graphcore Ltd. All rights reserved.
+import os
 from typing import Any, Dict, List, Tuple
 
 import jax
@@ -12,10 +13,12 @@ from .tile_interpreter import register_ipu_tile_primitive, tile_map_primitive
 from .tile_interpreter_primitives import (
     IpuTileMapEquation,
     make_ipu_vertex_attributes,
+    make_ipu_vertex_constant_info,
     make_ipu_vertex_inputs,
     make_ipu_vertex_name_templated,
     make_ipu_vertex_outputs,
 )
+from .tile_interpreter_vertex_utils import make_ipu_vector1d_worker_offsets
 
 """Bridging to the low level interface allowing to control IPU random seed for every tile.
 
@@ -105,6 +108,52 @@ ipu_get_hw_seeds_p.def_abstract_eval(ipu_get_hw_seeds_abstract_eval)
 register_ipu_tile_primitive(ipu_get_hw_seeds_p, ipu_get_hw_seeds_translation_ipu)
 
 
+def get_random_vertex_gp_filename() -> str:
+    return os.path.join(os.path.dirname(__file__), "vertex", "tile_random_vertex.cpp")
+
+
+def make_random_vertex_equation(
+    p: Primitive, tiles: Tuple[int, ...], basename: str, outaval: ShapedArray, **attributes: Any
+) -> IpuTileMapEquation:
+    """Make the IPU tile equation of a worker-parallel random vertex (see `tile_random_vertex.cpp`).
+
+    Workers are sampling 64 bits vectors with the tile hardware RNG (seeded with `ipu_set_hw_seeds_tmap`),
+    the last worker sampling as well any remaining elements (i.e. not filling a full vector).
+
+    Args:
+        p: Random primitive.
+        tiles: Tiles on which to sample.
+        basename: Random vertex basename.
+        outaval: Output aval, float32 or float16 1d array.
+        attributes: Vertex (floating) sampling attributes.
+    Returns:
+        IPU tile map equation.
+    """
+    size = outaval.size
+    vector_size = 8 // outaval.dtype.itemsize
+    worker_offsets = make_ipu_vector1d_worker_offsets(
+        (size // vector_size) * vector_size, vector_size=vector_size, wdtype=np.uint32
+    )
+    attrs_i32, attrs_f32 = make_ipu_vertex_attributes(size=size, **attributes)
+    return IpuTileMapEquation(
+        vname=make_ipu_vertex_name_templated(basename, outaval.dtype),
+        pname=p.name,
+        tiles=tiles,
+        inputs_info=[make_ipu_vertex_constant_info("worker_offsets", worker_offsets, vertex_dim2=0)],
+        outputs_info=make_ipu_vertex_outputs({"out": outaval}),
+        attributes_i32=attrs_i32,
+        attributes_f32=attrs_f32,
+        gp_filename=get_random_vertex_gp_filename(),
+        perf_estimate=make_random_vertex_perf_estimate(size, vector_size),
+    )
+
+
+def make_random_vertex_perf_estimate(size: int, vector_size: int, num_workers: int = 6) -> int:
+    """Random vertex perf. estimate: roughly one cycle per element (and per worker), plus the tail."""
+    num_vectors = -(-size // vector_size)
+    return 50 + (-(-num_vectors // num_workers) + 1) * vector_size * num_workers
+
+
 ipu_random_uniform_p = Primitive("ipu_random_uniform")
 
 
@@ -127,9 +176,15 @@ def ipu_random_uniform_translation_ipu(
     dtype = np.dtype(attributes["dtype"])
     offset = attributes["offset"]
     scale = attributes["scale"]
+    outaval = ipu_random_uniform_abstract_eval(size, dtype, offset, scale)
+    if dtype != np.int32:
+        # Worker-parallel custom vertex for floating dtypes.
+        return make_random_vertex_equation(
+            p, tiles, "RandomUniformVertex", outaval, offset=float(offset), scale=float(scale)
+        )
     vname = make_ipu_vertex_name_templated("poprand::Uniform", dtype)
 
-    outavals_dict = {"out": ipu_random_uniform_abstract_eval(size, dtype, offset, scale)}
+    outavals_dict = {"out": outaval}
     attrs_i32, attrs_f32 = make_ipu_vertex_attributes(offset=offset, scale=scale)
     # Translation rule to IPU vertex.
     ipu_prim_info = IpuTileMapEquation(
@@ -151,7 +206,11 @@ register_ipu_tile_primitive(ipu_random_uniform_p, ipu_random_uniform_translation
 def ipu_random_uniform_tmap(
     tiles: Tuple[int, ...], size: int, dtype: DTypeLike, offset: float = 0.0, scale: float = 1.0
 ) -> TileShardedArray:
-    """IPU Uniform sampling on a collection of tiles."""
+    """IPU Uniform sampling on a collection of tiles: `offset + scale * U[0, 1]`.
+
+    Floating dtypes are sampled with worker-parallel vertices using the tile hardware RNG,
+    seeded with `ipu_set_hw_seeds_tmap`. The `int32` dtype uses the `poprand` vertex.
+    """
     return tile_map_primitive(  # type:ignore
         ipu_random_uniform_p, size=size, dtype=dtype, offset=offset, scale=scale, tiles=tiles
     )
@@ -179,21 +238,8 @@ def ipu_random_normal_translation_ipu(
     dtype = np.dtype(attributes["dtype"])
     mean = float(attributes["mean"])
     stddev = float(attributes["stddev"])
-    vname = make_ipu_vertex_name_templated("poprand::Normal", dtype)
-
-    outavals_dict = {"out": ipu_random_normal_abstract_eval(size, dtype, mean, stddev)}
-    attrs_i32, attrs_f32 = make_ipu_vertex_attributes(mean=mean, stdDev=stddev)
-    # Translation rule to IPU vertex.
-    ipu_prim_info = IpuTileMapEquation(
-        vname=vname,
-        pname=p.name,
-        tiles=tiles,
-        inputs_info=[],
-        outputs_info=make_ipu_vertex_outputs(outavals_dict),
-        attributes_i32=attrs_i32,
-        attributes_f32=attrs_f32,
-    )
-    return ipu_prim_info
+    outaval = ipu_random_normal_abstract_eval(size, dtype, mean, stddev)
+    return make_random_vertex_equation(p, tiles, "RandomNormalVertex", outaval, mean=mean, stddev=stddev)
 
 
 ipu_random_normal_p.def_abstract_eval(ipu_random_normal_abstract_eval)
@@ -203,7 +249,73 @@ register_ipu_tile_primitive(ipu_random_normal_p, ipu_random_normal_translation_i
 def ipu_random_normal_tmap(
     tiles: Tuple[int, ...], size: int, dtype: DTypeLike, mean: float = 0.0, stddev: float = 1.0
 ) -> TileShardedArray:
-    """IPU Normal sampling on a collection of tiles."""
+    """IPU Normal sampling on a collection of tiles, with worker-parallel vertices using the
+    tile hardware RNG (seeded with `ipu_set_hw_seeds_tmap`).
+    """
     return tile_map_primitive(  # type:ignore
         ipu_random_normal_p, size=size, dtype=dtype, mean=mean, stddev=stddev, tiles=tiles
     )
+
+
+ipu_random_truncated_normal_p = Primitive("ipu_random_truncated_normal")
+
+
+def ipu_random_truncated_normal_abstract_eval(
+    size: int, dtype: DTypeLike, mean: float, stddev: float, alpha: float, iterations: int
+) -> ShapedArray:
+    dtype = np.dtype(dtype)
+    # Type supported in the IPU vertex.
+    assert dtype in {np.dtype(np.float16), np.dtype(np.float32)}
+    assert alpha > 0
+    return ShapedArray((size,), dtype)
+
+
+def ipu_random_truncated_normal_translation_ipu(
+    p: Primitive,
+    tiles: Tuple[int, ...],
+    inavals: List[ShapedArray],
+    attributes: Dict[str, Any] = None,
+) -> IpuTileMapEquation:
+    assert attributes is not None
+
+    size = int(attributes["size"])
+    dtype = np.dtype(attributes["dtype"])
+    mean = float(attributes["mean"])
+    stddev = float(attributes["stddev"])
+    alpha = float(attributes["alpha"])
+    iterations = int(attributes["iterations"])
+    outaval = ipu_random_truncated_normal_abstract_eval(size, dtype, mean, stddev, alpha, iterations)
+    return make_random_vertex_equation(
+        p, tiles, "RandomTruncatedNormalVertex", outaval, mean=mean, stddev=stddev, alpha=alpha, iterations=iterations
+    )
+
+
+ipu_random_truncated_normal_p.def_abstract_eval(ipu_random_truncated_normal_abstract_eval)
+register_ipu_tile_primitive(ipu_random_truncated_normal_p, ipu_random_truncated_normal_translation_ipu)
+
+
+def ipu_random_truncated_normal_tmap(
+    tiles: Tuple[int, ...],
+    size: int,
+    dtype: DTypeLike,
+    mean: float = 0.0,
+    stddev: float = 1.0,
+    alpha: float = 2.0,
+    iterations: int = 4,
+) -> TileShardedArray:
+    """IPU truncated Normal sampling on a collection of tiles, with worker-parallel vertices using
+    the tile hardware RNG (seeded with `ipu_set_hw_seeds_tmap`).
+
+    Samples are truncated to `[mean - alpha * stddev, mean + alpha * stddev]`: out of range values
+    are re-sampled at most `iterations` times, and then replaced by uniform samples in the range.
+    """
+    return tile_map_primitive(  # type:ignore
+        ipu_random_truncated_normal_p,
+        size=size,
+        dtype=dtype,
+        mean=mean,
+        stddev=stddev,
+        alpha=alpha,
+        iterations=iterations,
+        tiles=tiles,
+    )
@@ -0,0 +1,258 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+import os
+from dataclasses import dataclass
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+import jax.numpy as jnp
+import numpy as np
+from jax.core import Primitive, ShapedArray
+
+from jax_ipu_experimental_addons.utils import NDArray
+
+from .tile_array import TileShardedArray, make_global_tiles, tile_constant_sharded, tile_put_sharded
+from .tile_interpreter import register_ipu_tile_primitive, tile_map_primitive
+from .tile_interpreter_primitives import (
+    IpuTileMapEquation,
+    make_ipu_vertex_inputs,
+    make_ipu_vertex_name_templated,
+    make_ipu_vertex_outputs,
+)
+
+Array = Any
+
+# Sparse vertex index types (see `tile_sparse_vertex.cpp`).
+sparse_col_index_dtype = np.dtype(np.uint16)
+sparse_row_offset_dtype = np.dtype(np.uint32)
+sparse_worker_offset_dtype = np.dtype(np.uint16)
+
+
+def get_sparse_vertex_gp_filename() -> str:
+    return os.path.join(os.path.dirname(__file__), "vertex", "tile_sparse_vertex.cpp")
+
+
+@dataclass(frozen=True)
+class TileSparseCsrMatrix:
+    """Sparse CSR matrix partitioned in row blocks over tiles (static, host data).
+
+    Every tile stores a CSR row block, with column indices local to the dense vector slice
+    gathered on the tile (i.e. only the columns with non zeros in the block). Per tile arrays
+    are padded to the maximum size over tiles, such that memory scales with the number of
+    non zeros (and not the dense matrix size).
+
+    Args:
+        tiles: Tiles on which row blocks are mapped.
+        shape: (M, N) dense shape of the matrix.
+        rows_per_tile: Number of rows per tile (last tile padded with empty rows).
+        values: (T, nnz_max) non zero values.
+        col_indices: (T, nnz_max) local column indices, in the gathered dense vector slice.
+        row_offsets: (T, rows_per_tile + 1) CSR row offsets.
+        columns: (T, ncols_max) global column indices of the gathered dense vector slice.
+        worker_offsets: (T, num_workers + 1) worker row offsets, balanced on non zeros.
+    """
+
+    tiles: Tuple[int, ...]
+    shape: Tuple[int, int]
+    rows_per_tile: int
+    values: NDArray[Any]
+    col_indices: NDArray[Any]
+    row_offsets: NDArray[Any]
+    columns: NDArray[Any]
+    worker_offsets: NDArray[Any]
+
+    @property
+    def nnz(self) -> int:
+        return int(np.sum(self.row_offsets[:, -1]))
+
+    @property
+    def dtype(self) -> Any:
+        return self.values.dtype
+
+
+def make_sparse_worker_offsets(row_offsets: NDArray[Any], num_workers: int = 6, grain: int = 2) -> NDArray[Any]:
+    """Make worker row offsets of a CSR row block, balanced on the number of non zeros.
+
+    Worker boundaries are multiple of `grain` rows, avoiding concurrent sub-word writes
+    in the output (e.g. half rows).
+
+    Args:
+        row_offsets: (rows + 1,) CSR row offsets.
+        num_workers: Number of workers.
+        grain: Worker rows grain size.
+    Returns:
+        (num_workers + 1,) worker row offsets.
+    """
+    num_rows = len(row_offsets) - 1
+    # Cost: non zeros + a row overhead.
+    cost = row_offsets.astype(np.int64) + np.arange(num_rows + 1)
+    targets = cost[-1] * np.arange(num_workers + 1) / num_workers
+    offsets = np.searchsorted(cost, targets, side="left")
+    offsets = np.round(offsets / grain).astype(np.int64) * grain
+    offsets = np.clip(offsets, 0, num_rows)
+    offsets[0] = 0
+    offsets[-1] = num_rows
+    offsets = np.maximum.accumulate(offsets)
+    assert offsets[-1] <= np.iinfo(sparse_worker_offset_dtype).max
+    return offsets.astype(sparse_worker_offset_dtype)
+
+
+def make_tile_sparse_csr_matrix(
+    data: NDArray[Any],
+    indices: NDArray[Any],
+    indptr: NDArray[Any],
+    shape: Tuple[int, int],
+    tiles: Sequence[int],
+) -> TileSparseCsrMatrix:
+    """Partition a CSR sparse matrix in row blocks over tiles.
+
+    Inputs follow the standard CSR convention (e.g. `scipy.sparse.csr_matrix` `data`,
+    `indices` and `indptr` fields).
+
+    Args:
+        data: (nnz,) non zero values (float32 or float16).
+        indices: (nnz,) column indices.
+        indptr: (M + 1,) row offsets.
+        shape: (M, N) dense shape.
+        tiles: Tiles on which to map the row blocks.
+    Returns:
+        Tile partitioned sparse CSR matrix.
+    """
+    data = np.asarray(data)
+    indices = np.asarray(indices)
+    indptr = np.asarray(indptr)
+    tiles = make_global_tiles(tiles)
+    M, N = shape
+    assert data.dtype in {np.dtype(np.float32), np.dtype(np.float16)}
+    assert len(indptr) == M + 1
+    num_tiles = len(tiles)
+    rows_per_tile = -(-M // num_tiles)
+
+    blocks = []
+    for idx in range(num_tiles):
+        rstart, rend = min(idx * rows_per_tile, M), min((idx + 1) * rows_per_tile, M)
+        kstart, kend = indptr[rstart], indptr[rend]
+        # Dense vector slice required by the row block.
+        columns, local_indices = np.unique(indices[kstart:kend], return_inverse=True)
+        row_offsets = indptr[rstart : rend + 1] - kstart
+        # Padding with empty rows.
+        row_offsets = np.pad(row_offsets, (0, rows_per_tile + 1 - len(row_offsets)), mode="edge")
+        blocks.append((data[kstart:kend], local_indices, row_offsets, columns))
+
+    nnz_max = max([max(len(b[0]), 1) for b in blocks])
+    ncols_max = max([max(len(b[3]), 1) for b in blocks])
+    assert ncols_max <= np.iinfo(sparse_col_index_dtype).max + 1
+
+    def pad_stack(arrays: List[NDArray[Any]], size: int, dtype: Any) -> NDArray[Any]:
+        return np.stack([np.pad(v, (0, size - len(v))) for v in arrays]).astype(dtype)
+
+    row_offsets_all = np.stack([b[2] for b in blocks]).astype(sparse_row_offset_dtype)
+    return TileSparseCsrMatrix(
+        tiles=tiles,
+        shape=(M, N),
+        rows_per_tile=rows_per_tile,
+        values=pad_stack([b[0] for b in blocks], nnz_max, data.dtype),
+        col_indices=pad_stack([b[1] for b in blocks], nnz_max, sparse_col_index_dtype),
+        row_offsets=row_offsets_all,
+        # Padding with column 0 (not used by the vertex).
+        columns=pad_stack([b[3] for b in blocks], ncols_max, np.int32),
+        worker_offsets=np.stack([make_sparse_worker_offsets(v) for v in row_offsets_all]),
+    )
+
+
+sparse_csr_matvec_p = Primitive("sparse_csr_matvec")
+sparse_csr_matvec_p.map_primitive = False
+
+
+def sparse_csr_matvec_abstract_eval(
+    values: ShapedArray,
+    col_indices: ShapedArray,
+    row_offsets: ShapedArray,
+    x: ShapedArray,
+    worker_offsets: ShapedArray,
+) -> ShapedArray:
+    assert values.dtype in {np.dtype(np.float32), np.dtype(np.float16)}
+    assert x.dtype == values.dtype
+    assert col_indices.shape == values.shape
+    assert col_indices.dtype == sparse_col_index_dtype
+    assert row_offsets.dtype == sparse_row_offset_dtype
+    return ShapedArray((row_offsets.shape[0] - 1,), values.dtype)
+
+
+def sparse_csr_matvec_impl(values: Array, col_indices: Array, row_offsets: Array, x: Array, worker_offsets: Array):
+    """Sparse CSR row block matvec, JAX NumPy default implementation."""
+    num_rows = row_offsets.shape[0] - 1
+    # Row index of every non zero (padding values mapped out of range, i.e. dropped).
+    row_ids = jnp.searchsorted(row_offsets, jnp.arange(values.shape[0]), side="right") - 1
+    row_ids = jnp.where(jnp.arange(values.shape[0]) < row_offsets[-1], row_ids, num_rows)
+    products = values.astype(np.float32) * x[col_indices.astype(np.int32)].astype(np.float32)
+    out = jnp.zeros((num_rows + 1,), np.float32).at[row_ids].add(products)
+    return out[:num_rows].astype(values.dtype)
+
+
+def sparse_csr_matvec_translation_ipu(
+    p: Primitive,
+    tiles: Tuple[int, ...],
+    inavals: List[ShapedArray],
+    attributes: Dict[str, Any] = None,
+) -> IpuTileMapEquation:
+    assert len(inavals) == 5
+    names = ["values", "col_indices", "row_offsets", "x", "worker_offsets"]
+    inavals_dict = dict(zip(names, inavals))
+    outaval = sparse_csr_matvec_abstract_eval(*inavals)
+    num_rows = outaval.shape[0]
+    # Perf. estimate: a few cycles per non zero and per row, spread over 6 workers.
+    perf_estimate = 50 + (4 * inavals[0].size + 10 * num_rows) // 6
+    return IpuTileMapEquation(
+        vname=make_ipu_vertex_name_templated("SparseCsrMatVec", inavals[0].dtype),
+        pname=p.name,
+        tiles=tiles,
+        inputs_info=make_ipu_vertex_inputs(inavals_dict),
+        outputs_info=make_ipu_vertex_outputs({"out": outaval}),
+        gp_filename=get_sparse_vertex_gp_filename(),
+        perf_estimate=perf_estimate,
+    )
+
+
+sparse_csr_matvec_p.def_impl(sparse_csr_matvec_impl)
+sparse_csr_matvec_p.def_abstract_eval(sparse_csr_matvec_abstract_eval)
+register_ipu_tile_primitive(sparse_csr_matvec_p, sparse_csr_matvec_translation_ipu)
+
+
+def tile_sparse_csr_gather_vector(A: TileSparseCsrMatrix, x: Array) -> TileShardedArray:
+    """Gather on every tile the dense vector slice required by the sparse row block.
+
+    Args:
+        A: Tile partitioned sparse CSR matrix.
+        x: (N,) dense vector.
+    Returns:
+        (T, ncols_max) tile sharded dense vector slices.
+    """
+    assert x.shape == (A.shape[1],)
+    return tile_put_sharded(x[A.columns], A.tiles)
+
+
+def tile_sparse_csr_matvec(
+    A: TileSparseCsrMatrix, x: Array, values: Optional[TileShardedArray] = None
+) -> TileShardedArray:
+    """Sparse CSR matrix - dense vector product, `A @ x`, with a row block per tile.
+
+    Args:
+        A: Tile partitioned sparse CSR matrix (see `make_tile_sparse_csr_matrix`).
+        x: (N,) dense vector, or already gathered (T, ncols_max) tile sharded slices.
+        values: Optional (T, nnz_max) non zero values, overriding `A.values` (e.g. same
+            sparsity pattern with updated values). Tile constants used by default.
+    Returns:
+        (T, rows_per_tile) tile sharded output (padded rows equal to zero). The dense
+        (M,) output is `output.array.reshape(-1)[:M]`.
+    """
+    if not isinstance(x, TileShardedArray):
+        x = tile_sparse_csr_gather_vector(A, x)
+    if values is None:
+        values = tile_constant_sharded(A.values, A.tiles)
+    assert values.tiles == A.tiles
+    assert x.tiles == A.tiles
+    col_indices = tile_constant_sharded(A.col_indices, A.tiles)
+    row_offsets = tile_constant_sharded(A.row_offsets, A.tiles)
+    worker_offsets = tile_constant_sharded(A.worker_offsets, A.tiles)
+    return tile_map_primitive(  # type:ignore
+        sparse_csr_matvec_p, values, col_indices, row_offsets, x, worker_offsets
+    )
@@ -0,0 +1,381 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+"""Pre-compilation tile memory estimation of tile programs.
+
+Walking the jaxpr of a tile program (i.e. `tile_put_*`, `tile_constant_*`, `tile_gather` and
+`tile_map_primitive` calls), and estimating the memory used on every tile, without any
+Poplar graph compilation. Allows rejecting (or re-sharding) a tile layout in seconds, instead
+of getting an out-of-memory error at the end of the Poplar compilation.
+
+The estimate is split in 4 categories:
+    variables: Tile arrays (and vertex temporary space), with a program order liveness analysis.
+    constants: Tile constants, and vertex constant inputs (deduplicated as in the IPU constant pool).
+    vertex_state: Vertex state of every tile map vertex, i.e. fields pointers & attributes.
+    exchange: Exchange code, a coarse estimate per slice transfer, on sending and receiving tiles.
+
+NOTE: codelets code, Poplar internal buffers and (non tile) XLA operations are not taken into account.
+"""
+import base64
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, Iterator, List, Optional, Sequence, Tuple
+
+import jax
+import numpy as np
+from jax import core
+
+from .tile_common_utils import from_numpy_dtype_to_ipu_type
+from .tile_interpreter_primitives import IpuTileMapEquation, IpuVertexIOType
+
+IPU_TILE_MEMORY_BYTES = 638976
+"""Tile SRAM memory of IPU Mk2 (Bow/GC200), i.e. 624 KiB.
+"""
+
+VERTEX_STATE_BYTES_PER_FIELD = 8
+"""Vertex state estimate, per vertex field (i.e. pointer and size).
+"""
+VERTEX_STATE_BYTES_PER_ATTRIBUTE = 4
+"""Vertex state estimate, per vertex attribute.
+"""
+VERTEX_STATE_BYTES_PER_ROW = 4
+"""Vertex state estimate, per row of 2d vertex fields.
+"""
+EXCHANGE_BYTES_PER_TRANSFER = 32
+"""Exchange code estimate, per slice transfer (on sending and receiving tiles).
+"""
+
+TileBytes = Dict[int, int]
+"""Bytes per (global) tile index.
+"""
+
+
+def _add_tile_bytes(d: TileBytes, tile: int, nbytes: int):
+    if nbytes > 0:
+        d[tile] = d.get(tile, 0) + int(nbytes)
+
+
+def _merge_tile_bytes(tile_bytes_list: Sequence[TileBytes]) -> TileBytes:
+    merged: TileBytes = {}
+    for tile_bytes in tile_bytes_list:
+        for t, nbytes in tile_bytes.items():
+            _add_tile_bytes(merged, t, nbytes)
+    return merged
+
+
+@dataclass
+class TileMemoryEstimate:
+    """Tile memory estimate of a tile program (in bytes, per tile).
+
+    Args:
+        variables: Peak tile arrays memory (liveness in program order).
+        constants: Tile constants memory.
+        vertex_state: Vertex state memory.
+        exchange: Exchange code memory.
+    """
+
+    variables: TileBytes = field(default_factory=dict)
+    constants: TileBytes = field(default_factory=dict)
+    vertex_state: TileBytes = field(default_factory=dict)
+    exchange: TileBytes = field(default_factory=dict)
+
+    @property
+    def tiles(self) -> Tuple[int, ...]:
+        """Sorted tiles used by the tile program."""
+        return tuple(sorted(set(self.variables) | set(self.constants) | set(self.vertex_state) | set(self.exchange)))
+
+    @property
+    def total(self) -> TileBytes:
+        """Total memory estimate per tile."""
+        categories = (self.variables, self.constants, self.vertex_state, self.exchange)
+        return {t: sum([c.get(t, 0) for c in categories]) for t in self.tiles}
+
+    @property
+    def peak_tile(self) -> Optional[int]:
+        """Tile with the highest memory estimate (None if no tile used)."""
+        total = self.total
+        return max(total, key=lambda t: (total[t], -t)) if total else None
+
+    @property
+    def peak_bytes(self) -> int:
+        """Highest tile memory estimate."""
+        return max(self.total.values(), default=0)
+
+    def fits(self, tile_memory_bytes: int = IPU_TILE_MEMORY_BYTES) -> bool:
+        """Does the tile program (likely) fit in tile memory?"""
+        return self.peak_bytes <= tile_memory_bytes
+
+
+@dataclass
+class _TileAllocation:
+    """Tile array allocation: bytes per tile."""
+
+    tile_bytes: TileBytes
+    last_use: int = -1
+
+
+def _aval_tile_nbytes(aval: Any) -> int:
+    """Bytes of a tile slice of a (T, ...) tile array."""
+    return int(np.prod(aval.shape[1:], dtype=np.int64)) * np.dtype(aval.dtype).itemsize
+
+
+def _ipu_aval_nbytes(aval: Any) -> int:
+    return int(aval.size) * int(aval.dtype.bytesize)
+
+
+def _tile_map_equation_aliases(tile_map_eqn: IpuTileMapEquation, invars: Sequence[Any]) -> Dict[int, List[Any]]:
+    """In-place outputs of a tile map equation, aliasing the (non constant) input with the same name."""
+    input_names = [v.name for v in tile_map_eqn.inputs_info if not v.is_constant_input]
+    aliases: Dict[int, List[Any]] = {}
+    for i, info in enumerate(tile_map_eqn.outputs_info):
+        if info.iotype != IpuVertexIOType.Out and info.name in input_names[: len(invars)]:
+            aliases[i] = [invars[input_names.index(info.name)]]
+    return aliases
+
+
+def _iter_sub_jaxprs(params: Dict[str, Any]) -> Iterator[core.Jaxpr]:
+    """Iterate over the sub-jaxprs of an equation (calls, loops, conditionals, ...)."""
+    for v in params.values():
+        for e in v if isinstance(v, (tuple, list)) else (v,):
+            if isinstance(e, core.ClosedJaxpr):
+                yield e.jaxpr
+            elif isinstance(e, core.Jaxpr):
+                yield e
+
+
+class _TileMemoryEstimator:
+    """Jaxpr walker accumulating tile memory estimates."""
+
+    def __init__(self):
+        self.estimate = TileMemoryEstimate()
+        # Constants deduplication keys, per tile.
+        self.constant_keys: Dict[int, set] = {}
+
+    def add_constant(self, tile: int, key: Any, nbytes: int):
+        """Add a tile constant, deduplicated using (dtype, shape, content) as key."""
+        keys = self.constant_keys.setdefault(tile, set())
+        if key in keys:
+            return
+        keys.add(key)
+        _add_tile_bytes(self.estimate.constants, tile, nbytes)
+
+    def add_exchange(self, tiles: Sequence[int]):
+        for t in tiles:
+            _add_tile_bytes(self.estimate.exchange, t, EXCHANGE_BYTES_PER_TRANSFER)
+
+    def add_tile_map_equation(self, tile_map_eqn: IpuTileMapEquation) -> Tuple[List[Optional[TileBytes]], TileBytes]:
+        """Add a tile map equation vertex state and constants.
+
+        Returns:
+            (outputs, tmp_space) tile allocations, with None for in-place outputs.
+        """
+        tiles = list(tile_map_eqn.tiles)
+        num_fields = len(tile_map_eqn.inputs_info) + len(tile_map_eqn.outputs_info)
+        num_attributes = len(tile_map_eqn.attributes_i32) + len(tile_map_eqn.attributes_f32)
+        num_rows = sum([len(v.slices2d) for v in list(tile_map_eqn.inputs_info) + list(tile_map_eqn.outputs_info)])
+        vertex_state = (
+            VERTEX_STATE_BYTES_PER_FIELD * (num_fields + int(tile_map_eqn.use_tmp_space))
+            + VERTEX_STATE_BYTES_PER_ATTRIBUTE * num_attributes
+            + VERTEX_STATE_BYTES_PER_ROW * num_rows
+        )
+        for t in tiles:
+            _add_tile_bytes(self.estimate.vertex_state, t, vertex_state)
+        # Vertex constant inputs.
+        for info in tile_map_eqn.inputs_info:
+            if not info.is_constant_input:
+                continue
+            nbytes = _ipu_aval_nbytes(info.aval)
+            raw_data = base64.b64decode(info.constant_data.encoded_data)
+            for idx, t in enumerate(tiles):
+                # Sharded constants: a different slice on every tile.
+                tile_data = raw_data[idx * nbytes : (idx + 1) * nbytes] if info.constant_sharded else raw_data
+                self.add_constant(t, (info.aval.dtype, tuple(info.aval.shape), tile_data), nbytes)
+        outputs: List[Optional[TileBytes]] = [
+            {t: _ipu_aval_nbytes(info.aval) for t in tiles} if info.iotype == IpuVertexIOType.Out else None
+            for info in tile_map_eqn.outputs_info
+        ]
+        # Temporary scratch space, only live during the vertex call.
+        tmp_space: TileBytes = {}
+        if tile_map_eqn.use_tmp_space:
+            tmp_space = {t: _ipu_aval_nbytes(tile_map_eqn.tmp_space_aval) for t in tiles}
+        return outputs, tmp_space
+
+    def walk(self, jaxpr: core.Jaxpr) -> Tuple[TileBytes, List[Optional[TileBytes]]]:
+        """Walk a jaxpr, returning peak variables memory and outputs tile allocations."""
+        # Last use of every variable (jaxpr outputs live until the end).
+        last_use: Dict[core.Var, int] = {}
+        for idx, eqn in enumerate(jaxpr.eqns):
+            for v in eqn.invars:
+                if isinstance(v, core.Var):
+                    last_use[v] = idx
+        for v in jaxpr.outvars:
+            if isinstance(v, core.Var):
+                last_use[v] = len(jaxpr.eqns)
+
+        # Tile allocations of every variable (multiple when partially aliasing inputs).
+        allocs: Dict[core.Var, List[_TileAllocation]] = {}
+        # Allocations to release after every equation.
+        releases: Dict[int, List[_TileAllocation]] = {}
+        # Tile mapping of tile arrays.
+        var_tiles: Dict[core.Var, Tuple[int, ...]] = {}
+        live: TileBytes = {}
+        peak: TileBytes = {}
+
+        def update_peak(extra: TileBytes):
+            for t in set(live) | set(extra):
+                peak[t] = max(peak.get(t, 0), live.get(t, 0) + extra.get(t, 0))
+
+        def use(var: core.Var, idx: int):
+            for alloc in allocs[var]:
+                new_last_use = max(alloc.last_use, last_use.get(var, idx))
+                if new_last_use != alloc.last_use:
+                    alloc.last_use = new_last_use
+                    releases.setdefault(new_last_use, []).append(alloc)
+
+        def moved_allocation(outvar: core.Var, invar: Any, src_tiles: Sequence[int], tiles: Sequence[int]) -> TileBytes:
+            """Allocation of moved slices only, the other output slices aliasing the input on the same tile."""
+            moved = [src != t for src, t in zip(src_tiles, tiles)]
+            if not all(moved) and invar in allocs:
+                aliases[0] = [invar]
+            # Negative source tile: no existing tile mapping.
+            self.add_exchange([v for src, t, m in zip(src_tiles, tiles, moved) if m for v in (src, t) if v >= 0])
+            nbytes = _aval_tile_nbytes(outvar.aval)
+            return {t: nbytes for t, m in zip(tiles, moved) if m}
+
+        for idx, eqn in enumerate(jaxpr.eqns):
+            pname = eqn.primitive.name
+            params = eqn.params
+            new_allocs: List[Optional[TileBytes]] = [None] * len(eqn.outvars)
+            aliases: Dict[int, List[Any]] = {}
+            extra: TileBytes = {}
+
+            if pname in ("tile_put_sharded", "tile_put_replicated"):
+                tiles = tuple(params["tiles"])
+                in_tiles = var_tiles.get(eqn.invars[0], ()) if pname == "tile_put_sharded" else ()
+                if in_tiles:
+                    # Slices already on the proper tile are not copied (aliasing the input).
+                    new_allocs[0] = moved_allocation(eqn.outvars[0], eqn.invars[0], in_tiles, tiles)
+                else:
+                    new_allocs[0] = {t: _aval_tile_nbytes(eqn.outvars[0].aval) for t in tiles}
+                    self.add_exchange(tiles)
+                var_tiles[eqn.outvars[0]] = tiles
+            elif pname == "tile_gather":
+                tiles = tuple(params["tiles"])
+                src_tiles = [params["previous_tiles"][i] for i in params["indices"]]
+                new_allocs[0] = moved_allocation(eqn.outvars[0], eqn.invars[0], src_tiles, tiles)
+                var_tiles[eqn.outvars[0]] = tiles
+            elif pname in ("tile_constant_sharded", "tile_constant_replicated"):
+                tiles = tuple(params["tiles"])
+                data = np.ascontiguousarray(params["data"])
+                ipu_type = from_numpy_dtype_to_ipu_type(data.dtype)
+                for i, t in enumerate(tiles):
+                    tile_data = data[i] if pname == "tile_constant_sharded" else data
+                    self.add_constant(t, (ipu_type, tile_data.shape, tile_data.tobytes()), tile_data.nbytes)
+                var_tiles[eqn.outvars[0]] = tiles
+            elif pname == "tile_data_barrier":
+                # In-place barrier vertex, on all input tiles.
+                for i, (invar, tiles) in enumerate(zip(eqn.invars, params["inputs_tiles"])):
+                    aliases[i] = [invar]
+                    for t in tiles:
+                        _add_tile_bytes(self.estimate.vertex_state, t, VERTEX_STATE_BYTES_PER_FIELD)
+            elif pname in ("tile_map_equation_call_single_out", "tile_map_equation_call_multi_out"):
+                tiles = tuple(params["tiles"])
+                tile_map_eqn = IpuTileMapEquation.from_json_str(params["tile_map_eqn_json"])
+                outputs, extra = self.add_tile_map_equation(tile_map_eqn)
+                aliases = _tile_map_equation_aliases(tile_map_eqn, eqn.invars)
+                new_allocs[: len(outputs)] = outputs[: len(eqn.outvars)]
+                # Additional profiling cycle count output.
+                for i in range(len(outputs), len(eqn.outvars)):
+                    new_allocs[i] = {t: _aval_tile_nbytes(eqn.outvars[i].aval) for t in tiles}
+                for v in eqn.outvars:
+                    var_tiles[v] = tiles
+            elif pname == "tile_map_equation_group_call":
+                # Single compute set: all temporary spaces live at the same time.
+                inidx, outidx = 0, 0
+                for _, tiles, tile_map_eqn_json, num_inputs, _ in params["group"]:
+                    tile_map_eqn = IpuTileMapEquation.from_json_str(tile_map_eqn_json)
+                    outputs, tmp_space = self.add_tile_map_equation(tile_map_eqn)
+                    # Same in-place aliasing as single tile map calls, on the equation inputs slice.
+                    eqn_aliases = _tile_map_equation_aliases(tile_map_eqn, eqn.invars[inidx : inidx + num_inputs])
+                    for i, tile_bytes in enumerate(outputs):
+                        if outidx + i < len(eqn.outvars):
+                            new_allocs[outidx + i] = tile_bytes
+                            var_tiles[eqn.outvars[outidx + i]] = tuple(tiles)
+                            if i in eqn_aliases:
+                                aliases[outidx + i] = eqn_aliases[i]
+                    inidx += num_inputs
+                    outidx += len(outputs)
+                    for t, v in tmp_space.items():
+                        _add_tile_bytes(extra, t, v)
+            else:
+                # Sub-jaxprs (jit calls, loops, ...): all constants, and max of variables peaks.
+                sub_peaks: TileBytes = {}
+                for sub_jaxpr in _iter_sub_jaxprs(params):
+                    sub_peak, sub_outputs = self.walk(sub_jaxpr)
+                    for t, v in sub_peak.items():
+                        sub_peaks[t] = max(sub_peaks.get(t, 0), v)
+                    if len(sub_outputs) == len(eqn.outvars):
+                        new_allocs = [a or b for a, b in zip(new_allocs, sub_outputs)]
+                # Sub-jaxprs peaks already including their outputs.
+                update_peak(sub_peaks)
+
+            # New allocations, and aliases extending the input allocation liveness.
+            for i, v in enumerate(eqn.outvars):
+                aliased = [a for a in aliases.get(i, []) if isinstance(a, core.Var) and a in allocs]
+                out_allocs = [alloc for a in aliased for alloc in allocs[a]]
+                if aliased and v not in var_tiles:
+                    var_tiles[v] = var_tiles.get(aliased[0], ())
+                if new_allocs[i]:
+                    out_allocs.append(_TileAllocation(dict(new_allocs[i])))
+                    for t, nbytes in new_allocs[i].items():
+                        _add_tile_bytes(live, t, nbytes)
+                if out_allocs:
+                    allocs[v] = out_allocs
+                    use(v, idx)
+            for v in eqn.invars:
+                if isinstance(v, core.Var) and v in allocs:
+                    use(v, idx)
+            update_peak(extra)
+            # Release dead allocations (skipping the ones with an extended liveness).
+            for alloc in releases.pop(idx, []):
+                if alloc.last_use == idx:
+                    for t, nbytes in alloc.tile_bytes.items():
+                        live[t] -= nbytes
+
+        update_peak({})
+        outputs = [
+            _merge_tile_bytes([a.tile_bytes for a in allocs[v]]) if isinstance(v, core.Var) and v in allocs else None
+            for v in jaxpr.outvars
+        ]
+        return peak, outputs
+
+
+def tile_memory_estimate_jaxpr(jaxpr: Any) -> TileMemoryEstimate:
+    """Estimate the memory used on every tile by a tile program jaxpr.
+
+    Args:
+        jaxpr: Jaxpr (or closed jaxpr) of the tile program.
+    Returns:
+        Tile memory estimate.
+    """
+    if isinstance(jaxpr, core.ClosedJaxpr):
+        jaxpr = jaxpr.jaxpr
+    estimator = _TileMemoryEstimator()
+    peak, _ = estimator.walk(jaxpr)
+    estimator.estimate.variables = {t: v for t, v in peak.items() if v > 0}
+    return estimator.estimate
+
+
+def tile_memory_estimate(fn: Callable[..., Any], *args: Any, **kwargs: Any) -> TileMemoryEstimate:
+    """Estimate the memory used on every tile by a tile program, without any Poplar compilation.
+
+    Args:
+        fn: Tile program function (e.g. using `tile_put_sharded` and `tile_map_primitive`).
+        *args, **kwargs: Function arguments (arrays or `jax.ShapeDtypeStruct`).
+    Returns:
+        Tile memory estimate.
+
+    Example:
+        estimate = tile_memory_estimate(compute_fn, x)
+        if not estimate.fits():
+            print(f"Tile {estimate.peak_tile} out of memory: {estimate.peak_bytes} bytes.")
+    """
+    closed_jaxpr = jax.make_jaxpr(fn)(*args, **kwargs)
+    return tile_memory_estimate_jaxpr(closed_jaxpr)
@@ -0,0 +1,147 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+"""Pybind11 native modules import: prebuilt extensions, with a cppimport JIT fallback.
+
+Native modules are built at install time by `setup.py` (see `build_ext`), alongside a hash of their
+sources. The cppimport JIT compilation is only used when no up-to-date prebuilt extension is available
+(e.g. modified sources in a development install), or when forced with the environment variable
+`JAX_IPU_NATIVE_JIT=1`.
+JIT compilations are serialized between processes with a file lock.
+"""
+import fcntl
+import hashlib
+import importlib
+import importlib.machinery
+import importlib.util
+import os
+import re
+import sys
+import tempfile
+from contextlib import contextmanager
+from typing import Any, Dict, Iterator, List, Optional
+
+# NOTE: no package relative import, as also directly used by `setup.py` for building native modules.
+_cppimport_cfg_regex = re.compile(r"<%(.*?)%>", re.DOTALL)
+_local_include_regex = re.compile(r'^\s*#\s*include\s*"([^"]+)"', re.MULTILINE)
+
+
+def use_native_jit() -> bool:
+    """Is the cppimport JIT compilation of native modules forced? Set with `JAX_IPU_NATIVE_JIT=1`."""
+    return os.environ.get("JAX_IPU_NATIVE_JIT", "0").lower() in ("1", "true")
+
+
+def get_local_source_dependencies(filename: str) -> List[str]:
+    """Get a C++ source file and all its local (quoted) includes, recursively.
+
+    Only includes resolved relatively to the including file are collected, i.e. the
+    headers shipped alongside the sources (e.g. `common.hpp`, `intrinsics_utils.hpp`).
+    """
+    filename = os.path.abspath(filename)
+    dependencies: List[str] = []
+    pending = [filename]
+    while len(pending) > 0:
+        fname = pending.pop()
+        if fname in dependencies:
+            continue
+        dependencies.append(fname)
+        with open(fname, errors="replace") as f:
+            content = f.read()
+        for incname in _local_include_regex.findall(content):
+            incpath = os.path.abspath(os.path.join(os.path.dirname(fname), incname))
+            if os.path.isfile(incpath):
+                pending.append(incpath)
+    return dependencies
+
+
+def get_native_module_cfg(filename: str) -> Dict[str, Any]:
+    """Get the cppimport build configuration of a native module source (`<% ... %>` block)."""
+    with open(filename) as f:
+        content = f.read()
+    match = _cppimport_cfg_regex.search(content)
+    cfg: Dict[str, Any] = {}
+    if match is not None:
+        exec(match.group(1), {"cfg": cfg, "setup_pybind11": lambda cfg: None})
+    return cfg
+
+
+def get_native_module_dependencies(filename: str) -> List[str]:
+    """Get all the local source files a native module depends on (additional sources included)."""
+    filename = os.path.abspath(filename)
+    dirname = os.path.dirname(filename)
+    sources = [filename] + [os.path.join(dirname, s) for s in get_native_module_cfg(filename).get("sources", [])]
+    dependencies: List[str] = []
+    for src in sources:
+        dependencies += [d for d in get_local_source_dependencies(src) if d not in dependencies]
+    return dependencies
+
+
+def make_native_module_sources_hash(filename: str) -> str:
+    """Make the hash of all the source files of a native module (content only)."""
+    h = hashlib.sha256()
+    for fname in get_native_module_dependencies(filename):
+        with open(fname, "rb") as f:
+            h.update(hashlib.sha256(f.read()).digest())
+    return h.hexdigest()
+
+
+def get_native_module_hash_filename(ext_dirname: str, fullname: str) -> str:
+    """Get the filename storing the sources hash of a prebuilt native module."""
+    return os.path.join(ext_dirname, fullname.split(".")[-1] + ".sources.sha256")
+
+
+def find_prebuilt_native_module(fullname: str, filename: str) -> Optional[str]:
+    """Find an up-to-date prebuilt extension of a native module, i.e. built from the current sources."""
+    dirname = os.path.dirname(os.path.abspath(filename))
+    hash_filename = get_native_module_hash_filename(dirname, fullname)
+    if not os.path.isfile(hash_filename):
+        return None
+    with open(hash_filename) as f:
+        if f.read().strip() != make_native_module_sources_hash(filename):
+            return None
+    modname = fullname.split(".")[-1]
+    for suffix in importlib.machinery.EXTENSION_SUFFIXES:
+        ext_filename = os.path.join(dirname, modname + suffix)
+        if os.path.isfile(ext_filename):
+            return ext_filename
+    return None
+
+
+@contextmanager
+def native_module_file_lock(filename: str) -> Iterator[None]:
+    """Inter-process file lock, serializing the JIT compilation of a native module."""
+    pathhash = hashlib.sha1(os.path.abspath(filename).encode()).hexdigest()[:16]
+    lock_filename = os.path.join(tempfile.gettempdir(), f"jax_ipu_native_{pathhash}.lock")
+    with open(lock_filename, "w") as f:
+        fcntl.flock(f, fcntl.LOCK_EX)
+        try:
+            yield
+        finally:
+            fcntl.flock(f, fcntl.LOCK_UN)
+
+
+def import_native_module(filename: str, fullname: str) -> Any:
+    """Import a pybind11 native module, prebuilt or compiled with cppimport.
+
+    Args:
+        filename: Native module C++ source filename.
+        fullname: Full module name.
+    Returns:
+        Native Python module.
+    """
+    if fullname in sys.modules:
+        return sys.modules[fullname]
+    ext_filename = None if use_native_jit() else find_prebuilt_native_module(fullname, filename)
+    if ext_filename is not None:
+        try:
+            spec = importlib.util.spec_from_file_location(fullname, ext_filename)
+            module = importlib.util.module_from_spec(spec)  # type: ignore
+            spec.loader.exec_module(module)  # type: ignore
+            sys.modules[fullname] = module
+            return module
+        except ImportError:
+            # E.g. extension built against another Poplar SDK => JIT re-compilation.
+            pass
+    import cppimport
+
+    # Only one process compiling, others re-using the compiled module.
+    with native_module_file_lock(filename):
+        return cppimport.imp_from_filepath(filename, fullname)
@@ -64,3 +64,57 @@ template class CycleCountBarrier<unsigned>;
 template class CycleCountBarrier<int>;
 template class CycleCountBarrier<float>;
 template class CycleCountBarrier<half>;
+
+/**
+ * @brief Cycle count start vertex, used in tile map equation profiling mode.
+ *
+ * Write the current (64 bits) cycle count as (low, high) 32 bits words.
+ */
+class CycleCountStart : public SupervisorVertex {
+  static const bool needsAlignWorkers = false;
+
+ public:
+  Output<Vector<unsigned, VectorLayout::ONE_PTR>> cycles;  // (2,)
+
+  SUPERVISOR_TARGET bool compute() {
+#ifdef __IPU__
+    cycles[0] = __builtin_ipu_get_scount_l();
+    cycles[1] = __builtin_ipu_get_scount_u();
+#else
+    cycles[0] = 0;
+    cycles[1] = 0;
+#endif
+    return true;
+  }
+};
+
+/**
+ * @brief Cycle count delta vertex, used in tile map equation profiling mode.
+ *
+ * Update in-place the start cycle count, writing the (64 bits) cycle delta as
+ * (low, high) 32 bits words.
+ */
+class CycleCountDelta : public SupervisorVertex {
+  static const bool needsAlignWorkers = false;
+
+ public:
+  InOut<Vector<unsigned, VectorLayout::ONE_PTR>> cycles;  // (2,)
+
+  SUPERVISOR_TARGET bool compute() {
+#ifdef __IPU__
+    const unsigned end_l = __builtin_ipu_get_scount_l();
+    const unsigned end_u = __builtin_ipu_get_scount_u();
+#else
+    const unsigned end_l = 0;
+    const unsigned end_u = 0;
+#endif
+    const unsigned long long start =
+        (static_cast<unsigned long long>(cycles[1]) << 32) | cycles[0];
+    const unsigned long long end =
+        (static_cast<unsigned long long>(end_u) << 32) | end_l;
+    const unsigned long long delta = end - start;
+    cycles[0] = static_cast<unsigned>(delta);
+    cycles[1] = static_cast<unsigned>(delta >> 32);
+    return true;
+  }
+};
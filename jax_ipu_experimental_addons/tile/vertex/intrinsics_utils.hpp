@@ -72,6 +72,104 @@ ALWAYS_INLINE float ld32(const T* address, unsigned offset) {
   return result;
 }
 
+/**
+ * @brief In-place `x = x + TAS * v` loop on float2 vectors, using `ld2x64pace`
+ * dual loads of x and v (which must be in different memory banks), and the
+ * `f32v2axpy` pipeline (`$TAS` register must be set beforehand).
+ *
+ * Unbundled loop (~5 instructions per float2), supporting any size. See
+ * `f32v2axpy_inplace_ld2xst64pace` for the optimized loop.
+ *
+ * @param xptr In/out x pointer (8 bytes aligned).
+ * @param vptr Input v pointer (8 bytes aligned).
+ * @param size Number of float2 vectors. Must be > 0.
+ */
+ALWAYS_INLINE void f32v2axpy_inplace_ld2x64pace(float2* xptr,
+                                                const float2* vptr,
+                                                unsigned size) noexcept {
+  const float2* xinptr = xptr;
+  unsigned count = size - 1;
+  asm volatile(
+      R"l(  ld64step $a0:1, $mzero, %[xin]+=, 1
+            ld64step $a2:3, $mzero, %[vin]+=, 1
+            tapack $m0:1, %[xin], %[vin], $mzero
+            brz %[count], 2f
+            add %[count], %[count], -1
+          1:
+            f32v2axpy $a6:7, $a0:1, $a2:3
+            ld2x64pace $a0:1, $a2:3, $m0:1+=, $mzero, 0b0000
+            f32v2axpy $a4:5, $a6:7, $a6:7
+            st64step $a4:5, $mzero, %[xout]+=, 1
+            brnzdec %[count], 1b
+          2:
+            f32v2axpy $a6:7, $a0:1, $a2:3
+            f32v2axpy $a4:5, $a6:7, $a6:7
+            st64step $a4:5, $mzero, %[xout]+=, 1
+      )l"
+      : [xin] "+r"(xinptr), [vin] "+r"(vptr), [xout] "+r"(xptr),
+        [count] "+r"(count)
+      :
+      : "$a0", "$a1", "$a2", "$a3", "$a4", "$a5", "$a6", "$a7", "$m0", "$m1",
+        "memory");
+}
+
+/** Maximum `rpt` loop count (12 bits repeat count register). */
+constexpr unsigned kIpuRptMaxCount = 4095;
+
+/**
+ * @brief In-place `x = x + TAS * v` loop on float2 vectors, with a single
+ * bundle `{ld2xst64pace ; f32v2axpy}` per float2 in a `rpt` loop (i.e. ~1
+ * cycle per float2): dual loads of x and v, and store of the x result of two
+ * iterations before (x and v must be in different memory banks, and x in
+ * interleaved memory, as x is loaded and stored in the same cycle). `$TAS`
+ * register must be set beforehand.
+ *
+ * @param xptr In/out x pointer (8 bytes aligned, interleaved memory).
+ * @param vptr Input v pointer (8 bytes aligned).
+ * @param size Number of float2 vectors. Must be in [3, kIpuRptMaxCount + 3].
+ */
+ALWAYS_INLINE void f32v2axpy_inplace_ld2xst64pace(float2* xptr,
+                                                  const float2* vptr,
+                                                  unsigned size) noexcept {
+  // First 3 float2 loaded (and pushed in the axpy pipeline) outside the loop.
+  const unsigned count = size - 3;
+  asm volatile(
+      R"l(  tapack $m0:1, %[xin], %[vin], %[xout]
+            ld2x64pace $a0:1, $a2:3, $m0:1+=, $mzero, 0b0000
+            {
+              ld2x64pace $a0:1, $a2:3, $m0:1+=, $mzero, 0b0000
+              f32v2axpy $a4:5, $a0:1, $a2:3
+            }
+            {
+              ld2x64pace $a0:1, $a2:3, $m0:1+=, $mzero, 0b0000
+              f32v2axpy $a4:5, $a0:1, $a2:3
+            }
+            .align 8
+            {
+              rpt %[count], (2f - 1f) / 8 - 1
+              fnop
+            }
+          1:
+            {
+              ld2xst64pace $a0:3, $a4:5, $m0:1+=, $mzero, 0b000000
+              f32v2axpy $a4:5, $a0:1, $a2:3
+            }
+          2:
+            {
+              st64pace $a4:5, $m0:1+=, $mzero, 0b00
+              f32v2axpy $a4:5, $a0:1, $a2:3
+            }
+            {
+              st64pace $a4:5, $m0:1+=, $mzero, 0b00
+              f32v2axpy $a4:5, $azeros, $azeros
+            }
+            st64pace $a4:5, $m0:1+=, $mzero, 0b00
+      )l"
+      :
+      : [xin] "r"(xptr), [vin] "r"(vptr), [xout] "r"(xptr), [count] "r"(count)
+      : "$a0", "$a1", "$a2", "$a3", "$a4", "$a5", "$m0", "$m1", "memory");
+}
+
 struct __ipu_and_ipumodel_tas {
   void put(float v) { __builtin_ipu_put_tas(v); }
   float2 f32v2axpy(float2 const& x, float2 const& y) {
@@ -79,8 +177,16 @@ struct __ipu_and_ipumodel_tas {
   }
 };
 
+/**
+ * @brief Decorrelate the hardware RNG between tiles and workers: no-op on IPU
+ * hardware, where every tile worker has its own (seeded) RNG state.
+ */
+ALWAYS_INLINE void __ipu_and_ipumodel_rng_decorrelate(const void*,
+                                                      unsigned) noexcept {}
+
 #else
 
+#include <cstdint>
 #include <limits>
 
 namespace ipu {
@@ -170,4 +276,136 @@ T __builtin_ipu_f32v2axpy(T const& x, T const& y) {
 }
 // clang-format on
 
+/**
+ * @brief IPU model hardware RNG: xorshift128+ generator per host thread.
+ *
+ * NOTE: not controlled by the hardware seeds (i.e. `setHwSeeds`) on the IPU
+ * model, only statistically equivalent to the IPU `urand`/`grand` builtins.
+ * Host threads are running many tiles/workers, hence every vertex call should
+ * mix its tile and worker identifiers in the state (see `decorrelate`).
+ */
+struct __ipumodel_hw_rng {
+  static ALWAYS_INLINE uint64_t* state() noexcept {
+    thread_local uint64_t s[2] = {0x9e3779b97f4a7c15ull, 0xbf58476d1ce4e5b9ull};
+    return s;
+  }
+
+  /** @brief SplitMix64 finalizer, spreading keys bits over the state. */
+  static ALWAYS_INLINE uint64_t splitmix64(uint64_t x) noexcept {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  /**
+   * @brief Mix a tile key and worker id in the current state, decorrelating
+   * tiles and workers sharing the same host thread.
+   */
+  static ALWAYS_INLINE void decorrelate(uint64_t tile_key,
+                                        unsigned wid) noexcept {
+    uint64_t* s = state();
+    s[0] ^= splitmix64(tile_key);
+    s[1] ^= splitmix64(tile_key ^ (uint64_t(wid + 1) << 56));
+    // xorshift128+ state must not be all zeros.
+    if (s[0] == 0 && s[1] == 0) {
+      s[1] = 0xbf58476d1ce4e5b9ull;
+    }
+  }
+
+  static ALWAYS_INLINE uint64_t next() noexcept {
+    uint64_t* s = state();
+    uint64_t s1 = s[0];
+    const uint64_t s0 = s[1];
+    s[0] = s0;
+    s1 ^= s1 << 23;
+    s[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+    return s[1] + s0;
+  }
+};
+
+// https://docs.graphcore.ai/projects/poplar-api/en/latest/ipu_intrinsics/ipu_builtins.html#random-number-generation
+/** @brief Uniform FP32 sample in [-0.5, 0.5]. */
+ALWAYS_INLINE float __builtin_ipu_urand_f32() {
+  // 24 bits mantissa
+  return float(__ipumodel_hw_rng::next() >> 40) * (1.0f / 16777216.0f) - 0.5f;
+}
+
+/**
+ * @brief Decorrelate the IPU model RNG between tiles and workers. The tile key
+ * is a tile (and vertex) specific address, e.g. the vertex output, as the tile
+ * id is not available on the IPU model.
+ */
+ALWAYS_INLINE void __ipu_and_ipumodel_rng_decorrelate(const void* tile_key,
+                                                      unsigned wid) noexcept {
+  __ipumodel_hw_rng::decorrelate(reinterpret_cast<uintptr_t>(tile_key), wid);
+}
+
+/** @brief Normal FP32 samples (Box-Muller transform). */
+ALWAYS_INLINE float2 __builtin_ipu_f32v2grand() {
+  const float u0 = __builtin_ipu_urand_f32() + 0.5f;
+  const float u1 = __builtin_ipu_urand_f32() + 0.5f;
+  // Avoiding log(0).
+  const float r = std::sqrt(-2.0f * std::log(1.0f - u0));
+  const float theta = 6.283185307179586f * u1;
+  return float2{r * std::cos(theta), r * std::sin(theta)};
+}
+
+#endif
+
+/**
+ * @brief Storage vector traits, for FP32 compute on float or half storage.
+ *
+ * Storage vectors are 64 bits (float2 or half4), converted to FP32 compute
+ * vectors (float2 or float4).
+ */
+template <typename T>
+struct StorageVectorTraits;
+
+template <>
+struct StorageVectorTraits<float> {
+  using StorageVector = float2;
+  using ComputeVector = float2;
+  static constexpr unsigned size = 2;
+
+  static ALWAYS_INLINE ComputeVector splat(float v) noexcept {
+    return ComputeVector{v, v};
+  }
+  static ALWAYS_INLINE ComputeVector to_compute(StorageVector v) noexcept {
+    return v;
+  }
+  static ALWAYS_INLINE StorageVector to_storage(ComputeVector v) noexcept {
+    return v;
+  }
+  /** @brief Partial reduction to float2. */
+  static ALWAYS_INLINE float2 reduce2(ComputeVector v) noexcept { return v; }
+};
+
+template <>
+struct StorageVectorTraits<half> {
+  using StorageVector = half4;
+  using ComputeVector = float4;
+  static constexpr unsigned size = 4;
+
+  static ALWAYS_INLINE ComputeVector splat(float v) noexcept {
+    return ComputeVector{v, v, v, v};
+  }
+  static ALWAYS_INLINE ComputeVector to_compute(StorageVector v) noexcept {
+#ifdef __IPU__
+    return __builtin_convertvector(v, float4);
+#else
+    return ComputeVector{float(v[0]), float(v[1]), float(v[2]), float(v[3])};
 #endif
+  }
+  static ALWAYS_INLINE StorageVector to_storage(ComputeVector v) noexcept {
+#ifdef __IPU__
+    return __builtin_convertvector(v, half4);
+#else
+    return StorageVector{half(v[0]), half(v[1]), half(v[2]), half(v[3])};
+#endif
+  }
+  /** @brief Partial reduction to float2. */
+  static ALWAYS_INLINE float2 reduce2(ComputeVector v) noexcept {
+    return float2{v[0] + v[2], v[1] + v[3]};
+  }
+};
@@ -2,6 +2,8 @@
 #pragma once
 
 #ifndef __IPU__
+#include <poplar/HalfFloat.hpp>
+
 #include <array>
 #include <cstddef>
 
@@ -59,6 +61,9 @@ struct IpuVector : public std::array<T, N> {
 using float2 = IpuVector<float, 2>;
 using float4 = IpuVector<float, 4>;
 
+using half2 = IpuVector<half, 2>;
+using half4 = IpuVector<half, 4>;
+
 using char2 = IpuVector<char, 2>;
 using uchar2 = IpuVector<unsigned char, 2>;
 using char4 = IpuVector<char, 4>;
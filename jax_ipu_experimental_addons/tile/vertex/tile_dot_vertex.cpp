@@ -0,0 +1,161 @@
+// Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+#include <poplar/HalfFloat.hpp>
+#include <poplar/Vertex.hpp>
+
+#include "intrinsics_utils.hpp"
+
+using namespace poplar;
+
+/**
+ * @brief Dot general fallback vertex, using the vector unit: out = lhs @ rhs.T
+ *
+ * Used for dot shapes not compatible with the AMP (`ConvPartial1x1Out`) or
+ * HMAC (`ConvPartialHorizontalMac`) vertices. Output elements are split
+ * between workers in 32 bits words (i.e. pairs of half outputs, no sub-word
+ * store race), with FP32 accumulation, and 64 bits vector loads when the
+ * contracting size is a multiple of the vector size.
+ *
+ * @tparam T Input dtype (float or half).
+ * @tparam TOut Output dtype (float or half).
+ */
+template <typename T, typename TOut>
+class DotGeneralVectorMac : public MultiVertex {
+ public:
+  // 64 bits storage vectors, FP32 compute vectors.
+  using Traits = StorageVectorTraits<T>;
+  using SV = typename Traits::StorageVector;
+  using CV = typename Traits::ComputeVector;
+  // Using `uint16` seems to be generating more efficient loops?
+  using IndexType = unsigned short;
+
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> lhs;  // (M, K) lhs
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> rhs;  // (O, K) rhs
+
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads output elements + 1.
+
+  Output<Vector<TOut, poplar::VectorLayout::ONE_PTR, 8>> out;  // (M, O) out
+
+  const unsigned K;  // contracting size
+  const unsigned O;  // rhs non-contracting size
+
+  DotGeneralVectorMac();
+
+  bool compute(unsigned wid) {
+    const IndexType wstart = worker_offsets[wid];
+    const IndexType wend = worker_offsets[wid + 1];
+    const bool use_vectors = (K % Traits::size) == 0;
+    const unsigned Kvec = K / Traits::size;
+
+    for (unsigned idx = wstart; idx != wend; ++idx) {
+      const unsigned m = idx / O;
+      const unsigned o = idx - m * O;
+      const T* lhs_row = &lhs[m * K];
+      const T* rhs_row = &rhs[o * K];
+      float result = 0;
+      if (use_vectors) {
+        const SV* ptr_lhs = reinterpret_cast<const SV*>(lhs_row);
+        const SV* ptr_rhs = reinterpret_cast<const SV*>(rhs_row);
+        CV partial = Traits::splat(0);
+        for (unsigned k = 0; k != Kvec; ++k) {
+          const CV x = Traits::to_compute(ipu::load_postinc(&ptr_lhs, 1));
+          const CV y = Traits::to_compute(ipu::load_postinc(&ptr_rhs, 1));
+          partial += x * y;
+        }
+        const float2 partial2 = Traits::reduce2(partial);
+        result = partial2[0] + partial2[1];
+      } else {
+        for (unsigned k = 0; k != K; ++k) {
+          result += float(lhs_row[k]) * float(rhs_row[k]);
+        }
+      }
+      out[idx] = TOut(result);
+    }
+    return true;
+  }
+};
+
+template class DotGeneralVectorMac<float, float>;
+template class DotGeneralVectorMac<half, float>;
+template class DotGeneralVectorMac<half, half>;
+
+/**
+ * @brief FP8 formats decoding, from raw bytes (Poplar QUARTER F143 or F152).
+ *
+ * FP8 values are decoded as `significand * 2^exponent`, without the constant
+ * format scale `2^-(bias + mantissa bits)`, which can be applied once on the
+ * accumulated result. NaN (0x80) is not supported, decoded as negative zero.
+ */
+template <bool IsF143>
+struct Fp8Format {
+  static constexpr unsigned mbits = IsF143 ? 3 : 2;
+  static constexpr unsigned emask = IsF143 ? 0xF : 0x1F;
+  /** @brief Format scale, i.e. 2^-(bias + mantissa bits). */
+  static constexpr float scale = IsF143 ? 1.0f / (1 << 11) : 1.0f / (1 << 18);
+
+  static ALWAYS_INLINE float decode_unscaled(unsigned char v) noexcept {
+    const unsigned exponent = (v >> mbits) & emask;
+    const unsigned mantissa = v & ((1 << mbits) - 1);
+    // Sub-normal numbers when exponent == 0.
+    const unsigned significand =
+        exponent ? (mantissa | (1 << mbits)) : mantissa;
+    const float r =
+        float(significand) * float(1u << (exponent ? exponent : 1));
+    return (v & 0x80) ? -r : r;
+  }
+};
+
+/**
+ * @brief FP8 dot general vertex, using the vector unit: out = lhs @ rhs.T
+ *
+ * FP8 inputs are stored as raw bytes, decoded on the fly and accumulated in
+ * FP32. Same shapes and worker partition as `DotGeneralVectorMac`.
+ *
+ * @tparam TOut Output dtype (float or half).
+ * @tparam IsF143 FP8 format: F143 (true) or F152 (false).
+ */
+template <typename TOut, bool IsF143>
+class DotGeneralFp8VectorMac : public MultiVertex {
+ public:
+  using Format = Fp8Format<IsF143>;
+  using IndexType = unsigned short;
+
+  Input<Vector<unsigned char, poplar::VectorLayout::ONE_PTR, 8>>
+      lhs;  // (M, K) lhs
+  Input<Vector<unsigned char, poplar::VectorLayout::ONE_PTR, 8>>
+      rhs;  // (O, K) rhs
+
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads output elements + 1.
+
+  Output<Vector<TOut, poplar::VectorLayout::ONE_PTR, 8>> out;  // (M, O) out
+
+  const unsigned K;  // contracting size
+  const unsigned O;  // rhs non-contracting size
+
+  bool compute(unsigned wid) {
+    const IndexType wstart = worker_offsets[wid];
+    const IndexType wend = worker_offsets[wid + 1];
+    // Format scales of lhs and rhs.
+    constexpr float scale = Format::scale * Format::scale;
+
+    for (unsigned idx = wstart; idx != wend; ++idx) {
+      const unsigned m = idx / O;
+      const unsigned o = idx - m * O;
+      const unsigned char* lhs_row = &lhs[m * K];
+      const unsigned char* rhs_row = &rhs[o * K];
+      float result = 0;
+      for (unsigned k = 0; k != K; ++k) {
+        result += Format::decode_unscaled(lhs_row[k]) *
+                  Format::decode_unscaled(rhs_row[k]);
+      }
+      out[idx] = TOut(result * scale);
+    }
+    return true;
+  }
+};
+
+template class DotGeneralFp8VectorMac<float, true>;
+template class DotGeneralFp8VectorMac<float, false>;
+template class DotGeneralFp8VectorMac<half, true>;
+template class DotGeneralFp8VectorMac<half, false>;
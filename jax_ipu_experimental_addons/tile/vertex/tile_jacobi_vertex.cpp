@@ -81,14 +81,20 @@ class JacobiSymSchur2 : public Vertex {
 /**
  * @brief Jacobi algorithm, update first step: schur + column update.
  *
+ * Columns stored in float or half (with FP32 compute and (c, s) values).
+ *
  * See:  Gene H. Golub, Charles F. Van Loan, MATRIX COMPUTATIONS, 3rd edition,
  * Johns Hopkins Chapter 8.
  */
+template <typename T>
 class [[poplar::constraint("elem(*pcol) != elem(*qcol)")]] JacobiUpdateFirstStep
     : public MultiVertex {
  public:
-  using T = float;
   using T2 = float2;
+  // 64 bits storage vectors, FP32 compute vectors.
+  using Traits = StorageVectorTraits<T>;
+  using SV = typename Traits::StorageVector;
+  using CV = typename Traits::ComputeVector;
   // Using `uint16` seems to be generating more efficient loops?
   using IndexType = unsigned short;
 
@@ -100,7 +106,7 @@ class [[poplar::constraint("elem(*pcol) != elem(*qcol)")]] JacobiUpdateFirstStep
   Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
       worker_offsets;  // (7,) threads work size + 1.
 
-  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+  Output<Vector<float, poplar::VectorLayout::ONE_PTR, 8>>
       cs;  // (2,) (c, s) Schur decomposition values
 
   Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
@@ -115,14 +121,14 @@ class [[poplar::constraint("elem(*pcol) != elem(*qcol)")]] JacobiUpdateFirstStep
   bool compute(unsigned wid) {
     const unsigned p = rotset[0];
     const unsigned q = rotset[1];
-    const T Apq = pcol[q];
-    const T App = pcol[p];
-    const T Aqq = qcol[q];
+    const float Apq = pcol[q];
+    const float App = pcol[p];
+    const float Aqq = qcol[q];
 
     // Schur2 decomposition.
     const T2 cs_vec = sym_schur2(App, Aqq, Apq);
-    const T& c = cs_vec[0];
-    const T& s = cs_vec[1];
+    const float& c = cs_vec[0];
+    const float& s = cs_vec[1];
     cs[0] = c;
     cs[1] = s;
 
@@ -133,41 +139,42 @@ class [[poplar::constraint("elem(*pcol) != elem(*qcol)")]] JacobiUpdateFirstStep
     const IndexType wsize = wend - wstart;
 
     // pcol, qcol and results pointers.
-    const float2* ptr_pcol =
-        reinterpret_cast<const float2*>(pcol.data()) + wstart;
-    const float2* ptr_qcol =
-        reinterpret_cast<const float2*>(qcol.data()) + wstart;
-    float2* ptr_pcol_updated =
-        reinterpret_cast<float2*>(pcol_updated.data()) + wstart;
-    float2* ptr_qcol_updated =
-        reinterpret_cast<float2*>(qcol_updated.data()) + wstart;
-
-    const T2 cvec = T2{c, c};
-    const T2 svec = T2{s, s};
+    const SV* ptr_pcol = reinterpret_cast<const SV*>(pcol.data()) + wstart;
+    const SV* ptr_qcol = reinterpret_cast<const SV*>(qcol.data()) + wstart;
+    SV* ptr_pcol_updated = reinterpret_cast<SV*>(pcol_updated.data()) + wstart;
+    SV* ptr_qcol_updated = reinterpret_cast<SV*>(qcol_updated.data()) + wstart;
+
+    const CV cvec = Traits::splat(c);
+    const CV svec = Traits::splat(s);
 
     // Easier to vectorized + parallelize if start with normal update first.
     for (IndexType idx = 0; idx != wsize; ++idx) {
       // TODO: investigate assembly?
-      const T2 pvec = ipu::load_postinc(&ptr_pcol, 1);
-      const T2 qvec = ipu::load_postinc(&ptr_qcol, 1);
+      const CV pvec = Traits::to_compute(ipu::load_postinc(&ptr_pcol, 1));
+      const CV qvec = Traits::to_compute(ipu::load_postinc(&ptr_qcol, 1));
 
-      const T2 pvec_updated = cvec * pvec - svec * qvec;
-      const T2 qvec_updated = svec * pvec + cvec * qvec;
+      const CV pvec_updated = cvec * pvec - svec * qvec;
+      const CV qvec_updated = svec * pvec + cvec * qvec;
 
-      ipu::store_postinc(&ptr_pcol_updated, pvec_updated, 1);
-      ipu::store_postinc(&ptr_qcol_updated, qvec_updated, 1);
+      ipu::store_postinc(&ptr_pcol_updated, Traits::to_storage(pvec_updated),
+                         1);
+      ipu::store_postinc(&ptr_qcol_updated, Traits::to_storage(qvec_updated),
+                         1);
     }
 
     // Update main values App, Apq, Aqq
-    pcol_updated[p] = c * c * App - 2 * s * c * Apq + s * s * Aqq;
-    qcol_updated[q] = s * s * App + 2 * s * c * Apq + c * c * Aqq;
+    pcol_updated[p] = T(c * c * App - 2 * s * c * Apq + s * s * Aqq);
+    qcol_updated[q] = T(s * s * App + 2 * s * c * Apq + c * c * Aqq);
     // Zero on purpose with Schur decomposition!
-    pcol_updated[q] = 0;
-    qcol_updated[p] = 0;
+    pcol_updated[q] = T(0);
+    qcol_updated[p] = T(0);
     return true;
   }
 };
 
+template class JacobiUpdateFirstStep<float>;
+template class JacobiUpdateFirstStep<half>;
+
 class JacobiUpdateSecondStep : public MultiVertex {
  public:
   using T = float;
@@ -237,22 +244,118 @@ class JacobiUpdateSecondStep : public MultiVertex {
   }
 };
 
+/**
+ * @brief Jacobi algorithm, second update step, with host-packed rotation set.
+ *
+ * Same as `JacobiUpdateSecondStep`, with (k, l) indices packed on 32 bits
+ * (i.e. `k | l << 16`), and p & q columns coefficients updated jointly using
+ * float2 SIMD operations. Rotations are processed by pairs: packed indices and
+ * (c, s) values of a pair are read with 64 bits loads (worker offsets are in
+ * grains of 2 rotations, keeping worker starts 64 bits aligned).
+ *
+ * NOTE: p & q columns coefficients are still 32 bits gathers/scatters, as
+ * (k, l) indices of a rotation set are not contiguous.
+ */
+class JacobiUpdateSecondStepPacked : public MultiVertex {
+ public:
+  using T = float;
+  using T2 = float2;
+  // Using `uint16` seems to be generating more efficient loops?
+  using IndexType = unsigned short;
+
+  InOut<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      cs_arr;  // (N/2, 2) (c, s) values
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR, 8>>
+      rotset_packed;  // (N/2,) packed (p, q) values. p < q
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR, 8>>
+      rotset_idx_ignored;  // (1,) index in rotset to ignore.
+
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads work size + 1.
+
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> pcol;  // (N,) p column
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> qcol;  // (N,) q column
+
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      pcol_updated;  // (N,) p column updated
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      qcol_updated;  // (N,) q column updated
+
+  JacobiUpdateSecondStepPacked();
+
+  bool compute(unsigned wid) {
+    // Use (p, q) = (1, 0) for ignore idx.
+    const unsigned ignore_idx = 2 * rotset_idx_ignored[0];
+    cs_arr[ignore_idx] = 1;
+    cs_arr[ignore_idx + 1] = 0;
+
+    // Worker load: start + end rotations indexes.
+    constexpr unsigned ptr_step = 1;
+    const IndexType wstart = worker_offsets[wid];
+    const IndexType wend = worker_offsets[wid + 1];
+    const IndexType wsize = wend - wstart;
+
+    // (c, s) and pairs of packed (k, l) pointers (even worker start).
+    const T2* ptr_cs = reinterpret_cast<const T2*>(cs_arr.data()) + wstart;
+    const uint2* ptr_rotset2 =
+        reinterpret_cast<const uint2*>(rotset_packed.data()) + wstart / 2;
+    for (IndexType idx = 0; idx != wsize / 2; ++idx) {
+      const uint2 kl2 = ipu::load_postinc(&ptr_rotset2, ptr_step);
+      const T2 cs0 = ipu::load_postinc(&ptr_cs, ptr_step);
+      const T2 cs1 = ipu::load_postinc(&ptr_cs, ptr_step);
+      rotate(cs0, kl2[0]);
+      rotate(cs1, kl2[1]);
+    }
+    // Odd number of rotations: last one (last worker only).
+    if (wsize % 2 != 0) {
+      rotate(*ptr_cs, rotset_packed[wend - 1]);
+    }
+    return true;
+  }
+
+ private:
+  /** Apply a single rotation on (p, q) coefficients at (k, l) indices. */
+  void rotate(const T2 cs, const unsigned kl) {
+    const IndexType k = kl & 0xFFFF;
+    const IndexType l = kl >> 16;
+
+    const T2 cvec = T2{cs[0], cs[0]};
+    const T2 svec = T2{cs[1], cs[1]};
+    // (p, q) coefficients at k and l indices.
+    const T2 Sk = T2{pcol[k], qcol[k]};
+    const T2 Sl = T2{pcol[l], qcol[l]};
+    // 4 coefficients updates, as 2 float2.
+    const T2 Sk_updated = cvec * Sk - svec * Sl;
+    const T2 Sl_updated = svec * Sk + cvec * Sl;
+
+    pcol_updated[k] = Sk_updated[0];
+    qcol_updated[k] = Sk_updated[1];
+    pcol_updated[l] = Sl_updated[0];
+    qcol_updated[l] = Sl_updated[1];
+  }
+};
+
 /**
  * @brief Jacobi algorithm, update of eigen vectors matrix.
  *
+ * Columns stored in float or half (with FP32 compute and (c, s) values).
+ *
  * See:  Gene H. Golub, Charles F. Van Loan, MATRIX COMPUTATIONS, 3rd edition,
  * Johns Hopkins Chapter 8.
  */
+template <typename T>
 class [[poplar::constraint(
     "elem(*vpcol) != elem(*vqcol)")]] JacobiUpdateEigenvectors
     : public MultiVertex {
  public:
-  using T = float;
-  using T2 = float2;
+  // 64 bits storage vectors, FP32 compute vectors.
+  using Traits = StorageVectorTraits<T>;
+  using SV = typename Traits::StorageVector;
+  using CV = typename Traits::ComputeVector;
   // Using `uint16` seems to be generating more efficient loops?
   using IndexType = unsigned short;
 
-  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+  Input<Vector<float, poplar::VectorLayout::ONE_PTR, 8>>
       cs;  // (2,) (c, s) Schur decomposition values
   Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> vpcol;  // (N,) p column
   Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> vqcol;  // (N,) q column
@@ -268,10 +371,8 @@ class [[poplar::constraint(
   JacobiUpdateEigenvectors();
 
   bool compute(unsigned wid) {
-    const T c = cs[0];
-    const T s = cs[1];
-    const T2 cvec = T2{c, c};
-    const T2 svec = T2{s, s};
+    const CV cvec = Traits::splat(cs[0]);
+    const CV svec = Traits::splat(cs[1]);
 
     // Worker load: start + end vectorized indexes.
     constexpr unsigned ptr_step = 1;
@@ -280,20 +381,451 @@ class [[poplar::constraint(
     const IndexType wsize = wend - wstart;
 
     // pcol, qcol and results pointers.
-    const T2* ptr_pcol = reinterpret_cast<const T2*>(vpcol.data()) + wstart;
-    const T2* ptr_qcol = reinterpret_cast<const T2*>(vqcol.data()) + wstart;
-    T2* ptr_pcol_updated = reinterpret_cast<T2*>(vpcol_out.data()) + wstart;
-    T2* ptr_qcol_updated = reinterpret_cast<T2*>(vqcol_out.data()) + wstart;
+    const SV* ptr_pcol = reinterpret_cast<const SV*>(vpcol.data()) + wstart;
+    const SV* ptr_qcol = reinterpret_cast<const SV*>(vqcol.data()) + wstart;
+    SV* ptr_pcol_updated = reinterpret_cast<SV*>(vpcol_out.data()) + wstart;
+    SV* ptr_qcol_updated = reinterpret_cast<SV*>(vqcol_out.data()) + wstart;
+
+    for (IndexType idx = 0; idx != wsize; ++idx) {
+      const CV vpvec = Traits::to_compute(ipu::load_postinc(&ptr_pcol, 1));
+      const CV vqvec = Traits::to_compute(ipu::load_postinc(&ptr_qcol, 1));
+
+      const CV vpvec_updated = cvec * vpvec - svec * vqvec;
+      const CV vqvec_updated = svec * vpvec + cvec * vqvec;
+
+      ipu::store_postinc(&ptr_qcol_updated, Traits::to_storage(vqvec_updated),
+                         1);
+      ipu::store_postinc(&ptr_pcol_updated, Traits::to_storage(vpvec_updated),
+                         1);
+    }
+    return true;
+  }
+};
+
+template class JacobiUpdateEigenvectors<float>;
+template class JacobiUpdateEigenvectors<half>;
+
+/**
+ * @brief Block Jacobi algorithm, update first step on a block of column pairs.
+ *
+ * Same as `JacobiUpdateFirstStep`, looping over `num_blocks` (p, q) column
+ * pairs stored contiguously on the tile. Main values Apq, App and Aqq are only
+ * written by the worker owning the corresponding indices.
+ */
+class [[poplar::constraint(
+    "elem(*pcols) != elem(*qcols)")]] JacobiUpdateFirstStepBlock
+    : public MultiVertex {
+ public:
+  using T = float;
+  using T2 = float2;
+  // Using `uint16` seems to be generating more efficient loops?
+  using IndexType = unsigned short;
+
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR, 8>>
+      rotset;  // (B, 2) rotation indexes p and q. p < q
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> pcols;  // (B, N) p columns
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> qcols;  // (B, N) q columns
+
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads work size + 1.
+
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      cs;  // (B, 2) (c, s) Schur decomposition values
+
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      pcols_updated;  // (B, N) p columns updated
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      qcols_updated;  // (B, N) q columns updated
+
+  const IndexType N;           // size
+  const IndexType num_blocks;  // B, number of column pairs.
+
+  JacobiUpdateFirstStepBlock();
+
+  bool compute(unsigned wid) {
+    // Worker load: start + end vectorized indexes (in every column).
+    constexpr unsigned ptr_step = 1;
+    const IndexType wstart = worker_offsets[wid];
+    const IndexType wend = worker_offsets[wid + 1];
+    const IndexType wsize = wend - wstart;
+
+    for (IndexType bidx = 0; bidx != num_blocks; ++bidx) {
+      const unsigned offset = bidx * N;
+      const unsigned p = rotset[2 * bidx];
+      const unsigned q = rotset[2 * bidx + 1];
+      const T Apq = pcols[offset + q];
+      const T App = pcols[offset + p];
+      const T Aqq = qcols[offset + q];
+
+      // Schur2 decomposition.
+      const T2 cs_vec = sym_schur2(App, Aqq, Apq);
+      const T& c = cs_vec[0];
+      const T& s = cs_vec[1];
+      if (wid == 0) {
+        cs[2 * bidx] = c;
+        cs[2 * bidx + 1] = s;
+      }
+
+      // pcol, qcol and results pointers.
+      const T2* ptr_pcol = reinterpret_cast<const T2*>(&pcols[offset]) + wstart;
+      const T2* ptr_qcol = reinterpret_cast<const T2*>(&qcols[offset]) + wstart;
+      T2* ptr_pcol_updated =
+          reinterpret_cast<T2*>(&pcols_updated[offset]) + wstart;
+      T2* ptr_qcol_updated =
+          reinterpret_cast<T2*>(&qcols_updated[offset]) + wstart;
+
+      const T2 cvec = T2{c, c};
+      const T2 svec = T2{s, s};
+      for (IndexType idx = 0; idx != wsize; ++idx) {
+        const T2 pvec = ipu::load_postinc(&ptr_pcol, ptr_step);
+        const T2 qvec = ipu::load_postinc(&ptr_qcol, ptr_step);
+
+        const T2 pvec_updated = cvec * pvec - svec * qvec;
+        const T2 qvec_updated = svec * pvec + cvec * qvec;
+
+        ipu::store_postinc(&ptr_pcol_updated, pvec_updated, ptr_step);
+        ipu::store_postinc(&ptr_qcol_updated, qvec_updated, ptr_step);
+      }
+
+      // Update main values App, Apq, Aqq, on the owning worker only.
+      if (p / 2 >= wstart && p / 2 < wend) {
+        pcols_updated[offset + p] =
+            c * c * App - 2 * s * c * Apq + s * s * Aqq;
+        // Zero on purpose with Schur decomposition!
+        qcols_updated[offset + p] = 0;
+      }
+      if (q / 2 >= wstart && q / 2 < wend) {
+        qcols_updated[offset + q] =
+            s * s * App + 2 * s * c * Apq + c * c * Aqq;
+        pcols_updated[offset + q] = 0;
+      }
+    }
+    return true;
+  }
+};
+
+/**
+ * @brief Block Jacobi algorithm, second update step on a block of column pairs.
+ *
+ * Same as `JacobiUpdateSecondStepPacked`, with every rotation applied to the
+ * `num_blocks` (p, q) column pairs on the tile. Each column pair has its own
+ * ignored rotation (already applied in the first step): the owning worker
+ * restores the corresponding 4 coefficients from the input columns.
+ */
+class JacobiUpdateSecondStepPackedBlock : public MultiVertex {
+ public:
+  using T = float;
+  using T2 = float2;
+  // Using `uint16` seems to be generating more efficient loops?
+  using IndexType = unsigned short;
 
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      cs_arr;  // (N/2, 2) (c, s) values
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR, 8>>
+      rotset_packed;  // (N/2,) packed (p, q) values. p < q
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR, 8>>
+      rotset_idx_ignored;  // (B,) indexes in rotset to ignore.
+
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads work size + 1.
+
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> pcols;  // (B, N) p columns
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> qcols;  // (B, N) q columns
+
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      pcols_updated;  // (B, N) p columns updated
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      qcols_updated;  // (B, N) q columns updated
+
+  const IndexType N;           // size
+  const IndexType num_blocks;  // B, number of column pairs.
+
+  JacobiUpdateSecondStepPackedBlock();
+
+  bool compute(unsigned wid) {
+    // Worker load: start + end rotations indexes.
+    constexpr unsigned ptr_step = 1;
+    const IndexType wstart = worker_offsets[wid];
+    const IndexType wend = worker_offsets[wid + 1];
+    const IndexType wsize = wend - wstart;
+
+    // (c, s) and packed (k, l) pointers.
+    const T2* ptr_cs = reinterpret_cast<const T2*>(cs_arr.data()) + wstart;
+    const unsigned* ptr_rotset = &rotset_packed[wstart];
     for (IndexType idx = 0; idx != wsize; ++idx) {
-      const T2 vpvec = ipu::load_postinc(&ptr_pcol, 1);
-      const T2 vqvec = ipu::load_postinc(&ptr_qcol, 1);
+      const T2 cs = ipu::load_postinc(&ptr_cs, ptr_step);
+      const unsigned kl = ipu::load_postinc(&ptr_rotset, ptr_step);
+      const IndexType k = kl & 0xFFFF;
+      const IndexType l = kl >> 16;
+
+      const T2 cvec = T2{cs[0], cs[0]};
+      const T2 svec = T2{cs[1], cs[1]};
+      // Same rotation applied to all column pairs in the block.
+      unsigned offset = 0;
+      for (IndexType bidx = 0; bidx != num_blocks; ++bidx) {
+        const T2 Sk = T2{pcols[offset + k], qcols[offset + k]};
+        const T2 Sl = T2{pcols[offset + l], qcols[offset + l]};
+        const T2 Sk_updated = cvec * Sk - svec * Sl;
+        const T2 Sl_updated = svec * Sk + cvec * Sl;
+
+        pcols_updated[offset + k] = Sk_updated[0];
+        qcols_updated[offset + k] = Sk_updated[1];
+        pcols_updated[offset + l] = Sl_updated[0];
+        qcols_updated[offset + l] = Sl_updated[1];
+        offset += N;
+      }
+    }
+
+    // Ignored rotations: identity, i.e. restoring the input coefficients.
+    for (IndexType bidx = 0; bidx != num_blocks; ++bidx) {
+      const unsigned ignore_idx = rotset_idx_ignored[bidx];
+      if (ignore_idx >= wstart && ignore_idx < wend) {
+        const unsigned kl = rotset_packed[ignore_idx];
+        const unsigned k = bidx * N + (kl & 0xFFFF);
+        const unsigned l = bidx * N + (kl >> 16);
+        pcols_updated[k] = pcols[k];
+        qcols_updated[k] = qcols[k];
+        pcols_updated[l] = pcols[l];
+        qcols_updated[l] = qcols[l];
+      }
+    }
+    return true;
+  }
+};
+
+/**
+ * @brief Block Jacobi algorithm, update of eigen vectors matrix on a block of
+ * column pairs.
+ */
+class [[poplar::constraint(
+    "elem(*vpcols) != elem(*vqcols)")]] JacobiUpdateEigenvectorsBlock
+    : public MultiVertex {
+ public:
+  using T = float;
+  using T2 = float2;
+  // Using `uint16` seems to be generating more efficient loops?
+  using IndexType = unsigned short;
+
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      cs;  // (B, 2) (c, s) Schur decomposition values
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      vpcols;  // (B, N) p columns
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      vqcols;  // (B, N) q columns
+
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads work size + 1.
+
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      vpcols_out;  // (B, N) p columns
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      vqcols_out;  // (B, N) q columns
+
+  const IndexType N;           // size
+  const IndexType num_blocks;  // B, number of column pairs.
+
+  JacobiUpdateEigenvectorsBlock();
+
+  bool compute(unsigned wid) {
+    // Worker load: start + end vectorized indexes (in every column).
+    constexpr unsigned ptr_step = 1;
+    const IndexType wstart = worker_offsets[wid];
+    const IndexType wend = worker_offsets[wid + 1];
+    const IndexType wsize = wend - wstart;
 
-      const T2 vpvec_updated = cvec * vpvec - svec * vqvec;
-      const T2 vqvec_updated = svec * vpvec + cvec * vqvec;
+    for (IndexType bidx = 0; bidx != num_blocks; ++bidx) {
+      const unsigned offset = bidx * N;
+      const T c = cs[2 * bidx];
+      const T s = cs[2 * bidx + 1];
+      const T2 cvec = T2{c, c};
+      const T2 svec = T2{s, s};
+
+      const T2* ptr_pcol =
+          reinterpret_cast<const T2*>(&vpcols[offset]) + wstart;
+      const T2* ptr_qcol =
+          reinterpret_cast<const T2*>(&vqcols[offset]) + wstart;
+      T2* ptr_pcol_updated =
+          reinterpret_cast<T2*>(&vpcols_out[offset]) + wstart;
+      T2* ptr_qcol_updated =
+          reinterpret_cast<T2*>(&vqcols_out[offset]) + wstart;
+
+      for (IndexType idx = 0; idx != wsize; ++idx) {
+        const T2 vpvec = ipu::load_postinc(&ptr_pcol, ptr_step);
+        const T2 vqvec = ipu::load_postinc(&ptr_qcol, ptr_step);
+
+        const T2 vpvec_updated = cvec * vpvec - svec * vqvec;
+        const T2 vqvec_updated = svec * vpvec + cvec * vqvec;
+
+        ipu::store_postinc(&ptr_qcol_updated, vqvec_updated, ptr_step);
+        ipu::store_postinc(&ptr_pcol_updated, vpvec_updated, ptr_step);
+      }
+    }
+    return true;
+  }
+};
+
+/**
+ * @brief Sum of squares of a column worker range [wstart, wend) (in float2
+ * units), excluding the diagonal coefficient at index `diag`.
+ */
+__attribute__((always_inline)) float offdiag_sum_squares(
+    const float* col, int wstart, int wend, int diag) noexcept {
+  using T2 = float2;
+  const int diag2 = diag / 2;
+  T2 acc{0, 0};
+  // Before the diagonal coefficient.
+  const int lo_end = diag2 < wend ? diag2 : wend;
+  const T2* ptr = reinterpret_cast<const T2*>(col) + wstart;
+  for (int idx = wstart; idx < lo_end; ++idx) {
+    const T2 v = ipu::load_postinc(&ptr, 1);
+    acc += v * v;
+  }
+  // After the diagonal coefficient.
+  const int hi_start = diag2 + 1 > wstart ? diag2 + 1 : wstart;
+  ptr = reinterpret_cast<const T2*>(col) + hi_start;
+  for (int idx = hi_start; idx < wend; ++idx) {
+    const T2 v = ipu::load_postinc(&ptr, 1);
+    acc += v * v;
+  }
+  float sum = acc[0] + acc[1];
+  // Other coefficient sharing the float2 with the diagonal.
+  if (diag2 >= wstart && diag2 < wend) {
+    const float v = col[diag ^ 1];
+    sum += v * v;
+  }
+  return sum;
+}
+
+/**
+ * @brief Jacobi algorithm, partial off-diagonal squared norm of (p, q) columns.
+ *
+ * Every worker outputs the sum of squares of its (p, q) columns range,
+ * excluding the diagonal coefficients App and Aqq. The cross-tile reduction of
+ * these partial sums gives the off-diagonal Frobenius norm of A, used as
+ * convergence criteria.
+ */
+class JacobiOffDiagNormSquare : public MultiVertex {
+ public:
+  using T = float;
+  // Using `uint16` seems to be generating more efficient loops?
+  using IndexType = unsigned short;
+
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR, 8>>
+      rotset;  // (B, 2) diagonal indexes p and q.
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> pcols;  // (B, N) p columns
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> qcols;  // (B, N) q columns
+
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads work size + 1.
+
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      norm_partials;  // (6,) per worker partial sums.
+
+  const IndexType N;           // size
+  const IndexType num_blocks;  // B, number of column pairs.
+
+  JacobiOffDiagNormSquare();
+
+  bool compute(unsigned wid) {
+    const int wstart = worker_offsets[wid];
+    const int wend = worker_offsets[wid + 1];
+    T sum = 0;
+    for (IndexType bidx = 0; bidx != num_blocks; ++bidx) {
+      const unsigned offset = bidx * N;
+      sum +=
+          offdiag_sum_squares(&pcols[offset], wstart, wend, rotset[2 * bidx]);
+      sum += offdiag_sum_squares(&qcols[offset], wstart, wend,
+                                 rotset[2 * bidx + 1]);
+    }
+    norm_partials[wid] = sum;
+    return true;
+  }
+};
+
+/**
+ * @brief Batched Jacobi eigen decomposition of small symmetric matrices.
+ *
+ * Every worker runs the full cyclic Jacobi algorithm on its own subset of
+ * the (tile local) matrices, i.e. no synchronization between workers.
+ * Eigenvalues are returned on the diagonal of A, and eigenvectors as V
+ * columns.
+ *
+ * See:  Gene H. Golub, Charles F. Van Loan, MATRIX COMPUTATIONS, 3rd edition,
+ * Johns Hopkins Chapter 8.4.3.
+ */
+class JacobiEighBatched : public MultiVertex {
+ public:
+  using T = float;
+  using T2 = float2;
+  // Using `uint16` seems to be generating more efficient loops?
+  using IndexType = unsigned short;
+
+  InOut<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      A;  // (B, N, N) symmetric matrices, diagonalized inplace.
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      V;  // (B, N, N) eigenvectors matrices.
+
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads matrices + 1.
+
+  const IndexType N;           // matrix size
+  const IndexType num_sweeps;  // number of Jacobi sweeps.
+
+  JacobiEighBatched();
+
+  bool compute(unsigned wid) {
+    const unsigned NN = unsigned(N) * N;
+    const IndexType wstart = worker_offsets[wid];
+    const IndexType wend = worker_offsets[wid + 1];
 
-      ipu::store_postinc(&ptr_qcol_updated, vqvec_updated, 1);
-      ipu::store_postinc(&ptr_pcol_updated, vpvec_updated, 1);
+    for (IndexType midx = wstart; midx != wend; ++midx) {
+      T* a = &A[midx * NN];
+      T* v = &V[midx * NN];
+      // Initial eigenvectors: identity matrix.
+      for (unsigned idx = 0; idx != NN; ++idx) {
+        v[idx] = 0;
+      }
+      for (IndexType idx = 0; idx != N; ++idx) {
+        v[idx * N + idx] = 1;
+      }
+      // Cyclic-by-row Jacobi sweeps.
+      for (IndexType sweep = 0; sweep != num_sweeps; ++sweep) {
+        for (IndexType p = 0; p != N; ++p) {
+          for (IndexType q = p + 1; q != N; ++q) {
+            const T Apq = a[p * N + q];
+            if (Apq == 0) {
+              continue;
+            }
+            const T2 cs_vec = sym_schur2(a[p * N + p], a[q * N + q], Apq);
+            const T c = cs_vec[0];
+            const T s = cs_vec[1];
+            // Columns update: A = A @ J.
+            for (IndexType k = 0; k != N; ++k) {
+              const T akp = a[k * N + p];
+              const T akq = a[k * N + q];
+              a[k * N + p] = c * akp - s * akq;
+              a[k * N + q] = s * akp + c * akq;
+            }
+            // Rows update: A = J^T @ A.
+            for (IndexType k = 0; k != N; ++k) {
+              const T apk = a[p * N + k];
+              const T aqk = a[q * N + k];
+              a[p * N + k] = c * apk - s * aqk;
+              a[q * N + k] = s * apk + c * aqk;
+            }
+            // Zero on purpose with Schur decomposition!
+            a[p * N + q] = 0;
+            a[q * N + p] = 0;
+            // Eigenvectors update: V = V @ J.
+            for (IndexType k = 0; k != N; ++k) {
+              const T vkp = v[k * N + p];
+              const T vkq = v[k * N + q];
+              v[k * N + p] = c * vkp - s * vkq;
+              v[k * N + q] = s * vkp + c * vkq;
+            }
+          }
+        }
+      }
     }
     return true;
   }
@@ -45,28 +45,79 @@ template class TileDataBarrierVertex<float>;
 template class TileDataBarrierVertex<half>;
 
 /**
- * @brief On-tile memcpy vertex. Useful for explicit copies
- * on tile (but not as performant as Poplar optimized ones).
+ * @brief Multi-dtypes tile barrier vertex: same as `TileDataBarrierVertex`,
+ * with tensors grouped per data type size (8, 16 and 32 bits), allowing any mix
+ * of input dtypes in a single barrier vertex.
+ *
+ * FP16 tensors have a separate field, as FP16 is simulated on the IPU model
+ * (i.e. no reinterpret as 16 bits integers). On IPU hardware, FP16 tensors are
+ * reinterpreted and grouped in `data16`.
+ */
+class TileDataBarrierMultiVertex : public SupervisorVertex {
+  static const bool needsAlignWorkers = false;
+
+ public:
+  // 8 bits data gated by the barrier.
+  Vector<InOut<Vector<unsigned char, poplar::VectorLayout::ONE_PTR, 1>>,
+         poplar::VectorLayout::ONE_PTR, 1>
+      data8;
+  // 16 bits data gated by the barrier.
+  Vector<InOut<Vector<unsigned short, poplar::VectorLayout::ONE_PTR, 1>>,
+         poplar::VectorLayout::ONE_PTR, 1>
+      data16;
+  // FP16 data gated by the barrier (IPU model only).
+  Vector<InOut<Vector<half, poplar::VectorLayout::ONE_PTR, 1>>,
+         poplar::VectorLayout::ONE_PTR, 1>
+      data16f;
+  // 32 bits data gated by the barrier.
+  Vector<InOut<Vector<unsigned, poplar::VectorLayout::ONE_PTR, 1>>,
+         poplar::VectorLayout::ONE_PTR, 1>
+      data32;
+
+  SUPERVISOR_TARGET bool compute() { return true; }
+};
+
+/**
+ * @brief On-tile memcpy vertex. Useful for explicit copies on tile.
+ *
+ * The copy is split between the 6 workers using `worker_offsets`, in units of
+ * 64-bit words, with every worker using `ld64/st64` loads and stores. The
+ * remaining tail elements (i.e. when the size in bytes is not a multiple of 8)
+ * are copied by the last worker.
  */
 template <typename T>
 class TileMemcpyVertex : public MultiVertex {
  public:
-  // Conservative alignment assumption?
-  // static constexpr int AlignSize = sizeof(T) * 2;
+  using IndexType = unsigned short;
   static constexpr int AlignSize = 8;
   static constexpr int NumWorkers = 6;
 
   Input<Vector<T, poplar::VectorLayout::SPAN, AlignSize>> in;  // (N,) in vector
   Output<Vector<T, poplar::VectorLayout::SPAN, AlignSize>>
       out;  // (N,) out vector
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads work size + 1, in 64-bit words.
 
   bool compute(unsigned wid) {
-    if (wid != 0) {
-      return true;
+    // Worker load: start + end 64-bit words indexes.
+    constexpr unsigned ptr_step = 1;
+    const IndexType wstart = worker_offsets[wid];
+    const IndexType wend = worker_offsets[wid + 1];
+    const IndexType wsize = wend - wstart;
+
+    const float2* ptr_in = reinterpret_cast<const float2*>(in.data()) + wstart;
+    float2* ptr_out = reinterpret_cast<float2*>(out.data()) + wstart;
+    for (IndexType idx = 0; idx < wsize; ++idx) {
+      const float2 v = ipu::load_postinc(&ptr_in, ptr_step);
+      ipu::store_postinc(&ptr_out, v, ptr_step);
     }
-    // Start with the most basic loop!
-    for (int i = 0; i < in.size(); ++i) {
-      out[i] = in[i];
+    // Tail elements, not fitting in a full 64-bit word.
+    if (wid == NumWorkers - 1) {
+      const unsigned tail_start =
+          worker_offsets[NumWorkers] * AlignSize / sizeof(T);
+      for (unsigned idx = tail_start; idx < in.size(); ++idx) {
+        out[idx] = in[idx];
+      }
     }
     return true;
   }
@@ -1,6 +1,7 @@
 // Copyright (c) 2022 Graphcore Ltd. All rights reserved.
 #include <poplar/HalfFloat.hpp>
 #include <poplar/Vertex.hpp>
+#include <type_traits>
 
 #include "intrinsics_utils.hpp"
 
@@ -11,11 +12,19 @@ using namespace poplar;
      -o jax_ipu_experimental_addons/tile/vertex/tile_qr_vertex.gp
 */
 
+/**
+ * @brief Vertex computing per-worker partial dot products, with x and y
+ * stored in float or half (FP32 accumulation).
+ */
+template <typename T>
 class [[poplar::constraint("elem(*x) != elem(*y)")]] DotProduct1dVertex
     : public MultiVertex {
  public:
-  using T = float;
   using T2 = float2;
+  // 64 bits storage vectors, FP32 compute vectors.
+  using Traits = StorageVectorTraits<T>;
+  using SV = typename Traits::StorageVector;
+  using CV = typename Traits::ComputeVector;
   // Using `uint16` seems to be generating more efficient loops?
   using IndexType = unsigned short;
 
@@ -28,10 +37,11 @@ class [[poplar::constraint("elem(*x) != elem(*y)")]] DotProduct1dVertex
 
   Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
       worker_offsets;  // (7,) number threads + 1.
-  Output<Vector<T, poplar::VectorLayout::ONE_PTR>> partials;  // float result.
+  Output<Vector<float, poplar::VectorLayout::ONE_PTR>>
+      partials;  // float result.
 
   bool compute(unsigned wid) {
-    // Always assuming size % 2 == 0
+    // Always assuming size % vector size == 0
     const IndexType wstart = worker_offsets[wid];
     const IndexType wend = worker_offsets[wid + 1];
     const IndexType wsize = wend - wstart;
@@ -43,23 +53,26 @@ class [[poplar::constraint("elem(*x) != elem(*y)")]] DotProduct1dVertex
       return true;
     }
     // X and Y input pointers.
-    const T2* ptr_inxdata_f2 = reinterpret_cast<const T2*>(x.data()) + wstart;
-    const T2* ptr_inydata_f2 = reinterpret_cast<const T2*>(y.data()) + wstart;
-    T2 partial = T2{0, 0};
+    const SV* ptr_inxdata = reinterpret_cast<const SV*>(x.data()) + wstart;
+    const SV* ptr_inydata = reinterpret_cast<const SV*>(y.data()) + wstart;
+    CV partial = Traits::splat(0);
 
     for (IndexType idx = 0; idx != wsize; ++idx) {
       // TODO: use ld2x64pace + tapack instructions?
-      const T2 xin = ipu::load_postinc(&ptr_inxdata_f2, 1);
-      const T2 yin = ipu::load_postinc(&ptr_inydata_f2, 1);
+      const CV xin = Traits::to_compute(ipu::load_postinc(&ptr_inxdata, 1));
+      const CV yin = Traits::to_compute(ipu::load_postinc(&ptr_inydata, 1));
       // popc seems to recognize this pattern and optimize it.
       // Using directly ipu::fma intrinsics leads to poor performance!?
       partial += xin * yin;
     }
-    ipu::store_postinc(&ptr_tmp_partials_f2, partial, 1);
+    ipu::store_postinc(&ptr_tmp_partials_f2, Traits::reduce2(partial), 1);
     return true;
   }
 };
 
+template class DotProduct1dVertex<float>;
+template class DotProduct1dVertex<half>;
+
 /**
  * @brief Vertex computing the correction vector in the QR algorithm.
  */
@@ -155,6 +168,187 @@ class QRCorrectionVectorVertex : public MultiVertex {
 
 float QRCorrectionVectorVertex::shared_partial_sqnorms[6] = {-1};
 
+/**
+ * @brief Vertex computing the QR correction vector, first step: v copy and
+ * partial squared norms per worker.
+ *
+ * No shared state between workers: the final reduction is done in the
+ * `QRCorrectionVectorFinalizeVertex` (next compute set), making the norm
+ * reduction deterministic and supporting multiple instances per tile.
+ */
+class QRCorrectionVectorPartialVertex : public MultiVertex {
+ public:
+  using T = float;
+  Input<Vector<T, poplar::VectorLayout::SPAN>> Rcol;  // (N,) R column.
+
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR>>
+      v;  // (N,) QR correction vector (not normalized, without diag. update)
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR>>
+      partials;  // (6,) partial squared norms per worker.
+
+  const unsigned col_idx;  // R column index.
+
+  QRCorrectionVectorPartialVertex();
+
+  bool compute(unsigned wid) {
+    const unsigned num_workers = 6;
+    const unsigned size = Rcol.size();
+    const unsigned col_idx_rem = col_idx % 2;
+    const unsigned col_idx_prem = col_idx + col_idx_rem;
+
+    const float2 zeros_f2{0, 0};
+    float2* ptr_outdata_f2 = reinterpret_cast<float2*>(v.data()) + wid;
+    // Push to col_idx_prem, may write one zero too much, but does not matter!
+    float2* ptr_outdata_end_f2 = reinterpret_cast<float2*>(&v[col_idx_prem]);
+    // First chunk of v initialized with zeros.
+    while (ptr_outdata_f2 < ptr_outdata_end_f2) {
+      ipu::store_postinc(&ptr_outdata_f2, zeros_f2, num_workers);
+    }
+
+    float2 partials_f2{0, 0};
+    const float2* ptr_indata_f2 =
+        reinterpret_cast<const float2*>(&Rcol[col_idx_prem]) + wid;
+    ptr_outdata_f2 = reinterpret_cast<float2*>(&v[col_idx_prem]) + wid;
+    ptr_outdata_end_f2 = reinterpret_cast<float2*>(&v[size]);
+    // Copy Rcol data and accumulate squared norm.
+    while (ptr_outdata_f2 < ptr_outdata_end_f2) {
+      const float2 v = ipu::load_postinc(&ptr_indata_f2, num_workers);
+      partials_f2 += v * v;
+      ipu::store_postinc(&ptr_outdata_f2, v, num_workers);
+    }
+    partials[wid] = partials_f2[0] + partials_f2[1];
+    return true;
+  }
+};
+
+/**
+ * @brief Vertex computing the QR correction vector, second step: reduction
+ * of partial squared norms, diagonal entry and rescaling factor.
+ */
+class QRCorrectionVectorFinalizeVertex : public Vertex {
+ public:
+  using T = float;
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR>> Rcol;   // (N,) R column.
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR>> sdiag;  // (N,) R diag. sign.
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR>>
+      partials;  // (6,) partial squared norms per worker.
+
+  InOut<Vector<T, poplar::VectorLayout::ONE_PTR>>
+      v;  // (N,) QR correction vector (not normalized)
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR>>
+      vrescale;  // (1,) QR correction vector rescaling (2 / norm)
+
+  const unsigned col_idx;  // R column index.
+
+  QRCorrectionVectorFinalizeVertex();
+
+  bool compute() {
+    const unsigned num_workers = 6;
+    const unsigned col_idx_rem = col_idx % 2;
+    const T initial_rcol_val = Rcol[col_idx];
+    const T initial_rcol_val_sq = initial_rcol_val * initial_rcol_val;
+
+    // Correction to squared normed depending on `col_idx_rem`
+    T norm_squared = col_idx_rem * initial_rcol_val_sq;
+    for (unsigned w = 0; w < num_workers; ++w) {
+      norm_squared += partials[w];
+    }
+    // Compute the norm.
+    const T norm = std::sqrt(norm_squared);
+    // Change the entry of v that corresponds to the diagonal element of R.
+    const auto update_vidx_val = initial_rcol_val - norm * sdiag[col_idx];
+    v[col_idx] = update_vidx_val;
+
+    // Update the squared norm of v.
+    norm_squared -= initial_rcol_val_sq;
+    norm_squared += update_vidx_val * update_vidx_val;
+    // Vector rescaling for QR householder update.
+    vrescale[0] = T(2) / norm_squared;
+    return true;
+  }
+};
+
+/**
+ * @brief Inplace householder row update: x += s * v, FP32 storage.
+ *
+ * @tparam Bundled Use the bundled `ld2xst64pace` inner loop on IPU hardware
+ * (unbundled `ld2x64pace` loop otherwise, kept as a reference).
+ */
+template <bool Bundled>
+inline void qr_householder_row_update_inplace(float* x, const float* v,
+                                              const float s,
+                                              unsigned short wstart,
+                                              unsigned short wsize) noexcept {
+  // Always assuming size % 2 == 0
+  constexpr unsigned ptr_step = 1;
+  // Set the $TAS register with the proper scale.
+  // __builtin_ipu_put_tas(s);
+  __ipu_and_ipumodel_tas tas;
+  tas.put(s);
+
+  // Nothing to do in this worker thread.
+  if (wsize == 0) {
+    return;
+  }
+#ifdef __IPU__
+  float2* xptr = reinterpret_cast<float2*>(x) + wstart;
+  const float2* vptr = reinterpret_cast<const float2*>(v) + wstart;
+  if (Bundled && wsize >= 3 && wsize <= kIpuRptMaxCount + 3) {
+    // Optimized inner loop: ld2xst64pace dual loads (different banks) + store.
+    f32v2axpy_inplace_ld2xst64pace(xptr, vptr, wsize);
+  } else {
+    f32v2axpy_inplace_ld2x64pace(xptr, vptr, wsize);
+  }
+#else
+  // X and v IO pointers.
+  const float2* ptr_inxdata_f2 = reinterpret_cast<const float2*>(x) + wstart;
+  float2* ptr_outxdata_f2 = reinterpret_cast<float2*>(x) + wstart;
+  const float2* ptr_vdata_f2 = reinterpret_cast<const float2*>(v) + wstart;
+
+  float2 xin, vin, rtmp, rout;
+  // First vectors loading.
+  xin = ipu::load_postinc(&ptr_inxdata_f2, ptr_step);
+  vin = ipu::load_postinc(&ptr_vdata_f2, ptr_step);
+  for (unsigned short idx = 1; idx != wsize; ++idx) {
+    rtmp = tas.f32v2axpy(xin, vin);
+    // rtmp = __builtin_ipu_f32v2axpy(xin, vin);
+    // Grouping here seems to help the compiler optimising loads?
+    xin = ipu::load_postinc(&ptr_inxdata_f2, ptr_step);
+    vin = ipu::load_postinc(&ptr_vdata_f2, ptr_step);
+    rout = tas.f32v2axpy(rtmp, rtmp);
+    // rout = __builtin_ipu_f32v2axpy(rtmp, rtmp);
+    ipu::store_postinc(&ptr_outxdata_f2, rout, ptr_step);
+  }
+  // Finish the loop, getting the last computation.
+  // rtmp = __builtin_ipu_f32v2axpy(xin, vin);
+  // rout = __builtin_ipu_f32v2axpy(rtmp, rtmp);
+  rtmp = tas.f32v2axpy(xin, vin);
+  rout = tas.f32v2axpy(rtmp, rtmp);
+  ipu::store_postinc(&ptr_outxdata_f2, rout, ptr_step);
+#endif
+}
+
+/**
+ * @brief Inplace householder row update: x += s * v, FP16 storage (half4
+ * loads, FP32 compute).
+ */
+template <bool Bundled>
+inline void qr_householder_row_update_inplace(half* x, const half* v,
+                                              const float s,
+                                              unsigned short wstart,
+                                              unsigned short wsize) noexcept {
+  using Traits = StorageVectorTraits<half>;
+  const half4* ptr_inxdata = reinterpret_cast<const half4*>(x) + wstart;
+  half4* ptr_outxdata = reinterpret_cast<half4*>(x) + wstart;
+  const half4* ptr_vdata = reinterpret_cast<const half4*>(v) + wstart;
+  const float4 svec = Traits::splat(s);
+  for (unsigned short idx = 0; idx != wsize; ++idx) {
+    const float4 xin = Traits::to_compute(ipu::load_postinc(&ptr_inxdata, 1));
+    const float4 vin = Traits::to_compute(ipu::load_postinc(&ptr_vdata, 1));
+    ipu::store_postinc(&ptr_outxdata, Traits::to_storage(xin + svec * vin), 1);
+  }
+}
+
 /**
  * @brief Vertex implementing the inplace householder (row) update in the QR
  * algorithm. NOTE: the vertex is only updating the sub-slice of x corresponding
@@ -162,26 +356,36 @@ float QRCorrectionVectorVertex::shared_partial_sqnorms[6] = {-1};
  *
  * More specifically: x[end-len(v)+i] -= scale1[0] * scale2[0] * v[i]
  *
+ * x and v stored in float or half, with FP32 scaling factors and compute.
+ * `Bundled` selects the FP32 inner loop on IPU hardware (see
+ * `qr_householder_row_update_inplace`).
+ *
  * NOTE: poplar::constraint here to make sure x and v are not part of the same
  * memory bank, allowing simultaneous loads (see `ld2x64pace` instruction).
+ * In the bundled FP32 case, x is also loaded and stored in the same cycle
+ * (`ld2xst64pace`), hence allocated in interleaved memory.
  */
+template <typename T, bool Bundled>
 class [[poplar::constraint(
     "elem(*x) != elem(*v)")]] QRHouseholderRowUpdateVertex
     : public MultiVertex {
  public:
-  using T = float;
   // Using `uint16` seems to be generating more efficient loops?
   using IndexType = unsigned short;
 
-  InOut<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> x;  // (N,) row of Q or R
+  static constexpr bool kInterleavedX =
+      Bundled && std::is_same<T, float>::value;
+
+  InOut<Vector<T, poplar::VectorLayout::ONE_PTR, 8, kInterleavedX>>
+      x;  // (N,) row of Q or R
   Input<Vector<T, poplar::VectorLayout::SPAN, 8>>
       v;  // (M,) v correction vector
 
   // Passing 2 scaling factors is more efficient for the QR implementation.
   // Avoids another full pass on the v vector in the vertex it is constructed.
-  Input<Vector<T, poplar::VectorLayout::ONE_PTR>>
+  Input<Vector<float, poplar::VectorLayout::ONE_PTR>>
       scale1;  // (1,) first scaling factor.
-  Input<Vector<T, poplar::VectorLayout::ONE_PTR>>
+  Input<Vector<float, poplar::VectorLayout::ONE_PTR>>
       scale2;  // (1,) 2nd scaling factor.
 
   Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
@@ -191,51 +395,112 @@ class [[poplar::constraint(
                         // alignment aspects).
 
   bool compute(unsigned wid) {
-    // Always assuming size % 2 == 0
-    constexpr unsigned ptr_step = 1;
     const IndexType wstart = worker_offsets[wid];
     const IndexType wend = worker_offsets[wid + 1];
     const IndexType wsize = wend - wstart;
+    const float s = -scale1[0] * scale2[0];
+    qr_householder_row_update_inplace<Bundled>(&x[start_idx], &v[0], s, wstart,
+                                               wsize);
+    return true;
+  }
+};
 
-    // Set the $TAS register with the proper scale.
-    const T s = -scale1[0] * scale2[0];
-    // __builtin_ipu_put_tas(s);
-    __ipu_and_ipumodel_tas tas;
-    tas.put(s);
+template class QRHouseholderRowUpdateVertex<float, true>;
+template class QRHouseholderRowUpdateVertex<float, false>;
+template class QRHouseholderRowUpdateVertex<half, true>;
 
-    // Nothing to do in this worker thread.
-    if (wstart == wend) {
-      return true;
-    }
-    // X and v IO pointers.
-    const float2* ptr_inxdata_f2 =
-        reinterpret_cast<const float2*>(&x[start_idx]) + wstart;
-    float2* ptr_outxdata_f2 = reinterpret_cast<float2*>(&x[start_idx]) + wstart;
-    const float2* ptr_vdata_f2 =
-        reinterpret_cast<const float2*>(&v[0]) + wstart;
-
-    float2 xin, vin, rtmp, rout;
-    // First vectors loading.
-    xin = ipu::load_postinc(&ptr_inxdata_f2, ptr_step);
-    vin = ipu::load_postinc(&ptr_vdata_f2, ptr_step);
-    // TODO: use ld2x64pace + tapack instructions.
-    for (IndexType idx = 1; idx != wsize; ++idx) {
-      rtmp = tas.f32v2axpy(xin, vin);
-      // rtmp = __builtin_ipu_f32v2axpy(xin, vin);
-      // Grouping here seems to help the compiler optimising loads?
-      xin = ipu::load_postinc(&ptr_inxdata_f2, ptr_step);
-      vin = ipu::load_postinc(&ptr_vdata_f2, ptr_step);
-      rout = tas.f32v2axpy(rtmp, rtmp);
-      // rout = __builtin_ipu_f32v2axpy(rtmp, rtmp);
-      ipu::store_postinc(&ptr_outxdata_f2, rout, ptr_step);
-    }
-    // Finish the loop, getting the last computation.
-    // rtmp = __builtin_ipu_f32v2axpy(xin, vin);
-    // rout = __builtin_ipu_f32v2axpy(rtmp, rtmp);
-    rtmp = tas.f32v2axpy(xin, vin);
-    rout = tas.f32v2axpy(rtmp, rtmp);
-    ipu::store_postinc(&ptr_outxdata_f2, rout, ptr_step);
+/**
+ * @brief Batched Householder QR decomposition of small square matrices.
+ *
+ * Every worker runs the full Householder QR algorithm on its own subset of
+ * the (tile local) matrices, i.e. no synchronization between workers. The
+ * Householder vector tail is kept inplace in R column until the Q update.
+ *
+ * See:  Gene H. Golub, Charles F. Van Loan, MATRIX COMPUTATIONS, 3rd edition,
+ * Johns Hopkins Chapter 5.2.1.
+ */
+class QRHouseholderBatchedVertex : public MultiVertex {
+ public:
+  using T = float;
+  // Using `uint16` seems to be generating more efficient loops?
+  using IndexType = unsigned short;
+
+  InOut<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      R;  // (B, N, N) input matrices, R result inplace.
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>>
+      Q;  // (B, N, N) Q result matrices.
+
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads matrices + 1.
 
+  const IndexType N;  // matrix size
+
+  QRHouseholderBatchedVertex();
+
+  bool compute(unsigned wid) {
+    const unsigned NN = unsigned(N) * N;
+    const IndexType wstart = worker_offsets[wid];
+    const IndexType wend = worker_offsets[wid + 1];
+
+    for (IndexType midx = wstart; midx != wend; ++midx) {
+      T* r = &R[midx * NN];
+      T* q = &Q[midx * NN];
+      // Initial Q: identity matrix.
+      for (unsigned idx = 0; idx != NN; ++idx) {
+        q[idx] = 0;
+      }
+      for (IndexType idx = 0; idx != N; ++idx) {
+        q[idx * N + idx] = 1;
+      }
+
+      for (IndexType j = 0; j + 1 < N; ++j) {
+        // Householder vector v = (x0 - alpha, x[1:]), with x = R[j:, j].
+        const T x0 = r[j * N + j];
+        T sqnorm_tail = 0;
+        for (IndexType i = j + 1; i != N; ++i) {
+          sqnorm_tail += r[i * N + j] * r[i * N + j];
+        }
+        if (sqnorm_tail == 0) {
+          continue;
+        }
+        const T norm = std::sqrt(x0 * x0 + sqnorm_tail);
+        // Sign choice avoiding cancellation.
+        const T alpha = x0 >= 0 ? -norm : norm;
+        const T v0 = x0 - alpha;
+        const T vrescale = T(2) / (v0 * v0 + sqnorm_tail);
+
+        // R = H @ R, on the remaining columns.
+        for (IndexType k = j + 1; k != N; ++k) {
+          T w = v0 * r[j * N + k];
+          for (IndexType i = j + 1; i != N; ++i) {
+            w += r[i * N + j] * r[i * N + k];
+          }
+          w *= vrescale;
+          r[j * N + k] -= w * v0;
+          for (IndexType i = j + 1; i != N; ++i) {
+            r[i * N + k] -= w * r[i * N + j];
+          }
+        }
+        // Q = Q @ H.
+        for (IndexType i = 0; i != N; ++i) {
+          T* qrow = &q[i * N];
+          T w = qrow[j] * v0;
+          for (IndexType l = j + 1; l != N; ++l) {
+            w += qrow[l] * r[l * N + j];
+          }
+          w *= vrescale;
+          qrow[j] -= w * v0;
+          for (IndexType l = j + 1; l != N; ++l) {
+            qrow[l] -= w * r[l * N + j];
+          }
+        }
+        // Final R column j.
+        r[j * N + j] = alpha;
+        for (IndexType i = j + 1; i != N; ++i) {
+          r[i * N + j] = 0;
+        }
+      }
+    }
     return true;
   }
 };
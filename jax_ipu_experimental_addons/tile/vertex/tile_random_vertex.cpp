@@ -0,0 +1,232 @@
+// Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+#include <poplar/HalfFloat.hpp>
+#include <poplar/Vertex.hpp>
+
+#include "intrinsics_utils.hpp"
+
+using namespace poplar;
+
+/**
+ * @brief Random sampling in FP32 compute vectors (float2 or float4), using
+ * the tile hardware RNG (i.e. seeded with `setHwSeeds`).
+ */
+template <typename CV>
+struct RandomSampler;
+
+template <>
+struct RandomSampler<float2> {
+  /** @brief Uniform samples in [-0.5, 0.5]. */
+  static ALWAYS_INLINE float2 uniform() noexcept {
+    return float2{__builtin_ipu_urand_f32(), __builtin_ipu_urand_f32()};
+  }
+  /** @brief Standard normal samples. */
+  static ALWAYS_INLINE float2 normal() noexcept {
+    return __builtin_ipu_f32v2grand();
+  }
+};
+
+template <>
+struct RandomSampler<float4> {
+  static ALWAYS_INLINE float4 uniform() noexcept {
+    return float4{__builtin_ipu_urand_f32(), __builtin_ipu_urand_f32(),
+                  __builtin_ipu_urand_f32(), __builtin_ipu_urand_f32()};
+  }
+  static ALWAYS_INLINE float4 normal() noexcept {
+    const float2 v0 = __builtin_ipu_f32v2grand();
+    const float2 v1 = __builtin_ipu_f32v2grand();
+    return float4{v0[0], v0[1], v1[0], v1[1]};
+  }
+};
+
+/**
+ * @brief Uniform op: offset + scale * U[0, 1].
+ */
+struct RandomUniformOp {
+  float offset;
+  float scale;
+
+  template <typename CV>
+  ALWAYS_INLINE CV sample() const noexcept {
+    constexpr unsigned N = sizeof(CV) / sizeof(float);
+    CV v = RandomSampler<CV>::uniform();
+    for (unsigned i = 0; i < N; ++i) {
+      v[i] = offset + scale * (v[i] + 0.5f);
+    }
+    return v;
+  }
+};
+
+/**
+ * @brief Normal op: mean + stddev * N(0, 1).
+ */
+struct RandomNormalOp {
+  float mean;
+  float stddev;
+
+  template <typename CV>
+  ALWAYS_INLINE CV sample() const noexcept {
+    constexpr unsigned N = sizeof(CV) / sizeof(float);
+    CV v = RandomSampler<CV>::normal();
+    for (unsigned i = 0; i < N; ++i) {
+      v[i] = mean + stddev * v[i];
+    }
+    return v;
+  }
+};
+
+/**
+ * @brief Truncated normal op: mean + stddev * N(0, 1), truncated to
+ * [-alpha, alpha] standard deviations.
+ *
+ * Out of range values are re-sampled (at most `iterations` times), and then
+ * replaced by uniform samples in [-alpha, alpha] (as in poprand).
+ */
+struct RandomTruncatedNormalOp {
+  float mean;
+  float stddev;
+  float alpha;
+  unsigned iterations;
+
+  template <typename CV>
+  ALWAYS_INLINE CV sample() const noexcept {
+    constexpr unsigned N = sizeof(CV) / sizeof(float);
+    CV v = RandomSampler<CV>::normal();
+    for (unsigned it = 0; it < iterations; ++it) {
+      // Re-sampling the full vector only when necessary.
+      bool valid = true;
+      for (unsigned i = 0; i < N; ++i) {
+        valid &= (v[i] >= -alpha) & (v[i] <= alpha);
+      }
+      if (valid) {
+        break;
+      }
+      const CV r = RandomSampler<CV>::normal();
+      for (unsigned i = 0; i < N; ++i) {
+        v[i] = (v[i] >= -alpha && v[i] <= alpha) ? v[i] : r[i];
+      }
+    }
+    const CV u = RandomSampler<CV>::uniform();
+    for (unsigned i = 0; i < N; ++i) {
+      const bool valid = v[i] >= -alpha && v[i] <= alpha;
+      const float x = valid ? float(v[i]) : 2 * alpha * u[i];
+      v[i] = mean + stddev * x;
+    }
+    return v;
+  }
+};
+
+/**
+ * @brief Worker-parallel random sampling of a 1d output, using 64 bits
+ * storage vectors.
+ *
+ * Worker offsets are in storage vectors, covering the first `size / vsize`
+ * full vectors. The (< vsize) remaining elements are sampled by the last
+ * worker.
+ */
+template <typename T, typename Op>
+ALWAYS_INLINE void random_sampling_1d(T* out, const unsigned* worker_offsets,
+                                      unsigned size, unsigned wid,
+                                      const Op& op) noexcept {
+  using Traits = StorageVectorTraits<T>;
+  using SV = typename Traits::StorageVector;
+  using CV = typename Traits::ComputeVector;
+  constexpr unsigned vsize = Traits::size;
+
+  __ipu_and_ipumodel_rng_decorrelate(out, wid);
+  const unsigned wstart = worker_offsets[wid];
+  const unsigned wend = worker_offsets[wid + 1];
+  SV* outptr = reinterpret_cast<SV*>(out) + wstart;
+  for (unsigned idx = wstart; idx != wend; ++idx) {
+    ipu::store_postinc(&outptr, Traits::to_storage(op.template sample<CV>()),
+                       1);
+  }
+  // Last worker (out of 6): remaining elements.
+  if (wid == 5) {
+    const unsigned tstart = worker_offsets[6] * vsize;
+    if (tstart < size) {
+      const CV v = op.template sample<CV>();
+      for (unsigned idx = tstart; idx < size; ++idx) {
+        out[idx] = T(v[idx - tstart]);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Uniform sampling vertex: out = offset + scale * U[0, 1].
+ *
+ * Worker-parallel sampling with the tile hardware RNG (`urand` builtins).
+ */
+template <typename T>
+class RandomUniformVertex : public MultiVertex {
+ public:
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> out;  // (size,)
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads work size + 1.
+
+  const unsigned size;
+  const float offset;
+  const float scale;
+
+  bool compute(unsigned wid) {
+    random_sampling_1d(&out[0], &worker_offsets[0], size, wid,
+                       RandomUniformOp{offset, scale});
+    return true;
+  }
+};
+
+template class RandomUniformVertex<float>;
+template class RandomUniformVertex<half>;
+
+/**
+ * @brief Normal sampling vertex: out = mean + stddev * N(0, 1).
+ *
+ * Worker-parallel sampling with the tile hardware RNG (`grand` builtins).
+ */
+template <typename T>
+class RandomNormalVertex : public MultiVertex {
+ public:
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> out;  // (size,)
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads work size + 1.
+
+  const unsigned size;
+  const float mean;
+  const float stddev;
+
+  bool compute(unsigned wid) {
+    random_sampling_1d(&out[0], &worker_offsets[0], size, wid,
+                       RandomNormalOp{mean, stddev});
+    return true;
+  }
+};
+
+template class RandomNormalVertex<float>;
+template class RandomNormalVertex<half>;
+
+/**
+ * @brief Truncated normal sampling vertex: out = mean + stddev * N(0, 1),
+ * truncated to [-alpha, alpha] standard deviations.
+ */
+template <typename T>
+class RandomTruncatedNormalVertex : public MultiVertex {
+ public:
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> out;  // (size,)
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads work size + 1.
+
+  const unsigned size;
+  const float mean;
+  const float stddev;
+  const float alpha;
+  const unsigned iterations;
+
+  bool compute(unsigned wid) {
+    const RandomTruncatedNormalOp op{mean, stddev, alpha, iterations};
+    random_sampling_1d(&out[0], &worker_offsets[0], size, wid, op);
+    return true;
+  }
+};
+
+template class RandomTruncatedNormalVertex<float>;
+template class RandomTruncatedNormalVertex<half>;
@@ -0,0 +1,211 @@
+// Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+#include <poplar/HalfFloat.hpp>
+#include <poplar/Vertex.hpp>
+
+#include <limits>
+
+#include "intrinsics_utils.hpp"
+
+using namespace poplar;
+
+/**
+ * @brief Reduce operations, in FP32 (scalar and compute vectors).
+ */
+struct ReduceAddOp {
+  static ALWAYS_INLINE float init() noexcept { return 0.0f; }
+  static ALWAYS_INLINE float apply(float a, float b) noexcept { return a + b; }
+  template <typename V>
+  static ALWAYS_INLINE V apply(V a, V b) noexcept {
+    return a + b;
+  }
+};
+
+struct ReduceMulOp {
+  static ALWAYS_INLINE float init() noexcept { return 1.0f; }
+  static ALWAYS_INLINE float apply(float a, float b) noexcept { return a * b; }
+  template <typename V>
+  static ALWAYS_INLINE V apply(V a, V b) noexcept {
+    return a * b;
+  }
+};
+
+struct ReduceMaxOp {
+  static ALWAYS_INLINE float init() noexcept {
+    return -std::numeric_limits<float>::infinity();
+  }
+  static ALWAYS_INLINE float apply(float a, float b) noexcept {
+    return a > b ? a : b;
+  }
+  template <typename V>
+  static ALWAYS_INLINE V apply(V a, V b) noexcept {
+    constexpr unsigned N = sizeof(V) / sizeof(float);
+    for (unsigned i = 0; i < N; ++i) {
+      a[i] = apply(float(a[i]), float(b[i]));
+    }
+    return a;
+  }
+};
+
+struct ReduceMinOp {
+  static ALWAYS_INLINE float init() noexcept {
+    return std::numeric_limits<float>::infinity();
+  }
+  static ALWAYS_INLINE float apply(float a, float b) noexcept {
+    return a < b ? a : b;
+  }
+  template <typename V>
+  static ALWAYS_INLINE V apply(V a, V b) noexcept {
+    constexpr unsigned N = sizeof(V) / sizeof(float);
+    for (unsigned i = 0; i < N; ++i) {
+      a[i] = apply(float(a[i]), float(b[i]));
+    }
+    return a;
+  }
+};
+
+/**
+ * @brief Horizontal reduction of a compute vector.
+ */
+template <typename Op, typename V>
+ALWAYS_INLINE float reduce_compute_vector(V v) noexcept {
+  constexpr unsigned N = sizeof(V) / sizeof(float);
+  float r = v[0];
+  for (unsigned i = 1; i < N; ++i) {
+    r = Op::apply(r, float(v[i]));
+  }
+  return r;
+}
+
+/**
+ * @brief Input offset corresponding to a linear index over a set of
+ * (size, stride) dimensions (innermost dimension last).
+ */
+ALWAYS_INLINE unsigned reduce_dims_offset(unsigned idx, const unsigned* dims,
+                                          unsigned num_dims) noexcept {
+  unsigned offset = 0;
+  for (int d = int(num_dims) - 1; d >= 0; --d) {
+    const unsigned size = dims[2 * d];
+    const unsigned q = idx / size;
+    offset += (idx - q * size) * dims[2 * d + 1];
+    idx = q;
+  }
+  return offset;
+}
+
+/**
+ * @brief General reduce vertex, supporting any set of reduced axes.
+ *
+ * The input is described as a collection of kept (`out_dims`) and reduced
+ * (`red_dims`) dimensions, as (size, stride) pairs (contiguous dimensions
+ * merged beforehand). Output elements are split between the 6 workers, in
+ * blocks of `grain` outputs, with FP32 accumulation. Vector modes:
+ *  - 0: scalar loads;
+ *  - 1: innermost input dimension kept and contiguous, vectorized over
+ *    outputs (float2 / half4 loads & stores);
+ *  - 2: innermost input dimension reduced and contiguous, vectorized over
+ *    the reduced dimension (float2 / half4 loads).
+ *
+ * @tparam T Input/output dtype (float or half).
+ * @tparam Op Reduce operation.
+ */
+template <typename T, typename Op>
+class ReduceGeneralVertex : public MultiVertex {
+ public:
+  using Traits = StorageVectorTraits<T>;
+  using SV = typename Traits::StorageVector;
+  using CV = typename Traits::ComputeVector;
+  // Using `uint16` seems to be generating more efficient loops?
+  using IndexType = unsigned short;
+
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> in;  // (N,) input
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads work size + 1, in grains.
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR>>
+      out_dims;  // (num_out_dims, 2) kept dims (size, stride).
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR>>
+      red_dims;  // (num_red_dims, 2) reduced dims (size, stride).
+
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 8>> out;  // (M,) output
+
+  const unsigned num_out_dims;  // number of kept dimensions
+  const unsigned num_red_dims;  // number of reduced dimensions (> 0)
+  const unsigned num_outputs;   // number of output elements
+  const unsigned grain;         // worker grain size, in output elements
+  const unsigned vector_mode;   // vectorization mode
+
+  ReduceGeneralVertex();
+
+  bool compute(unsigned wid) {
+    const unsigned wstart = worker_offsets[wid] * grain;
+    const unsigned wend_grain = worker_offsets[wid + 1] * grain;
+    const unsigned wend = wend_grain < num_outputs ? wend_grain : num_outputs;
+    // Innermost reduced dimension: inner loop.
+    const unsigned* red_outer_dims = &red_dims[0];
+    const unsigned num_red_outer_dims = num_red_dims - 1;
+    const unsigned red_inner_size = red_dims[2 * num_red_outer_dims];
+    const unsigned red_inner_stride = red_dims[2 * num_red_outer_dims + 1];
+    unsigned red_outer_size = 1;
+    for (unsigned d = 0; d < num_red_outer_dims; ++d) {
+      red_outer_size *= red_dims[2 * d];
+    }
+
+    if (vector_mode == 1) {
+      // Vectorized over (contiguous) outputs.
+      for (unsigned o = wstart; o < wend; o += Traits::size) {
+        const unsigned base = reduce_dims_offset(o, &out_dims[0], num_out_dims);
+        CV acc = Traits::splat(Op::init());
+        for (unsigned ro = 0; ro < red_outer_size; ++ro) {
+          const unsigned rbase =
+              base + reduce_dims_offset(ro, red_outer_dims, num_red_outer_dims);
+          for (unsigned r = 0; r < red_inner_size; ++r) {
+            const SV* ptr =
+                reinterpret_cast<const SV*>(&in[rbase + r * red_inner_stride]);
+            acc = Op::apply(acc, Traits::to_compute(*ptr));
+          }
+        }
+        *reinterpret_cast<SV*>(&out[o]) = Traits::to_storage(acc);
+      }
+    } else if (vector_mode == 2) {
+      // Vectorized over the (contiguous) innermost reduced dimension.
+      const unsigned red_inner_vsize = red_inner_size / Traits::size;
+      for (unsigned o = wstart; o < wend; ++o) {
+        const unsigned base = reduce_dims_offset(o, &out_dims[0], num_out_dims);
+        CV acc = Traits::splat(Op::init());
+        for (unsigned ro = 0; ro < red_outer_size; ++ro) {
+          const unsigned rbase =
+              base + reduce_dims_offset(ro, red_outer_dims, num_red_outer_dims);
+          const SV* ptr = reinterpret_cast<const SV*>(&in[rbase]);
+          for (unsigned r = 0; r < red_inner_vsize; ++r) {
+            acc =
+                Op::apply(acc, Traits::to_compute(ipu::load_postinc(&ptr, 1)));
+          }
+        }
+        out[o] = T(reduce_compute_vector<Op>(acc));
+      }
+    } else {
+      // Generic scalar loop.
+      for (unsigned o = wstart; o < wend; ++o) {
+        const unsigned base = reduce_dims_offset(o, &out_dims[0], num_out_dims);
+        float acc = Op::init();
+        for (unsigned ro = 0; ro < red_outer_size; ++ro) {
+          const unsigned rbase =
+              base + reduce_dims_offset(ro, red_outer_dims, num_red_outer_dims);
+          for (unsigned r = 0; r < red_inner_size; ++r) {
+            acc = Op::apply(acc, float(in[rbase + r * red_inner_stride]));
+          }
+        }
+        out[o] = T(acc);
+      }
+    }
+    return true;
+  }
+};
+
+template class ReduceGeneralVertex<float, ReduceAddOp>;
+template class ReduceGeneralVertex<float, ReduceMulOp>;
+template class ReduceGeneralVertex<float, ReduceMaxOp>;
+template class ReduceGeneralVertex<float, ReduceMinOp>;
+template class ReduceGeneralVertex<half, ReduceAddOp>;
+template class ReduceGeneralVertex<half, ReduceMulOp>;
+template class ReduceGeneralVertex<half, ReduceMaxOp>;
+template class ReduceGeneralVertex<half, ReduceMinOp>;
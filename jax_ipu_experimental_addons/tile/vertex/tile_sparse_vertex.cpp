@@ -0,0 +1,55 @@
+// Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+#include <poplar/HalfFloat.hpp>
+#include <poplar/Vertex.hpp>
+
+#include "intrinsics_utils.hpp"
+
+using namespace poplar;
+
+/**
+ * @brief Sparse CSR matrix-vector product on a row block: out = A @ x.
+ *
+ * The row block is stored in CSR format, with column indices local to the
+ * (gathered) dense vector slice `x` required by the block. FP32 accumulation.
+ *
+ * Work is split between workers by rows, with worker offsets balanced on the
+ * number of non zeros (even row boundaries, avoiding sub-word writes races on
+ * half outputs).
+ */
+template <typename T>
+class SparseCsrMatVec : public MultiVertex {
+ public:
+  using IndexType = unsigned short;
+
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR>> values;  // (nnz,)
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      col_indices;  // (nnz,) local column indices in x.
+  Input<Vector<unsigned, poplar::VectorLayout::ONE_PTR>>
+      row_offsets;                                    // (rows + 1,)
+  Input<Vector<T, poplar::VectorLayout::ONE_PTR>> x;  // (ncols,)
+  Input<Vector<IndexType, poplar::VectorLayout::ONE_PTR>>
+      worker_offsets;  // (7,) threads rows + 1.
+
+  Output<Vector<T, poplar::VectorLayout::ONE_PTR, 4>> out;  // (rows,)
+
+  bool compute(unsigned wid) {
+    const IndexType rstart = worker_offsets[wid];
+    const IndexType rend = worker_offsets[wid + 1];
+    const T* values_ptr = &values[row_offsets[rstart]];
+    const IndexType* col_indices_ptr = &col_indices[row_offsets[rstart]];
+    for (IndexType r = rstart; r < rend; ++r) {
+      const unsigned row_nnz = row_offsets[r + 1] - row_offsets[r];
+      float acc = 0.0f;
+      for (unsigned k = 0; k < row_nnz; ++k) {
+        acc += float(values_ptr[k]) * float(x[col_indices_ptr[k]]);
+      }
+      out[r] = T(acc);
+      values_ptr += row_nnz;
+      col_indices_ptr += row_nnz;
+    }
+    return true;
+  }
+};
+
+template class SparseCsrMatVec<float>;
+template class SparseCsrMatVec<half>;
@@ -1,11 +1,13 @@
 # Copyright (c) 2023 Graphcore Ltd. All rights reserved.
 import glob
+import importlib.util
 import itertools
 import os.path
 import sys
-from typing import List
+from typing import Any, List
 
 import setuptools
+from setuptools.command.build_ext import build_ext
 
 PACKAGE_NAME = "jax_ipu_experimental_addons"
 repository_dir = os.path.dirname(__file__)
@@ -35,6 +37,79 @@ package_data_cpp_list = [glob.glob(f"{PACKAGE_NAME}/**/*{ext}", recursive=True)
 package_data_cpp: List[str] = list(itertools.chain(*package_data_cpp_list))
 package_data_cpp = [f.replace(f"{PACKAGE_NAME}/", "") for f in package_data_cpp]
 
+# Native pybind11 modules, prebuilt at install time (cppimport JIT compilation as a fallback).
+native_modules = ["tile/tile_array_primitives_impl.cpp", "tile/tile_interpreter_primitives_impl.cpp"]
+# Native modules build helpers, with the same configuration as cppimport.
+_native_spec = importlib.util.spec_from_file_location(
+    "_tile_native_modules", os.path.join(repository_dir, PACKAGE_NAME, "tile", "tile_native_modules.py")
+)
+tile_native_modules: Any = importlib.util.module_from_spec(_native_spec)  # type: ignore
+_native_spec.loader.exec_module(tile_native_modules)  # type: ignore
+
+
+def get_native_include_dirs() -> List[str]:
+    """Get the native modules include directories.
+
+    Poplar headers are expected in `CPATH` (i.e. Poplar SDK enabled). JAX IPU custom primitive
+    headers are searched in the `jax.ipu` package, or set with `JAX_IPU_NATIVE_INCLUDE_DIRS`.
+    """
+    include_dirs = [os.path.join(repository_dir, PACKAGE_NAME, "external")]
+    include_dirs += [d for d in os.environ.get("JAX_IPU_NATIVE_INCLUDE_DIRS", "").split(":") if d]
+    try:
+        import jax.ipu.primitive
+
+        jax_ipu_dir = os.path.dirname(os.path.dirname(jax.ipu.primitive.__file__))
+        headers = glob.glob(os.path.join(jax_ipu_dir, "**", "ipu_custom_primitive.hpp"), recursive=True)
+        include_dirs += sorted({os.path.dirname(h) for h in headers})
+    except ImportError:
+        pass
+    return include_dirs
+
+
+def make_native_extensions() -> List[setuptools.Extension]:
+    """Make the native modules extensions (empty if disabled with `JAX_IPU_BUILD_NATIVE=0` or no pybind11)."""
+    if os.environ.get("JAX_IPU_BUILD_NATIVE", "1").lower() in ("0", "false"):
+        return []
+    try:
+        from pybind11.setup_helpers import Pybind11Extension
+    except ImportError:
+        return []
+
+    include_dirs = get_native_include_dirs()
+    extensions = []
+    for relpath in native_modules:
+        filename = os.path.join(PACKAGE_NAME, relpath)
+        cfg = tile_native_modules.get_native_module_cfg(filename)
+        dirname = os.path.dirname(filename)
+        extensions.append(
+            Pybind11Extension(
+                f"{PACKAGE_NAME}.{os.path.splitext(relpath)[0].replace('/', '.')}",
+                sources=[filename] + [os.path.normpath(os.path.join(dirname, f)) for f in cfg.get("sources", [])],
+                include_dirs=include_dirs + cfg.get("include_dirs", []),
+                libraries=cfg.get("libraries", []),
+                extra_compile_args=cfg.get("extra_compile_args", []),
+                cxx_std=17,
+            )
+        )
+    return extensions
+
+
+class NativeBuildExt(build_ext):
+    """Build native modules, with the sources hash used at import time, falling back to cppimport on failure."""
+
+    def build_extension(self, ext):
+        try:
+            super().build_extension(ext)
+        except Exception as e:
+            sys.stderr.write(f"Failed to build native module `{ext.name}`, using cppimport JIT instead:\n  {e}\n")
+            sys.stderr.flush()
+            return
+        ext_fullpath = self.get_ext_fullpath(ext.name)
+        hash_filename = tile_native_modules.get_native_module_hash_filename(os.path.dirname(ext_fullpath), ext.name)
+        with open(hash_filename, "w") as f:
+            f.write(tile_native_modules.make_native_module_sources_hash(ext.sources[0]))
+
+
 setuptools.setup(
     name=PACKAGE_NAME,
     author="Graphcore Research team",
@@ -53,6 +128,8 @@ setuptools.setup(
     extras_require={"test": test_requirements},
     package_data={PACKAGE_NAME: ["py.typed"] + package_data_cpp},
     include_package_data=True,
+    ext_modules=make_native_extensions(),
+    cmdclass={"build_ext": NativeBuildExt},
     classifiers=[
         "Programming Language :: Python :: 3.8",
         "Programming Language :: Python :: 3.9",
@@ -9,11 +9,13 @@ from jax_ipu_experimental_addons.tile import (
     IpuTileMapEquation,
     declare_ipu_tile_primitive,
     from_numpy_dtype_to_ipu_type,
+    make_ipu_shaped_array,
     make_ipu_vertex_constant_info,
     make_ipu_vertex_in_info,
     make_ipu_vertex_out_info,
     register_ipu_tile_primitive,
 )
+from jax_ipu_experimental_addons.tile.tile_interpreter_primitives import IpuVertexAttributeF32
 from jax_ipu_experimental_addons.utils import DTypeLike
 
 custom_vertex_filename = os.path.join(os.path.dirname(__file__), "custom_arange_vertex.cpp")
@@ -91,6 +93,47 @@ custom_arange_p.def_abstract_eval(custom_arange_abstract_eval)
 register_ipu_tile_primitive(custom_arange_p, custom_arange_tile_translation_ipu)
 
 
+custom_sharded_scale_p = core.Primitive("custom_sharded_scale")
+custom_sharded_scale_p.multiple_results = True
+
+
+def custom_sharded_scale_abstract_eval(input):
+    return [core.ShapedArray(input.shape, input.dtype)] * 2
+
+
+def custom_sharded_scale_tile_translation_ipu(
+    p: core.Primitive,
+    tiles: Tuple[int, ...],
+    inavals: List[core.ShapedArray],
+    attributes: Dict[str, Any] = None,
+) -> IpuTileMapEquation:
+    """IPU tile translation scaling every tile input by (tile index + 1), embedded as a sharded constant."""
+    assert len(inavals) == 1
+    inaval = inavals[0]
+    scales_data = np.arange(1, len(tiles) + 1).astype(inaval.dtype).reshape((len(tiles), 1))
+    ipu_prim_info = IpuTileMapEquation(
+        vname=f"CustomMultiOutVertex<{from_numpy_dtype_to_ipu_type(inaval.dtype).name.lower()}>",
+        pname=p.name,
+        tiles=tiles,
+        inputs_info=[
+            make_ipu_vertex_in_info("input", inaval),
+            make_ipu_vertex_constant_info("constant_scale", scales_data, sharded=True),
+        ],
+        outputs_info=[make_ipu_vertex_out_info("out0", inaval), make_ipu_vertex_out_info("out1", inaval)],
+        attributes_i32=[],
+        attributes_f32=[IpuVertexAttributeF32("scale_value", 1.0)],
+        gp_filename=custom_vertex_filename,
+        perf_estimate=inaval.size + 5,
+    )
+    ipu_prim_info.tmp_space_name = "mytmp"
+    ipu_prim_info.tmp_space_aval = make_ipu_shaped_array(inaval.shape, inaval.dtype)
+    return ipu_prim_info
+
+
+custom_sharded_scale_p.def_abstract_eval(custom_sharded_scale_abstract_eval)
+register_ipu_tile_primitive(custom_sharded_scale_p, custom_sharded_scale_tile_translation_ipu)
+
+
 # Declaring a tile primitive in a very simple & fast way.
 @declare_ipu_tile_primitive("CustomSingleOutVertex<{input}>", gp_filename=custom_vertex_filename)
 def custom_single_out_p(input):
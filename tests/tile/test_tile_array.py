@@ -12,15 +12,21 @@ from jax.lax import add_p, sub_p
 
 from jax_ipu_experimental_addons.tile import (
     TileShardedArray,
+    ipu_tile_constant_pool_clear,
+    ipu_tile_constant_pool_stats,
     tile_constant_replicated,
     tile_constant_sharded,
+    tile_contiguous_regions,
     tile_data_barrier,
     tile_gather,
+    tile_global_index,
+    tile_ipu_index,
     tile_map_primitive,
     tile_put_replicated,
     tile_put_sharded,
 )
-from jax_ipu_experimental_addons.tile.tile_array import check_tile_array_multi_slice
+from jax_ipu_experimental_addons.tile.tile_array import check_tile_array_multi_slice, ipu_num_tiles_per_ipu
+from jax_ipu_experimental_addons.tile.tile_interpreter_linalg_qr import qr_householder_row_update_p
 
 
 class TileShardedArrayTests(chex.TestCase, parameterized.TestCase):
@@ -54,6 +60,24 @@ class TileShardedArrayTests(chex.TestCase, parameterized.TestCase):
         assert all([isinstance(v, int) for v in arr.tiles])
         assert arr.tiles == (1, 3, 7)
 
+    def test__tile_sharded_array__ipu_tile_pairs__global_tiles(self):
+        input = np.asarray([1, 2, 3], np.float32)
+        output = TileShardedArray(input, [(0, 5), (1, 3), 7])
+        assert output.tiles == (5, ipu_num_tiles_per_ipu() + 3, 7)
+
+    @parameterized.parameters([(0, 0), 12, (1, 0), (3, ipu_num_tiles_per_ipu() - 1)])
+    def test__tile_global_index__tile_ipu_index__round_trip(self, tile):
+        gtile = tile_global_index(tile)
+        assert isinstance(gtile, int)
+        assert tile_global_index(tile_ipu_index(gtile)) == gtile
+        if isinstance(tile, tuple):
+            assert tile_ipu_index(gtile) == tile
+
+    @parameterized.parameters([(0, ipu_num_tiles_per_ipu()), (-1, 2), (0, -1)])
+    def test__tile_global_index__invalid_ipu_tile_pair(self, ipu, tile):
+        with self.assertRaises(ValueError):
+            tile_global_index((ipu, tile))
+
     @chex.variants(with_jit=True, without_jit=True)
     def test__tile_sharded_array__shape_dtype(self):
         @self.variant
@@ -183,6 +207,49 @@ def test__tile_put_sharded__backend_jitting(backend):
     npt.assert_array_equal(output.array, input)
 
 
+@pytest.mark.parametrize("out_tiles", [(3, 4, 5), (3, 5, 4), (5, 6, 7)])
+def test__tile_put_sharded__chaining_tile_ops__proper_result(out_tiles):
+    # No copy, partial or full copy of already sharded data.
+    data = np.random.randn(3, 7).astype(np.float32)
+    tiles = (3, 4, 5)
+
+    @partial(jax.jit, backend="ipu")
+    def compute_fn(data):
+        arr = tile_put_sharded(data, tiles)
+        arr = tile_map_primitive(add_p, arr, arr)
+        arr = tile_put_sharded(arr.array, out_tiles)
+        return arr, tile_contiguous_regions(arr)
+
+    output, num_regions = compute_fn(data)
+    assert isinstance(output, TileShardedArray)
+    assert output.tiles == out_tiles
+    npt.assert_array_equal(output.array, 2 * data)
+    npt.assert_array_equal(num_regions.array, np.ones((len(out_tiles),), np.int32))
+
+
+@pytest.mark.parametrize("out_tiles", [(3, 4, 5), (3, 5, 4)])
+def test__tile_put_sharded__inplace_tile_map_on_output__input_unchanged(out_tiles):
+    # In-place (InOut) update of forwarded slices must not modify the (live) input.
+    data = np.random.randn(3, 8).astype(np.float32)
+    v = np.random.randn(8).astype(np.float32)
+    w = np.array([0.5], np.float32)
+    tiles = (3, 4, 5)
+
+    @partial(jax.jit, backend="ipu")
+    def compute_fn(data, v, w):
+        arr = tile_put_sharded(data, tiles)
+        arr = tile_map_primitive(add_p, arr, arr)
+        out = tile_put_sharded(arr.array, out_tiles)
+        v = tile_put_replicated(v, out_tiles)
+        w = tile_put_replicated(w, out_tiles)
+        out = tile_map_primitive(qr_householder_row_update_p, out, v, w, w, start_idx=0)
+        return arr, out
+
+    arr, out = compute_fn(data, v, w)
+    npt.assert_array_equal(arr.array, 2 * data)
+    npt.assert_array_almost_equal(out.array, 2 * data - w[0] * w[0] * v, decimal=5)
+
+
 @pytest.mark.parametrize("backend", ["cpu", "ipu"])
 def test__tile_put_replicated__backend_jitting(backend):
     input = np.asarray([1, 2, 3], np.float32)
@@ -294,7 +361,7 @@ class TileDataBarrierTests(chex.TestCase, parameterized.TestCase):
         t1 = tile_data_barrier(t0)
         assert t1 is t0
 
-    def test__tile_data_barrier__not_supporting_different_size_dtypes(self):
+    def test__tile_data_barrier__supporting_different_size_dtypes(self):
         tiles = [0, 1]
         data = np.asarray([1, 2, 5], np.float32)
 
@@ -302,10 +369,29 @@ class TileDataBarrierTests(chex.TestCase, parameterized.TestCase):
         def tile_data_barrier_fn(data) -> Tuple[TileShardedArray, ...]:
             t0 = tile_put_replicated(data, tiles)
             t1 = tile_put_replicated(data.astype(np.float16), tiles)
+            t2 = tile_put_replicated(data.astype(np.uint8), [1, 2])
+            t3 = tile_put_replicated(data.astype(np.int16), [2, 3])
+            return tile_data_barrier(t0, t1, t2, t3)
+
+        outputs = tile_data_barrier_fn(data)
+        assert [v.dtype for v in outputs] == [np.float32, np.float16, np.uint8, np.int16]
+        for out in outputs:
+            npt.assert_array_equal(np.asarray(out)[0], data)
+
+    def test__tile_data_barrier__supporting_float16_int16_dtypes(self):
+        tiles = [0, 1]
+        data = np.asarray([1, 2, 5], np.float32)
+
+        @partial(jax.jit, backend="ipu")
+        def tile_data_barrier_fn(data) -> Tuple[TileShardedArray, ...]:
+            t0 = tile_put_replicated(data.astype(np.float16), tiles)
+            t1 = tile_put_replicated(data.astype(np.int16), [1, 2])
             return tile_data_barrier(t0, t1)
 
-        with self.assertRaises(TypeError):
-            tile_data_barrier_fn(data)
+        outputs = tile_data_barrier_fn(data)
+        assert [v.dtype for v in outputs] == [np.float16, np.int16]
+        for out in outputs:
+            npt.assert_array_equal(np.asarray(out)[0], data)
 
     def test__tile_data_barrier__supporting_same_size_dtypes(self):
         tiles = [0, 1]
@@ -388,6 +474,62 @@ class TileConstantTests(chex.TestCase, parameterized.TestCase):
             assert out.shape == (len(tiles), *data.shape)
             npt.assert_array_equal(out, np.stack([data] * len(tiles)))
 
+    def test__tile_constant_replicated__jitting__deduplicated_constants(self):
+        data = np.asarray([[1, 2, 3], [4, 5, 6]], np.float32)
+        tiles0 = (3, 4, 5, 6)
+        tiles1 = (4, 5)
+
+        @partial(jax.jit, backend="ipu")
+        def compute_fn(v):
+            return v, tile_constant_replicated(data, tiles0), tile_constant_replicated(data, tiles1)
+
+        ipu_tile_constant_pool_clear()
+        _, out0, out1 = compute_fn(data)
+        npt.assert_array_equal(out0, np.stack([data] * len(tiles0)))
+        npt.assert_array_equal(out1, np.stack([data] * len(tiles1)))
+        # Second constant re-using the tile tensors of the first one.
+        stats = ipu_tile_constant_pool_stats()
+        assert stats["num_reused"] == len(tiles1)
+        assert stats["bytes_saved"] == len(tiles1) * data.nbytes
+
+    def test__tile_constant_replicated__multiple_jitting__no_reuse_between_graphs(self):
+        data = np.asarray([1, 2, 3], np.float32)
+        tiles = (3, 4)
+
+        def compute_fn(v):
+            return v, tile_constant_replicated(data, tiles)
+
+        ipu_tile_constant_pool_clear()
+        jax.jit(compute_fn, backend="ipu")(data)
+        # New graph: constants not re-used from the previous one.
+        _, out = jax.jit(lambda v: compute_fn(v + 1), backend="ipu")(data)
+        npt.assert_array_equal(out, np.stack([data] * len(tiles)))
+        stats = ipu_tile_constant_pool_stats()
+        assert stats["num_constants"] == 2 * len(tiles)
+        assert stats["num_reused"] == 0
+
+    def test__tile_constant_replicated__inplace_tile_map_on_pooled_constant__other_constant_unchanged(self):
+        # In-place (InOut) update of a pooled constant must not modify the other users.
+        data = np.random.randn(8).astype(np.float32)
+        v = np.random.randn(8).astype(np.float32)
+        w = np.array([0.5], np.float32)
+        tiles = (3, 4, 5)
+
+        @partial(jax.jit, backend="ipu")
+        def compute_fn(v, w):
+            c0 = tile_constant_replicated(data, tiles)
+            c1 = tile_constant_replicated(data, tiles)
+            v = tile_put_replicated(v, tiles)
+            w = tile_put_replicated(w, tiles)
+            out = tile_map_primitive(qr_householder_row_update_p, c0, v, w, w, start_idx=0)
+            return out, c1
+
+        ipu_tile_constant_pool_clear()
+        out, c1 = compute_fn(v, w)
+        npt.assert_array_equal(c1.array, np.stack([data] * len(tiles)))
+        npt.assert_array_almost_equal(out.array, np.stack([data - w[0] * w[0] * v] * len(tiles)), decimal=5)
+        assert ipu_tile_constant_pool_stats()["num_reused"] == len(tiles)
+
     def test__tile_constant_sharded__no_jitting__proper_tile_numpy_array(self):
         data = np.asarray([[1, 2, 3], [4, 5, 6]], np.float32)
         tiles = (3, 6)
@@ -433,3 +575,20 @@ class TileConstantTests(chex.TestCase, parameterized.TestCase):
             assert out.tiles == tiles
             assert out.shape == data.shape
             npt.assert_array_equal(out, data)
+
+
+class TileContiguousRegionsTests(chex.TestCase, parameterized.TestCase):
+    @parameterized.parameters(["cpu", "ipu"])
+    def test__tile_contiguous_regions__tile_put_sharded__single_region(self, backend):
+        tiles = (3, 4, 5)
+        data = np.random.randn(len(tiles), 7).astype(np.float32)
+
+        @partial(jax.jit, backend=backend)
+        def compute_fn(data):
+            arr = tile_put_sharded(data, tiles)
+            return tile_contiguous_regions(arr)
+
+        output = compute_fn(data)
+        assert isinstance(output, TileShardedArray)
+        assert output.tiles == tiles
+        npt.assert_array_equal(output.array, np.ones((len(tiles),), np.int32))
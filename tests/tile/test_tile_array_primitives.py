@@ -1,4 +1,6 @@
 # Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+import base64
+
 import chex
 import jax
 import numpy as np
@@ -7,10 +9,13 @@ import pytest
 from absl.testing import parameterized
 
 from jax_ipu_experimental_addons.tile.tile_array_primitives import (
+    Base64Data,
+    TileConstantParams,
     TileDataBarrierParams,
     tile_put_replicated_prim,
     tile_put_sharded_prim,
 )
+from jax_ipu_experimental_addons.tile.tile_common_utils import make_ipu_shaped_array
 
 
 class TilePutShardedPrimTests(chex.TestCase, parameterized.TestCase):
@@ -71,3 +76,13 @@ def test__tile_data_barrier_params__init__proper_fields():
 def test__tile_data_barrier_params__json__proper_value():
     params = TileDataBarrierParams("vbarrier", [[0, 1], [3, 4, 5]], 5)
     assert params.to_json_str() == '{"inputs_tiles":[[0,1],[3,4,5]],"max_tile":5,"vname":"vbarrier"}'
+
+
+def test__tile_constant_params__msgpack_bytes__proper_round_trip():
+    data = np.arange(16, dtype=np.int32)
+    params = TileConstantParams(
+        aval=make_ipu_shaped_array(data.shape, data.dtype), tiles=[1, 3], data=Base64Data(base64.b64encode(data))
+    )
+    params_rt = TileConstantParams.from_msgpack_bytes(params.to_msgpack_bytes())
+    assert params_rt.tiles == [1, 3]
+    assert params_rt.to_json_str() == params.to_json_str()
@@ -0,0 +1,143 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+import os
+import stat
+import tempfile
+from unittest import mock
+
+import chex
+from absl.testing import parameterized
+
+from jax_ipu_experimental_addons.tile import tile_codelet_cache
+from jax_ipu_experimental_addons.tile.tile_codelet_cache import (
+    get_cached_codelet_filename,
+    get_codelet_targets,
+    get_popc_version,
+    make_codelet_cache_key,
+)
+from jax_ipu_experimental_addons.tile.tile_native_modules import get_local_source_dependencies
+
+vertex_dir = os.path.join(os.path.dirname(tile_codelet_cache.__file__), "vertex")
+
+# Fake popc: printing a version and copying the source to the output file.
+fake_popc_script = """#!/bin/sh
+if [ "$1" = "--version" ]; then echo "popc fake 1.0"; exit 0; fi
+while [ $# -gt 0 ]; do
+  case "$1" in
+    -o) out="$2"; shift ;;
+    *.cpp) src="$1" ;;
+  esac
+  shift
+done
+echo "$src" >> "$(dirname "$0")/calls.txt"
+cp "$src" "$out"
+"""
+
+
+class IpuTileCodeletCacheTests(chex.TestCase, parameterized.TestCase):
+    def setUp(self):
+        super().setUp()
+        self.tmp_dir = tempfile.TemporaryDirectory()
+        # Fake popc in PATH, and empty cache directory.
+        bin_dir = os.path.join(self.tmp_dir.name, "bin")
+        os.makedirs(bin_dir)
+        self.popc_calls = os.path.join(bin_dir, "calls.txt")
+        popc = os.path.join(bin_dir, "popc")
+        with open(popc, "w") as f:
+            f.write(fake_popc_script)
+        os.chmod(popc, os.stat(popc).st_mode | stat.S_IEXEC)
+        self.cache_dir = os.path.join(self.tmp_dir.name, "cache")
+        self.env = {
+            "PATH": f"{bin_dir}:{os.environ.get('PATH', '')}",
+            "JAX_IPU_CODELET_CACHE_DIR": self.cache_dir,
+            "JAX_IPU_CODELET_CACHE": "1",
+        }
+        # Source file including a local header.
+        self.src_filename = os.path.join(self.tmp_dir.name, "my_vertex.cpp")
+        self.hdr_filename = os.path.join(self.tmp_dir.name, "my_utils.hpp")
+        with open(self.src_filename, "w") as f:
+            f.write('#include <poplar/Vertex.hpp>\n#include "my_utils.hpp"\n')
+        with open(self.hdr_filename, "w") as f:
+            f.write("#pragma once\n")
+        get_popc_version.cache_clear()
+        tile_codelet_cache._codelet_filename_cache.clear()
+
+    def tearDown(self):
+        get_popc_version.cache_clear()
+        tile_codelet_cache._codelet_filename_cache.clear()
+        self.tmp_dir.cleanup()
+        super().tearDown()
+
+    def num_popc_calls(self) -> int:
+        if not os.path.isfile(self.popc_calls):
+            return 0
+        with open(self.popc_calls) as f:
+            return len(f.readlines())
+
+    def test__get_local_source_dependencies__vertex_includes(self):
+        deps = get_local_source_dependencies(os.path.join(vertex_dir, "tile_dot_vertex.cpp"))
+        assert deps[0] == os.path.join(vertex_dir, "tile_dot_vertex.cpp")
+        assert os.path.join(vertex_dir, "intrinsics_utils.hpp") in deps
+
+    def test__make_codelet_cache_key__config_and_content_dependent(self):
+        key = make_codelet_cache_key(self.src_filename, "popc 1.0", "", ["-O2"])
+        assert key == make_codelet_cache_key(self.src_filename, "popc 1.0", "", ["-O2"])
+        assert key != make_codelet_cache_key(self.src_filename, "popc 1.1", "", ["-O2"])
+        assert key != make_codelet_cache_key(self.src_filename, "popc 1.0", "ipu2", ["-O2"])
+        assert key != make_codelet_cache_key(self.src_filename, "popc 1.0", "", ["-O3"])
+        # Local header modification => new key.
+        with open(self.hdr_filename, "a") as f:
+            f.write("// update\n")
+        assert key != make_codelet_cache_key(self.src_filename, "popc 1.0", "", ["-O2"])
+
+    def test__get_cached_codelet_filename__compiled_once(self):
+        with mock.patch.dict(os.environ, self.env):
+            gp_filename = get_cached_codelet_filename(self.src_filename)
+            assert gp_filename.startswith(self.cache_dir)
+            assert gp_filename.endswith(".gp")
+            assert os.path.isfile(gp_filename)
+            assert self.num_popc_calls() == 1
+            # In-process and cross-process (i.e. on-disk) cache re-use.
+            assert get_cached_codelet_filename(self.src_filename) == gp_filename
+            tile_codelet_cache._codelet_filename_cache.clear()
+            assert get_cached_codelet_filename(self.src_filename) == gp_filename
+            assert self.num_popc_calls() == 1
+
+    def test__get_cached_codelet_filename__header_update__new_entry(self):
+        with mock.patch.dict(os.environ, self.env):
+            gp_filename0 = get_cached_codelet_filename(self.src_filename)
+            # Local header update (with a different mtime) => in-process memo invalidated.
+            with open(self.hdr_filename, "a") as f:
+                f.write("// update\n")
+            mtime = os.path.getmtime(self.hdr_filename) + 10
+            os.utime(self.hdr_filename, (mtime, mtime))
+            gp_filename1 = get_cached_codelet_filename(self.src_filename)
+            assert gp_filename0 != gp_filename1
+            assert self.num_popc_calls() == 2
+
+    def test__get_codelet_targets__default_ipu_model_target(self):
+        with mock.patch.dict(os.environ, self.env):
+            assert "cpu" in get_codelet_targets().split(",")
+            with mock.patch.dict(os.environ, {"JAX_IPU_CODELET_TARGETS": "ipu2"}):
+                assert get_codelet_targets() == "ipu2"
+
+    def test__get_cached_codelet_filename__opt_flags_new_entry(self):
+        with mock.patch.dict(os.environ, self.env):
+            gp_filename0 = get_cached_codelet_filename(self.src_filename)
+            with mock.patch.dict(os.environ, {"JAX_IPU_CODELET_OPT_FLAGS": "-O3"}):
+                gp_filename1 = get_cached_codelet_filename(self.src_filename)
+            assert gp_filename0 != gp_filename1
+            assert self.num_popc_calls() == 2
+
+    @parameterized.parameters(["", "my_vertex.gp"])
+    def test__get_cached_codelet_filename__not_cpp_source__unchanged(self, filename):
+        with mock.patch.dict(os.environ, self.env):
+            assert get_cached_codelet_filename(filename) == filename
+
+    def test__get_cached_codelet_filename__cache_disabled__unchanged(self):
+        with mock.patch.dict(os.environ, {**self.env, "JAX_IPU_CODELET_CACHE": "0"}):
+            assert get_cached_codelet_filename(self.src_filename) == self.src_filename
+            assert self.num_popc_calls() == 0
+
+    def test__get_cached_codelet_filename__no_popc__unchanged(self):
+        with mock.patch.dict(os.environ, {**self.env, "PATH": self.tmp_dir.name}):
+            assert get_cached_codelet_filename(self.src_filename) == self.src_filename
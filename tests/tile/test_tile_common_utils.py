@@ -2,9 +2,23 @@
 import base64
 
 import chex
+import numpy as np
+import numpy.testing as npt
 from absl.testing import parameterized
 
-from jax_ipu_experimental_addons.tile.tile_common_utils import Base64Data, IpuShapedArray, IpuType
+from jax_ipu_experimental_addons.tile.tile_common_utils import (
+    Base64Data,
+    IpuFp8Format,
+    IpuShapedArray,
+    IpuType,
+    base64_decode,
+    base64_encode,
+    fp8_decode,
+    fp8_encode,
+    from_ipu_type_to_numpy_dtype,
+    get_ipu_type_name,
+    make_fp8_decode_table,
+)
 
 
 class Base64DataTests(chex.TestCase, parameterized.TestCase):
@@ -42,6 +56,29 @@ class Base64DataTests(chex.TestCase, parameterized.TestCase):
         assert data.encoded_data == "12345"
         assert data.to_json_str() == '{"encoded_data":"12345"}'
 
+    @parameterized.parameters(
+        {"size": 0, "use_avx2": True},
+        {"size": 7, "use_avx2": True},
+        {"size": 1000, "use_avx2": False},
+        {"size": 1000, "use_avx2": True},
+        {"size": 1024 * 1024 + 5, "use_avx2": True},
+    )
+    def test__base64_encode_decode__python_base64_compatibility(self, size, use_avx2):
+        data = np.random.randint(0, 256, size=size, dtype=np.uint8).tobytes()
+        encoded = base64_encode(data, use_avx2=use_avx2)
+        assert encoded == base64.b64encode(data)
+        assert base64_decode(encoded, use_avx2=use_avx2) == data
+
+    def test__base64_data__large_payload__python_base64_compatibility(self):
+        data = "0123456789abcdef" * 10000
+        b64data = Base64Data.from_decoded_data(data)
+        assert b64data.encoded_data == base64.b64encode(data.encode()).decode()
+        assert b64data.decoded_data == data
+
+    def test__base64_decode__invalid_data__error(self):
+        with self.assertRaises(RuntimeError):
+            base64_decode(b"12$%" * 100)
+
 
 class IpuTypeTests(chex.TestCase, parameterized.TestCase):
     def test__ipu_type__proper_bytesize(self):
@@ -49,6 +86,43 @@ class IpuTypeTests(chex.TestCase, parameterized.TestCase):
         assert IpuType.HALF.bytesize == 2
         assert IpuType.FLOAT.bytesize == 4
 
+    def test__ipu_type__quarter_raw_bytes_storage(self):
+        assert from_ipu_type_to_numpy_dtype(IpuType.QUARTER) == np.uint8
+        assert get_ipu_type_name(IpuType.QUARTER) == "unsigned char"
+
+
+class IpuFp8Tests(chex.TestCase, parameterized.TestCase):
+    @parameterized.parameters([(IpuFp8Format.F143, 240.0, 2.0**-10), (IpuFp8Format.F152, 57344.0, 2.0**-17)])
+    def test__make_fp8_decode_table__proper_range(self, fp8_format, max_value, min_value):
+        table = make_fp8_decode_table(fp8_format)
+        assert table.shape == (256,)
+        assert table.dtype == np.float32
+        assert np.max(table) == max_value
+        assert np.min(table) == -max_value
+        assert np.min(table[table > 0]) == min_value
+        # Positive values in increasing order.
+        assert np.all(np.diff(table[:128]) > 0)
+
+    @parameterized.parameters([IpuFp8Format.F143, IpuFp8Format.F152])
+    def test__fp8_encode__decode__exact_roundtrip(self, fp8_format):
+        codes = np.array([v for v in range(256) if v != 0x80], dtype=np.uint8)
+        npt.assert_array_equal(fp8_encode(fp8_decode(codes, fp8_format), fp8_format), codes)
+
+    def test__fp8_encode__round_to_nearest_saturation(self):
+        x = np.array([1.06, 1.07, 1.0625, -1e6, 1e6, 0.0, -0.0])
+        codes = fp8_encode(x, IpuFp8Format.F143)
+        assert codes.dtype == np.uint8
+        npt.assert_array_equal(fp8_decode(codes, IpuFp8Format.F143), [1.0, 1.125, 1.0, -240.0, 240.0, 0.0, 0.0])
+        assert codes[-1] == 0
+
+    @parameterized.parameters([IpuFp8Format.F143, IpuFp8Format.F152])
+    def test__fp8_decode__nan_code_decoded_as_negative_zero(self, fp8_format):
+        value = fp8_decode(np.array([0x80], dtype=np.uint8), fp8_format)
+        npt.assert_array_equal(value, [0.0])
+        assert np.signbit(value[0])
+        # NaN code never produced by the encoder.
+        assert np.all(fp8_encode([-0.0, -1e-12, np.finfo(np.float32).tiny], fp8_format) != 0x80)
+
 
 class IpuShapedArrayTests(chex.TestCase, parameterized.TestCase):
     def test__shaped_array__init__default_values(self):
@@ -6,10 +6,17 @@ import jax
 import numpy as np
 import numpy.testing as npt
 from absl.testing import parameterized
-from custom_arange_primitive import custom_arange_p, custom_multi_out_p, custom_single_out_p
+from custom_arange_primitive import custom_arange_p, custom_multi_out_p, custom_sharded_scale_p, custom_single_out_p
 from jax import lax
 
-from jax_ipu_experimental_addons.tile import TileShardedArray, tile_map_primitive, tile_put_sharded
+from jax_ipu_experimental_addons.tile import (
+    TileShardedArray,
+    tile_gather,
+    tile_map_primitive,
+    tile_map_primitive_group,
+    tile_pipelined_loop,
+    tile_put_sharded,
+)
 
 
 class IpuTileMapPrimitiveTests(chex.TestCase, parameterized.TestCase):
@@ -111,6 +118,24 @@ class IpuTileMapPrimitiveTests(chex.TestCase, parameterized.TestCase):
                 decimal=0,
             )
 
+    def test__tile_map_primitive__sharded_constant_input__ipu_jitting(self):
+        size = 16
+        tiles = (3, 4, 5)
+        input = np.random.rand(len(tiles), size).astype(np.float32)
+
+        @partial(jax.jit, backend="ipu")
+        def compute_fn(input):
+            input = tile_put_sharded(input, tiles)
+            return tile_map_primitive(custom_sharded_scale_p, input)
+
+        out0, out1 = compute_fn(input)
+        assert isinstance(out0, TileShardedArray)
+        assert out0.tiles == tiles
+        # Different constant scale on every tile.
+        expected = input * np.arange(1, len(tiles) + 1, dtype=np.float32).reshape((-1, 1))
+        npt.assert_array_almost_equal(out0, expected)
+        npt.assert_array_almost_equal(out1, -expected)
+
     @parameterized.parameters([(np.float32, "ipu"), (np.int32, "ipu"), (np.float32, "cpu")])
     def test__tile_map_primitive__custom_vertex__single_output__ipu_jitting(self, dtype, backend):
         size = 128
@@ -150,3 +175,112 @@ class IpuTileMapPrimitiveTests(chex.TestCase, parameterized.TestCase):
 
         npt.assert_array_equal(out0, size * scale_value * input)
         npt.assert_array_equal(out1, -size * scale_value * input)
+
+    @parameterized.parameters(["ipu", "cpu"])
+    def test__tile_map_primitive__profile_mode__cycle_delta_output(self, backend):
+        tiles = (3, 4, 5)
+        data = np.random.randn(len(tiles), 256).astype(np.float32)
+
+        @partial(jax.jit, backend=backend)
+        def compute_fn(data):
+            input = tile_put_sharded(data, tiles)
+            return tile_map_primitive(lax.abs_p, input, profile=True)
+
+        output, cycles = compute_fn(data)
+        assert isinstance(cycles, TileShardedArray)
+        assert cycles.tiles == tiles
+        assert cycles.shape == (len(tiles), 2)
+        assert cycles.dtype == np.uint32
+        npt.assert_array_equal(output, np.abs(data))
+        cycles = np.asarray(cycles)
+        if backend == "ipu" and not jax.devices("ipu")[0].is_ipu_model:
+            assert np.all(cycles[:, 0] > 0)
+        else:
+            npt.assert_array_equal(cycles, 0)
+
+
+class IpuTileMapPrimitiveGroupTests(chex.TestCase, parameterized.TestCase):
+    @parameterized.parameters(["ipu", "cpu"])
+    def test__tile_map_primitive_group__disjoint_tiles__proper_results(self, backend):
+        tiles0 = (1, 2)
+        tiles1 = (5, 6, 7)
+        input0 = np.random.randn(len(tiles0), 9).astype(np.float32)
+        input1 = np.random.rand(len(tiles1), 16).astype(np.float32) + 1
+        scale_value = 2
+
+        @partial(jax.jit, backend=backend)
+        def compute_fn(in0, in1):
+            in0 = tile_put_sharded(in0, tiles0)
+            in1 = tile_put_sharded(in1, tiles1)
+            return tile_map_primitive_group(
+                [
+                    (lax.abs_p, [in0], {}),
+                    (custom_multi_out_p, [in1], {"scale_value": scale_value}),
+                    (lax.add_p, [in0, in0], {}),
+                ]
+            )
+
+        # Last equation overlapping tiles with the first one.
+        with self.assertRaises(ValueError):
+            compute_fn(input0, input1)
+
+        @partial(jax.jit, backend=backend)
+        def compute_valid_fn(in0, in1):
+            in0 = tile_put_sharded(in0, tiles0)
+            in1 = tile_put_sharded(in1, tiles1)
+            return tile_map_primitive_group(
+                [(lax.abs_p, [in0], {}), (custom_multi_out_p, [in1], {"scale_value": scale_value})]
+            )
+
+        out0, (out1, out2) = compute_valid_fn(input0, input1)
+        assert isinstance(out0, TileShardedArray)
+        assert out0.tiles == tiles0
+        assert out1.tiles == tiles1
+        assert out2.tiles == tiles1
+        npt.assert_array_equal(out0, np.abs(input0))
+        npt.assert_array_equal(out1, 16 * scale_value * input1)
+        npt.assert_array_equal(out2, -16 * scale_value * input1)
+
+
+class IpuTilePipelinedLoopTests(chex.TestCase, parameterized.TestCase):
+    @parameterized.parameters(["ipu", "cpu"])
+    def test__tile_pipelined_loop__lag_stage_one_step_behind__proper_results(self, backend):
+        lead_tiles = (1, 2, 3)
+        lag_tiles = (4, 5, 6)
+        num_steps = 4
+        x = np.random.randn(len(lead_tiles), 8).astype(np.float32)
+        y = np.random.randn(len(lag_tiles), 8).astype(np.float32)
+
+        def lead_compute_fn(k, x):
+            return (lax.add_p, [x, x], {})
+
+        def lead_exchange_fn(k, x, x2):
+            # Rotate between lead tiles, and send a copy to the lag stage.
+            x = tile_gather(x2, [1, 2, 0], lead_tiles)
+            return x, tile_put_sharded(x2.array, lag_tiles)
+
+        def lag_compute_fn(k, y, message):
+            return (lax.add_p, [y, message], {})
+
+        def lag_exchange_fn(k, y, yout):
+            return yout
+
+        @partial(jax.jit, backend=backend)
+        def compute_fn(x, y):
+            x = tile_put_sharded(x, lead_tiles)
+            y = tile_put_sharded(y, lag_tiles)
+            return tile_pipelined_loop(
+                num_steps, lead_compute_fn, lead_exchange_fn, lag_compute_fn, lag_exchange_fn, x, y
+            )
+
+        xout, yout = compute_fn(x, y)
+        assert isinstance(xout, TileShardedArray)
+        assert xout.tiles == lead_tiles
+        assert yout.tiles == lag_tiles
+        # Sequential reference.
+        xref, yref = x, y
+        for _ in range(num_steps):
+            yref = yref + 2 * xref
+            xref = np.roll(2 * xref, -1, axis=0)
+        npt.assert_array_almost_equal(xout, xref)
+        npt.assert_array_almost_equal(yout, yref)
@@ -329,6 +329,22 @@ class IpuTileMemcpyTests(chex.TestCase):
         npt.assert_array_equal(np.asarray(out1)[0, :6], data)
         npt.assert_array_equal(np.asarray(out2)[0, :12], data)
 
+    @parameterized.parameters(
+        [(np.uint8, 1), (np.uint8, 13), (np.float16, 7), (np.float16, 100), (np.int32, 3), (np.float32, 1025)]
+    )
+    def test__tile_copy__unaligned_tail__multi_dtypes(self, dtype, size):
+        tiles = (0, 3)
+        data = np.random.randn(len(tiles), size).astype(dtype)
+
+        @partial(jax.jit, backend="ipu")
+        def copy_fn(indata):
+            indata = tile_put_sharded(indata, tiles)
+            return tile_copy(indata)
+
+        output = copy_fn(data)
+        assert isinstance(output, TileShardedArray)
+        npt.assert_array_equal(np.asarray(output), data)
+
     def test__tile_copy__benchmark_performance(self):
         N = 512
         tiles = (0,)
@@ -7,16 +7,63 @@ import numpy as np
 import numpy.testing as npt
 import pytest
 from absl.testing import parameterized
+from jax import core
+from jax.core import ShapedArray
 
-from jax_ipu_experimental_addons.tile import IpuConvVertexType, TileShardedArray, tile_map_primitive, tile_put_sharded
+from jax_ipu_experimental_addons.tile import (
+    IpuConvVertexType,
+    IpuFp8Format,
+    TileShardedArray,
+    fp8_decode,
+    fp8_encode,
+    make_ipu_vertex_constant_info,
+    register_ipu_tile_primitive,
+    tile_data_barrier,
+    tile_fp8_dot,
+    tile_map_primitive,
+    tile_put_sharded,
+)
+from jax_ipu_experimental_addons.tile.tile_common_utils import IpuType
 from jax_ipu_experimental_addons.tile.tile_interpreter_lax_dot import (
     IpuConvPartial1x1Args,
     IpuConvPartial1x1StaticArgs,
+    fp8_dot_general_abstract_eval,
+    fp8_dot_general_impl,
+    fp8_dot_general_translation_ipu,
     ipuGetTransformedOutStride,
+    ipu_dot_general_plan,
     ipuReverseTransformedOutStride,
     make_conv_partial1x1_attributes,
+    make_dot_worker_offsets,
 )
 
+# FP8 dot product with a QUARTER vertex constant `rhs`, i.e. FP8 raw bytes embedded in the graph.
+fp8_constant_rhs_data = fp8_encode(np.linspace(-2.0, 2.0, 3 * 12).reshape((3, 12)), IpuFp8Format.F143)
+fp8_dot_constant_rhs_p = core.Primitive("fp8_dot_constant_rhs")
+
+
+def fp8_dot_constant_rhs_impl(lhs, fp8_format, preferred_element_type=None):
+    return fp8_dot_general_impl(lhs, fp8_constant_rhs_data, fp8_format, preferred_element_type)
+
+
+def fp8_dot_constant_rhs_abstract_eval(lhs, fp8_format, preferred_element_type=None):
+    rhs = ShapedArray(fp8_constant_rhs_data.shape, np.uint8)
+    return fp8_dot_general_abstract_eval(lhs, rhs, fp8_format, preferred_element_type)
+
+
+def fp8_dot_constant_rhs_translation_ipu(p, tiles, inavals, attributes=None):
+    rhs_aval = ShapedArray(fp8_constant_rhs_data.shape, np.uint8)
+    tile_map_eqn = fp8_dot_general_translation_ipu(p, tiles, [inavals[0], rhs_aval], attributes)
+    lhs_info, _, worker_offsets_info = tile_map_eqn.inputs_info
+    rhs_info = make_ipu_vertex_constant_info("rhs", fp8_constant_rhs_data, ipu_type=IpuType.QUARTER)
+    tile_map_eqn.inputs_info = [lhs_info, rhs_info, worker_offsets_info]
+    return tile_map_eqn
+
+
+fp8_dot_constant_rhs_p.def_impl(fp8_dot_constant_rhs_impl)
+fp8_dot_constant_rhs_p.def_abstract_eval(fp8_dot_constant_rhs_abstract_eval)
+register_ipu_tile_primitive(fp8_dot_constant_rhs_p, fp8_dot_constant_rhs_translation_ipu)
+
 
 class IpuConvPartial1x1Utils(chex.TestCase, parameterized.TestCase):
     def test__ConvPartial1x1StaticArgs__vertex_fullname(self):
@@ -68,6 +115,47 @@ class IpuConvPartial1x1Utils(chex.TestCase, parameterized.TestCase):
         assert attrs_dict["outChansPerGroup"] == 32
         assert attrs_dict["inChansPerGroup"] == 8
 
+    @parameterized.parameters(
+        # AMP compatible shapes.
+        {"lhs_shape": (7, 8), "rhs_shape": (16, 8), "dtype": np.float32, "expected": IpuConvVertexType.ConvPartial1x1},
+        {
+            "lhs_shape": (7, 16),
+            "rhs_shape": (16, 16),
+            "dtype": np.float16,
+            "expected": IpuConvVertexType.ConvPartial1x1,
+        },
+        # HMAC compatible shapes.
+        {"lhs_shape": (64,), "rhs_shape": (64,), "dtype": np.float32, "expected": IpuConvVertexType.ConvPartialHMAC},
+        {"lhs_shape": (64,), "rhs_shape": (64,), "dtype": np.float16, "expected": IpuConvVertexType.ConvPartialHMAC},
+        {"lhs_shape": (6,), "rhs_shape": (6,), "dtype": np.float16, "expected": IpuConvVertexType.ConvPartialHMAC},
+        # Vector MAC fallback.
+        {"lhs_shape": (7, 7), "rhs_shape": (16, 7), "dtype": np.float32, "expected": IpuConvVertexType.VectorMac},
+        {"lhs_shape": (7, 8), "rhs_shape": (15, 8), "dtype": np.float32, "expected": IpuConvVertexType.VectorMac},
+        {"lhs_shape": (7,), "rhs_shape": (7,), "dtype": np.float32, "expected": IpuConvVertexType.VectorMac},
+        {"lhs_shape": (3, 32), "rhs_shape": (32,), "dtype": np.float16, "expected": IpuConvVertexType.VectorMac},
+        {"lhs_shape": (7,), "rhs_shape": (7,), "dtype": np.float16, "expected": IpuConvVertexType.VectorMac},
+        {"lhs_shape": (5, 7), "rhs_shape": (3, 7), "dtype": np.float16, "expected": IpuConvVertexType.VectorMac},
+    )
+    def test__ipu_dot_general_plan__proper_vertex_selection(self, lhs_shape, rhs_shape, dtype, expected):
+        attributes = {"dimension_numbers": (([len(lhs_shape) - 1], [len(rhs_shape) - 1]), ([], []))}
+        plan = ipu_dot_general_plan(ShapedArray(lhs_shape, dtype), ShapedArray(rhs_shape, dtype), attributes)
+        assert plan == expected
+
+    @parameterized.parameters([(np.float32, 1), (np.float16, 2)])
+    def test__make_dot_worker_offsets__32bits_words_worker_split(self, outdtype, grain):
+        num_outputs = 15
+        offsets = make_dot_worker_offsets(num_outputs, outdtype)
+        assert offsets.shape == (7,)
+        assert offsets[0] == 0
+        assert offsets[-1] == num_outputs
+        # No 32 bits output word shared between workers.
+        assert np.all((offsets[:-1] % grain) == 0)
+
+    def test__ipu_dot_general_plan__unsupported_batching(self):
+        attributes = {"dimension_numbers": (([2], [2]), ([0], [0]))}
+        with self.assertRaises(ValueError):
+            ipu_dot_general_plan(ShapedArray((2, 4, 8), np.float32), ShapedArray((2, 4, 8), np.float32), attributes)
+
 
 @pytest.mark.ipu_hardware
 class IpuConvPartial1x1DotPrimitive(chex.TestCase, parameterized.TestCase):
@@ -188,6 +276,47 @@ class IpuConvPartial1x1DotPrimitive(chex.TestCase, parameterized.TestCase):
         assert output_ipu.shape == output_cpu.shape
         npt.assert_array_almost_equal(output_ipu.array, output_cpu, decimal=2)
 
+    @parameterized.parameters(
+        {"lhs_shape": (7, 7), "rhs_shape": (16, 7), "indtype": np.float32, "accdtype": np.float32},
+        {"lhs_shape": (5, 12), "rhs_shape": (3, 12), "indtype": np.float16, "accdtype": np.float32},
+        {"lhs_shape": (5, 16), "rhs_shape": (16,), "indtype": np.float16, "accdtype": np.float16},
+        # FP16 vector MAC, odd number of outputs (i.e. workers tail in the middle of a 32 bits word).
+        {"lhs_shape": (5, 7), "rhs_shape": (3, 7), "indtype": np.float16, "accdtype": np.float16},
+        {"lhs_shape": (3, 9), "rhs_shape": (7, 9), "indtype": np.float16, "accdtype": np.float16},
+        # Automatic planner selecting AMP and HMAC vertices.
+        {"lhs_shape": (7, 8), "rhs_shape": (16, 8), "indtype": np.float32, "accdtype": np.float32},
+        {"lhs_shape": (64,), "rhs_shape": (64,), "indtype": np.float32, "accdtype": np.float32},
+        {"lhs_shape": (32,), "rhs_shape": (32,), "indtype": np.float16, "accdtype": np.float32},
+        {"lhs_shape": (32,), "rhs_shape": (32,), "indtype": np.float16, "accdtype": np.float16},
+    )
+    def test__dot_general__automatic_vertex__ipu_jitting(self, lhs_shape, rhs_shape, indtype, accdtype):
+        tiles = (0, 3)
+        lhs_data = np.random.randn(len(tiles), *lhs_shape).astype(indtype)
+        rhs_data = np.random.randn(len(tiles), *rhs_shape).astype(indtype)
+
+        def dot_general_fn(lhs, rhs):
+            lhs = tile_put_sharded(lhs, tiles)
+            rhs = tile_put_sharded(rhs, tiles)
+            output = tile_map_primitive(
+                jax.lax.dot_general_p,
+                lhs,
+                rhs,
+                dimension_numbers=(([len(lhs_shape) - 1], [len(rhs_shape) - 1]), ([], [])),
+                precision=jax.lax.Precision.DEFAULT,
+                preferred_element_type=accdtype,
+                ipu_vertex_type=IpuConvVertexType.Automatic,
+            )
+            return output
+
+        output_ipu = partial(jax.jit, backend="ipu")(dot_general_fn)(lhs_data, rhs_data)
+        output_cpu = partial(jax.jit, backend="cpu")(dot_general_fn)(lhs_data, rhs_data)
+
+        assert isinstance(output_ipu, TileShardedArray)
+        assert output_ipu.tiles == tiles
+        assert output_ipu.dtype == accdtype
+        assert output_ipu.shape == output_cpu.shape
+        npt.assert_array_almost_equal(output_ipu.array, output_cpu, decimal=2)
+
     @parameterized.parameters(
         # Basic AMP unit config, without any in/out "groups"
         # {"lhs_shape": (8, 8), "rhs_shape": (1, 8), "indtype": np.float32, "accdtype": np.float32},
@@ -222,3 +351,73 @@ class IpuConvPartial1x1DotPrimitive(chex.TestCase, parameterized.TestCase):
         assert output_ipu.dtype == accdtype
         assert output_ipu.shape == output_cpu.shape
         npt.assert_array_almost_equal(output_ipu.array, output_cpu, decimal=2)
+
+
+class IpuFp8DotPrimitive(chex.TestCase, parameterized.TestCase):
+    def setUp(self):
+        super().setUp()
+        np.random.seed(42)
+
+    @parameterized.parameters(
+        {"lhs_shape": (5, 12), "rhs_shape": (3, 12), "fp8_format": IpuFp8Format.F143, "outdtype": np.float32},
+        {"lhs_shape": (7, 9), "rhs_shape": (9,), "fp8_format": IpuFp8Format.F152, "outdtype": np.float32},
+        {"lhs_shape": (16,), "rhs_shape": (16,), "fp8_format": IpuFp8Format.F143, "outdtype": np.float16},
+        # Half outputs, odd number of outputs per worker.
+        {"lhs_shape": (5, 8), "rhs_shape": (3, 8), "fp8_format": IpuFp8Format.F143, "outdtype": np.float16},
+        {"lhs_shape": (7, 9), "rhs_shape": (9,), "fp8_format": IpuFp8Format.F152, "outdtype": np.float16},
+    )
+    def test__tile_fp8_dot__ipu_jitting(self, lhs_shape, rhs_shape, fp8_format, outdtype):
+        tiles = (0, 3)
+        lhs_data = fp8_encode(np.random.randn(len(tiles), *lhs_shape), fp8_format)
+        rhs_data = fp8_encode(np.random.randn(len(tiles), *rhs_shape), fp8_format)
+
+        def dot_fn(lhs, rhs):
+            lhs = tile_put_sharded(lhs, tiles)
+            rhs = tile_put_sharded(rhs, tiles)
+            return tile_fp8_dot(lhs, rhs, fp8_format=fp8_format, preferred_element_type=outdtype)
+
+        output_ipu = partial(jax.jit, backend="ipu")(dot_fn)(lhs_data, rhs_data)
+        output_cpu = partial(jax.jit, backend="cpu")(dot_fn)(lhs_data, rhs_data)
+        lhs, rhs = fp8_decode(lhs_data, fp8_format), fp8_decode(rhs_data, fp8_format)
+        expected = np.stack([np.tensordot(lhs[i], rhs[i], axes=([-1], [-1])) for i in range(len(tiles))])
+
+        assert isinstance(output_ipu, TileShardedArray)
+        assert output_ipu.tiles == tiles
+        assert output_ipu.dtype == outdtype
+        assert output_ipu.shape == expected.shape
+        npt.assert_array_almost_equal(output_cpu.array, expected, decimal=2)
+        npt.assert_array_almost_equal(output_ipu.array, expected, decimal=2)
+
+    def test__make_ipu_vertex_constant_info__quarter_constant_info(self):
+        info = make_ipu_vertex_constant_info("rhs", fp8_constant_rhs_data, ipu_type=IpuType.QUARTER)
+        assert info.dtype == IpuType.QUARTER
+        assert tuple(info.shape) == fp8_constant_rhs_data.shape
+        with self.assertRaises(ValueError):
+            make_ipu_vertex_constant_info("rhs", fp8_constant_rhs_data.astype(np.int8), ipu_type=IpuType.QUARTER)
+        with self.assertRaises(ValueError):
+            make_ipu_vertex_constant_info("rhs", fp8_constant_rhs_data, ipu_type=IpuType.HALF)
+
+    def test__tile_map_primitive__fp8_quarter_vertex_constant__ipu_jitting(self):
+        tiles = (0, 3)
+        fp8_format = IpuFp8Format.F143
+        lhs_data = fp8_encode(np.random.randn(len(tiles), 5, 12), fp8_format)
+
+        @partial(jax.jit, backend="ipu")
+        def dot_fn(lhs):
+            lhs = tile_put_sharded(lhs, tiles)
+            # FP8 raw bytes data barrier.
+            (lhs,) = tile_data_barrier(lhs)
+            output = tile_map_primitive(
+                fp8_dot_constant_rhs_p, lhs, fp8_format=fp8_format, preferred_element_type=np.float32
+            )
+            return lhs, output
+
+        lhs_ipu, output_ipu = dot_fn(lhs_data)
+        lhs, rhs = fp8_decode(lhs_data, fp8_format), fp8_decode(fp8_constant_rhs_data, fp8_format)
+        expected = np.stack([np.tensordot(lhs[i], rhs, axes=([-1], [-1])) for i in range(len(tiles))])
+
+        assert isinstance(output_ipu, TileShardedArray)
+        assert output_ipu.tiles == tiles
+        assert output_ipu.shape == expected.shape
+        npt.assert_array_equal(lhs_ipu.array, lhs_data)
+        npt.assert_array_almost_equal(output_ipu.array, expected, decimal=2)
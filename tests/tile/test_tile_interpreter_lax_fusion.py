@@ -0,0 +1,122 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+import os
+from functools import partial
+
+import chex
+import jax
+import jax.numpy as jnp
+import numpy as np
+import numpy.testing as npt
+from absl.testing import parameterized
+
+from jax_ipu_experimental_addons.tile import TileShardedArray, tile_map_fused, tile_put_sharded
+from jax_ipu_experimental_addons.tile.tile_interpreter_lax_fusion import (
+    get_fused_vertex_gp_filename,
+    make_fused_elementwise_primitive,
+    make_fused_elementwise_vertex,
+    make_fused_worker_offsets,
+)
+
+
+class IpuTileFusedElementwiseUtilsTests(chex.TestCase, parameterized.TestCase):
+    def test__make_fused_elementwise_vertex__proper_source(self):
+        jaxpr = jax.make_jaxpr(lambda a, x, b: jnp.exp(a * x + b))(*[jax.ShapeDtypeStruct((5,), np.float32)] * 3)
+        vname, source = make_fused_elementwise_vertex(jaxpr.jaxpr)
+        assert vname.startswith("FusedElementwiseVertex_")
+        assert f"class {vname} : public MultiVertex" in source
+        assert "Input<Vector<float, poplar::VectorLayout::ONE_PTR, 8>> in2;" in source
+        assert "Output<Vector<float, poplar::VectorLayout::ONE_PTR, 8>> out0;" in source
+        assert "const float v3 = v0 * v1;" in source
+        assert "const float v4 = v3 + v2;" in source
+        assert "const float v5 = std::exp(v4);" in source
+        assert "out0[idx] = float(v5);" in source
+
+    def test__make_fused_elementwise_vertex__mixed_dtypes_literals(self):
+        def fn(x):
+            y = (x.astype(np.float32) * 2.5) ** 2
+            return y, y.astype(np.float16)
+
+        jaxpr = jax.make_jaxpr(fn)(jax.ShapeDtypeStruct((3, 4), np.float16))
+        _, source = make_fused_elementwise_vertex(jaxpr.jaxpr)
+        assert "Input<Vector<half, poplar::VectorLayout::ONE_PTR, 8>> in0;" in source
+        assert "2.5f" in source
+        assert "out0[idx] = float(" in source
+        assert "out1[idx] = half(" in source
+
+    def test__make_fused_elementwise_vertex__deterministic_name(self):
+        jaxpr = jax.make_jaxpr(lambda x: jnp.tanh(x) - x)(jax.ShapeDtypeStruct((5,), np.float32))
+        vname0, source0 = make_fused_elementwise_vertex(jaxpr.jaxpr)
+        vname1, source1 = make_fused_elementwise_vertex(jaxpr.jaxpr)
+        assert vname0 == vname1
+        assert source0 == source1
+        # Same primitive returned for the same fused chain.
+        assert make_fused_elementwise_primitive(jaxpr.jaxpr) is make_fused_elementwise_primitive(jaxpr.jaxpr)
+
+    def test__make_fused_elementwise_vertex__unsupported_primitive(self):
+        jaxpr = jax.make_jaxpr(lambda x: jnp.cumsum(x))(jax.ShapeDtypeStruct((5,), np.float32))
+        with self.assertRaises(ValueError):
+            make_fused_elementwise_vertex(jaxpr.jaxpr)
+
+    def test__make_fused_elementwise_vertex__unsupported_dtype(self):
+        jaxpr = jax.make_jaxpr(lambda x: x + x)(jax.ShapeDtypeStruct((5,), np.int32))
+        with self.assertRaises(TypeError):
+            make_fused_elementwise_vertex(jaxpr.jaxpr)
+
+    @parameterized.parameters([0, 1, 7, 12, 33])
+    def test__make_fused_worker_offsets__proper_coverage(self, size):
+        offsets = make_fused_worker_offsets(size)
+        assert offsets.shape == (7,)
+        assert offsets.dtype == np.uint16
+        assert 2 * int(offsets[-1]) >= size
+        assert 2 * int(offsets[-1]) <= size + 1
+
+    def test__get_fused_vertex_gp_filename__source_written(self):
+        jaxpr = jax.make_jaxpr(lambda x: jnp.sin(x))(jax.ShapeDtypeStruct((5,), np.float32))
+        vname, source = make_fused_elementwise_vertex(jaxpr.jaxpr)
+        filename = get_fused_vertex_gp_filename(vname, source)
+        assert os.path.isfile(filename)
+        with open(filename) as f:
+            assert f.read() == source
+
+
+class IpuTileFusedElementwisePrimitiveTests(chex.TestCase, parameterized.TestCase):
+    def setUp(self):
+        super().setUp()
+        np.random.seed(42)
+
+    @parameterized.parameters([np.float32, np.float16])
+    def test__tile_map_fused__affine_exp__ipu_jitting__proper_result(self, dtype):
+        tiles = (0, 3, 5)
+        inshape = (len(tiles), 7, 9)
+        a, x, b = [np.random.randn(*inshape).astype(dtype) for _ in range(3)]
+
+        def compute_fn(a, x, b):
+            a, x, b = [tile_put_sharded(v, tiles) for v in (a, x, b)]
+            return tile_map_fused(lambda a, x, b: jnp.exp(a * x + b), a, x, b)
+
+        output_ipu = partial(jax.jit, backend="ipu")(compute_fn)(a, x, b)
+        output_cpu = partial(jax.jit, backend="cpu")(compute_fn)(a, x, b)
+        assert isinstance(output_ipu, TileShardedArray)
+        assert output_ipu.tiles == tiles
+        assert output_ipu.dtype == dtype
+        rtol = 1e-2 if dtype == np.float16 else 1e-5
+        npt.assert_allclose(output_ipu.array.astype(np.float32), output_cpu.array.astype(np.float32), rtol=rtol)
+
+    def test__tile_map_fused__multiple_outputs__ipu_jitting__proper_result(self):
+        tiles = (1, 2)
+        x = np.random.rand(len(tiles), 13).astype(np.float32) + 0.5
+
+        def fused_fn(x):
+            y = jnp.sqrt(x) * 2.0 - 1.0
+            return jnp.maximum(y, 0.5), jnp.log(x).astype(np.float16)
+
+        def compute_fn(x):
+            x = tile_put_sharded(x, tiles)
+            return tile_map_fused(fused_fn, x)
+
+        out0_ipu, out1_ipu = partial(jax.jit, backend="ipu")(compute_fn)(x)
+        out0_ref, out1_ref = fused_fn(x)
+        assert out0_ipu.dtype == np.float32
+        assert out1_ipu.dtype == np.float16
+        npt.assert_array_almost_equal(out0_ipu.array, out0_ref, decimal=5)
+        npt.assert_array_almost_equal(out1_ipu.array, out1_ref, decimal=2)
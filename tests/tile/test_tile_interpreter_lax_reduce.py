@@ -5,10 +5,21 @@ import chex
 import jax
 import numpy as np
 import numpy.testing as npt
+import pytest
 from absl.testing import parameterized
 
-from jax_ipu_experimental_addons.tile import TileShardedArray, tile_map_primitive, tile_put_sharded
-from jax_ipu_experimental_addons.tile.tile_interpreter_lax_reduce import make_continuous_reduce_vertex_fullname
+from jax_ipu_experimental_addons.tile import (
+    TileShardedArray,
+    tile_map_primitive,
+    tile_put_sharded,
+    tile_reduce_gather,
+)
+from jax_ipu_experimental_addons.tile.tile_interpreter_lax_reduce import (
+    make_continuous_reduce_vertex_fullname,
+    make_reduce_canonical_dims,
+    make_reduce_vector_mode,
+    make_reduce_worker_offsets,
+)
 
 
 def test__make_continuous_reduce_vertex_fullname__proper_name():
@@ -16,6 +27,41 @@ def test__make_continuous_reduce_vertex_fullname__proper_name():
     assert fullname == "popops::ContinuousReduce<popops::ReduceMul,float,half,false>"
 
 
+@pytest.mark.parametrize(
+    "shape,axes,out_dims,red_dims",
+    [
+        ((3, 5, 7, 9), (2, 3), [(15, 63)], [(63, 1)]),
+        ((3, 5, 7, 9), (1, 3), [(3, 315), (7, 9)], [(5, 63), (9, 1)]),
+        ((3, 5, 7, 9), (0, 1), [(63, 1)], [(15, 63)]),
+        ((3, 1, 7, 9), (0, 1), [(63, 1)], [(3, 63)]),
+        ((3, 5), (0, 1), [(1, 0)], [(15, 1)]),
+    ],
+)
+def test__make_reduce_canonical_dims__proper_result(shape, axes, out_dims, red_dims):
+    assert make_reduce_canonical_dims(shape, axes) == (out_dims, red_dims)
+
+
+@pytest.mark.parametrize(
+    "out_dims,red_dims,dtype,expected",
+    [
+        ([(64, 1)], [(15, 64)], np.float32, (1, 2)),
+        ([(64, 1)], [(15, 64)], np.float16, (1, 4)),
+        ([(7, 9)], [(5, 63), (9, 1)], np.float32, (0, 1)),
+        ([(7, 8)], [(5, 56), (8, 1)], np.float16, (2, 2)),
+    ],
+)
+def test__make_reduce_vector_mode__proper_result(out_dims, red_dims, dtype, expected):
+    assert make_reduce_vector_mode(out_dims, red_dims, dtype) == expected
+
+
+@pytest.mark.parametrize("num_outputs,grain", [(1, 1), (13, 2), (64, 4), (1000, 2)])
+def test__make_reduce_worker_offsets__proper_coverage(num_outputs, grain):
+    offsets = make_reduce_worker_offsets(num_outputs, grain)
+    assert offsets.shape == (7,)
+    assert int(offsets[-1]) * grain >= num_outputs
+    assert int(offsets[-1]) * grain < num_outputs + grain
+
+
 class IpuTilePrimitivesLaxReduce(chex.TestCase, parameterized.TestCase):
     def setUp(self):
         super().setUp()
@@ -111,19 +157,68 @@ class IpuTilePrimitivesLaxReduce(chex.TestCase, parameterized.TestCase):
         npt.assert_array_almost_equal(output_ipu.array, output_cpu, decimal=2)
 
     @parameterized.parameters(
-        {"dtype": np.float32, "axes": (1, 3)},
-        {"dtype": np.float32, "axes": (2,)},
+        {"dtype": np.float32, "axes": (1, 3), "reduce_p": jax.lax.reduce_sum_p},
+        {"dtype": np.float32, "axes": (2,), "reduce_p": jax.lax.reduce_sum_p},
+        {"dtype": np.float32, "axes": (0,), "reduce_p": jax.lax.reduce_max_p},
+        {"dtype": np.float32, "axes": (0, 2), "reduce_p": jax.lax.reduce_min_p},
+        {"dtype": np.float16, "axes": (1, 3), "reduce_p": jax.lax.reduce_sum_p},
+        {"dtype": np.float16, "axes": (0, 1), "reduce_p": jax.lax.reduce_max_p},
+        {"dtype": np.float16, "axes": (2,), "reduce_p": jax.lax.reduce_prod_p},
     )
-    def test__tile_map_primitive__reduce_partial__unsupported_axes(self, dtype, axes):
+    def test__tile_map_primitive__reduce_general_axes__ipu_jitting__proper_result(self, dtype, axes, reduce_p):
+        tiles = (1, 2, self.num_tiles - 1)
+        shape = (3, 5, 7, 8)
+        indata = np.random.randn(len(tiles), *shape).astype(dtype)
+        if reduce_p == jax.lax.reduce_prod_p:
+            # Avoid overflow/underflow in FP16.
+            indata = (1 + 0.1 * indata).astype(dtype)
+
+        def compute_fn(in0):
+            input0 = tile_put_sharded(in0, tiles)
+            output = tile_map_primitive(reduce_p, input0, axes=axes)
+            return output
+
+        output_ipu = partial(jax.jit, backend="ipu")(compute_fn)(indata)
+        output_cpu = partial(jax.jit, backend="cpu")(compute_fn)(indata)
+
+        assert isinstance(output_ipu, TileShardedArray)
+        assert output_ipu.tiles == tiles
+        assert output_ipu.dtype == indata.dtype
+        assert output_ipu.shape == output_cpu.shape
+        npt.assert_array_almost_equal(output_ipu.array, output_cpu, decimal=2 if dtype == np.float32 else 1)
+
+    def test__tile_map_primitive__reduce_partial__unsupported_axes(self):
         tiles = (1, 2, self.num_tiles - 1)
         shape = (3, 5, 7, 9)
 
         @partial(jax.jit, backend="ipu")
         def compute_fn(in0):
             input0 = tile_put_sharded(in0, tiles)
-            output = tile_map_primitive(jax.lax.reduce_sum_p, input0, axes=axes)
+            output = tile_map_primitive(jax.lax.reduce_or_p, input0, axes=(1, 3))
             return output
 
-        indata = np.random.randn(len(tiles), *shape).astype(dtype)
+        indata = np.random.randn(len(tiles), *shape) > 0
         with self.assertRaises(NotImplementedError):
             compute_fn(indata)
+
+    @parameterized.parameters(
+        {"dtype": np.float32, "axes": (1,), "reduce_p": jax.lax.reduce_sum_p},
+        {"dtype": np.float32, "axes": (), "reduce_p": jax.lax.reduce_max_p},
+        {"dtype": np.float16, "axes": (0, 1), "reduce_p": jax.lax.reduce_sum_p},
+    )
+    def test__tile_reduce_gather__ipu_jitting__proper_result(self, dtype, axes, reduce_p):
+        tiles = (1, 2, 5, self.num_tiles - 1)
+        indata = np.random.randn(len(tiles), 6, 16).astype(dtype)
+
+        @partial(jax.jit, backend="ipu")
+        def compute_fn(in0):
+            input0 = tile_put_sharded(in0, tiles)
+            return tile_reduce_gather(input0, reduce_p, axes=axes, tile=3)
+
+        output = compute_fn(indata)
+        np_reduce_fn = np.sum if reduce_p == jax.lax.reduce_sum_p else np.max
+        expected = np_reduce_fn(indata.astype(np.float32), axis=(0, *[a + 1 for a in axes]))
+        assert isinstance(output, TileShardedArray)
+        assert output.tiles == (3,)
+        assert output.dtype == dtype
+        npt.assert_array_almost_equal(output.array[0], expected, decimal=2 if dtype == np.float32 else 1)
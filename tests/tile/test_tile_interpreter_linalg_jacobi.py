@@ -13,12 +13,17 @@ from absl.testing import parameterized
 from jax_ipu_experimental_addons.tile import ipu_cycle_count, tile_data_barrier, tile_map_primitive, tile_put_replicated
 from jax_ipu_experimental_addons.tile.tile_interpreter_linalg_jacobi import (
     ipu_eigh,
+    ipu_eigh_batched,
     ipu_jacobi_eigh,
     jacobi_initial_rotation_set,
     jacobi_next_rotation_set,
+    jacobi_pack_rotation_set,
+    jacobi_sort_rotation_set,
     jacobi_sym_schur2_p,
     jacobi_update_eigenvectors_p,
     jacobi_update_first_step_p,
+    jacobi_update_second_step_p,
+    jacobi_update_second_step_packed_p,
 )
 from jax_ipu_experimental_addons.utils import IpuTargetType
 
@@ -127,6 +132,118 @@ class IpuTileLinalgJacobi(chex.TestCase, parameterized.TestCase):
         # print("CYCLE count:", qr_correction_cycle_count)
         # assert False
 
+    def test__jacobi_update_first_step_eigenvectors__float16_storage(self):
+        N = 64
+        tiles = (0,)
+        pq = np.array([3, N // 2], dtype=np.uint32)
+        pcol = np.random.randn(N).astype(np.float32)
+        qcol = np.random.randn(N).astype(np.float32)
+
+        def jacobi_update_fn(pq, pcol, qcol):
+            pq = tile_put_replicated(pq, tiles)
+            pcol = tile_put_replicated(pcol, tiles)
+            qcol = tile_put_replicated(qcol, tiles)
+            cs, pcol_updated, qcol_updated = tile_map_primitive(  # type:ignore
+                jacobi_update_first_step_p, pq, pcol, qcol, N=N
+            )
+            vpcol, vqcol = tile_map_primitive(jacobi_update_eigenvectors_p, cs, pcol, qcol)  # type:ignore
+            return cs.array, pcol_updated.array, qcol_updated.array, vpcol.array, vqcol.array
+
+        jacobi_update_fn = jax.jit(jacobi_update_fn, backend="ipu")
+        outputs_f32 = jacobi_update_fn(pq, pcol, qcol)
+        outputs_f16 = jacobi_update_fn(pq, pcol.astype(np.float16), qcol.astype(np.float16))
+        # (c, s) always in FP32, columns in FP16 storage.
+        assert outputs_f16[0].dtype == np.float32
+        for v in outputs_f16[1:]:
+            assert v.dtype == np.float16
+        for v16, v32 in zip(outputs_f16, outputs_f32):
+            npt.assert_array_almost_equal(np.asarray(v16, dtype=np.float32), np.asarray(v32), decimal=2)
+
+    def test__jacobi_pack_rotation_set__proper_packing(self):
+        rotset = jacobi_sort_rotation_set(jacobi_next_rotation_set(jacobi_initial_rotation_set(8)))
+        packed = jacobi_pack_rotation_set(rotset)
+        assert packed.shape == (4,)
+        assert packed.dtype == np.uint32
+        npt.assert_array_equal(packed & 0xFFFF, rotset[:, 0])
+        npt.assert_array_equal(packed >> 16, rotset[:, 1])
+
+    @parameterized.parameters(
+        {"N": 32},
+        # Odd number of rotations: single rotation tail on the last worker.
+        {"N": 14},
+        {"N": 6},
+    )
+    def test__jacobi_update_second_step_packed_vertex__same_result_as_unpacked(self, N):
+        tiles = (0,)
+        rotset = jacobi_sort_rotation_set(jacobi_next_rotation_set(jacobi_initial_rotation_set(N)))
+        rotset_packed = jacobi_pack_rotation_set(rotset)
+        rotset_idx_ignored = np.array([1], dtype=np.uint32)
+        cs = np.random.randn(N // 2, 2).astype(np.float32)
+        pcol = np.random.randn(N).astype(np.float32)
+        qcol = np.random.randn(N).astype(np.float32)
+
+        def jacobi_update_second_step_fn(cs, rotset, rotset_packed, rotset_idx_ignored, pcol, qcol):
+            cs, rotset, rotset_packed, rotset_idx_ignored, pcol, qcol = [
+                tile_put_replicated(v, tiles) for v in (cs, rotset, rotset_packed, rotset_idx_ignored, pcol, qcol)
+            ]
+            _, pcol0, qcol0 = tile_map_primitive(  # type:ignore
+                jacobi_update_second_step_p, cs, rotset, rotset_idx_ignored, pcol, qcol, halfN=N // 2
+            )
+            _, pcol1, qcol1 = tile_map_primitive(  # type:ignore
+                jacobi_update_second_step_packed_p, cs, rotset_packed, rotset_idx_ignored, pcol, qcol
+            )
+            return pcol0, qcol0, pcol1, qcol1
+
+        jacobi_update_second_step_fn = jax.jit(jacobi_update_second_step_fn, backend="ipu")
+        pcol0, qcol0, pcol1, qcol1 = jacobi_update_second_step_fn(
+            cs, rotset, rotset_packed, rotset_idx_ignored, pcol, qcol
+        )
+        npt.assert_array_almost_equal(np.asarray(pcol1), np.asarray(pcol0))
+        npt.assert_array_almost_equal(np.asarray(qcol1), np.asarray(qcol0))
+
+    @parameterized.parameters(
+        {"N": 128},
+        {"N": 512},
+    )
+    def test__jacobi_update_second_step_packed_vertex__benchmark_performance(self, N):
+        tiles = (0,)
+        rotset = jacobi_sort_rotation_set(jacobi_next_rotation_set(jacobi_initial_rotation_set(N)))
+        rotset_packed = jacobi_pack_rotation_set(rotset)
+        rotset_idx_ignored = np.array([3], dtype=np.uint32)
+        cs = np.random.randn(N // 2, 2).astype(np.float32)
+        pcol = np.random.randn(N).astype(np.float32)
+        qcol = np.random.randn(N).astype(np.float32)
+
+        def jacobi_update_second_step_fn(cs, rotset, rotset_idx_ignored, pcol, qcol, packed):
+            cs, rotset, rotset_idx_ignored, pcol, qcol = [
+                tile_put_replicated(v, tiles) for v in (cs, rotset, rotset_idx_ignored, pcol, qcol)
+            ]
+            # Force synchronization at this point, before cycle count.
+            cs, rotset, rotset_idx_ignored, pcol, qcol = tile_data_barrier(cs, rotset, rotset_idx_ignored, pcol, qcol)
+            pcol, start = ipu_cycle_count(pcol)
+            if packed:
+                cs, _, _ = tile_map_primitive(  # type:ignore
+                    jacobi_update_second_step_packed_p, cs, rotset, rotset_idx_ignored, pcol, qcol
+                )
+            else:
+                cs, _, _ = tile_map_primitive(  # type:ignore
+                    jacobi_update_second_step_p, cs, rotset, rotset_idx_ignored, pcol, qcol, halfN=N // 2
+                )
+            cs, end = ipu_cycle_count(cs)
+            return cs, start, end
+
+        cycle_counts = []
+        for packed, rotset_arr in ((False, rotset), (True, rotset_packed)):
+            fn_ipu = jax.jit(partial(jacobi_update_second_step_fn, packed=packed), backend="ipu")
+            _, start, end = fn_ipu(cs, rotset_arr, rotset_idx_ignored, pcol, qcol)
+            start, end = np.asarray(start)[0], np.asarray(end)[0]
+            cycle_counts.append(end[0] - start[0])
+        unpacked_cycle_count, packed_cycle_count = cycle_counts
+        # Packed rotation set, 64 bits loads of pairs of rotations: targeting ~2x speed-up (with some margin).
+        assert packed_cycle_count <= 0.6 * unpacked_cycle_count
+        # print("CYCLE count:", N, unpacked_cycle_count, packed_cycle_count)
+        # assert False
+
     def test__jacobi_update_eigenvectors_vertex__benchmark_performance(self):
         N = 256
         tiles = (0,)
@@ -199,6 +316,97 @@ class IpuTileLinalgJacobi(chex.TestCase, parameterized.TestCase):
         npt.assert_array_almost_equal(eigvalues_sorted, expected_eigvalues, decimal=5)
         npt.assert_array_almost_equal(np.abs(eigvectors_sorted), np.abs(expected_eigvectors), decimal=5)
 
+    @parameterized.parameters([2, 4])
+    @unittest.skipUnless(ipu_num_tiles >= 16, "Requires IPU with 16 tiles")
+    def test__jacobi_eigh_block__same_result_as_non_block(self, block_size):
+        N = 16
+        x = np.random.randn(N, N).astype(np.float32)
+        x = (x + x.T) / 2.0
+
+        jacobi_eigh_fn = jax.jit(ipu_jacobi_eigh, backend="ipu", static_argnums=(1, 2))
+        A, VT = jacobi_eigh_fn(x, 2, 1)
+        Ablock, VTblock = jacobi_eigh_fn(x, 2, block_size)
+        npt.assert_array_almost_equal(np.asarray(Ablock), np.asarray(A), decimal=5)
+        npt.assert_array_almost_equal(np.asarray(VTblock), np.asarray(VT), decimal=5)
+
+    @unittest.skipUnless(ipu_num_tiles >= 16, "Requires IPU with 16 tiles")
+    def test__jacobi_eigh_pipelined__same_result_as_non_pipelined(self):
+        N = 16
+        x = np.random.randn(N, N).astype(np.float32)
+        x = (x + x.T) / 2.0
+
+        jacobi_eigh_fn = jax.jit(ipu_jacobi_eigh, backend="ipu", static_argnums=(1, 2, 3, 4))
+        A, VT = jacobi_eigh_fn(x, 2, 1, None, False)
+        Apipe, VTpipe = jacobi_eigh_fn(x, 2, 1, None, True)
+        npt.assert_array_almost_equal(np.asarray(Apipe), np.asarray(A), decimal=5)
+        npt.assert_array_almost_equal(np.asarray(VTpipe), np.asarray(VT), decimal=5)
+
+    @unittest.skipUnless(ipu_hw_available, "Requires IPU hardware")
+    def test__jacobi_eigh_pipelined__benchmark_performance(self):
+        N = 512
+        tiles = (0,)
+        x = np.random.randn(N, N).astype(np.float32)
+        x = (x + x.T) / 2.0
+
+        def jacobi_eigh_fn(x, pipelined):
+            x = tile_put_replicated(x, tiles)
+            x, start = ipu_cycle_count(x, sync=True)
+            A, VT = ipu_jacobi_eigh(x.array[0], num_iters=1, pipelined=pipelined)
+            A = tile_put_replicated(A, tiles)
+            VT = tile_put_replicated(VT, tiles)
+            A, VT, end = ipu_cycle_count(A, VT, sync=True)
+            return A.array[0], VT.array[0], start, end
+
+        cycle_counts = []
+        outputs = []
+        for pipelined in (False, True):
+            fn_ipu = jax.jit(partial(jacobi_eigh_fn, pipelined=pipelined), backend="ipu")
+            A, VT, start, end = fn_ipu(x)
+            start, end = np.asarray(start)[0], np.asarray(end)[0]
+            cycle_counts.append(end[0] - start[0])
+            outputs.append((np.asarray(A), np.asarray(VT)))
+        cycle_count, pipelined_cycle_count = cycle_counts
+        npt.assert_array_almost_equal(outputs[1][0], outputs[0][0], decimal=4)
+        npt.assert_array_almost_equal(outputs[1][1], outputs[0][1], decimal=4)
+        # Eigenvectors update grouped with the A tiles compute: one compute set less per step.
+        assert pipelined_cycle_count < cycle_count
+        # print("CYCLE count:", N, cycle_count, pipelined_cycle_count)
+        # assert False
+
+    @unittest.skipUnless(ipu_num_tiles >= 16, "Requires IPU with 16 tiles")
+    def test__jacobi_eigh__tolerance__early_exit(self):
+        N = 8
+        x = np.random.randn(N, N).astype(np.float32)
+        x = (x + x.T) / 2.0
+
+        jacobi_eigh_fn = jax.jit(partial(ipu_jacobi_eigh, num_iters=20, tol=1e-6), backend="ipu")
+        A, VT, num_sweeps = jacobi_eigh_fn(x)
+        A = np.asarray(A)
+        num_sweeps = int(num_sweeps)
+        assert 1 <= num_sweeps < 20
+        # Converged: off-diagonal norm below tolerance.
+        offdiag = A - np.diag(np.diag(A))
+        assert np.linalg.norm(offdiag) <= 1e-5 * np.linalg.norm(x)
+        expected_eigvalues, _ = np.linalg.eigh(x)
+        npt.assert_array_almost_equal(np.sort(np.diag(A)), expected_eigvalues, decimal=5)
+
+    @parameterized.parameters(
+        {"N": 4, "matrices_per_tile": 1},
+        {"N": 16, "matrices_per_tile": 7},
+    )
+    def test__jacobi_eigh_batched__proper_eigh_result(self, N, matrices_per_tile):
+        x = np.random.randn(2 * matrices_per_tile, N, N).astype(np.float32)
+        x = (x + np.transpose(x, (0, 2, 1))) / 2.0
+
+        ipu_eigh_fn = jax.jit(
+            lambda x: ipu_eigh_batched(x, num_sweeps=10, matrices_per_tile=matrices_per_tile), backend="ipu"
+        )
+        eigvectors, eigvalues = ipu_eigh_fn(x)
+        eigvectors, eigvalues = np.asarray(eigvectors), np.asarray(eigvalues)
+        expected_eigvalues, expected_eigvectors = np.linalg.eigh(x)
+        npt.assert_array_almost_equal(eigvalues, expected_eigvalues, decimal=5)
+        npt.assert_array_almost_equal(np.abs(eigvectors), np.abs(expected_eigvectors), decimal=5)
+
     @unittest.skipUnless(ipu_num_tiles >= 16, "Requires IPU with 16 tiles")
     def test__jacobi_eigh__not_sorting(self):
         N = 8
@@ -237,6 +445,23 @@ class IpuTileLinalgJacobi(chex.TestCase, parameterized.TestCase):
         npt.assert_array_almost_equal(eigvalues, expected_eigvalues, decimal=5)
         npt.assert_array_almost_equal(np.abs(eigvectors), np.abs(expected_eigvectors), decimal=5)
 
+    @unittest.skipUnless(ipu_num_tiles >= 16, "Requires IPU with 16 tiles")
+    def test__jacobi_eigh__block_size__sorting(self):
+        N = 16
+        x = np.random.randn(N, N).astype(np.float32)
+        x = (x + x.T) / 2.0
+
+        ipu_eigh_fn = jax.jit(lambda x: ipu_eigh(x, sort_eigenvalues=True, num_iters=6, block_size=2), backend="ipu")
+        eigvectors, eigvalues = ipu_eigh_fn(x)
+        expected_eigvalues, expected_eigvectors = np.linalg.eigh(x)
+        npt.assert_array_almost_equal(np.asarray(eigvalues), expected_eigvalues, decimal=5)
+        npt.assert_array_almost_equal(np.abs(np.asarray(eigvectors)), np.abs(expected_eigvectors), decimal=5)
+
+    def test__jacobi_eigh__too_many_tiles__raising_error(self):
+        x = np.zeros((2048, 2048), dtype=np.float32)
+        with self.assertRaises(ValueError):
+            ipu_eigh(x, block_size=1)
+
     @unittest.skipUnless(ipu_num_tiles >= 8, "Requires IPU with 8 tiles")
     def test__jacobi_eigh__sorting_failure_case(self):
         # Trivial diagonalization, but with multiple identical eigen values.
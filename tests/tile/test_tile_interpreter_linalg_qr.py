@@ -1,5 +1,6 @@
 # Copyright (c) 2022 Graphcore Ltd. All rights reserved.
 import unittest
+from functools import partial
 
 import chex
 import jax
@@ -19,16 +20,20 @@ from jax_ipu_experimental_addons.tile import (
 from jax_ipu_experimental_addons.tile.tile_interpreter_linalg_qr import (
     dot_product1d_p,
     ipu_qr,
+    ipu_qr_batched,
+    ipu_qr_correction_vector,
     ipu_qr_iterations,
     ipu_qr_shard_inputs,
     make_ipu_vector1d_worker_offsets,
     qr_correction_vector_p,
     qr_householder_row_update_p,
+    qr_householder_row_update_unbundled_p,
 )
 from jax_ipu_experimental_addons.utils import IpuTargetType
 
 # Skipping some tests if no local IPU hardware.
 ipu_hw_available = len(jax.devices("ipu")) > 0 and jax.devices("ipu")[0].target_type == IpuTargetType.IPU
+ipu_num_tiles = jax.devices("ipu")[0].num_tiles
 
 
 def qr_correction_vector_impl(rcol, sdiag, rcol_idx):
@@ -54,9 +59,9 @@ class IpuTileLinalgQR(chex.TestCase, parameterized.TestCase):
 
     @parameterized.parameters(
         {"N": 4, "expected_offsets": [0, 1, 2, 2, 2, 2, 2], "expected_stride": 1},
-        {"N": 16, "expected_offsets": [0, 2, 4, 6, 8, 8, 8], "expected_stride": 1},
+        {"N": 16, "expected_offsets": [0, 2, 4, 5, 6, 7, 8], "expected_stride": 1},
         {"N": 36, "expected_offsets": [0, 3, 6, 9, 12, 15, 18], "expected_stride": 1},
-        {"N": 128, "expected_offsets": [0, 11, 22, 33, 44, 55, 64], "expected_stride": 1},
+        {"N": 128, "expected_offsets": [0, 11, 22, 33, 44, 54, 64], "expected_stride": 1},
     )
     def test__tile_linalg__make_ipu_vector1d_worker_offsets(self, N, expected_offsets, expected_stride):
         vector_size = 2
@@ -120,6 +125,30 @@ class IpuTileLinalgQR(chex.TestCase, parameterized.TestCase):
         npt.assert_array_almost_equal(ret_ipu.array[0, :start_idx], ret_cpu[:start_idx])
         npt.assert_array_almost_equal(ret_ipu.array[0, start_idx:], ret_cpu[start_idx:])
 
+    @parameterized.parameters(
+        {"N": 16, "M": 16},
+        {"N": 48, "M": 32},
+    )
+    def test__qr_householder_row_update_p__float16_storage(self, N, M):
+        tiles = (0,)
+        x = np.random.randn(N).astype(np.float16)
+        v = np.random.randn(M).astype(np.float16)
+        w = 0.5 + np.random.rand(1).astype(np.float32)
+        start_idx = N - M
+
+        def qr_householder_update_fn(x, v, w):
+            x = tile_put_replicated(x, tiles)
+            v = tile_put_replicated(v, tiles)
+            w = tile_put_replicated(w, tiles)
+            return tile_map_primitive(qr_householder_row_update_p, x, v, w, w, start_idx=start_idx)
+
+        ret_ipu = jax.jit(qr_householder_update_fn, backend="ipu")(x, v, w)
+        ret_cpu = x.astype(np.float32)
+        ret_cpu[start_idx:] -= w[0] * w[0] * v.astype(np.float32)
+
+        assert ret_ipu.dtype == np.float16
+        npt.assert_array_almost_equal(ret_ipu.array[0].astype(np.float32), ret_cpu, decimal=2)
+
     def test__qr_householder_row_update_p__benchmark_performance(self):
         N = 32 * 8
         M = N
@@ -150,6 +179,64 @@ class IpuTileLinalgQR(chex.TestCase, parameterized.TestCase):
         # print("SIZE / CYCLE COUNT: ", N, qr_correction_cycle_count)
         # assert False
 
+    @unittest.skipUnless(ipu_hw_available, "Requires IPU hardware")
+    def test__qr_householder_row_update_p__bundled_loop_faster_than_unbundled(self):
+        N = 1024
+        tiles = (0,)
+        x = np.random.randn(N).astype(np.float32)
+        v = np.random.randn(N).astype(np.float32)
+        w = np.random.randn(1).astype(np.float32)
+
+        def qr_householder_update_fn(x, v, w, row_update_p):
+            x = tile_put_replicated(x, tiles)
+            v = tile_put_replicated(v, tiles)
+            w = tile_put_replicated(w, tiles)
+            # Need a first call to force all data transfers to tile.
+            x = tile_map_primitive(row_update_p, x, v, w, w, start_idx=0)
+            x, start = ipu_cycle_count(x)
+            x = tile_map_primitive(row_update_p, x, v, w, w, start_idx=0)
+            x, end = ipu_cycle_count(x)
+            return x, start, end
+
+        cycle_counts = []
+        outputs = []
+        for row_update_p in (qr_householder_row_update_p, qr_householder_row_update_unbundled_p):
+            fn_ipu = jax.jit(partial(qr_householder_update_fn, row_update_p=row_update_p), backend="ipu")
+            out, start, end = fn_ipu(x, v, w)
+            start, end = np.asarray(start)[0], np.asarray(end)[0]
+            cycle_counts.append(end[0] - start[0])
+            outputs.append(np.asarray(out.array[0]))
+        bundled_cycle_count, unbundled_cycle_count = cycle_counts
+        # Same result, in (at least) half of the cycles.
+        npt.assert_array_almost_equal(outputs[0], outputs[1], decimal=5)
+        assert bundled_cycle_count <= unbundled_cycle_count // 2
+
+    # IPU model run of the bundled instantiation, with interleaved `x` (at least 3 float2 per worker).
+    @parameterized.parameters(
+        {"N": 256, "M": 256},
+        {"N": 256, "M": 192},
+    )
+    def test__qr_householder_row_update_p__bundled_and_unbundled__same_result(self, N, M):
+        tiles = (0, 1)
+        x = np.random.randn(len(tiles), N).astype(np.float32)
+        v = np.random.randn(M).astype(np.float32)
+        w = 0.5 + np.random.rand(1).astype(np.float32)
+        start_idx = N - M
+
+        def qr_householder_update_fn(x, v, w, row_update_p):
+            x = tile_put_sharded(x, tiles)
+            v = tile_put_replicated(v, tiles)
+            w = tile_put_replicated(w, tiles)
+            return tile_map_primitive(row_update_p, x, v, w, w, start_idx=start_idx)
+
+        expected = x.copy()
+        expected[:, start_idx:] -= w[0] * w[0] * v
+        for row_update_p in (qr_householder_row_update_p, qr_householder_row_update_unbundled_p):
+            fn_ipu = jax.jit(partial(qr_householder_update_fn, row_update_p=row_update_p), backend="ipu")
+            output = fn_ipu(x, v, w)
+            assert output.tiles == tiles
+            npt.assert_array_almost_equal(output.array, expected, decimal=5)
+
     @unittest.skipUnless(ipu_hw_available, "Requires IPU hardware")
     @parameterized.parameters(
         {"N": 16, "col_idx": 0},
@@ -176,6 +263,32 @@ class IpuTileLinalgQR(chex.TestCase, parameterized.TestCase):
         npt.assert_array_equal(v_ipu.array[0][:col_idx], 0)
         npt.assert_array_almost_equal(v_ipu.array[0], v_exp)
 
+    # No worker spin-wait in the split vertices: supported on the IPU model.
+    @parameterized.parameters(
+        {"N": 16, "col_idx": 0, "tiles": (0,)},
+        {"N": 16, "col_idx": 13, "tiles": (0,)},
+        {"N": 16, "col_idx": 15, "tiles": (0,)},
+        # Multiple instances per tile.
+        {"N": 16, "col_idx": 5, "tiles": (0, 0, 1)},
+    )
+    def test__qr_correction_vector_split__proper_result(self, N, col_idx, tiles):
+        Rcol = np.random.randn(len(tiles), N).astype(np.float32)
+        sdiag = np.random.randn(len(tiles), N).astype(np.float32)
+
+        def qr_correction_vector_fn(Rcol, sdiag):
+            Rcol = tile_put_sharded(Rcol, tiles)
+            sdiag = tile_put_sharded(sdiag, tiles)
+            v_ipu, v_rescale = ipu_qr_correction_vector(Rcol, sdiag, col_idx=col_idx, split=True)
+            return v_ipu, v_rescale
+
+        qr_correction_vector_fn_ipu = jax.jit(qr_correction_vector_fn, backend="ipu")
+        v_ipu, v_rescale = qr_correction_vector_fn_ipu(Rcol, sdiag)
+        for idx in range(len(tiles)):
+            v_exp, v_rescale_exp = qr_correction_vector_impl(Rcol[idx], sdiag[idx], col_idx)
+            npt.assert_array_equal(v_ipu.array[idx][:col_idx], 0)
+            npt.assert_array_almost_equal(v_ipu.array[idx], v_exp)
+            npt.assert_array_almost_equal(v_rescale.array[idx], v_rescale_exp)
+
     def test__qr_correction_vector_vertex__benchmark_performance(self):
         N = 128
         tiles = (0,)
@@ -221,6 +334,37 @@ class IpuTileLinalgQR(chex.TestCase, parameterized.TestCase):
         npt.assert_array_almost_equal(np.abs(Q.array), np.abs(Qexp), decimal=5)
         npt.assert_array_almost_equal(np.abs(RT.array), np.abs(Rexp.T), decimal=5)
 
+    @unittest.skipUnless(ipu_num_tiles >= 32, "Requires IPU with 32 tiles")
+    def test__linalg_qr_ipu__split_correction_vector__result_close_to_numpy(self):
+        N = 16
+        x = np.random.randn(N, N).astype(np.float32)
+        x = (x + x.T) / 2
+        xsdiag = np.sign(np.diag(x)).astype(x.dtype)
+
+        qr_decomposition_fn_ipu = jax.jit(partial(ipu_qr, split_correction_vector=True), backend="ipu")
+        Q, RT = qr_decomposition_fn_ipu(x, xsdiag)
+        Qexp, Rexp = np.linalg.qr(x)
+
+        npt.assert_array_almost_equal(np.abs(Q.array), np.abs(Qexp), decimal=5)
+        npt.assert_array_almost_equal(np.abs(RT.array), np.abs(Rexp.T), decimal=5)
+
+    @parameterized.parameters(
+        {"N": 4, "matrices_per_tile": 1},
+        {"N": 8, "matrices_per_tile": 7},
+    )
+    def test__linalg_qr_batched_ipu__result_close_to_numpy(self, N, matrices_per_tile):
+        x = np.random.randn(2 * matrices_per_tile, N, N).astype(np.float32)
+        qr_batched_fn = jax.jit(lambda x: ipu_qr_batched(x, matrices_per_tile=matrices_per_tile), backend="ipu")
+        Q, R = qr_batched_fn(x)
+        Q, R = np.asarray(Q), np.asarray(R)
+
+        npt.assert_array_almost_equal(Q @ R, x, decimal=5)
+        npt.assert_array_almost_equal(np.triu(R), R)
+        for idx in range(x.shape[0]):
+            Qexp, Rexp = np.linalg.qr(x[idx])
+            npt.assert_array_almost_equal(np.abs(Q[idx]), np.abs(Qexp), decimal=5)
+            npt.assert_array_almost_equal(np.abs(R[idx]), np.abs(Rexp), decimal=5)
+
     @unittest.skipUnless(ipu_hw_available, "Requires IPU hardware")
     def test__linalg_qr_ipu__benchmark(self):
         N = 32
@@ -253,7 +397,7 @@ class IpuTileLinalgQR(chex.TestCase, parameterized.TestCase):
         # print("CYCLE COUNT, TIMING:", qr_cycle_count, timing * 1000)
         # assert False
 
-    @parameterized.parameters({"dtype": np.float32})
+    @parameterized.parameters({"dtype": np.float32}, {"dtype": np.float16})
     def test__dot_product1d__proper_result(self, dtype):
         IPU_NUM_THREADS = 6
         IPU_SIMD_WIDTH = 8 // dtype(0).nbytes
@@ -278,11 +422,13 @@ class IpuTileLinalgQR(chex.TestCase, parameterized.TestCase):
         dot_product1d_fn = jax.jit(dot_product1d_fn, backend="ipu")
         res = dot_product1d_fn(x, y)
         res = np.asarray(res)
-        assert res.shape == (T, WORKER_SIZE)
-        np_res = [np.dot(x[i], y[i]) for i in range(T)]
+        # FP32 partials, (float2 per worker), independently of the input dtype.
+        assert res.dtype == np.float32
+        assert res.shape == (T, IPU_NUM_THREADS * 2)
+        np_res = [np.dot(x[i].astype(np.float32), y[i].astype(np.float32)) for i in range(T)]
         ipu_res = np.sum(res, 1)
         # NOTE: accumulation accuracy changing a bit depending on the strategy.
-        npt.assert_array_almost_equal(ipu_res, np_res, decimal=5)
+        npt.assert_array_almost_equal(ipu_res, np_res, decimal=5 if dtype == np.float32 else 4)
 
     def test__dot_product1d__benchmark(self):
         N = 512
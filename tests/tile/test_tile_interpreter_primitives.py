@@ -12,6 +12,8 @@ from jax.core import Primitive, ShapedArray
 from jax_ipu_experimental_addons.tile.tile_common_utils import Base64Data, IpuType, from_ipu_type_to_numpy_dtype
 from jax_ipu_experimental_addons.tile.tile_interpreter_primitives import (
     from_numpy_dtype_to_ipu_type,
+    ipu_tile_constant_pool_clear,
+    ipu_tile_constant_pool_stats,
     make_ipu_vertex_attributes,
     make_ipu_vertex_constant_info,
     make_ipu_vertex_inputs,
@@ -20,6 +22,10 @@ from jax_ipu_experimental_addons.tile.tile_interpreter_primitives import (
     make_ipu_vertex_outputs,
     primitive_has_batching,
     primitive_has_impl,
+    tile_map_equation_cache_clear,
+    tile_map_equation_cache_get,
+    tile_map_equation_cache_set_max_size,
+    tile_map_equation_cache_stats,
 )
 from jax_ipu_experimental_addons.tile.tile_interpreter_primitives_impl import (
     IpuTensorSlice,
@@ -85,7 +91,7 @@ class IpuTileEquationBaseTests(chex.TestCase, parameterized.TestCase):
         ioinfo = IpuVertexIOInfo(name="in0", iotype=IpuVertexIOType.InOut, shape=[1, 2, 3], dtype=IpuType.FLOAT)
         assert (
             ioinfo.to_json_str()
-            == '{"aval":{"dtype":12,"shape":[1,2,3]},"constant_data":null,"iotype":2,"name":"in0","slices2d":[]}'
+            == '{"aval":{"dtype":12,"shape":[1,2,3]},"constant_data":null,"constant_sharded":false,"iotype":2,"name":"in0","slices2d":[]}'
         )
 
     def test__ipu_vertex_io_info__from_json_str__proper_representation(self):
@@ -98,6 +104,99 @@ class IpuTileEquationBaseTests(chex.TestCase, parameterized.TestCase):
         assert ioinfo.dtype == IpuType.FLOAT
         assert len(ioinfo.slices2d) == 1
 
+    def test__ipu_vertex_io_info__msgpack_bytes__proper_round_trip(self):
+        data = np.array([1, 2, 3], dtype=np.float32)
+        ioinfo = IpuVertexIOInfo(
+            name="in0",
+            iotype=IpuVertexIOType.In,
+            shape=[3],
+            dtype=IpuType.FLOAT,
+            constant_data=Base64Data(base64.b64encode(data)),
+        )
+        msgpack_bytes = ioinfo.to_msgpack_bytes()
+        assert isinstance(msgpack_bytes, bytes)
+        ioinfo_rt = IpuVertexIOInfo.from_msgpack_bytes(msgpack_bytes)
+        assert ioinfo_rt.name == "in0"
+        assert ioinfo_rt.shape == [3]
+        assert ioinfo_rt.is_constant_input
+        # Same JSON representation after the binary round trip.
+        assert ioinfo_rt.to_json_str() == ioinfo.to_json_str()
+
+    def test__ipu_tile_map_equation__msgpack_bytes__smaller_than_json(self):
+        data = np.arange(64, dtype=np.float32)
+        eqn = IpuTileMapEquation(
+            tiles=[10],
+            vname="vertex",
+            pname="prim",
+            inputs_info=[make_ipu_vertex_constant_info("in0", data)],
+            attributes_f32=[IpuVertexAttributeF32("test", 2.5)],
+        )
+        msgpack_bytes = eqn.to_msgpack_bytes()
+        assert len(msgpack_bytes) < len(eqn.to_json_str())
+        eqn_rt = IpuTileMapEquation.from_msgpack_bytes(msgpack_bytes)
+        assert eqn_rt.to_json_str() == eqn.to_json_str()
+
+    def test__tile_map_equation_cache__hits_and_misses(self):
+        data = np.arange(8, dtype=np.float32)
+        eqn = IpuTileMapEquation(
+            tiles=[3], vname="vertex", pname="prim", inputs_info=[make_ipu_vertex_constant_info("in0", data)]
+        )
+        tile_map_equation_cache_clear()
+        eqn_cached0 = tile_map_equation_cache_get(eqn.to_json_str())
+        eqn_cached1 = tile_map_equation_cache_get(eqn.to_json_str())
+        eqn_cached2 = tile_map_equation_cache_get(eqn.to_msgpack_bytes())
+        assert tile_map_equation_cache_stats() == {"hits": 1, "misses": 2, "size": 2}
+        # Same equation, with constant data already decoded.
+        for e in (eqn_cached0, eqn_cached1, eqn_cached2):
+            assert e.to_json_str() == eqn.to_json_str()
+        tile_map_equation_cache_clear()
+        assert tile_map_equation_cache_stats() == {"hits": 0, "misses": 0, "size": 0}
+
+    def test__tile_map_equation_cache__least_recently_used_eviction(self):
+        eqns = [IpuTileMapEquation(tiles=[idx], vname="vertex", pname="prim").to_json_str() for idx in range(3)]
+        tile_map_equation_cache_clear()
+        tile_map_equation_cache_set_max_size(2)
+        try:
+            tile_map_equation_cache_get(eqns[0])
+            tile_map_equation_cache_get(eqns[1])
+            # Most recent use of equation 0 => evicting equation 1.
+            tile_map_equation_cache_get(eqns[0])
+            tile_map_equation_cache_get(eqns[2])
+            assert tile_map_equation_cache_stats() == {"hits": 1, "misses": 3, "size": 2}
+            tile_map_equation_cache_get(eqns[0])
+            tile_map_equation_cache_get(eqns[1])
+            assert tile_map_equation_cache_stats() == {"hits": 2, "misses": 4, "size": 2}
+        finally:
+            tile_map_equation_cache_set_max_size(1024)
+            tile_map_equation_cache_clear()
+
+    def test__ipu_tile_constant_pool_stats__initial_empty_report(self):
+        ipu_tile_constant_pool_clear()
+        assert ipu_tile_constant_pool_stats() == {
+            "num_constants": 0,
+            "num_reused": 0,
+            "bytes_allocated": 0,
+            "bytes_saved": 0,
+        }
+
+    def test__ipu_tile_map_equation__input_to_output_tensor_aliasing__inout_tensors(self):
+        eqn = IpuTileMapEquation(
+            tiles=[3],
+            vname="vertex",
+            pname="prim",
+            inputs_info=[
+                make_ipu_vertex_constant_info("cst", np.arange(4, dtype=np.float32)),
+                make_ipu_vertex_io_info("x", IpuVertexIOType.In, ShapedArray((4,), np.float32)),
+                make_ipu_vertex_io_info("y", IpuVertexIOType.InOut, ShapedArray((4,), np.float32)),
+            ],
+            outputs_info=[
+                make_ipu_vertex_io_info("z", IpuVertexIOType.Out, ShapedArray((4,), np.float32)),
+                make_ipu_vertex_io_info("y", IpuVertexIOType.InOut, ShapedArray((4,), np.float32)),
+            ],
+        )
+        # Constant input not part of the custom primitive operands.
+        assert eqn.input_to_output_tensor_aliasing() == {1: 1}
+
     def test__ipu_tile_map_equation__init__proper_fields(self):
         eqn = IpuTileMapEquation(
             tiles=[10], vname="vertex", pname="prim", attributes_f32=[IpuVertexAttributeF32("test", 2.5)]
@@ -133,6 +232,24 @@ class IpuTileEquationBaseTests(chex.TestCase, parameterized.TestCase):
         dataout = np.frombuffer(base64.decodebytes(str.encode(info.constant_data.encoded_data)), dtype=datain.dtype)
         npt.assert_array_equal(dataout, datain)
 
+    def test__make_ipu_vertex_constant_info__sharded__proper_result(self):
+        datain = np.arange(12, dtype=np.int32).reshape((3, 4))
+        info = make_ipu_vertex_constant_info("constant", datain, vertex_dim2=2, sharded=True)
+        assert info.is_constant_input
+        assert info.constant_sharded
+        # Per tile shape, with full sharded data.
+        assert tuple(info.shape) == (4,)
+        assert len(info.slices2d) == 2
+        dataout = np.frombuffer(base64.decodebytes(str.encode(info.constant_data.encoded_data)), dtype=datain.dtype)
+        npt.assert_array_equal(dataout, datain.ravel())
+        # Sharded flag kept in serialized equations.
+        assert IpuVertexIOInfo.from_json_str(info.to_json_str()).constant_sharded
+        assert IpuVertexIOInfo.from_msgpack_bytes(info.to_msgpack_bytes()).constant_sharded
+
+    def test__make_ipu_vertex_constant_info__sharded_scalar__value_error(self):
+        with self.assertRaises(ValueError):
+            make_ipu_vertex_constant_info("constant", np.float32(1), sharded=True)
+
     def test__make_ipu_vertex_inputs__proper_results(self):
         inavals = {"in0": ShapedArray((3, 2), np.float16), "in1": ShapedArray((6,), np.uint8)}
         infos = make_ipu_vertex_inputs(inavals, {"in0"}, {"in1": 3})
@@ -14,6 +14,7 @@ from jax_ipu_experimental_addons.tile import (
     TileShardedArray,
     ipu_get_hw_seeds_tmap,
     ipu_random_normal_tmap,
+    ipu_random_truncated_normal_tmap,
     ipu_random_uniform_tmap,
     ipu_set_hw_seeds_tmap,
     tile_put_sharded,
@@ -82,6 +83,34 @@ class IpuTilePrimitivesRandomUniform(chex.TestCase, parameterized.TestCase):
         assert np.min(ipu_uniform_array) >= 0.0
         assert np.max(ipu_uniform_array) <= 2.0
 
+    @parameterized.parameters([(np.float32, 1), (np.float32, 1001), (np.float16, 3), (np.float16, 1003)])
+    def test__ipu_random_uniform_tmap__float_unaligned_size__all_values_sampled(self, dtype, size):
+        tiles = (1, 2, 3)
+
+        @partial(jax.jit, backend="ipu")
+        def compute_fn():
+            return ipu_random_uniform_tmap(tiles, size=size, dtype=dtype, offset=1.0, scale=2.0)
+
+        ipu_uniform_array = compute_fn()
+        assert ipu_uniform_array.shape == (len(tiles), size)
+        # Including the last elements sampled outside full vectors.
+        assert np.min(ipu_uniform_array) >= 1.0
+        assert np.max(ipu_uniform_array) <= 3.0
+
+    def test__ipu_random_uniform_tmap__float__decorrelated_tiles(self):
+        tiles = (1, 2, 3)
+        size = 1000
+
+        @partial(jax.jit, backend="ipu")
+        def compute_fn():
+            return ipu_random_uniform_tmap(tiles, size=size, dtype=np.float32, offset=0.0, scale=1.0)
+
+        ipu_uniform_array = np.asarray(compute_fn())
+        # Different samples on every tile (and worker), including on the IPU model.
+        assert len(np.unique(ipu_uniform_array)) > 0.99 * ipu_uniform_array.size
+        corrcoefs = np.corrcoef(ipu_uniform_array)
+        assert np.max(np.abs(corrcoefs[~np.eye(len(tiles), dtype=bool)])) < 0.2
+
     @parameterized.parameters([np.int32])
     def test__ipu_random_uniform_tmap__int__proper_random_array(self, dtype):
         tiles = (1, 2, 3)
@@ -123,3 +152,30 @@ class IpuTilePrimitivesRandomNormal(chex.TestCase, parameterized.TestCase):
 
         npt.assert_almost_equal(np.mean(ipu_normal_array), mean, decimal=1)
         npt.assert_almost_equal(np.std(np.asarray(ipu_normal_array, dtype=np.float32) - mean), stddev, decimal=1)
+
+
+class IpuTilePrimitivesRandomTruncatedNormal(chex.TestCase, parameterized.TestCase):
+    @parameterized.parameters([(np.float32, 10000), (np.float16, 10001)])
+    def test__ipu_random_truncated_normal_tmap__float__proper_random_array(self, dtype, size):
+        tiles = (1, 2, 3)
+        mean = 1.0
+        stddev = 2.0
+        alpha = 1.5
+
+        @partial(jax.jit, backend="ipu")
+        def compute_fn():
+            return ipu_random_truncated_normal_tmap(
+                tiles, size=size, dtype=dtype, mean=mean, stddev=stddev, alpha=alpha
+            )
+
+        ipu_normal_array = compute_fn()
+        assert isinstance(ipu_normal_array, TileShardedArray)
+        assert ipu_normal_array.shape == (len(tiles), size)
+        assert ipu_normal_array.dtype == dtype
+
+        ipu_normal_array = np.asarray(ipu_normal_array, dtype=np.float32)
+        assert np.min(ipu_normal_array) >= mean - alpha * stddev - 1e-2
+        assert np.max(ipu_normal_array) <= mean + alpha * stddev + 1e-2
+        npt.assert_almost_equal(np.mean(ipu_normal_array), mean, decimal=1)
+        # Truncated normal std: smaller than the normal std.
+        assert np.std(ipu_normal_array) < stddev
@@ -0,0 +1,101 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+from functools import partial
+
+import chex
+import jax
+import numpy as np
+import numpy.testing as npt
+from absl.testing import parameterized
+
+from jax_ipu_experimental_addons.tile import (
+    TileShardedArray,
+    make_tile_sparse_csr_matrix,
+    tile_put_sharded,
+    tile_sparse_csr_matvec,
+)
+from jax_ipu_experimental_addons.tile.tile_interpreter_sparse import make_sparse_worker_offsets
+
+
+def make_random_csr(M: int, N: int, density: float, dtype):
+    """Random sparse matrix, as (dense, data, indices, indptr)."""
+    dense = np.random.randn(M, N).astype(dtype)
+    dense *= np.random.rand(M, N) < density
+    rows, cols = np.nonzero(dense)
+    indptr = np.concatenate([[0], np.cumsum(np.bincount(rows, minlength=M))])
+    return dense, dense[rows, cols], cols, indptr
+
+
+class IpuTileSparseCsrMatrixTests(chex.TestCase, parameterized.TestCase):
+    def setUp(self):
+        super().setUp()
+        np.random.seed(42)
+
+    @parameterized.parameters([(16, 20, 3), (17, 20, 4), (5, 7, 5)])
+    def test__make_tile_sparse_csr_matrix__proper_row_blocks(self, M, N, num_tiles):
+        dense, data, indices, indptr = make_random_csr(M, N, 0.3, np.float32)
+        tiles = tuple(range(1, num_tiles + 1))
+        A = make_tile_sparse_csr_matrix(data, indices, indptr, (M, N), tiles)
+
+        assert A.tiles == tiles
+        assert A.nnz == len(data)
+        assert A.row_offsets.shape == (num_tiles, A.rows_per_tile + 1)
+        assert A.values.shape == A.col_indices.shape
+        assert A.worker_offsets.shape == (num_tiles, 7)
+        # Dense reconstruction from row blocks.
+        blocks = np.zeros((num_tiles, A.rows_per_tile, N), np.float32)
+        for t in range(num_tiles):
+            for r in range(A.rows_per_tile):
+                for k in range(A.row_offsets[t, r], A.row_offsets[t, r + 1]):
+                    blocks[t, r, A.columns[t, A.col_indices[t, k]]] += A.values[t, k]
+        npt.assert_array_equal(blocks.reshape((-1, N))[:M], dense)
+
+    def test__make_tile_sparse_csr_matrix__memory_scaling_with_nnz(self):
+        M, N = 64, 4096
+        dense, data, indices, indptr = make_random_csr(M, N, 0.01, np.float32)
+        A = make_tile_sparse_csr_matrix(data, indices, indptr, (M, N), tuple(range(4)))
+        # Gathered vector slices and values much smaller than dense blocks.
+        assert A.columns.shape[1] < N // 4
+        assert A.values.shape[1] < (M // 4) * N // 10
+
+    def test__make_sparse_worker_offsets__balanced_nnz_even_rows(self):
+        row_nnz = np.array([10, 0, 0, 10, 1, 1, 1, 1, 20, 0, 5, 5, 5, 5, 0, 1])
+        row_offsets = np.concatenate([[0], np.cumsum(row_nnz)]).astype(np.uint32)
+        offsets = make_sparse_worker_offsets(row_offsets)
+        assert offsets.dtype == np.uint16
+        assert offsets[0] == 0
+        assert offsets[-1] == len(row_nnz)
+        assert np.all(np.diff(offsets.astype(np.int32)) >= 0)
+        assert np.all(offsets[:-1] % 2 == 0)
+
+    @parameterized.parameters([("cpu", np.float32), ("ipu", np.float32), ("ipu", np.float16)])
+    def test__tile_sparse_csr_matvec__proper_result(self, backend, dtype):
+        M, N = 48, 40
+        dense, data, indices, indptr = make_random_csr(M, N, 0.2, dtype)
+        x = np.random.randn(N).astype(dtype)
+        A = make_tile_sparse_csr_matrix(data, indices, indptr, (M, N), (3, 4, 5, 6, 7))
+
+        @partial(jax.jit, backend=backend)
+        def compute_fn(x):
+            return tile_sparse_csr_matvec(A, x)
+
+        output = compute_fn(x)
+        assert isinstance(output, TileShardedArray)
+        assert output.tiles == A.tiles
+        assert output.shape == (len(A.tiles), A.rows_per_tile)
+        assert output.dtype == dtype
+        expected = dense.astype(np.float32) @ x.astype(np.float32)
+        tol = 1e-5 if dtype == np.float32 else 1e-2
+        npt.assert_allclose(np.asarray(output.array).reshape(-1)[:M], expected, rtol=tol, atol=tol)
+
+    def test__tile_sparse_csr_matvec__updated_values(self):
+        M, N = 16, 12
+        dense, data, indices, indptr = make_random_csr(M, N, 0.3, np.float32)
+        x = np.random.randn(N).astype(np.float32)
+        A = make_tile_sparse_csr_matrix(data, indices, indptr, (M, N), (1, 2))
+
+        @partial(jax.jit, backend="ipu")
+        def compute_fn(x, values):
+            return tile_sparse_csr_matvec(A, x, values=tile_put_sharded(values, A.tiles))
+
+        output = compute_fn(x, 2 * A.values)
+        npt.assert_allclose(np.asarray(output.array).reshape(-1)[:M], 2 * dense @ x, rtol=1e-5, atol=1e-5)
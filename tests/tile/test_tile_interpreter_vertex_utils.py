@@ -5,6 +5,7 @@ import numpy as np
 import numpy.testing as npt
 from absl.testing import parameterized
 
+from jax_ipu_experimental_addons.tile.tile_common_utils import make_balanced_worker_offsets
 from jax_ipu_experimental_addons.tile.tile_interpreter_vertex_utils import (
     make_ipu_vector1d_worker_offsets,
     make_num_elements_per_worker,
@@ -19,9 +20,10 @@ class IpuTileVertexUtils(chex.TestCase, parameterized.TestCase):
 
     @parameterized.parameters(
         {"N": 4, "expected_offsets": [0, 1, 2, 2, 2, 2, 2], "expected_stride": 1},
-        {"N": 16, "expected_offsets": [0, 2, 4, 6, 8, 8, 8], "expected_stride": 1},
+        {"N": 16, "expected_offsets": [0, 2, 4, 5, 6, 7, 8], "expected_stride": 1},
         {"N": 36, "expected_offsets": [0, 3, 6, 9, 12, 15, 18], "expected_stride": 1},
-        {"N": 128, "expected_offsets": [0, 11, 22, 33, 44, 55, 64], "expected_stride": 1},
+        {"N": 128, "expected_offsets": [0, 11, 22, 33, 44, 54, 64], "expected_stride": 1},
+        {"N": 2 * 6 * 5 + 2, "expected_offsets": [0, 6, 11, 16, 21, 26, 31], "expected_stride": 1},
     )
     def test__tile_vertex_utils__make_ipu_vector1d_worker_offsets(self, N, expected_offsets, expected_stride):
         vector_size = 2
@@ -31,6 +33,28 @@ class IpuTileVertexUtils(chex.TestCase, parameterized.TestCase):
         assert sum(woffsets[1:] - woffsets[:-1]) * vector_size == N
         npt.assert_array_equal(woffsets, expected_offsets)
 
+    @parameterized.parameters(
+        {"N": 0, "vector_size": 2, "grain": 1},
+        {"N": 14, "vector_size": 2, "grain": 1},
+        {"N": 1000, "vector_size": 4, "grain": 1},
+        {"N": 1000, "vector_size": 4, "grain": 3},
+        {"N": 8, "vector_size": 1, "grain": 4},
+    )
+    def test__tile_vertex_utils__make_ipu_vector1d_worker_offsets__balanced(self, N, vector_size, grain):
+        num_workers = 6
+        woffsets = make_ipu_vector1d_worker_offsets(N, vector_size, num_workers=num_workers, grain=grain)
+        wsizes = np.diff(woffsets.astype(np.int32))
+        assert woffsets[0] == 0
+        assert woffsets[-1] * vector_size == N
+        assert np.all(wsizes >= 0)
+        # At most one grain of difference, all workers starting at a grain boundary.
+        assert np.max(wsizes) - np.min(wsizes) <= grain
+        assert np.all(woffsets[:-1][wsizes > 0] % grain == 0)
+
+    def test__tile_vertex_utils__make_ipu_vector1d_worker_offsets__invalid_size(self):
+        with self.assertRaises(ValueError):
+            make_balanced_worker_offsets(7, 2, 6, 1)
+
     @parameterized.parameters(
         {"N": 0, "expected_num_elements": [0, 0, 0, 0, 0, 0]},
         {"N": 1, "expected_num_elements": [1, 0, 0, 0, 0, 0]},
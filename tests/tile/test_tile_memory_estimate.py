@@ -0,0 +1,107 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+import chex
+import jax
+import numpy as np
+from absl.testing import parameterized
+
+from jax_ipu_experimental_addons.tile import (
+    IPU_TILE_MEMORY_BYTES,
+    TileMemoryEstimate,
+    tile_constant_replicated,
+    tile_constant_sharded,
+    tile_gather,
+    tile_map_primitive,
+    tile_memory_estimate,
+    tile_put_replicated,
+    tile_put_sharded,
+)
+from jax_ipu_experimental_addons.tile.tile_memory_estimate import EXCHANGE_BYTES_PER_TRANSFER
+
+
+class TileMemoryEstimateTests(chex.TestCase, parameterized.TestCase):
+    def test__tile_memory_estimate__tile_put_sharded_map_primitive(self):
+        tiles = (0, 2, 5)
+        x = np.random.randn(3, 100).astype(np.float32)
+
+        def compute_fn(x):
+            return tile_map_primitive(jax.lax.neg_p, tile_put_sharded(x, tiles))
+
+        estimate = tile_memory_estimate(compute_fn, x)
+        assert isinstance(estimate, TileMemoryEstimate)
+        assert estimate.tiles == tiles
+        # Input and output tile arrays.
+        assert estimate.variables == {t: 800 for t in tiles}
+        assert estimate.constants == {}
+        assert estimate.exchange == {t: EXCHANGE_BYTES_PER_TRANSFER for t in tiles}
+        assert all([estimate.vertex_state[t] > 0 for t in tiles])
+        assert estimate.peak_tile == 0
+        assert estimate.peak_bytes == estimate.total[0]
+        assert estimate.fits()
+
+    def test__tile_memory_estimate__variables_liveness(self):
+        tiles = (1, 3)
+        x = np.random.randn(2, 100).astype(np.float32)
+
+        def compute_fn(x):
+            x = tile_put_sharded(x, tiles)
+            for _ in range(4):
+                x = tile_map_primitive(jax.lax.neg_p, x)
+            return x
+
+        estimate = tile_memory_estimate(compute_fn, x)
+        # At most 2 tile arrays live at the same time.
+        assert estimate.variables == {t: 800 for t in tiles}
+
+    def test__tile_memory_estimate__constants_deduplication(self):
+        tiles = (0, 1, 2)
+        data = np.arange(10, dtype=np.int32)
+        sharded_data = np.array([[1, 2], [3, 4], [1, 2]], dtype=np.float32)
+
+        def compute_fn():
+            c0 = tile_constant_replicated(data, tiles)
+            c1 = tile_constant_replicated(data, tiles)
+            c2 = tile_constant_sharded(sharded_data, tiles)
+            c3 = tile_constant_sharded(sharded_data[::-1], tiles)
+            return c0, c1, c2, c3
+
+        estimate = tile_memory_estimate(compute_fn)
+        assert estimate.constants == {0: 48, 1: 48, 2: 48}
+
+    def test__tile_memory_estimate__peak_tile_and_jit_calls(self):
+        x = np.random.randn(2, 1000).astype(np.float32)
+        y = np.random.randn(1000).astype(np.float32)
+
+        @jax.jit
+        def inner_fn(y):
+            return tile_put_replicated(y, (4,))
+
+        def compute_fn(x, y):
+            x = tile_put_sharded(x, (1, 4))
+            # No additional exchange from the same tiles.
+            x = tile_put_sharded(x.array, (1, 4))
+            return x, inner_fn(y)
+
+        estimate = tile_memory_estimate(compute_fn, x, y)
+        assert estimate.tiles == (1, 4)
+        # Second `tile_put_sharded` aliasing the first one (no copy).
+        assert estimate.variables == {1: 4000, 4: 8000}
+        assert estimate.exchange == {1: EXCHANGE_BYTES_PER_TRANSFER, 4: 2 * EXCHANGE_BYTES_PER_TRANSFER}
+        assert estimate.peak_tile == 4
+        assert estimate.peak_bytes == 8000 + 2 * EXCHANGE_BYTES_PER_TRANSFER
+        assert estimate.fits(IPU_TILE_MEMORY_BYTES)
+        assert estimate.fits(8000 + 2 * EXCHANGE_BYTES_PER_TRANSFER)
+        assert not estimate.fits(8000)
+
+    def test__tile_memory_estimate__tile_gather_aliasing_non_moved_slices(self):
+        tiles = (0, 1, 2)
+        x = np.random.randn(3, 100).astype(np.float32)
+
+        def compute_fn(x):
+            x = tile_put_sharded(x, tiles)
+            return x, tile_gather(x, (2, 1, 0), tiles)
+
+        estimate = tile_memory_estimate(compute_fn, x)
+        # Slice on tile 1 not moved, directly using the input data.
+        assert estimate.variables == {0: 800, 1: 400, 2: 800}
+        # Initial sharding, plus the two moved slices (sending and receiving tiles).
+        assert estimate.exchange == {t: (1 if t == 1 else 3) * EXCHANGE_BYTES_PER_TRANSFER for t in tiles}
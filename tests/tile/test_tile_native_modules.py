@@ -0,0 +1,90 @@
+# Copyright (c) 2023 Graphcore Ltd. All rights reserved.
+import importlib.machinery
+import os
+import tempfile
+from unittest import mock
+
+import chex
+
+from jax_ipu_experimental_addons.tile import tile_native_modules
+from jax_ipu_experimental_addons.tile.tile_native_modules import (
+    find_prebuilt_native_module,
+    get_native_module_cfg,
+    get_native_module_dependencies,
+    get_native_module_hash_filename,
+    make_native_module_sources_hash,
+    native_module_file_lock,
+)
+
+tile_dir = os.path.dirname(tile_native_modules.__file__)
+
+native_source = """// cppimport
+#include "my_utils.hpp"
+/*
+<%
+cfg['libraries'] = ['poplar']
+cfg['sources'] = ['my_other.cpp']
+setup_pybind11(cfg)
+%>
+*/
+"""
+
+
+class IpuTileNativeModulesTests(chex.TestCase):
+    def setUp(self):
+        super().setUp()
+        self.tmp_dir = tempfile.TemporaryDirectory()
+        self.fullname = "my_package.my_native_impl"
+        self.src_filename = os.path.join(self.tmp_dir.name, "my_native_impl.cpp")
+        for name, content in [("my_native_impl.cpp", native_source), ("my_utils.hpp", ""), ("my_other.cpp", "")]:
+            with open(os.path.join(self.tmp_dir.name, name), "w") as f:
+                f.write(content)
+
+    def tearDown(self):
+        self.tmp_dir.cleanup()
+        super().tearDown()
+
+    def write_prebuilt_module(self, sources_hash: str) -> str:
+        ext_filename = os.path.join(self.tmp_dir.name, "my_native_impl" + importlib.machinery.EXTENSION_SUFFIXES[0])
+        open(ext_filename, "w").close()
+        with open(get_native_module_hash_filename(self.tmp_dir.name, self.fullname), "w") as f:
+            f.write(sources_hash)
+        return ext_filename
+
+    def test__get_native_module_cfg__repository_modules(self):
+        cfg = get_native_module_cfg(os.path.join(tile_dir, "tile_interpreter_primitives_impl.cpp"))
+        assert "-std=c++17" in cfg["extra_compile_args"]
+        assert "poplar" in cfg["libraries"]
+        assert "poplin/ConvPartialsStridesPacking.cpp" in cfg["sources"]
+
+    def test__get_native_module_dependencies__includes_and_sources(self):
+        deps = get_native_module_dependencies(self.src_filename)
+        assert [os.path.basename(d) for d in deps] == ["my_native_impl.cpp", "my_utils.hpp", "my_other.cpp"]
+
+    def test__make_native_module_sources_hash__content_dependent(self):
+        sources_hash = make_native_module_sources_hash(self.src_filename)
+        assert sources_hash == make_native_module_sources_hash(self.src_filename)
+        with open(os.path.join(self.tmp_dir.name, "my_other.cpp"), "w") as f:
+            f.write("// update\n")
+        assert sources_hash != make_native_module_sources_hash(self.src_filename)
+
+    def test__find_prebuilt_native_module__no_prebuilt_module(self):
+        assert find_prebuilt_native_module(self.fullname, self.src_filename) is None
+
+    def test__find_prebuilt_native_module__up_to_date_module(self):
+        ext_filename = self.write_prebuilt_module(make_native_module_sources_hash(self.src_filename))
+        assert find_prebuilt_native_module(self.fullname, self.src_filename) == ext_filename
+
+    def test__find_prebuilt_native_module__outdated_module(self):
+        self.write_prebuilt_module(make_native_module_sources_hash(self.src_filename))
+        with open(os.path.join(self.tmp_dir.name, "my_utils.hpp"), "w") as f:
+            f.write("// update\n")
+        assert find_prebuilt_native_module(self.fullname, self.src_filename) is None
+
+    def test__native_module_file_lock__sequential_use(self):
+        with mock.patch.object(tempfile, "gettempdir", return_value=self.tmp_dir.name):
+            with native_module_file_lock(self.src_filename):
+                pass
+            with native_module_file_lock(self.src_filename):
+                pass
+            assert len([f for f in os.listdir(self.tmp_dir.name) if f.endswith(".lock")]) == 1